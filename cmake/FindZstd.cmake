@@ -0,0 +1,30 @@
+############################################################################
+# Check if the zstd library is installed
+#
+# This cmake file will define the following variables
+#    Zstd_FOUND, whether the zstd header and library can be found
+#    Zstd_LIBRARIES, the list of zstd libraries
+############################################################################
+message(STATUS "Detecting zstd library...")
+set(Zstd_FOUND TRUE)
+
+find_path(ZSTD_INCLUDE_DIR NAMES zstd.h)
+find_library(ZSTD_LIBRARY NAMES zstd)
+if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+    set(Zstd_LIBRARIES ${ZSTD_LIBRARY})
+    include_directories(${ZSTD_INCLUDE_DIR})
+    message(STATUS "Found libzstd: " ${ZSTD_LIBRARY})
+else()
+    message(STATUS "Cannot find libzstd, .zst files are not supported")
+    set(Zstd_FOUND FALSE)
+endif()
+
+if(Zstd_FOUND)
+    set(PHYDB_USE_ZSTD 1)
+else()
+    set(PHYDB_USE_ZSTD 0)
+endif()
+configure_file(
+    ${CMAKE_CURRENT_SOURCE_DIR}/phydb/common/config.h.in
+    ${CMAKE_CURRENT_SOURCE_DIR}/phydb/common/config.h
+)
@@ -22,7 +22,9 @@
 
 namespace phydb {
 
-Blockage::Blockage() :
+Blockage::Blockage() : Blockage(GeometryAllocator()) {}
+
+Blockage::Blockage(GeometryAllocator alloc) :
     layer_ptr_(nullptr),
     is_slots_(false),
     is_fills_(false),
@@ -34,7 +36,9 @@ Blockage::Blockage() :
     mask_num_(0),
     is_placement_(false),
     is_soft_(false),
-    max_density_(-1.0) {}
+    max_density_(-1.0),
+    rects_(alloc),
+    polygons_(alloc) {}
 
 void Blockage::SetLayer(Layer *layer_ptr) {
   if (is_placement_) {
@@ -189,11 +193,11 @@ double Blockage::GetMaxPlacementDensity() const {
   return max_density_;
 }
 
-std::vector<Rect2D<int>> &Blockage::GetRectsRef() {
+GeometryVector<Rect2D<int>> &Blockage::GetRectsRef() {
   return rects_;
 }
 
-std::vector<Points2D<int>> &Blockage::GetPolygonRef() {
+GeometryVector<Points2D<int>> &Blockage::GetPolygonRef() {
   return polygons_;
 }
 
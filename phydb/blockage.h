@@ -24,12 +24,15 @@
 #include "component.h"
 #include "datatype.h"
 #include "layer.h"
+#include "phydb/common/arena.h"
 
 namespace phydb {
 
 class Blockage {
+  friend class Snapshot;
  public:
   Blockage();
+  explicit Blockage(GeometryAllocator alloc);
   void SetLayer(Layer *layer_ptr);
   void SetSlots(bool is_slots = true);
   void SetFills(bool is_fills = true);
@@ -57,8 +60,8 @@ class Blockage {
   bool IsPlacement() const;
   bool IsSoft() const;
   double GetMaxPlacementDensity() const;
-  std::vector<Rect2D<int>> &GetRectsRef();
-  std::vector<Points2D<int>> &GetPolygonRef();
+  GeometryVector<Rect2D<int>> &GetRectsRef();
+  GeometryVector<Points2D<int>> &GetPolygonRef();
 
   void Report();
 
@@ -75,8 +78,8 @@ class Blockage {
   bool is_placement_;
   bool is_soft_;
   double max_density_;
-  std::vector<Rect2D<int>> rects_;
-  std::vector<Points2D<int>> polygons_;
+  GeometryVector<Rect2D<int>> rects_;
+  GeometryVector<Points2D<int>> polygons_;
 };
 
 }
@@ -27,6 +27,7 @@
 namespace phydb {
 
 class ClusterCol {
+  friend class Snapshot;
  public:
   ClusterCol() : lx_(0), ux_(0) {}
   ClusterCol(
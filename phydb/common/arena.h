@@ -0,0 +1,67 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_COMMON_ARENA_H_
+#define PHYDB_COMMON_ARENA_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace phydb {
+
+// geometry containers allocate from the arena of their design
+using GeometryAllocator = std::pmr::polymorphic_allocator<std::byte>;
+template<typename T>
+using GeometryVector = std::pmr::vector<T>;
+
+/****
+ * @brief Memory for the geometry of a design: special net paths and polygons,
+ * blockage rectangles, routing guides. Memory is taken from the system in
+ * large blocks and is only given back when the arena is destroyed, so loading
+ * millions of small shapes does not call malloc for each of them. A pool on
+ * top of the blocks recycles buffers left behind by growing vectors.
+ *
+ * Teardown is not O(1): every container still runs its destructor and hands
+ * its buffer back to the pool. This is cheap bookkeeping instead of a call
+ * to free() per container, and the blocks themselves go back to the system
+ * in a few calls.
+ *
+ * An arena is not thread-safe. Threads parsing in parallel use their own
+ * arena, and geometry is copied into the arena of the design when merged.
+ */
+class GeometryArena {
+ public:
+  static constexpr std::size_t kInitialBlockSize = 64 * 1024;
+
+  GeometryArena() : monotonic_(kInitialBlockSize), pool_(&monotonic_) {}
+  GeometryArena(GeometryArena const &) = delete;
+  GeometryArena &operator=(GeometryArena const &) = delete;
+
+  GeometryAllocator GetAllocator() { return GeometryAllocator(&pool_); }
+
+ private:
+  std::pmr::monotonic_buffer_resource monotonic_;
+  std::pmr::unsynchronized_pool_resource pool_;
+};
+
+}
+
+#endif //PHYDB_COMMON_ARENA_H_
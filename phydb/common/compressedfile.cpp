@@ -0,0 +1,329 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "compressedfile.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "phydb/common/config.h"
+#include "logging.h"
+
+#if PHYDB_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace phydb {
+
+static constexpr std::size_t kCompressedFileBufferSize = 1 << 20;
+
+static bool EndsWith(std::string const &str, std::string const &suffix) {
+  return str.size() >= suffix.size()
+      && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/****
+ * @brief Decides the compression format of a file by its name, ".gz" means
+ * gzip, ".zst" means zstd.
+ */
+FileCompression GetFileCompression(std::string const &file_name) {
+  if (EndsWith(file_name, ".gz")) {
+    return FileCompression::GZIP;
+  }
+  if (EndsWith(file_name, ".zst")) {
+    return FileCompression::ZSTD;
+  }
+  return FileCompression::NONE;
+}
+
+// writes the whole buffer to a file descriptor, false if the reader is gone
+static bool WriteToFd(int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    ssize_t res = write(fd, data, size);
+    if (res < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += res;
+    size -= static_cast<std::size_t>(res);
+  }
+  return true;
+}
+
+// reads up to size bytes, fewer bytes are returned only at the end of data
+static std::size_t ReadFromFd(int fd, char *data, std::size_t size) {
+  std::size_t total = 0;
+  while (total < size) {
+    ssize_t res = read(fd, data + total, size - total);
+    if (res < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (res == 0) break;
+    total += static_cast<std::size_t>(res);
+  }
+  return total;
+}
+
+/****
+ * @brief Opens a file for reading ("r") or writing ("w"). A plain file is
+ * opened by fopen() directly. For a compressed file, the compressed file is
+ * opened first, then a pipe is created, and a worker thread starts moving
+ * data between them.
+ *
+ * @param file_name: the name of the file
+ * @param mode: "r" or "w"
+ */
+CompressedFile::CompressedFile(std::string const &file_name, const char *mode) :
+    file_name_(file_name),
+    compression_(GetFileCompression(file_name)),
+    is_write_(mode[0] == 'w') {
+  PhyDBExpects(
+      mode[0] == 'r' || mode[0] == 'w',
+      "unsupported mode for a compressed file: " << mode
+  );
+  if (compression_ == FileCompression::NONE) {
+    stream_ = fopen(file_name.c_str(), is_write_ ? "w" : "r");
+    return;
+  }
+
+  if (compression_ == FileCompression::GZIP) {
+    gz_file_ = gzopen(file_name.c_str(), is_write_ ? "wb6" : "rb");
+    if (gz_file_ == nullptr) return;
+    gzbuffer(gz_file_, kCompressedFileBufferSize);
+  } else {
+#if PHYDB_USE_ZSTD
+    zstd_file_ = fopen(file_name.c_str(), is_write_ ? "wb" : "rb");
+    if (zstd_file_ == nullptr) return;
+#else
+    PhyDBExpects(
+        false,
+        "PhyDB is built without zstd, cannot open " << file_name
+    );
+#endif
+  }
+
+  int fds[2];
+  PhyDBExpects(pipe(fds) == 0, "Cannot create a pipe for " << file_name);
+#ifdef F_SETPIPE_SZ
+  // a larger pipe means fewer context switches, failing is harmless
+  fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(kCompressedFileBufferSize));
+#endif
+  if (is_write_) {
+    stream_ = fdopen(fds[1], "w");
+    pipe_fd_ = fds[0];
+    worker_ = std::thread(&CompressedFile::Compress, this);
+  } else {
+    stream_ = fdopen(fds[0], "r");
+    pipe_fd_ = fds[1];
+    worker_ = std::thread(&CompressedFile::Decompress, this);
+  }
+  PhyDBExpects(
+      stream_ != nullptr,
+      "Cannot open a pipe stream for " << file_name
+  );
+}
+
+CompressedFile::~CompressedFile() {
+  Close();
+}
+
+/****
+ * @brief Closes the stream and waits for the worker thread. When writing,
+ * the compressed file is complete after this function returns.
+ *
+ * @return true if no error happens
+ */
+bool CompressedFile::Close() {
+  if (stream_ == nullptr) {
+    return error_message_.empty();
+  }
+  bool is_ok = (fclose(stream_) == 0);
+  stream_ = nullptr;
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  if (!is_ok && error_message_.empty()) {
+    error_message_ = "Cannot close " + file_name_;
+  }
+  return error_message_.empty();
+}
+
+/****
+ * @brief The worker thread of reading, it decompresses the file into the
+ * pipe. If the reader closes the stream early, the worker stops quietly.
+ */
+void CompressedFile::Decompress() {
+  // a closed pipe gives EPIPE instead of killing the process
+  sigset_t sigpipe_set;
+  sigemptyset(&sigpipe_set);
+  sigaddset(&sigpipe_set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe_set, nullptr);
+
+  std::vector<char> out(kCompressedFileBufferSize);
+  if (compression_ == FileCompression::GZIP) {
+    while (true) {
+      int size = gzread(
+          gz_file_,
+          out.data(),
+          static_cast<unsigned>(out.size())
+      );
+      if (size < 0) {
+        int err_num;
+        error_message_ = file_name_ + ": " + gzerror(gz_file_, &err_num);
+        break;
+      }
+      if (size == 0 || !WriteToFd(pipe_fd_, out.data(), size)) break;
+    }
+    gzclose(gz_file_);
+    gz_file_ = nullptr;
+  } else {
+#if PHYDB_USE_ZSTD
+    ZSTD_DStream *dstream = ZSTD_createDStream();
+    ZSTD_initDStream(dstream);
+    std::vector<char> in(ZSTD_DStreamInSize());
+    bool is_reader_open = true;
+    std::size_t last_res = 0;
+    std::size_t size;
+    while (is_reader_open
+        && (size = fread(in.data(), 1, in.size(), zstd_file_)) > 0) {
+      ZSTD_inBuffer input = {in.data(), size, 0};
+      while (input.pos < input.size) {
+        ZSTD_outBuffer output = {out.data(), out.size(), 0};
+        last_res = ZSTD_decompressStream(dstream, &output, &input);
+        if (ZSTD_isError(last_res)) {
+          error_message_ = file_name_ + ": " + ZSTD_getErrorName(last_res);
+          is_reader_open = false;
+          break;
+        }
+        if (!WriteToFd(pipe_fd_, out.data(), output.pos)) {
+          is_reader_open = false;
+          break;
+        }
+      }
+    }
+    if (is_reader_open && last_res != 0) {
+      error_message_ = file_name_ + ": truncated zstd frame";
+    }
+    ZSTD_freeDStream(dstream);
+    fclose(zstd_file_);
+    zstd_file_ = nullptr;
+#endif
+  }
+  close(pipe_fd_);
+  pipe_fd_ = -1;
+}
+
+/****
+ * @brief The worker thread of writing, it compresses data from the pipe into
+ * the file until the writer closes the stream. After an error, the pipe is
+ * still drained so that the writer is never blocked.
+ */
+void CompressedFile::Compress() {
+  std::vector<char> in(kCompressedFileBufferSize);
+  std::size_t size;
+  if (compression_ == FileCompression::GZIP) {
+    while ((size = ReadFromFd(pipe_fd_, in.data(), in.size())) > 0) {
+      if (!error_message_.empty()) continue;
+      if (gzwrite(gz_file_, in.data(), static_cast<unsigned>(size)) == 0) {
+        int err_num;
+        error_message_ = file_name_ + ": " + gzerror(gz_file_, &err_num);
+      }
+    }
+    if (gzclose(gz_file_) != Z_OK && error_message_.empty()) {
+      error_message_ = "Cannot close " + file_name_;
+    }
+    gz_file_ = nullptr;
+  } else {
+#if PHYDB_USE_ZSTD
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, 3);
+    std::vector<char> out(ZSTD_CStreamOutSize());
+    auto compress = [&](ZSTD_inBuffer &input, ZSTD_EndDirective mode) {
+      std::size_t remaining;
+      do {
+        ZSTD_outBuffer output = {out.data(), out.size(), 0};
+        remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+        if (ZSTD_isError(remaining)) {
+          error_message_ = file_name_ + ": " + ZSTD_getErrorName(remaining);
+          return;
+        }
+        if (fwrite(out.data(), 1, output.pos, zstd_file_) != output.pos) {
+          error_message_ = "Cannot write " + file_name_;
+          return;
+        }
+      } while (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size);
+    };
+    while ((size = ReadFromFd(pipe_fd_, in.data(), in.size())) > 0) {
+      if (!error_message_.empty()) continue;
+      ZSTD_inBuffer input = {in.data(), size, 0};
+      compress(input, ZSTD_e_continue);
+    }
+    if (error_message_.empty()) {
+      ZSTD_inBuffer input = {nullptr, 0, 0};
+      compress(input, ZSTD_e_end);
+    }
+    ZSTD_freeCCtx(cctx);
+    if (fclose(zstd_file_) != 0 && error_message_.empty()) {
+      error_message_ = "Cannot close " + file_name_;
+    }
+    zstd_file_ = nullptr;
+#endif
+  }
+  close(pipe_fd_);
+  pipe_fd_ = -1;
+}
+
+/****
+ * @brief Reads the whole content of a file into memory, compressed files
+ * are decompressed.
+ *
+ * @param file_name: the name of the file
+ * @return the content of the file
+ */
+std::string ReadWholeFile(std::string const &file_name) {
+  CompressedFile file(file_name, "r");
+  PhyDBExpects(file.Stream() != nullptr, "Cannot open file " << file_name);
+  std::string content;
+  std::size_t size = 0;
+  while (true) {
+    content.resize(size + kCompressedFileBufferSize);
+    std::size_t res = fread(
+        &content[size],
+        1,
+        kCompressedFileBufferSize,
+        file.Stream()
+    );
+    size += res;
+    if (res < kCompressedFileBufferSize) break;
+  }
+  content.resize(size);
+  PhyDBExpects(file.Close(), file.GetErrorMessage());
+  return content;
+}
+
+}
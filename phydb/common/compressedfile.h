@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_COMMON_COMPRESSEDFILE_H_
+#define PHYDB_COMMON_COMPRESSEDFILE_H_
+
+#include <cstdio>
+
+#include <string>
+#include <thread>
+
+struct gzFile_s;
+
+namespace phydb {
+
+enum class FileCompression {
+  NONE = 0,
+  GZIP = 1,
+  ZSTD = 2
+};
+
+FileCompression GetFileCompression(std::string const &file_name);
+
+/****
+ * @brief A stdio stream of a file which is compressed by gzip or zstd if its
+ * name ends with ".gz" or ".zst", and a plain file otherwise. Parsers and
+ * writers working on a FILE pointer, such as the Si2 LEF/DEF parsers, can
+ * use it without knowing about compression.
+ *
+ * For a compressed file, the stream is one end of a pipe, and a worker thread
+ * decompresses the file into the pipe or compresses data from the pipe into
+ * the file, so that decompression runs concurrently with parsing, and
+ * compression concurrently with formatting. Nothing is written to a
+ * temporary file.
+ */
+class CompressedFile {
+ public:
+  CompressedFile(std::string const &file_name, const char *mode);
+  ~CompressedFile();
+  CompressedFile(CompressedFile const &) = delete;
+  CompressedFile &operator=(CompressedFile const &) = delete;
+
+  // nullptr if the file cannot be opened
+  FILE *Stream() const { return stream_; }
+  bool Close();
+  std::string const &GetErrorMessage() const { return error_message_; }
+
+ private:
+  std::string file_name_;
+  FileCompression compression_ = FileCompression::NONE;
+  bool is_write_ = false;
+  FILE *stream_ = nullptr;
+
+  // the compressed file and the pipe end used by the worker thread
+  gzFile_s *gz_file_ = nullptr;
+  FILE *zstd_file_ = nullptr;
+  int pipe_fd_ = -1;
+  std::thread worker_;
+  std::string error_message_;
+
+  void Decompress();
+  void Compress();
+};
+
+std::string ReadWholeFile(std::string const &file_name);
+
+}
+
+#endif //PHYDB_COMMON_COMPRESSEDFILE_H_
@@ -58,4 +58,18 @@ void StrTokenize(std::string &line, std::vector<std::string> &res) {
   }
 }
 
-}
\ No newline at end of file
+/****
+ * @brief Converts a user-provided thread count to a usable one
+ *
+ * @param num_threads: the requested number of threads, non-positive means
+ * using all hardware threads
+ * @return a thread count no less than 1
+ */
+int ResolveNumThreads(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(num_threads, 1);
+}
+
+}
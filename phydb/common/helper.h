@@ -21,13 +21,85 @@
 #ifndef PHYDB_COMMON_HELPER_H_
 #define PHYDB_COMMON_HELPER_H_
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "logging.h"
+
 namespace phydb {
 
 void StrTokenize(std::string &line, std::vector<std::string> &res);
 
+int ResolveNumThreads(int num_threads);
+
+/****
+ * @brief Runs func(i) for every i in [0, num_tasks) using a pool of threads.
+ * Tasks are handed out dynamically, so the execution order is not fixed,
+ * callers are responsible for writing results to task-private storage.
+ * If PhyDBExpects() fails in a task, no more tasks are started, and the
+ * first error is reported on the calling thread once all threads are joined.
+ *
+ * @param num_tasks: the number of tasks
+ * @param num_threads: the number of threads, non-positive means all cores
+ * @param func: a callable taking the task index
+ */
+template<typename Func>
+void ParallelFor(int num_tasks, int num_threads, Func func) {
+  num_threads = std::min(ResolveNumThreads(num_threads), num_tasks);
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      func(i);
+    }
+    return;
+  }
+  std::atomic<int> next_task(0);
+  std::atomic<bool> has_error(false);
+  std::exception_ptr first_error;
+  auto worker = [&]() {
+    bool &throws_on_error = PhyDBThrowsOnError();
+    bool saved_throws_on_error = throws_on_error;
+    throws_on_error = true;
+    try {
+      int task;
+      while ((task = next_task.fetch_add(1)) < num_tasks) {
+        func(task);
+      }
+    } catch (...) {
+      // keeps the first error, and stops handing out tasks
+      if (!has_error.exchange(true)) {
+        first_error = std::current_exception();
+      }
+      next_task.store(num_tasks);
+    }
+    throws_on_error = saved_throws_on_error;
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread: threads) {
+    thread.join();
+  }
+  if (first_error == nullptr) {
+    return;
+  }
+  if (PhyDBThrowsOnError()) {
+    // nested in another ParallelFor(), let the outer one report it
+    std::rethrow_exception(first_error);
+  }
+  try {
+    std::rethrow_exception(first_error);
+  } catch (std::exception const &e) {
+    PhyDBReportFatalError(e.what());
+  }
+}
+
 }
 
 #endif //PHYDB_COMMON_HELPER_H_
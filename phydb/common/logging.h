@@ -26,20 +26,56 @@
 
 #include <iostream>
 #include <map>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace phydb {
 
+/****
+ * @brief The error thrown by PhyDBExpects() on a thread running tasks of
+ * ParallelFor(). The message is reported on the calling thread after all
+ * workers have stopped.
+ */
+class PhyDBError : public std::runtime_error {
+ public:
+  explicit PhyDBError(std::string const &message)
+      : std::runtime_error(message) {}
+};
+
+/****
+ * @brief Whether PhyDBExpects() throws PhyDBError on this thread instead of
+ * exiting. Only ParallelFor() turns this on, for the threads it runs tasks on.
+ */
+inline bool &PhyDBThrowsOnError() {
+  thread_local bool throws_on_error = false;
+  return throws_on_error;
+}
+
+[[noreturn]] inline void PhyDBReportFatalError(std::string const &message) {
+  std::cout
+      << "\033[0;31m"
+      << "FATAL ERROR:" << "\n"
+      << "    " << message
+      << "\033[0m" << std::endl;
+  exit(1);
+}
+
+[[noreturn]] inline void PhyDBFails(std::string const &message) {
+  if (PhyDBThrowsOnError()) {
+    throw PhyDBError(message);
+  }
+  PhyDBReportFatalError(message);
+}
+
 #define PhyDBExpects(e, error_message) do{ \
   if(!(e)) { \
-    std::cout \
-      << "\033[0;31m" \
-      << "FATAL ERROR:" << "\n" \
-      << "    " << error_message << "\n" \
-      << __FILE__ << " : " << __LINE__ << " : " << __FUNCTION__ \
-      << "\033[0m" << std::endl; \
-      exit(1); \
+    std::ostringstream phydb_error_stream; \
+    phydb_error_stream \
+      << error_message << "\n" \
+      << __FILE__ << " : " << __LINE__ << " : " << __FUNCTION__; \
+    ::phydb::PhyDBFails(phydb_error_stream.str()); \
   } \
 } while(0)
 
@@ -0,0 +1,65 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "mappedfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+namespace phydb {
+
+/****
+ * @brief Maps a file into memory, the kernel is told that the file will be
+ * read sequentially. An empty file gives an empty range.
+ *
+ * @param file_name: the name of the file
+ */
+MappedFile::MappedFile(std::string const &file_name) {
+  fd_ = open(file_name.c_str(), O_RDONLY);
+  PhyDBExpects(fd_ >= 0, "Cannot open file " << file_name);
+  struct stat file_stat{};
+  PhyDBExpects(
+      fstat(fd_, &file_stat) == 0,
+      "Cannot get the size of file " << file_name
+  );
+  size_ = static_cast<std::size_t>(file_stat.st_size);
+  if (size_ == 0) {
+    return;
+  }
+  void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  PhyDBExpects(addr != MAP_FAILED, "Cannot map file " << file_name);
+  data_ = static_cast<const char *>(addr);
+  madvise(addr, size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_COMMON_MAPPEDFILE_H_
+#define PHYDB_COMMON_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace phydb {
+
+/****
+ * @brief A read-only memory mapping of a whole file. The content can be
+ * parsed in place without copying it into a buffer first.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(std::string const &file_name);
+  ~MappedFile();
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  const char *Begin() const { return data_; }
+  const char *End() const { return data_ + size_; }
+  std::size_t Size() const { return size_; }
+
+ private:
+  int fd_ = -1;
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}
+
+#endif //PHYDB_COMMON_MAPPEDFILE_H_
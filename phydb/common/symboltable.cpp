@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "symboltable.h"
+
+#include <mutex>
+
+#include "logging.h"
+
+namespace phydb {
+
+/****
+ * @brief Interns a string and returns the interned copy, which stays valid
+ * until the last user of the symbol table goes away
+ *
+ * @param str: the string to intern
+ * @return the interned copy
+ */
+std::string const &SymbolTable::InternString(std::string_view str) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto res = views_.find(str);
+    if (res != views_.end()) {
+      return *res->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto res = views_.find(str);
+  if (res != views_.end()) {
+    return *res->second;
+  }
+  std::string const &interned = strings_.emplace_back(str);
+  views_.emplace(interned, &interned);
+  return interned;
+}
+
+std::size_t SymbolTable::Size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return strings_.size();
+}
+
+void SymbolTable::AddUser() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  ++num_users_;
+}
+
+/****
+ * @brief Frees all interned strings when the last user goes away. Interned
+ * copies handed out before are invalid after that.
+ */
+void SymbolTable::RemoveUser() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  PhyDBExpects(num_users_ > 0, "Symbol table has no user to remove");
+  if (--num_users_ > 0) {
+    return;
+  }
+  std::unordered_map<std::string_view, std::string const *>().swap(views_);
+  std::deque<std::string>().swap(strings_);
+}
+
+/****
+ * @brief The symbol table shared by all PhyDB instances in the process. Names
+ * which appear in several databases, e.g., the same design loaded twice, are
+ * stored only once, and all names are freed when the last PhyDB is destroyed.
+ */
+SymbolTable &GlobalSymbolTable() {
+  static SymbolTable symbol_table;
+  return symbol_table;
+}
+
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_COMMON_SYMBOLTABLE_H_
+#define PHYDB_COMMON_SYMBOLTABLE_H_
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace phydb {
+
+/****
+ * @brief An append-only pool of interned strings. Each distinct string is
+ * stored exactly once. Interned strings live in a std::deque, so their
+ * addresses never change, and string_views of them can be used as keys of
+ * hash tables without owning a copy of the string.
+ *
+ * Interning and queries can be called from multiple threads.
+ */
+class SymbolTable {
+ public:
+  std::string const &InternString(std::string_view str);
+  std::size_t Size() const;
+
+  void AddUser();
+  void RemoveUser();
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::deque<std::string> strings_;
+  // maps a view of each interned string to the string
+  std::unordered_map<std::string_view, std::string const *> views_;
+  int num_users_ = 0;
+};
+
+SymbolTable &GlobalSymbolTable();
+
+/****
+ * @brief Returns the interned copy of a name from the global symbol table.
+ * Names of components, nets, pins and macros are stored this way, so that
+ * the objects only keep a pointer, and name-to-id maps only keep a view.
+ *
+ * The empty name is not stored in the table, it stays valid forever, so
+ * default constructed objects can point to it.
+ */
+inline std::string const &InternName(std::string_view name) {
+  if (name.empty()) {
+    static const std::string empty_name;
+    return empty_name;
+  }
+  return GlobalSymbolTable().InternString(name);
+}
+
+/****
+ * @brief Keeps names in the global symbol table alive. Every PhyDB holds one,
+ * and the interned names are freed when the last PhyDB is destroyed, so
+ * objects with interned names must not outlive all PhyDB instances.
+ */
+class SymbolTableUser {
+ public:
+  SymbolTableUser() { GlobalSymbolTable().AddUser(); }
+  ~SymbolTableUser() { GlobalSymbolTable().RemoveUser(); }
+  SymbolTableUser(SymbolTableUser const &) = delete;
+  SymbolTableUser &operator=(SymbolTableUser const &) = delete;
+};
+
+}
+
+#endif //PHYDB_COMMON_SYMBOLTABLE_H_
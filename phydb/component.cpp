@@ -20,21 +20,42 @@
  ******************************************************************************/
 #include "component.h"
 
+#include "placementtracker.h"
+#include "spatialindex.h"
+#include "tech.h"
 #include "phydb/common/logging.h"
 
 namespace phydb {
 
 void Component::SetPlacementStatus(PlaceStatus status) {
   place_status_ = status;
+  if (spatial_index_ptr_ != nullptr) {
+    spatial_index_ptr_->UpdateComponent(*this);
+  }
+  if (placement_tracker_ptr_ != nullptr) {
+    placement_tracker_ptr_->MarkComponentChanged(id_);
+  }
 }
 
 void Component::SetLocation(int lx, int ly) {
   location_.x = lx;
   location_.y = ly;
+  if (spatial_index_ptr_ != nullptr) {
+    spatial_index_ptr_->UpdateComponent(*this);
+  }
+  if (placement_tracker_ptr_ != nullptr) {
+    placement_tracker_ptr_->MarkComponentChanged(id_);
+  }
 }
 
 void Component::SetOrientation(CompOrient orient) {
   orient_ = orient;
+  if (spatial_index_ptr_ != nullptr) {
+    spatial_index_ptr_->UpdateComponent(*this);
+  }
+  if (placement_tracker_ptr_ != nullptr) {
+    placement_tracker_ptr_->MarkComponentChanged(id_);
+  }
 }
 
 void Component::SetSource(CompSource source) {
@@ -46,11 +67,11 @@ int Component::GetId() {
 }
 
 std::string const &Component::GetName() {
-  return name_;
+  return *name_;
 }
 
-Macro *Component::GetMacro() {
-  return macro_ptr_;
+MacroId Component::GetMacroId() const {
+  return macro_id_;
 }
 
 CompSource Component::GetSource() const {
@@ -87,9 +108,13 @@ int Component::GetWeight() {
 
 std::ostream &operator<<(std::ostream &os, Component &c) {
   os << c.GetId() << " "
-     << c.GetName() << " "
-     << c.GetMacro()->GetName() << " "
-     << c.GetSourceStr() << " "
+     << c.GetName() << " ";
+  if (c.tech_ptr_ != nullptr && c.macro_id_ >= 0) {
+    os << c.tech_ptr_->GetMacro(c.macro_id_).GetName() << " ";
+  } else {
+    os << "macro id: " << c.macro_id_ << " ";
+  }
+  os << c.GetSourceStr() << " "
      << c.GetPlacementStatusStr() << " "
      << c.GetOrientationStr() << "\n"
      << "weight: " << c.GetWeight()
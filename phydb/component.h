@@ -24,24 +24,33 @@
 #include "datatype.h"
 #include "enumtypes.h"
 #include "macro.h"
+#include "phydb/common/symboltable.h"
 
 namespace phydb {
 
+class PlacementTracker;
+class SpatialIndex;
+class Tech;
+
 class Component {
+  friend class Design;
+  friend class Snapshot;
+  friend class SpatialIndex;
+  friend std::ostream &operator<<(std::ostream &, Component &);
  public:
   Component() = default;
   Component(
       int id,
       std::string const &comp_name,
-      Macro *macro_ptr,
+      MacroId macro_id,
       CompSource source,
       PlaceStatus place_status,
       Point2D<int> location,
       CompOrient orient,
       int weight = 0
   ) : id_(id),
-      name_(comp_name),
-      macro_ptr_(macro_ptr),
+      name_(&InternName(comp_name)),
+      macro_id_(macro_id),
       source_(source),
       place_status_(place_status),
       location_(location),
@@ -50,7 +59,7 @@ class Component {
   Component(
       int id,
       std::string const &comp_name,
-      Macro *macro_ptr,
+      MacroId macro_id,
       CompSource source,
       PlaceStatus place_status,
       int llx,
@@ -58,8 +67,8 @@ class Component {
       CompOrient orient,
       int weight = 0
   ) : id_(id),
-      name_(comp_name),
-      macro_ptr_(macro_ptr),
+      name_(&InternName(comp_name)),
+      macro_id_(macro_id),
       source_(source),
       place_status_(place_status),
       location_(llx, lly),
@@ -73,7 +82,7 @@ class Component {
 
   int GetId();
   std::string const &GetName();
-  Macro *GetMacro();
+  MacroId GetMacroId() const;
   CompSource GetSource() const;
   std::string GetSourceStr() const;
   PlaceStatus GetPlacementStatus();
@@ -85,13 +94,19 @@ class Component {
 
  private:
   int id_{};
-  std::string name_;
-  Macro *macro_ptr_{};
+  std::string const *name_ = &InternName("");
+  MacroId macro_id_ = -1; // use Tech::GetMacro() to get the macro
   CompSource source_;
   PlaceStatus place_status_;
   Point2D<int> location_;
   CompOrient orient_;
   int weight_{};
+  // notified when the placement changes, set by SpatialIndex::Build()
+  SpatialIndex *spatial_index_ptr_ = nullptr;
+  // records placement changes, set by Design::AddComponent()
+  PlacementTracker *placement_tracker_ptr_ = nullptr;
+  // holds the macro, set by Design::AddComponent()
+  Tech *tech_ptr_ = nullptr;
 };
 
 std::ostream &operator<<(std::ostream &, Component &);
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_COMPONENTARRAYS_H_
+#define PHYDB_COMPONENTARRAYS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "enumtypes.h"
+#include "macro.h"
+
+namespace phydb {
+
+/****
+ * New placement of one component, applied in batches by
+ * Design::ApplyPlacementUpdates(). Locations are in DEF database unit.
+ */
+struct PlacementUpdate {
+  int comp_id;
+  int x;
+  int y;
+  CompOrient orient;
+};
+
+/****
+ * Structure-of-arrays view of the components of a design.
+ *
+ * Entry i of every array belongs to the component with id i. Locations and
+ * macro sizes are in DEF database unit, sizes are not rotated by the
+ * orientation. The view is a copy filled by Design::ExportComponentArrays(),
+ * changes to locations, orientations and placement status are written back by
+ * Design::ImportComponentArrays(). Macro ids and sizes are read-only.
+ */
+class ComponentArrays {
+  friend class Design;
+ public:
+  std::size_t Size() const { return x_.size(); }
+
+  std::vector<int> &GetXRef() { return x_; }
+  std::vector<int> &GetYRef() { return y_; }
+  std::vector<CompOrient> &GetOrientsRef() { return orients_; }
+  std::vector<PlaceStatus> &GetPlacementStatusesRef() { return statuses_; }
+  std::vector<MacroId> const &GetMacroIdsRef() const { return macro_ids_; }
+  std::vector<int> const &GetWidthsRef() const { return widths_; }
+  std::vector<int> const &GetHeightsRef() const { return heights_; }
+
+ private:
+  std::vector<int> x_;
+  std::vector<int> y_;
+  std::vector<CompOrient> orients_;
+  std::vector<PlaceStatus> statuses_;
+  std::vector<MacroId> macro_ids_;
+  std::vector<int> widths_;
+  std::vector<int> heights_;
+};
+
+}
+
+#endif //PHYDB_COMPONENTARRAYS_H_
@@ -26,6 +26,7 @@
 namespace phydb {
 
 class CornerSpacing {
+  friend class Snapshot;
  public:
   CornerSpacing() = default;
 
@@ -25,7 +25,7 @@
 namespace phydb {
 
 std::ostream &operator<<(std::ostream &os, const LayerRect &lr) {
-  os << lr.layer_name_ << "\n";
+  os << *lr.layer_name_ << "\n";
   for (auto rect : lr.rects_) {
     os << rect << "\n";
   }
@@ -60,12 +60,13 @@ Rect2D<double> LayerRect::GetBoundingBox() {
 }
 
 void LayerRect::Reset() {
-  layer_name_ = "";
+  layer_name_ = &InternName("");
+  layer_id_ = -1;
   rects_.clear();
 }
 
 void LayerRect::Report() {
-  std::cout << "Name: " << layer_name_ << "\n";
+  std::cout << "Name: " << *layer_name_ << "\n";
   for (auto &rect_2d : rects_) {
     std::cout << "  " << rect_2d.ll.Str() << " " << rect_2d.ur.Str() << "\n";
   }
@@ -26,6 +26,7 @@
 
 #include "enumtypes.h"
 #include "phydb/common/logging.h"
+#include "phydb/common/symboltable.h"
 
 namespace phydb {
 
@@ -282,20 +283,24 @@ class Range {
 
 class LayerRect {
  public:
-  std::string layer_name_;
+  std::string const *layer_name_ = &InternName("");
+  int layer_id_ = -1; // index in Tech::layers_, -1 if not resolved
   std::vector<Rect2D<double>> rects_;
 
-  LayerRect() : layer_name_("") {}
-  explicit LayerRect(std::string &layer_name) : layer_name_(layer_name) {}
+  LayerRect() {}
+  explicit LayerRect(std::string_view layer_name, int layer_id = -1) :
+      layer_name_(&InternName(layer_name)),
+      layer_id_(layer_id) {}
   LayerRect(
       const std::string &layer_name,
       const std::vector<Rect2D<double>> &rects
   ) :
-      layer_name_(layer_name),
+      layer_name_(&InternName(layer_name)),
       rects_(rects) {}
 
   // API to add LayerRect
   void AddRect(double llx, double lly, double urx, double ury);
+  const std::string &GetLayerName() const { return *layer_name_; }
   std::vector<Rect2D<double>> &GetRects();
   Rect2D<double> GetBoundingBox();
   void Reset();
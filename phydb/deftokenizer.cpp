@@ -0,0 +1,178 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "deftokenizer.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+
+#include "phydb/common/logging.h"
+
+namespace phydb {
+
+/****
+ * @brief Gets the next token
+ *
+ * @param token: the next token if there is one
+ * @return false if the end of the text is reached
+ */
+bool DefTokenizer::Next(std::string_view &token) {
+  while (cur_ < end_) {
+    if (std::isspace(static_cast<unsigned char>(*cur_))) {
+      ++cur_;
+    } else if (*cur_ == '#') {
+      while (cur_ < end_ && *cur_ != '\n') ++cur_;
+    } else {
+      break;
+    }
+  }
+  if (cur_ >= end_) {
+    return false;
+  }
+
+  const char *start = cur_;
+  if (*cur_ == '"') {
+    ++start;
+    ++cur_;
+    while (cur_ < end_ && *cur_ != '"') {
+      if (*cur_ == '\\' && cur_ + 1 < end_) ++cur_;
+      ++cur_;
+    }
+    token = std::string_view(start, cur_ - start);
+    if (cur_ < end_) ++cur_;
+    return true;
+  }
+
+  while (cur_ < end_ && !std::isspace(static_cast<unsigned char>(*cur_))) {
+    ++cur_;
+  }
+  token = std::string_view(start, cur_ - start);
+  return true;
+}
+
+/****
+ * @brief Gets the next token without consuming it
+ *
+ * @param token: the next token if there is one
+ * @return false if the end of the text is reached
+ */
+bool DefTokenizer::Peek(std::string_view &token) {
+  const char *saved = cur_;
+  bool res = Next(token);
+  cur_ = saved;
+  return res;
+}
+
+/****
+ * @brief Gets the next token, it is a fatal error if the text ends
+ *
+ * @param token: the next token
+ * @param context: the name of the DEF construct being parsed, for error messages
+ */
+void DefTokenizer::Expect(std::string_view &token, const char *context) {
+  PhyDBExpects(Next(token), "Unexpected end of DEF " << context);
+}
+
+/****
+ * @brief Consumes the next token and checks it against a literal
+ *
+ * @param literal: the expected token
+ * @param context: the name of the DEF construct being parsed, for error messages
+ */
+void DefTokenizer::ExpectLiteral(const char *literal, const char *context) {
+  std::string_view token;
+  Expect(token, context);
+  PhyDBExpects(
+      token == literal,
+      "Expect " << literal << " in DEF " << context << ", get: " << token
+  );
+}
+
+/****
+ * @brief Consumes the next token and converts it to an integer
+ *
+ * @param context: the name of the DEF construct being parsed, for error messages
+ * @return the integer value of the token
+ */
+int DefTokenizer::ExpectInt(const char *context) {
+  std::string_view token;
+  Expect(token, context);
+  return DefTokenToInt(token);
+}
+
+/****
+ * @brief Converts a DEF number to an integer, numbers with a fractional part
+ * are truncated in the same way as the Si2 parser does.
+ *
+ * @param token: a token holding a number
+ * @return the integer value of the token
+ */
+int DefTokenToInt(std::string_view token) {
+  int value = 0;
+  const char *first = token.data();
+  const char *last = token.data() + token.size();
+  if (first != last && *first == '+') ++first;
+  auto res = std::from_chars(first, last, value);
+  if (res.ec == std::errc() && res.ptr == last) {
+    return value;
+  }
+  std::string str(token);
+  char *end = nullptr;
+  double d = std::strtod(str.c_str(), &end);
+  PhyDBExpects(
+      end != str.c_str() && *end == '\0' && std::isfinite(d),
+      "Expect a number in DEF, get: " << token
+  );
+  return static_cast<int>(d);
+}
+
+/****
+ * @brief Converts a DEF token to an integer without reporting errors
+ *
+ * @param token: a token which may hold an integer
+ * @param value: the integer value if the conversion succeeds
+ * @return false if the token is not an integer
+ */
+bool TryDefTokenToInt(std::string_view token, int &value) {
+  const char *first = token.data();
+  const char *last = token.data() + token.size();
+  if (first != last && *first == '+') ++first;
+  auto res = std::from_chars(first, last, value);
+  return res.ec == std::errc() && res.ptr == last;
+}
+
+/****
+ * @brief Converts a DEF token to a floating point number without reporting
+ * errors
+ *
+ * @param token: a token which may hold a number
+ * @param value: the value if the conversion succeeds
+ * @return false if the token is not a number
+ */
+bool TryDefTokenToDouble(std::string_view token, double &value) {
+  std::string str(token);
+  char *end = nullptr;
+  value = std::strtod(str.c_str(), &end);
+  return !str.empty() && *end == '\0' && std::isfinite(value);
+}
+
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_DEFTOKENIZER_H_
+#define PHYDB_DEFTOKENIZER_H_
+
+#include <string>
+#include <string_view>
+
+namespace phydb {
+
+/****
+ * @brief A tokenizer working in place on a range of DEF text.
+ *
+ * Tokens are separated by white spaces, a '#' at the beginning of a token
+ * starts a comment until the end of the line, and a double-quoted string is
+ * returned as a single token without quotes. Tokens are views into the
+ * original text, so the text must outlive the tokens.
+ */
+class DefTokenizer {
+ public:
+  DefTokenizer(const char *begin, const char *end) :
+      cur_(begin),
+      end_(end) {}
+
+  bool Next(std::string_view &token);
+  bool Peek(std::string_view &token);
+  void Expect(std::string_view &token, const char *context);
+  void ExpectLiteral(const char *literal, const char *context);
+  int ExpectInt(const char *context);
+
+  const char *Position() const { return cur_; }
+
+ private:
+  const char *cur_;
+  const char *end_;
+};
+
+int DefTokenToInt(std::string_view token);
+bool TryDefTokenToInt(std::string_view token, int &value);
+bool TryDefTokenToDouble(std::string_view token, double &value);
+
+}
+
+#endif //PHYDB_DEFTOKENIZER_H_
@@ -29,6 +29,7 @@
 #include <lef/lefwWriter.hpp>
 #include <lef/lefwWriterCalls.hpp>
 
+#include "phydb/common/compressedfile.h"
 #include "phydb/common/logging.h"
 
 void CheckStatus(int status) {
@@ -198,13 +199,14 @@ int WriteComponents(defwCallbackType_e type, defiUserData data) {
     exit(2);
   }
   auto components = ((PhyDB *) data)->GetDesignPtr()->GetComponentsRef();
+  Tech *tech_ptr = ((PhyDB *) data)->GetTechPtr();
   int status = defwStartComponents(static_cast<int>(components.size()));
   CheckStatus(status);
 
   for (auto &comp : components) {
     status = defwComponentStr(
         comp.GetName().c_str(),
-        comp.GetMacro()->GetName().c_str(),
+        tech_ptr->GetMacro(comp.GetMacroId()).GetName().c_str(),
         0,
         NULL, NULL, NULL, NULL,
         comp.GetSourceStr().c_str(),
@@ -377,8 +379,12 @@ int WriteNets(defwCallbackType_e type, defiUserData data) {
 
   auto &components = phydb_ptr->GetDesignPtr()->GetComponentsRef();
   auto &io_pins = phydb_ptr->GetDesignPtr()->GetIoPinsRef();
+  auto &layers = phydb_ptr->GetTechPtr()->GetLayersRef();
+  NetWireStore &net_wires = phydb_ptr->GetNetWiresRef();
+  net_wires.BuildNetIndex();
 
   auto pin_str = (char *) "PIN";
+  int net_id = 0;
   for (auto &net : nets) {
     status = defwNet(net.GetName().c_str());
     CheckStatus(status);
@@ -393,13 +399,49 @@ int WriteNets(defwCallbackType_e type, defiUserData data) {
     for (auto &pin : net.GetPinsRef()) {
       int comp_id = pin.InstanceId();
       std::string component_name = components[comp_id].GetName();
-      std::string macro_name = components[comp_id].GetMacro()->GetName();
-      Macro *macro_ptr = phydb_ptr->GetMacroPtr(macro_name);
-      PhyDBExpects(macro_ptr != nullptr, "Macro does not exist");
-      std::string pin_name = macro_ptr->GetPinsRef()[pin.PinId()].GetName();
+      Macro &macro = phydb_ptr->GetTechPtr()->GetMacro(
+          components[comp_id].GetMacroId()
+      );
+      std::string pin_name = macro.GetPinsRef()[pin.PinId()].GetName();
       status = defwNetConnection(component_name.c_str(), pin_name.c_str(), 0);
       CheckStatus(status);
     }
+
+    // consecutive wires are merged into one path when possible
+    bool has_path = false;
+    int end = net_wires.GetNetEnd(net_id);
+    for (int i = net_wires.GetNetBegin(net_id); i < end; ++i) {
+      int layer_id = net_wires.GetLayerId(i);
+      if (layer_id < 0) continue;
+      double x, y;
+      if (!net_wires.IsPathContinued(i)) {
+        status = defwNetPathStart(has_path ? "NEW" : "ROUTED");
+        CheckStatus(status);
+        has_path = true;
+        status = defwNetPathLayer(layers[layer_id].GetName().c_str(), 0, NULL);
+        CheckStatus(status);
+        x = net_wires.GetX0(i);
+        y = net_wires.GetY0(i);
+        status = defwNetPathPoint(1, &x, &y);
+        CheckStatus(status);
+      }
+      if (net_wires.IsVia(i)) {
+        std::string const &via_name =
+            net_wires.GetViaName(net_wires.GetViaId(i));
+        status = defwNetPathVia(via_name.c_str());
+      } else {
+        x = net_wires.GetX1(i);
+        y = net_wires.GetY1(i);
+        status = defwNetPathPoint(1, &x, &y);
+      }
+      CheckStatus(status);
+    }
+    if (has_path) {
+      status = defwNetPathEnd();
+      CheckStatus(status);
+    }
+    ++net_id;
+
     status = defwNetEndOneNet();
     CheckStatus(status);
   }
@@ -476,6 +518,14 @@ int WriteSNets(defwCallbackType_e type, defiUserData ud) {
       }
       if (!path.GetViaName().empty()) {
         defwSpecialNetPathVia(path.GetViaName().c_str());
+        if (path.IsViaArray()) {
+          defwSpecialNetPathViaData(
+              path.GetViaNumX(),
+              path.GetViaNumY(),
+              path.GetViaStepX(),
+              path.GetViaStepY()
+          );
+        }
       }
     }
     defwSpecialNetPathEnd();
@@ -496,7 +546,8 @@ std::string GetCurrentDateTime() {
 }
 
 void Si2WriteDef(PhyDB *phy_db_ptr, std::string const &defFileName) {
-  FILE *f = fopen(defFileName.c_str(), "w");
+  CompressedFile def_file(defFileName, "w");
+  FILE *f = def_file.Stream();
   PhyDBExpects(f != nullptr, "Couldn't open Write def file");
   std::cout << "Writing def to " << defFileName << std::endl;
 
@@ -528,7 +579,7 @@ void Si2WriteDef(PhyDB *phy_db_ptr, std::string const &defFileName) {
   fprintf(f, "###########################\n");
 
   int res = defwWrite(f, defFileName.c_str(), (defiUserData) phy_db_ptr);
-  fclose(f);
+  PhyDBExpects(def_file.Close(), def_file.GetErrorMessage());
 
   PhyDBExpects(res == 0, "DEF Writer returns an error!");
   std::cout << "def writing completes" << std::endl;
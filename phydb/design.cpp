@@ -22,8 +22,14 @@
 
 #include <cmath>
 
+#include "netconnectivity.h"
+#include "spatialindex.h"
+
 namespace phydb {
 
+// defined here, where SpatialIndex and NetConnectivity are complete types
+Design::Design() = default;
+
 Design::~Design() {
   delete plus_filling_;
   delete well_filling_;
@@ -83,7 +89,21 @@ Track *Design::AddTrack(
     int step,
     std::vector<std::string> &layer_names
 ) {
-  tracks_.emplace_back(direction, start, num_tracks, step, layer_names);
+  std::vector<int> layer_ids;
+  layer_ids.reserve(layer_names.size());
+  for (auto &layer_name: layer_names) {
+    int layer_id = tech_ptr_->GetLayerId(layer_name);
+    PhyDBExpects(layer_id >= 0, "Track layer not found: " << layer_name);
+    layer_ids.push_back(layer_id);
+  }
+  tracks_.emplace_back(
+      direction,
+      start,
+      num_tracks,
+      step,
+      layer_names,
+      layer_ids
+  );
   return &(tracks_.back());
 }
 
@@ -134,6 +154,7 @@ void Design::SetComponentCount(int count, double redundancy_factor) {
   if (redundancy_factor < 1) redundancy_factor = 1;
   int actual_count = (int) std::ceil(count * redundancy_factor);
   components_.reserve(actual_count);
+  component_2_id_.reserve(actual_count);
 }
 
 bool Design::IsComponentExisting(std::string const &comp_name) {
@@ -142,7 +163,7 @@ bool Design::IsComponentExisting(std::string const &comp_name) {
 
 Component *Design::AddComponent(
     std::string const &comp_name,
-    Macro *macro_ptr,
+    MacroId macro_id,
     PlaceStatus place_status,
     int llx,
     int lly,
@@ -153,17 +174,24 @@ Component *Design::AddComponent(
       !IsComponentExisting(comp_name),
       "Component name_ exists, cannot use it again"
   );
+  InvalidateNetConnectivity();
   int id = static_cast<int>(components_.size());
   components_.emplace_back(
       id, comp_name,
-      macro_ptr,
+      macro_id,
       source,
       place_status,
       llx,
       lly,
       orient
   );
-  component_2_id_[comp_name] = id;
+  component_2_id_[components_[id].GetName()] = id;
+  placement_tracker_.SetComponentCount(components_.size());
+  components_[id].placement_tracker_ptr_ = &placement_tracker_;
+  components_[id].tech_ptr_ = tech_ptr_;
+  if (spatial_index_ != nullptr) {
+    spatial_index_->UpdateComponent(components_[id]);
+  }
   return &(components_[id]);
 }
 
@@ -184,6 +212,194 @@ int Design::GetComponentId(std::string const &comp_name) {
   return res->second;
 }
 
+/****
+ * @brief Copy the placement of all components into a structure-of-arrays
+ * view. Macro sizes are converted to DEF database unit once per macro.
+ *
+ * @param arrays: the view to fill, resized to the number of components
+ */
+void Design::ExportComponentArrays(ComponentArrays &arrays) {
+  PhyDBExpects(
+      tech_ptr_ != nullptr,
+      "Design has no technology, cannot look up macros of components"
+  );
+  PhyDBExpects(
+      unit_distance_micron_ > 0,
+      "DEF database unit is not set, cannot convert macro sizes"
+  );
+  auto &macros = tech_ptr_->GetMacrosRef();
+  std::vector<int> macro_widths(macros.size());
+  std::vector<int> macro_heights(macros.size());
+  for (size_t i = 0; i < macros.size(); ++i) {
+    macro_widths[i] = (int) std::round(
+        macros[i].GetWidth() * unit_distance_micron_
+    );
+    macro_heights[i] = (int) std::round(
+        macros[i].GetHeight() * unit_distance_micron_
+    );
+  }
+
+  size_t num_components = components_.size();
+  arrays.x_.resize(num_components);
+  arrays.y_.resize(num_components);
+  arrays.orients_.resize(num_components);
+  arrays.statuses_.resize(num_components);
+  arrays.macro_ids_.resize(num_components);
+  arrays.widths_.resize(num_components);
+  arrays.heights_.resize(num_components);
+  for (size_t i = 0; i < num_components; ++i) {
+    Component &component = components_[i];
+    arrays.x_[i] = component.location_.x;
+    arrays.y_[i] = component.location_.y;
+    arrays.orients_[i] = component.orient_;
+    arrays.statuses_[i] = component.place_status_;
+    MacroId macro_id = component.macro_id_;
+    arrays.macro_ids_[i] = macro_id;
+    arrays.widths_[i] = macro_id < 0 ? 0 : macro_widths[macro_id];
+    arrays.heights_[i] = macro_id < 0 ? 0 : macro_heights[macro_id];
+  }
+}
+
+/****
+ * @brief Write locations, orientations and placement status of a
+ * structure-of-arrays view back to the components.
+ *
+ * @param arrays: a view filled by ExportComponentArrays()
+ */
+void Design::ImportComponentArrays(ComponentArrays const &arrays) {
+  size_t num_components = components_.size();
+  PhyDBExpects(
+      arrays.x_.size() == num_components
+          && arrays.y_.size() == num_components
+          && arrays.orients_.size() == num_components
+          && arrays.statuses_.size() == num_components,
+      "Component arrays do not match the number of components: "
+          << num_components
+  );
+  ImportComponentPlacement(
+      arrays.x_.data(),
+      arrays.y_.data(),
+      arrays.orients_.data(),
+      arrays.statuses_.data()
+  );
+}
+
+/****
+ * @brief Copy the locations of all components into two flat arrays.
+ *
+ * @param x: array of at least as many entries as components
+ * @param y: array of at least as many entries as components
+ */
+void Design::ExportComponentLocations(int *x, int *y) const {
+  for (size_t i = 0; i < components_.size(); ++i) {
+    x[i] = components_[i].location_.x;
+    y[i] = components_[i].location_.y;
+  }
+}
+
+/****
+ * @brief Set the locations of all components from two flat arrays.
+ * Orientations and placement status are not changed.
+ *
+ * @param x: array of at least as many entries as components
+ * @param y: array of at least as many entries as components
+ */
+void Design::ImportComponentLocations(int const *x, int const *y) {
+  ImportComponentPlacement(x, y, nullptr, nullptr);
+}
+
+/****
+ * @brief Apply a batch of placement updates. The placement status of
+ * updated components is kept. All changed components are recorded in one
+ * placement epoch.
+ *
+ * @param updates: new locations and orientations of components
+ * @param count: the number of updates
+ */
+void Design::ApplyPlacementUpdates(
+    PlacementUpdate const *updates,
+    size_t count
+) {
+  int num_components = static_cast<int>(components_.size());
+  std::vector<int> changed_ids;
+  for (size_t i = 0; i < count; ++i) {
+    PlacementUpdate const &update = updates[i];
+    PhyDBExpects(
+        update.comp_id >= 0 && update.comp_id < num_components,
+        "Component id out of range: " << update.comp_id
+    );
+    Component &component = components_[update.comp_id];
+    if (component.location_.x == update.x
+        && component.location_.y == update.y
+        && component.orient_ == update.orient) {
+      continue;
+    }
+    component.location_.x = update.x;
+    component.location_.y = update.y;
+    component.orient_ = update.orient;
+    changed_ids.push_back(update.comp_id);
+  }
+  OnComponentsPlaced(changed_ids);
+}
+
+void Design::ApplyPlacementUpdates(
+    std::vector<PlacementUpdate> const &updates
+) {
+  ApplyPlacementUpdates(updates.data(), updates.size());
+}
+
+/****
+ * @brief Assign the placement of all components. Orientations and placement
+ * status are kept when their arrays are nullptr.
+ */
+void Design::ImportComponentPlacement(
+    int const *x,
+    int const *y,
+    CompOrient const *orients,
+    PlaceStatus const *statuses
+) {
+  std::vector<int> changed_ids;
+  for (size_t i = 0; i < components_.size(); ++i) {
+    Component &component = components_[i];
+    bool is_changed = component.location_.x != x[i]
+        || component.location_.y != y[i];
+    component.location_.x = x[i];
+    component.location_.y = y[i];
+    if (orients != nullptr) {
+      is_changed |= component.orient_ != orients[i];
+      component.orient_ = orients[i];
+    }
+    if (statuses != nullptr) {
+      is_changed |= component.place_status_ != statuses[i];
+      component.place_status_ = statuses[i];
+    }
+    if (is_changed) {
+      changed_ids.push_back(static_cast<int>(i));
+    }
+  }
+  OnComponentsPlaced(changed_ids);
+}
+
+/****
+ * @brief Record components changed by a bulk update in a new placement
+ * epoch, and re-index them if a spatial index exists.
+ *
+ * @param changed_ids: ids of the changed components, may contain duplicates
+ */
+void Design::OnComponentsPlaced(std::vector<int> const &changed_ids) {
+  if (changed_ids.empty()) return;
+  placement_tracker_.MarkComponentsChanged(changed_ids);
+  if (spatial_index_ == nullptr) return;
+  // a bulk rebuild is cheaper than many single removals and insertions
+  if (changed_ids.size() > components_.size() / 8) {
+    spatial_index_->Build();
+    return;
+  }
+  for (int id : changed_ids) {
+    spatial_index_->UpdateComponent(components_[id]);
+  }
+}
+
 bool Design::IsDefViaExisting(std::string const &name) {
   return def_via_2_id_.find(name) != def_via_2_id_.end();
 }
@@ -193,7 +409,7 @@ DefVia *Design::AddDefVia(std::string const &via_name) {
                "Macro name_ exists, cannot use it again");
   int id = (int) vias_.size();
   vias_.emplace_back(via_name);
-  via_2_id_[via_name] = id;
+  via_2_id_[InternName(via_name)] = id;
   return &(vias_[id]);
 }
 
@@ -207,6 +423,7 @@ DefVia *Design::GetDefViaPtr(std::string const &via_name) {
 
 void Design::SetIoPinCount(int count) {
   iopins_.reserve(count);
+  iopin_2_id_.reserve(count);
 }
 
 bool Design::IsIoPinExisting(std::string const &iopin_name) {
@@ -220,9 +437,10 @@ IOPin *Design::AddIoPin(
 ) {
   PhyDBExpects(!IsIoPinExisting(iopin_name),
                "IOPin name_ exists, cannot use it again");
+  InvalidateNetConnectivity();
   int id = (int) iopins_.size();
   iopins_.emplace_back(iopin_name, signal_direction, signal_use);
-  iopin_2_id_[iopin_name] = id;
+  iopin_2_id_[iopins_[id].GetName()] = id;
   return &(iopins_[id]);
 }
 
@@ -244,15 +462,18 @@ int Design::GetIoPinId(std::string const &iopin_name) {
 }
 
 void Design::SetBlockageCount(int count) {
+  LoadLazyBlockages();
   blockages_.reserve(count);
 }
 
 Blockage *Design::AddBlockage() {
-  blockages_.emplace_back();
+  LoadLazyBlockages();
+  blockages_.emplace_back(geometry_arena_.GetAllocator());
   return &(blockages_.back());
 }
 
 Blockage *Design::GetBlockage(int index) {
+  LoadLazyBlockages();
   if (static_cast<int>(blockages_.size()) > index) {
     return nullptr;
   }
@@ -260,6 +481,7 @@ Blockage *Design::GetBlockage(int index) {
 }
 
 std::vector<Blockage> &Design::GetBlockagesRef() {
+  LoadLazyBlockages();
   return blockages_;
 }
 
@@ -270,6 +492,7 @@ void Design::SetNetCount(
   if (redundancy_factor < 1) redundancy_factor = 1;
   int actual_count = (int) std::ceil(count * redundancy_factor);
   nets_.reserve(actual_count);
+  net_2_id_.reserve(actual_count);
 }
 
 bool Design::IsNetExisting(std::string const &net_name) {
@@ -279,9 +502,10 @@ bool Design::IsNetExisting(std::string const &net_name) {
 Net *Design::AddNet(std::string const &net_name, double weight) {
   PhyDBExpects(!IsNetExisting(net_name),
                "Net name exists, cannot use it again");
+  InvalidateNetConnectivity();
   int id = (int) nets_.size();
-  nets_.emplace_back(net_name, weight);
-  net_2_id_[net_name] = id;
+  nets_.emplace_back(net_name, weight, geometry_arena_.GetAllocator());
+  net_2_id_[nets_[id].GetName()] = id;
   return &(nets_[id]);
 }
 
@@ -294,6 +518,7 @@ void Design::AddIoPinToNet(int iopin_id, int net_id) {
       (net_id < static_cast<int>(nets_.size())) && (net_id >= 0),
       "net id out of bound: " << net_id
   );
+  InvalidateNetConnectivity();
   iopins_[iopin_id].SetNetId(net_id);
   nets_[net_id].AddIoPin(iopin_id);
 }
@@ -303,6 +528,7 @@ void Design::AddCompPinToNet(int comp_id, int pin_id, int net_id) {
       (net_id < static_cast<int>(nets_.size())) && (net_id >= 0),
       "net id out of bound: " << net_id
   );
+  InvalidateNetConnectivity();
   nets_[net_id].AddCompPin(comp_id, pin_id);
 }
 
@@ -323,24 +549,67 @@ int Design::GetNetId(std::string const &net_name) {
 }
 
 SNet *Design::AddSNet(std::string const &net_name, SignalUse use) {
+  LoadLazySNets();
   bool e = (use == phydb::SignalUse::GROUND || use == phydb::SignalUse::POWER);
   PhyDBExpects(e, "special net use should be POWER or GROUND");
   int id = (int) snets_.size();
-  snets_.emplace_back(net_name, use);
-  snet_2_id_[net_name] = id;
+  snets_.emplace_back(net_name, use, geometry_arena_.GetAllocator());
+  snet_2_id_[InternName(net_name)] = id;
   return &snets_[id];
 }
 
 SNet *Design::GetSNet(std::string const &net_name) {
+  LoadLazySNets();
   bool e = (snet_2_id_.find(net_name) != snet_2_id_.end());
   PhyDBExpects(e, "snet is not found");
   return &snets_[snet_2_id_[net_name]];
 }
 
 std::vector<SNet> &Design::GetSNetRef() {
+  LoadLazySNets();
   return snets_;
 }
 
+/****
+ * @brief Defers loading SPECIALNETS until the first access to special nets.
+ * AddSNet() also calls the loader first, so ids are the same as the ones given
+ * by loading the whole DEF file at once.
+ *
+ * @param loader: a function adding all special nets of the section
+ */
+void Design::SetLazySNetLoader(std::function<void()> loader) {
+  snet_loader_ = std::move(loader);
+}
+
+/****
+ * @brief Defers loading BLOCKAGES until the first access to blockages.
+ *
+ * @param loader: a function adding all blockages of the section
+ */
+void Design::SetLazyBlockageLoader(std::function<void()> loader) {
+  blockage_loader_ = std::move(loader);
+}
+
+void Design::LoadLazySections() {
+  LoadLazySNets();
+  LoadLazyBlockages();
+}
+
+void Design::LoadLazySNets() {
+  if (!snet_loader_) return;
+  // the loader adds special nets through AddSNet(), so it is cleared first
+  std::function<void()> loader = std::move(snet_loader_);
+  snet_loader_ = nullptr;
+  loader();
+}
+
+void Design::LoadLazyBlockages() {
+  if (!blockage_loader_) return;
+  std::function<void()> loader = std::move(blockage_loader_);
+  blockage_loader_ = nullptr;
+  loader();
+}
+
 ClusterCol *Design::AddClusterCol(
     std::string const &name,
     std::string const &bot_signal
@@ -389,7 +658,7 @@ void Design::SetDefName(std::string const &def_file_name) {
 }
 
 SpecialMacroRectLayout *Design::CreatePpNpMacroAndComponent(
-    Macro *macro_ptr,
+    MacroId macro_id,
     int llx,
     int lly,
     int urx,
@@ -397,7 +666,7 @@ SpecialMacroRectLayout *Design::CreatePpNpMacroAndComponent(
 ) {
   delete plus_filling_;
   plus_filling_ = new SpecialMacroRectLayout(
-      macro_ptr,
+      macro_id,
       llx,
       lly,
       urx,
@@ -413,7 +682,7 @@ void Design::SavePpNpToRectFile(std::string const &file_name) const {
 }
 
 SpecialMacroRectLayout *Design::CreateWellLayerMacroAndComponent(
-    Macro *macro_ptr,
+    MacroId macro_id,
     int llx,
     int lly,
     int urx,
@@ -421,7 +690,7 @@ SpecialMacroRectLayout *Design::CreateWellLayerMacroAndComponent(
 ) {
   delete well_filling_;
   well_filling_ = new SpecialMacroRectLayout(
-      macro_ptr,
+      macro_id,
       llx,
       lly,
       urx,
@@ -440,7 +709,9 @@ void Design::SaveWellToRectFile(std::string const &file_name) const {
  * @brief Get the center of the bounding box of the component pin.
  * Every component pin consists of metal segments, whose shape may or may not be
  * regular. This method returns the center of the bounding box as its location
- * as an approximation.
+ * as an approximation. The offset of this center is looked up in the
+ * per-orientation table of the macro, which is computed on first use if
+ * Tech::ComputePinOffsets() has not been called.
  *
  * @param comp_id: index of the component
  * @param pin_id: index of the pin
@@ -448,22 +719,16 @@ void Design::SaveWellToRectFile(std::string const &file_name) const {
  */
 Point2D<int> Design::GetComponentPinLocation(int comp_id, int pin_id) {
   Component &comp = components_[comp_id];
-  Macro &macro = *(comp.GetMacro());
-  Pin &pin = macro.GetPinsRef()[pin_id];
+  Macro &macro = tech_ptr_->GetMacro(comp.GetMacroId());
+  if (!macro.IsPinOffsetsValid(unit_distance_micron_)) {
+    macro.ComputePinOffsets(unit_distance_micron_);
+  }
+  Point2D<int> const &offset =
+      macro.GetPinCenterOffset(comp.GetOrientation(), pin_id);
 
-  Rect2D<double> bbox = pin.GetBoundingBox();
-  Point2D<double> bb_center(
-      (bbox.LLX() + bbox.URX()) / 2.0,
-      (bbox.LLY() + bbox.URY()) / 2.0
-  );
-  bb_center.Rotate(comp.GetOrientation(), macro.GetWidth(), macro.GetHeight());
-
-  Point2D<int> comp_loc = comp.GetLocation();
-  Point2D<int> res;
-  res.x = comp_loc.x
-      + static_cast<int>(std::round(bb_center.x * GetUnitsDistanceMicrons()));
-  res.y = comp_loc.y
-      + static_cast<int>(std::round(bb_center.y * GetUnitsDistanceMicrons()));
+  Point2D<int> res = comp.GetLocation();
+  res.x += offset.x;
+  res.y += offset.y;
   return res;
 }
 
@@ -478,6 +743,64 @@ Point2D<int> Design::GetIoPinLocation(int iopin_id) {
   return iopin.GetLocation();
 }
 
+/****
+ * @brief Build (or rebuild) the spatial index of this design. Once built,
+ * the index follows placement changes of components.
+ *
+ * @return the pointer to the spatial index
+ */
+SpatialIndex *Design::BuildSpatialIndex() {
+  if (spatial_index_ == nullptr) {
+    spatial_index_ = std::make_unique<SpatialIndex>(this);
+  }
+  spatial_index_->Build();
+  return spatial_index_.get();
+}
+
+/****
+ * @brief Delete the spatial index, components stop notifying it.
+ */
+void Design::ClearSpatialIndex() {
+  spatial_index_.reset();
+}
+
+/****
+ * @brief Build (or rebuild) the CSR connectivity of the current netlist. The
+ * connectivity is rebuilt in place, so its address does not change during
+ * the lifetime of this design.
+ *
+ * @return the pointer to the connectivity
+ */
+NetConnectivity *Design::BuildNetConnectivity() {
+  if (net_connectivity_ == nullptr) {
+    net_connectivity_ = std::make_unique<NetConnectivity>(this);
+  }
+  net_connectivity_->Build();
+  is_connectivity_stale_ = false;
+  return net_connectivity_.get();
+}
+
+/****
+ * @brief Get the CSR connectivity of the current netlist.
+ *
+ * @return the pointer to the connectivity, or nullptr if it has not been
+ * built since the last netlist change
+ */
+NetConnectivity *Design::GetNetConnectivityPtr() {
+  if (is_connectivity_stale_) return nullptr;
+  return net_connectivity_.get();
+}
+
+/****
+ * @brief Mark the connectivity out of date after a netlist change. Users
+ * holding the connectivity compare GetConnectivityGeneration() with the
+ * generation they were built at, and rebuild when it differs.
+ */
+void Design::InvalidateNetConnectivity() {
+  is_connectivity_stale_ = true;
+  ++connectivity_generation_;
+}
+
 void Design::ReportTracks() {
   std::cout << "Total number of track: " << tracks_.size() << "\n";
   for (auto &track : tracks_) {
@@ -511,6 +834,7 @@ void Design::ReportIoPins() {
 }
 
 void Design::ReportBlockages() {
+  LoadLazyBlockages();
   std::cout << "Total blockages: " << blockages_.size() << "\n";
   for (auto &blockage : blockages_) {
     blockage.Report();
@@ -543,6 +867,7 @@ void Design::ReportGcellGrids() {
 }
 
 void Design::ReportSNets() {
+  LoadLazySNets();
   std::cout << "Total SNets: " << snets_.size() << "\n";
   for (auto &n : snets_) {
     n.Report();
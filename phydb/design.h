@@ -21,29 +21,53 @@
 #ifndef PHYDB_DESIGN_H_
 #define PHYDB_DESIGN_H_
 
+#include <functional>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "blockage.h"
 #include "clustercol.h"
 #include "component.h"
+#include "componentarrays.h"
 #include "defvia.h"
 #include "gcellgrid.h"
 #include "iopin.h"
 #include "net.h"
+#include "netwire.h"
+#include "placementtracker.h"
 #include "row.h"
 #include "snet.h"
 #include "specialmacrorectlayout.h"
 #include "tech.h"
 #include "track.h"
+#include "phydb/common/arena.h"
 #include "phydb/common/logging.h"
 
 namespace phydb {
 
+class NetConnectivity;
+class SpatialIndex;
+
 class Design {
+  friend class Snapshot;
  public:
-  Design() = default;
+  Design();
   ~Design();
+  // geometry lives in the arena of this design, and components point to its
+  // placement tracker and spatial index, so a design cannot be copied
+  Design(Design const &) = delete;
+  Design &operator=(Design const &) = delete;
+
+  // the technology containing macros of components, set by PhyDB
+  void SetTechPtr(Tech *tech_ptr) { tech_ptr_ = tech_ptr; }
+  Tech *GetTechPtr() { return tech_ptr_; }
+
+  // paths, polygons, blockage rects and routing guides live in this arena
+  GeometryAllocator GetGeometryAllocator() {
+    return geometry_arena_.GetAllocator();
+  }
 
   void SetVersion(double version);
   void SetDividerChar(std::string const &divider_char);
@@ -109,7 +133,7 @@ class Design {
   bool IsComponentExisting(std::string const &comp_name);
   Component *AddComponent(
       std::string const &comp_name,
-      Macro *macro_ptr,
+      MacroId macro_id,
       PlaceStatus place_status,
       int llx,
       int lly,
@@ -119,9 +143,19 @@ class Design {
   Component *GetComponentPtr(std::string const &comp_name);
   int GetComponentId(std::string const &comp_name);
   std::vector<Component> &GetComponentsRef() { return components_; }
-  std::unordered_map<std::string, int> &GetComponentNameMapRef() {
+  std::unordered_map<std::string_view, int> &GetComponentNameMapRef() {
     return component_2_id_;
   }
+  // bulk placement access, arrays are indexed by component id
+  void ExportComponentArrays(ComponentArrays &arrays);
+  void ImportComponentArrays(ComponentArrays const &arrays);
+  void ExportComponentLocations(int *x, int *y) const;
+  void ImportComponentLocations(int const *x, int const *y);
+  void ApplyPlacementUpdates(PlacementUpdate const *updates, size_t count);
+  void ApplyPlacementUpdates(std::vector<PlacementUpdate> const &updates);
+  // which components moved since a given epoch
+  PlacementTracker &GetPlacementTrackerRef() { return placement_tracker_; }
+  uint64_t GetPlacementEpoch() const { return placement_tracker_.GetEpoch(); }
 
   void SetIoPinCount(int count);
   bool IsIoPinExisting(std::string const &iopin_name);
@@ -133,7 +167,7 @@ class Design {
   IOPin *GetIoPinPtr(std::string const &iopin_name);
   int GetIoPinId(std::string const &iopin_name);
   std::vector<IOPin> &GetIoPinsRef() { return iopins_; }
-  std::unordered_map<std::string, int> &GetIoPinNameMapRef() {
+  std::unordered_map<std::string_view, int> &GetIoPinNameMapRef() {
     return iopin_2_id_;
   }
 
@@ -150,12 +184,22 @@ class Design {
   Net *GetNetPtr(std::string const &net_name);
   int GetNetId(std::string const &net_name);
   std::vector<Net> &GetNetsRef() { return nets_; }
-  std::unordered_map<std::string, int> &GetNetNameMapRef() { return net_2_id_; }
+  std::unordered_map<std::string_view, int> &GetNetNameMapRef() {
+    return net_2_id_;
+  }
+  NetWireStore &GetNetWiresRef() { return net_wires_; }
 
   SNet *AddSNet(std::string const &net_name, SignalUse use);
   SNet *GetSNet(std::string const &net_name);
   std::vector<SNet> &GetSNetRef();
 
+  // a loader is called once on the first access to its section
+  void SetLazySNetLoader(std::function<void()> loader);
+  void SetLazyBlockageLoader(std::function<void()> loader);
+  bool IsSNetLoaded() const { return !snet_loader_; }
+  bool IsBlockageLoaded() const { return !blockage_loader_; }
+  void LoadLazySections();
+
   ClusterCol *AddClusterCol(
       std::string const &name,
       std::string const &bot_signal
@@ -166,7 +210,7 @@ class Design {
   void SetDefName(std::string const &def_file_name);
 
   SpecialMacroRectLayout *CreatePpNpMacroAndComponent(
-      Macro *macro_ptr,
+      MacroId macro_id,
       int llx,
       int lly,
       int urx,
@@ -174,7 +218,7 @@ class Design {
   );
   void SavePpNpToRectFile(std::string const &file_name) const;
   SpecialMacroRectLayout *CreateWellLayerMacroAndComponent(
-      Macro *macro_ptr,
+      MacroId macro_id,
       int llx,
       int lly,
       int urx,
@@ -188,6 +232,20 @@ class Design {
   // get the center of the bounding box of the I/O pin
   Point2D<int> GetIoPinLocation(int iopin_id);
 
+  // spatial index over components, pin shapes, blockages and IO pins
+  SpatialIndex *BuildSpatialIndex();
+  SpatialIndex *GetSpatialIndexPtr() { return spatial_index_.get(); }
+  void ClearSpatialIndex();
+
+  // frozen CSR connectivity, rebuilt in place, nullptr while out of date
+  NetConnectivity *BuildNetConnectivity();
+  NetConnectivity *GetNetConnectivityPtr();
+  void InvalidateNetConnectivity();
+  // incremented whenever the netlist changes
+  uint64_t GetConnectivityGeneration() const {
+    return connectivity_generation_;
+  }
+
   // print various information to console for debugging purposes
   void ReportTracks();
   void ReportRows();
@@ -200,6 +258,19 @@ class Design {
   void ReportGcellGrids();
   void Report();
  private:
+  void LoadLazySNets();
+  void LoadLazyBlockages();
+  void ImportComponentPlacement(
+      int const *x,
+      int const *y,
+      CompOrient const *orients,
+      PlaceStatus const *statuses
+  );
+  void OnComponentsPlaced(std::vector<int> const &changed_ids);
+
+  Tech *tech_ptr_ = nullptr;
+  // declared before the containers using it, so it is destroyed after them
+  GeometryArena geometry_arena_;
   std::string name_;
   double version_ = -1;
   std::string divider_char_;
@@ -211,21 +282,25 @@ class Design {
   std::vector<Row> rows_;
   std::vector<Track> tracks_;
   std::vector<Component> components_;
+  PlacementTracker placement_tracker_;
   std::vector<IOPin> iopins_;
   std::vector<SNet> snets_;
   std::vector<Net> nets_;
+  NetWireStore net_wires_; // routed wiring of nets
   std::vector<DefVia> vias_;
   std::vector<ClusterCol> cluster_cols_;
   std::vector<GcellGrid> gcell_grids_;
   std::vector<Blockage> blockages_;
+  std::function<void()> snet_loader_; // set if SPECIALNETS is not loaded yet
+  std::function<void()> blockage_loader_; // set if BLOCKAGES is not loaded yet
 
-  std::unordered_map<std::string, int> component_2_id_;
-  std::unordered_map<std::string, int> iopin_2_id_;
-  std::unordered_map<std::string, int> def_via_2_id_;
+  std::unordered_map<std::string_view, int> component_2_id_;
+  std::unordered_map<std::string_view, int> iopin_2_id_;
+  std::unordered_map<std::string_view, int> def_via_2_id_;
   std::unordered_map<std::string, int> layer_name_2_trackid_;
-  std::unordered_map<std::string, int> net_2_id_;
-  std::unordered_map<std::string, int> snet_2_id_;
-  std::unordered_map<std::string, int> via_2_id_;
+  std::unordered_map<std::string_view, int> net_2_id_;
+  std::unordered_map<std::string_view, int> snet_2_id_;
+  std::unordered_map<std::string_view, int> via_2_id_;
   std::unordered_set<std::string> row_set_;
 
   /****DEF file name****/
@@ -234,6 +309,14 @@ class Design {
   /****Nplus/Pplus and N/P-well filling****/
   SpecialMacroRectLayout *plus_filling_ = nullptr;
   SpecialMacroRectLayout *well_filling_ = nullptr;
+
+  /****spatial index, built on demand****/
+  std::unique_ptr<SpatialIndex> spatial_index_;
+
+  /****net connectivity, built on demand****/
+  std::unique_ptr<NetConnectivity> net_connectivity_;
+  bool is_connectivity_stale_ = true;
+  uint64_t connectivity_generation_ = 0;
 };
 
 }
@@ -145,6 +145,23 @@ enum class SiteClass {
 SiteClass StrToSiteClass(std::string const &str_site_class);
 std::string SiteClassStr(SiteClass site_class);
 
+// bits of DEF sections loaded by PhyDB::ReadDef(), the header (VERSION, UNITS,
+// DIEAREA, ROW, TRACKS, GCELLGRID, ...) is always loaded
+typedef unsigned int DefSectionMask;
+constexpr DefSectionMask kDefComponents = 1u << 0;
+constexpr DefSectionMask kDefPins = 1u << 1;
+constexpr DefSectionMask kDefNets = 1u << 2;
+constexpr DefSectionMask kDefNetWiring = 1u << 3; // routed wiring in NETS
+constexpr DefSectionMask kDefSpecialNets = 1u << 4;
+constexpr DefSectionMask kDefBlockages = 1u << 5;
+constexpr DefSectionMask kDefVias = 1u << 6;
+constexpr DefSectionMask kDefAllSections = (1u << 7) - 1;
+constexpr DefSectionMask kDefPlacementSections = kDefComponents | kDefPins;
+constexpr DefSectionMask kDefConnectivitySections =
+    kDefComponents | kDefPins | kDefNets;
+// sections which can be loaded on first access
+constexpr DefSectionMask kDefLazySections = kDefSpecialNets | kDefBlockages;
+
 class Symmetry {
  public:
   Symmetry() = default;
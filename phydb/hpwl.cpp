@@ -0,0 +1,181 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "hpwl.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "netconnectivity.h"
+#include "phydb/common/helper.h"
+
+namespace phydb {
+
+void HpwlEngine::SetDbPtr(PhyDB *db_ptr) {
+  db_ptr_ = db_ptr;
+}
+
+/****
+ * @brief Set the number of threads used by full passes.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void HpwlEngine::SetNumThreads(int num_threads) {
+  num_threads_ = num_threads;
+}
+
+int HpwlEngine::GetNumThreads() const {
+  return num_threads_;
+}
+
+/****
+ * @brief Take the connectivity of the design, building it if needed, then
+ * locate all pins and compute the HPWL of every net.
+ */
+void HpwlEngine::Build() {
+  PhyDBExpects(db_ptr_ != nullptr, "Please initialize db_ptr in HpwlEngine");
+  Design &design = db_ptr_->design();
+  db_ptr_->tech().ComputePinOffsets(design.GetUnitsDistanceMicrons());
+  connectivity_ptr_ = design.GetNetConnectivityPtr();
+  if (connectivity_ptr_ == nullptr) {
+    connectivity_ptr_ = design.BuildNetConnectivity();
+  }
+  connectivity_generation_ = design.GetConnectivityGeneration();
+
+  pin_locator_.Reset(db_ptr_, connectivity_ptr_);
+  net_hpwl_.assign(connectivity_ptr_->GetNumNets(), 0);
+  SyncPinLocations();
+}
+
+/****
+ * @brief Re-read the locations and orientations of all components, and
+ * recompute the HPWL of all nets. The engine is built again if the netlist
+ * changed.
+ */
+void HpwlEngine::SyncPinLocations() {
+  if (IsConnectivityStale()) {
+    Build();
+    return;
+  }
+  pin_locator_.LocateAllPins(num_threads_);
+  ComputeTotalHpwl();
+  synced_epoch_ = db_ptr_->design().GetPlacementEpoch();
+}
+
+/****
+ * @brief Compute the HPWL of every net and the total HPWL, using the current
+ * pin coordinates. Partial sums are added in a fixed order, so the result
+ * does not depend on the number of threads.
+ *
+ * @return the total HPWL, in DEF database unit
+ */
+int64_t HpwlEngine::ComputeTotalHpwl() {
+  int num_nets = (int) net_hpwl_.size();
+  const int chunk_size = 2048;
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  std::vector<int64_t> partial_sums(num_chunks, 0);
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    int64_t sum = 0;
+    for (int net_id = chunk * chunk_size; net_id < end; ++net_id) {
+      net_hpwl_[net_id] = ComputeNetHpwl(net_id);
+      sum += net_hpwl_[net_id];
+    }
+    partial_sums[chunk] = sum;
+  });
+  total_hpwl_ = 0;
+  for (int64_t sum : partial_sums) {
+    total_hpwl_ += sum;
+  }
+  return total_hpwl_;
+}
+
+/****
+ * @brief Update the HPWL of nets touching components whose placement
+ * changed since the last Build(), SyncPinLocations() or Update().
+ *
+ * @return the change of the total HPWL, in DEF database unit
+ */
+int64_t HpwlEngine::Update() {
+  PlacementTracker &tracker = db_ptr_->design().GetPlacementTrackerRef();
+  std::vector<int> component_ids;
+  tracker.GetComponentsChangedSince(synced_epoch_, component_ids);
+  int64_t delta = UpdateComponents(component_ids);
+  synced_epoch_ = tracker.GetEpoch();
+  return delta;
+}
+
+/****
+ * @brief Update the HPWL after some components are moved or rotated. Only
+ * nets connected to these components are re-evaluated. If the netlist
+ * changed, the engine is built again.
+ *
+ * @param component_ids: ids of the components which have been moved
+ * @return the change of the total HPWL, in DEF database unit
+ */
+int64_t HpwlEngine::UpdateComponents(std::vector<int> const &component_ids) {
+  if (IsConnectivityStale()) {
+    int64_t old_total_hpwl = total_hpwl_;
+    Build();
+    return total_hpwl_ - old_total_hpwl;
+  }
+  std::vector<int> affected_nets;
+  connectivity_ptr_->CollectNetsOfComponents(component_ids, affected_nets);
+  int64_t delta = 0;
+  for (int net_id : affected_nets) {
+    pin_locator_.LocateNetPins(net_id);
+    int64_t hpwl = ComputeNetHpwl(net_id);
+    delta += hpwl - net_hpwl_[net_id];
+    net_hpwl_[net_id] = hpwl;
+  }
+  total_hpwl_ += delta;
+  return delta;
+}
+
+bool HpwlEngine::IsConnectivityStale() const {
+  PhyDBExpects(
+      connectivity_ptr_ != nullptr,
+      "Please build HpwlEngine before using it"
+  );
+  return connectivity_generation_
+      != db_ptr_->design().GetConnectivityGeneration();
+}
+
+int64_t HpwlEngine::ComputeNetHpwl(int net_id) const {
+  int begin = connectivity_ptr_->GetNetPinBegin(net_id);
+  int end = connectivity_ptr_->GetNetPinEnd(net_id);
+  if (end - begin < 2) return 0;
+  // separate loops over flat arrays are vectorized by the compiler
+  int const *xs = pin_locator_.GetXPtr(0);
+  int const *ys = pin_locator_.GetYPtr(0);
+  int min_x = INT_MAX, max_x = INT_MIN;
+  for (int i = begin; i < end; ++i) {
+    min_x = std::min(min_x, xs[i]);
+    max_x = std::max(max_x, xs[i]);
+  }
+  int min_y = INT_MAX, max_y = INT_MIN;
+  for (int i = begin; i < end; ++i) {
+    min_y = std::min(min_y, ys[i]);
+    max_y = std::max(max_y, ys[i]);
+  }
+  return (int64_t) max_x - min_x + (int64_t) max_y - min_y;
+}
+
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_HPWL_H_
+#define PHYDB_HPWL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "phydb.h"
+#include "pinlocator.h"
+
+namespace phydb {
+
+/****
+ * Half-perimeter wirelength engine over all nets of a design.
+ *
+ * Net-to-pin connectivity is the NetConnectivity of the design, and pin
+ * coordinates are kept by a PinLocator as two flat arrays in its pin order,
+ * so the min/max loop of a net runs over contiguous integers and can be
+ * vectorized by the compiler.
+ *
+ * The connectivity of the design is used directly. When the netlist changes,
+ * the connectivity generation of the design moves on, and the next
+ * SyncPinLocations() or UpdateComponents() builds the engine again.
+ * Component moves are picked up by SyncPinLocations() (all components),
+ * by UpdateComponents() (given components), or by Update() (components
+ * moved since the last sync, as recorded by the PlacementTracker of the
+ * design).
+ */
+class HpwlEngine {
+ public:
+  HpwlEngine() = default;
+  explicit HpwlEngine(PhyDB *db_ptr) : db_ptr_(db_ptr) {}
+
+  void SetDbPtr(PhyDB *db_ptr);
+  void SetNumThreads(int num_threads);
+  int GetNumThreads() const;
+
+  void Build();
+  void SyncPinLocations();
+  int64_t ComputeTotalHpwl();
+  int64_t Update();
+  int64_t UpdateComponents(std::vector<int> const &component_ids);
+
+  int64_t GetTotalHpwl() const { return total_hpwl_; }
+  int64_t GetNetHpwl(int net_id) const { return net_hpwl_[net_id]; }
+  std::vector<int64_t> &GetNetHpwlRef() { return net_hpwl_; }
+
+ private:
+  PhyDB *db_ptr_ = nullptr;
+  int num_threads_ = 1;
+  uint64_t synced_epoch_ = 0;
+
+  NetConnectivity const *connectivity_ptr_ = nullptr;
+  uint64_t connectivity_generation_ = 0;
+  PinLocator pin_locator_;
+
+  std::vector<int64_t> net_hpwl_;
+  int64_t total_hpwl_ = 0;
+
+  bool IsConnectivityStale() const;
+  int64_t ComputeNetHpwl(int net_id) const;
+};
+
+}
+
+#endif //PHYDB_HPWL_H_
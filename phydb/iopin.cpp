@@ -31,10 +31,15 @@ void IOPin::SetShape(std::string const &layer_name,
                      int ly,
                      int ux,
                      int uy) {
-  layer_name_ = layer_name;
+  layer_name_ = &InternName(layer_name);
+  layer_id_ = -1;
   rect_.Set(lx, ly, ux, uy);
 }
 
+void IOPin::SetLayerId(int layer_id) {
+  layer_id_ = layer_id;
+}
+
 void IOPin::SetPlacement(
     PlaceStatus place_status,
     int x,
@@ -52,7 +57,7 @@ void IOPin::SetPlacementStatus(PlaceStatus place_status) {
 }
 
 const std::string &IOPin::GetName() {
-  return name_;
+  return *name_;
 }
 
 int IOPin::GetNetId() {
@@ -68,7 +73,7 @@ SignalUse IOPin::GetUse() {
 }
 
 const std::string &IOPin::GetLayerName() {
-  return layer_name_;
+  return *layer_name_;
 }
 
 Rect2D<int> IOPin::GetRect() {
@@ -92,10 +97,10 @@ Rect2D<int> IOPin::GetBoundingBox() {
 }
 
 void IOPin::Report() {
-  std::cout << "IOPIN name: " << name_ << "  Net: " << net_id_ << " "
+  std::cout << "IOPIN name: " << *name_ << "  Net: " << net_id_ << " "
             << " DIRECTION: " << SignalDirectionStr(direction_) << " "
             << " USE: " << SignalUseStr(use_) << "\n"
-            << "LAYER: " << layer_name_ << " " << rect_.Str() << "\n"
+            << "LAYER: " << *layer_name_ << " " << rect_.Str() << "\n"
             << PlaceStatusStr(place_status_) << " "
             << location_.Str() << " "
             << CompOrientStr(orient_) << "\n";
@@ -26,10 +26,12 @@
 #include "datatype.h"
 #include "enumtypes.h"
 #include "phydb/common/logging.h"
+#include "phydb/common/symboltable.h"
 
 namespace phydb {
 
 class IOPin {
+  friend class Snapshot;
  public:
   IOPin() : id_(-1) {}
   IOPin(
@@ -37,7 +39,7 @@ class IOPin {
       SignalDirection direction,
       SignalUse use
   ) :
-      name_(name),
+      name_(&InternName(name)),
       direction_(direction),
       use_(use) {}
   IOPin(
@@ -51,18 +53,20 @@ class IOPin {
       CompOrient orient,
       PlaceStatus status
   ) :
-      name_(name),
+      name_(&InternName(name)),
       net_id_(net_id),
       direction_(direction),
       use_(use),
-      layer_name_(layerName),
+      layer_name_(&InternName(layerName)),
       rect_(rect),
       location_(location),
       orient_(orient),
       place_status_(status) {}
 
   void SetNetId(int net_id);
+  // the layer id becomes unknown until SetLayerId() is called
   void SetShape(std::string const &layer_name, int lx, int ly, int ux, int uy);
+  void SetLayerId(int layer_id);
   void SetPlacement(
       PlaceStatus place_status,
       int x,
@@ -77,6 +81,7 @@ class IOPin {
   SignalDirection GetDirection();
   SignalUse GetUse();
   const std::string &GetLayerName();
+  int GetLayerId() const { return layer_id_; }
   Rect2D<int> GetRect();
   Point2D<int> GetLocation();
   CompOrient GetOrientation();
@@ -87,12 +92,13 @@ class IOPin {
   void Report();
  private:
   int id_;
-  std::string name_;
-  int net_id_;
+  std::string const *name_ = &InternName("");
+  int net_id_ = -1;
   SignalDirection direction_;
   SignalUse use_;
 
-  std::string layer_name_;
+  int layer_id_ = -1; // index in Tech::layers_, -1 if not resolved
+  std::string const *layer_name_ = &InternName("");
   Rect2D<int> rect_;
 
   Point2D<int> location_;
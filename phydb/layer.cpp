@@ -20,6 +20,8 @@
  ******************************************************************************/
 #include "layer.h"
 
+#include <algorithm>
+
 namespace phydb {
 
 ConfigTable &LayerTechConfigCorner::InitResOverTable(
@@ -148,6 +150,48 @@ double LayerTechConfigCorner::GetOverSubstrateNoSurroundingWireCap() {
   return res;
 }
 
+/****
+ * @brief Compile all raw tables of this corner for fast queries. This
+ * should be called again whenever the raw tables change.
+ */
+void LayerTechConfigCorner::CompileTables() {
+  std::vector<ConfigTable> *raw_tables[BAD_TABLE_TYPE] = {
+      &res_over_, &cap_over_, &cap_under_, &cap_diagunder_, &cap_overunder_
+  };
+  for (int type = 0; type < BAD_TABLE_TYPE; ++type) {
+    auto &compiled_tables = compiled_tables_[type];
+    compiled_tables.resize(raw_tables[type]->size());
+    for (size_t i = 0; i < compiled_tables.size(); ++i) {
+      compiled_tables[i].Compile((*raw_tables[type])[i]);
+    }
+  }
+}
+
+/****
+ * @brief Find a compiled table. Index -1 means the substrate, like in the raw
+ * tables.
+ *
+ * @param type: type of the table
+ * @param index0: the over, under or diagunder layer index
+ * @param index1: the under layer index of an OVERUNDER table
+ * @return the first non-empty table with these indices, or nullptr
+ */
+CompiledConfigTable const *LayerTechConfigCorner::GetCompiledTable(
+    TableType type,
+    int index0,
+    int index1
+) const {
+  PhyDBExpects(type >= 0 && type < BAD_TABLE_TYPE, "Bad table type " << type);
+  for (auto &table : compiled_tables_[type]) {
+    if (table.Index0() == index0
+        && (type != CAP_OVERUNDER || table.Index1() == index1)
+        && !table.IsEmpty()) {
+      return &table;
+    }
+  }
+  return nullptr;
+}
+
 void LayerTechConfigCorner::Report() {
   for (auto &table : res_over_) {
     table.Report();
@@ -187,6 +231,12 @@ void LayerTechConfig::FixResOverTable() {
   }
 }
 
+void LayerTechConfig::CompileTables() {
+  for (auto &corner : corners_) {
+    corner.CompileTables();
+  }
+}
+
 void LayerTechConfig::Report() {
   for (auto &corner : corners_) {
     corner.Report();
@@ -496,6 +546,17 @@ void Layer::SetCapacitanceUnitFromLef() {
   unit_edge_cap_.assign(1, edgecapacitance_ * capmultiplier_);
 }
 
+/****
+ * @return the number of corners with unit resistance and capacitance set
+ */
+int Layer::GetRcCornerCount() const {
+  size_t count = std::min(
+      unit_res_.size(),
+      std::min(unit_edge_cap_.size(), unit_area_cap_.size())
+  );
+  return static_cast<int>(count);
+}
+
 /****
  * @brief Returns the resistance of a metal segment.
  *
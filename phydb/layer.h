@@ -36,6 +36,7 @@
 namespace phydb {
 
 class LayerTechConfigCorner {
+  friend class Snapshot;
  public:
   explicit LayerTechConfigCorner(int model_index)
       : model_index_(model_index) {}
@@ -66,6 +67,14 @@ class LayerTechConfigCorner {
   double GetOverSubstrateNoSurroundingWireCap();
   void Report();
 
+  /**** compiled tables for spacing-aware queries ****/
+  void CompileTables();
+  CompiledConfigTable const *GetCompiledTable(
+      TableType type,
+      int index0,
+      int index1 = 0
+  ) const;
+
  private:
   int model_index_;
   /**** raw data from technology configuration file ****/
@@ -74,9 +83,12 @@ class LayerTechConfigCorner {
   std::vector<ConfigTable> cap_under_;
   std::vector<ConfigTable> cap_diagunder_;
   std::vector<ConfigTable> cap_overunder_;
+  /**** compiled tables of every type, in the order of the raw tables ****/
+  std::vector<CompiledConfigTable> compiled_tables_[BAD_TABLE_TYPE];
 };
 
 class LayerTechConfig {
+  friend class Snapshot;
  private:
   std::vector<LayerTechConfigCorner> corners_;
  public:
@@ -84,12 +96,14 @@ class LayerTechConfig {
   std::vector<LayerTechConfigCorner> &CornersRef();
   LayerTechConfigCorner *GetLastCorner();
   void FixResOverTable();
+  void CompileTables();
 
   void Report();
 };
 
 class Layer {
   friend class Tech;
+  friend class Snapshot;
  public:
   Layer(
       std::string const &name,
@@ -209,6 +223,7 @@ class Layer {
   void SetResistanceUnitFromLef();
   void SetCapacitanceUnitFromTechConfig();
   void SetCapacitanceUnitFromLef();
+  int GetRcCornerCount() const;
   double GetResistance(
       double width,
       double length,
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 
+#include "phydb/common/compressedfile.h"
 #include "phydb/common/logging.h"
 
 namespace phydb {
@@ -178,7 +179,10 @@ int getLefPins(lefrCallbackType_e type, lefiPin *pin, lefiUserData data) {
       int itemType = pin->port(i)->itemType(j);
       if (itemType == 1) { //layer
         std::string layer_name(pin->port(i)->getLayer(j));
-        layer_rect_ptr = pin_ptr->AddLayerRect(layer_name);
+        layer_rect_ptr = pin_ptr->AddLayerRect(
+            layer_name,
+            phy_db_ptr->GetTechPtr()->GetLayerId(layer_name)
+        );
       } else if (itemType == 8) {
         double x1 = pin->port(i)->getRect(j)->xl;
         double y1 = pin->port(i)->getRect(j)->yl;
@@ -227,7 +231,10 @@ int getLefObs(
   for (int i = 0; i < numItems; ++i) {
     if (geometry->itemType(i) == lefiGeomLayerE) {
       std::string layer_name(geometry->getLayer(i));
-      layer_rect_ptr = obs_ptr->AddLayerRect(layer_name);
+      layer_rect_ptr = obs_ptr->AddLayerRect(
+          layer_name,
+          phy_db_ptr->GetTechPtr()->GetLayerId(layer_name)
+      );
     } else if (geometry->itemType(i) == lefiGeomRectE) {
       double x1 = geometry->getRect(i)->xl;
       double y1 = geometry->getRect(i)->yl;
@@ -468,6 +475,10 @@ int getLefVias(lefrCallbackType_e type, lefiVia *via, lefiUserData data) {
       layer_name[2],
       rects[2]
   );
+  for (auto &layer_rect: last_via.GetLayerRectsRef()) {
+    layer_rect.layer_id_ =
+        phy_db_ptr->GetTechPtr()->GetLayerId(layer_rect.GetLayerName());
+  }
 
   return 0;
 }
@@ -782,6 +793,7 @@ int getDefIOPins(defrCallbackType_e type, defiPin *pin, defiUserData data) {
           std::max(x1, x2),
           std::max(y1, y2)
       );
+      io_pin_ptr->SetLayerId(phy_db_ptr->GetTechPtr()->GetLayerId(layer_name));
     }
   }
 
@@ -809,6 +821,57 @@ int getDefNets(defrCallbackType_e type, defiNet *net, defiUserData data) {
     }
   }
 
+  // routed wiring, vias are resolved after the whole DEF file is loaded
+  Design *design_ptr = phy_db_ptr->GetDesignPtr();
+  int net_id = static_cast<int>(design_ptr->GetNetsRef().size()) - 1;
+  NetWireStore &net_wires = design_ptr->GetNetWiresRef();
+  for (int i = 0; i < (int) net->numWires(); i++) {
+    defiWire *tmpWire = net->wire(i);
+    for (int j = 0; j < (int) tmpWire->numPaths(); j++) {
+      defiPath *path = tmpWire->path(j);
+      path->initTraverse();
+      int pathId;
+      while ((pathId = path->next()) != DEFIPATH_DONE) {
+        switch (pathId) {
+          case DEFIPATH_LAYER: {
+            std::string layer_name(path->getLayer());
+            net_wires.StartPath(
+                net_id,
+                phy_db_ptr->GetTechPtr()->GetLayerId(layer_name)
+            );
+            break;
+          }
+          case DEFIPATH_VIA: {
+            net_wires.AddPathVia(path->getVia());
+            break;
+          }
+          case DEFIPATH_POINT: {
+            int X, Y;
+            path->getPoint(&X, &Y);
+            net_wires.AddPathPoint(X, Y);
+            break;
+          }
+          case DEFIPATH_FLUSHPOINT: {
+            int X, Y, ext;
+            path->getFlushPoint(&X, &Y, &ext);
+            net_wires.AddPathPoint(X, Y);
+            break;
+          }
+          case DEFIPATH_VIRTUALPOINT: {
+            int X, Y;
+            path->getVirtualPoint(&X, &Y);
+            net_wires.AddPathVirtualPoint(X, Y);
+            break;
+          }
+          default : {
+            // TAPER, STYLE, MASK and RECT patches are not stored
+            break;
+          }
+        }
+      }
+    }
+  }
+
   return 0;
 }
 
@@ -829,6 +892,7 @@ int getDefSNets(defrCallbackType_e type, defiNet *net, defiUserData data) {
     std::string layer_name = net->polygonName(i);
     auto points = net->getPolygon(i);
     auto phydb_polygon = phydb_snet->AddPolygon(layer_name);
+    phydb_polygon->SetLayerId(phy_db_ptr->GetTechPtr()->GetLayerId(layer_name));
     for (int j = 0; j < points.numPoints; j++) {
       phydb_polygon->AddRoutingPoint(points.x[j], points.y[j]);
     }
@@ -852,6 +916,9 @@ int getDefSNets(defrCallbackType_e type, defiNet *net, defiUserData data) {
           case DEFIPATH_LAYER: {
             auto layer_name = std::string(path->getLayer());
             phydb_path->SetLayerName(layer_name);
+            phydb_path->SetLayerId(
+                phy_db_ptr->GetTechPtr()->GetLayerId(layer_name)
+            );
             break;
           }
           case DEFIPATH_VIA: {
@@ -859,6 +926,12 @@ int getDefSNets(defrCallbackType_e type, defiNet *net, defiUserData data) {
             phydb_path->SetViaName(via_name);
             break;
           }
+          case DEFIPATH_VIADATA: {
+            int num_x, num_y, step_x, step_y;
+            path->getViaData(&num_x, &num_y, &step_x, &step_y);
+            phydb_path->SetViaArray(num_x, num_y, step_x, step_y);
+            break;
+          }
           case DEFIPATH_WIDTH: {
             phydb_path->SetWidth(path->getWidth());
             break;
@@ -1181,7 +1254,8 @@ void Si2ReadLef(PhyDB *phy_db_ptr, std::string const &lef_file_name) {
   lefrSetViaCbk(getLefVias);
   lefrSetViaRuleCbk(getLefViaRuleGenerates);
 
-  if ((f = fopen(lef_file_name.c_str(), "r")) == nullptr) {
+  CompressedFile lef_file(lef_file_name, "r");
+  if ((f = lef_file.Stream()) == nullptr) {
     std::cout << "Couldn't open lef file" << std::endl;
     exit(2);
   }
@@ -1191,13 +1265,44 @@ void Si2ReadLef(PhyDB *phy_db_ptr, std::string const &lef_file_name) {
     std::cout << "LEF parser returns an error!" << std::endl;
     exit(2);
   }
-  fclose(f);
+  PhyDBExpects(lef_file.Close(), lef_file.GetErrorMessage());
 
   lefrClear();
 }
 
-void Si2ReadDef(PhyDB *phy_db_ptr, std::string const &def_file_name) {
+void Si2ReadDef(
+    PhyDB *phy_db_ptr,
+    std::string const &def_file_name,
+    DefSectionMask sections
+) {
+  CompressedFile def_file(def_file_name, "r");
   FILE *f;
+  if ((f = def_file.Stream()) == 0) {
+    std::cout << "Couldn't open def file" << std::endl;
+    exit(2);
+  }
+  Si2ReadDefFromStream(phy_db_ptr, f, def_file_name, sections);
+  PhyDBExpects(def_file.Close(), def_file.GetErrorMessage());
+}
+
+/**
+ * Parse DEF content from an opened stream with the Si2 DEF parser.
+ * The stream does not need to be backed by a file on disk, for example, the
+ * parallel DEF reader feeds DEF sections it does not handle through fmemopen().
+ *
+ * @param phy_db_ptr, the pointer to the PhyDB database.
+ * @param f, the opened stream, it is not closed by this function.
+ * @param def_file_name, the name used in error messages of the Si2 parser.
+ * @param sections, DEF sections to load, callbacks of other sections are not
+ * registered, so the parser skips them.
+ * @return void.
+ */
+void Si2ReadDefFromStream(
+    PhyDB *phy_db_ptr,
+    FILE *f,
+    std::string const &def_file_name,
+    DefSectionMask sections
+) {
   int res;
 
   defrInit();
@@ -1218,34 +1323,48 @@ void Si2ReadDef(PhyDB *phy_db_ptr, std::string const &def_file_name) {
   defrSetRowCbk(getDefRow);
   defrSetTrackCbk(getDefTracks);
 
-  defrSetComponentStartCbk(getDefCountNumber);
-  defrSetComponentCbk(getDefComponents);
-
-  defrSetStartPinsCbk(getDefCountNumber);
-  defrSetPinCbk(getDefIOPins);
+  if (sections & kDefComponents) {
+    defrSetComponentStartCbk(getDefCountNumber);
+    defrSetComponentCbk(getDefComponents);
+  }
 
-  defrSetBlockageStartCbk(getDefBlockageStart);
-  defrSetBlockageCbk(getDefBlockage);
+  if (sections & kDefPins) {
+    defrSetStartPinsCbk(getDefCountNumber);
+    defrSetPinCbk(getDefIOPins);
+  }
 
-  defrSetNetStartCbk(getDefCountNumber);
-  defrSetSNetCbk(getDefSNets);
-  defrSetAddPathToNet();
-  defrSetNetCbk(getDefNets);
+  if (sections & kDefBlockages) {
+    defrSetBlockageStartCbk(getDefBlockageStart);
+    defrSetBlockageCbk(getDefBlockage);
+  }
 
-  defrSetViaCbk(getDefVias);
-  defrSetGcellGridCbk(getDefGcellGrid);
+  if (sections & kDefNets) {
+    defrSetNetStartCbk(getDefCountNumber);
+    defrSetNetCbk(getDefNets);
+  }
+  if (sections & kDefSpecialNets) {
+    defrSetSNetCbk(getDefSNets);
+  }
+  // this setting is shared by NETS and SPECIALNETS, paths are dropped otherwise
+  bool is_net_wiring_skipped = (sections & kDefNets)
+      && !(sections & kDefNetWiring);
+  if ((sections & kDefSpecialNets) || !is_net_wiring_skipped) {
+    defrSetAddPathToNet();
+  }
 
-  if ((f = fopen(def_file_name.c_str(), "r")) == 0) {
-    std::cout << "Couldn't open def file" << std::endl;
-    exit(2);
+  if (sections & kDefVias) {
+    defrSetViaCbk(getDefVias);
   }
+  defrSetGcellGridCbk(getDefGcellGrid);
 
   res = defrRead(f, def_file_name.c_str(), (defiUserData) phy_db_ptr, 1);
   if (res != 0) {
     std::cout << "DEF parser returns an error!" << std::endl;
     exit(2);
   }
-  fclose(f);
+  if (is_net_wiring_skipped && (sections & kDefSpecialNets)) {
+    phy_db_ptr->GetDesignPtr()->GetNetWiresRef().Clear();
+  }
 
   defrClear();
 }
@@ -1353,7 +1472,8 @@ void Si2LoadPlacedDef(PhyDB *phy_db_ptr, std::string const &def_file_name) {
   defrSetComponentStartCbk(getDefCountNumber);
   defrSetComponentCbk(LoadDefComponentLoc);
 
-  if ((f = fopen(def_file_name.c_str(), "r")) == nullptr) {
+  CompressedFile def_file(def_file_name, "r");
+  if ((f = def_file.Stream()) == nullptr) {
     std::cout << "Couldn't open def file" << std::endl;
     exit(2);
   }
@@ -1363,7 +1483,7 @@ void Si2LoadPlacedDef(PhyDB *phy_db_ptr, std::string const &def_file_name) {
     std::cout << "DEF parser returns an error!" << std::endl;
     exit(2);
   }
-  fclose(f);
+  PhyDBExpects(def_file.Close(), def_file.GetErrorMessage());
 
   defrClear();
 }
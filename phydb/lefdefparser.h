@@ -62,7 +62,17 @@ int getDefGcellGrid(defrCallbackType_e, defiGcellGrid *, defiUserData);
 int getDefRow(defrCallbackType_e, defiRow *, defiUserData);
 
 void Si2ReadLef(PhyDB *phy_db_ptr, std::string const &lef_file_name);
-void Si2ReadDef(PhyDB *phy_db_ptr, std::string const &def_file_name);
+void Si2ReadDef(
+    PhyDB *phy_db_ptr,
+    std::string const &def_file_name,
+    DefSectionMask sections = kDefAllSections
+);
+void Si2ReadDefFromStream(
+    PhyDB *phy_db_ptr,
+    FILE *f,
+    std::string const &def_file_name,
+    DefSectionMask sections = kDefAllSections
+);
 void Si2LoadPlacedDef(PhyDB *phy_db_ptr, std::string const &def_file_name);
 
 }
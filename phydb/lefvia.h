@@ -29,6 +29,7 @@
 namespace phydb {
 
 class LefVia {
+  friend class Snapshot;
  public:
   LefVia() : is_default_(false) {}
   explicit LefVia(std::string const &name) : name_(name) {}
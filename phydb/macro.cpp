@@ -20,14 +20,16 @@
  ******************************************************************************/
 #include "macro.h"
 
+#include <cmath>
+
 namespace phydb {
 
 const std::string &Macro::GetName() {
-  return name_;
+  return *name_;
 }
 
 void Macro::SetName(std::string const &name) {
-  name_ = name;
+  name_ = &InternName(name);
 }
 
 void Macro::SetClass(MacroClass macro_class) {
@@ -36,20 +38,24 @@ void Macro::SetClass(MacroClass macro_class) {
 
 void Macro::SetOrigin(Point2D<double> _origin) {
   origin_ = _origin;
+  pin_offsets_distance_microns_ = -1;
 }
 
 void Macro::SetOrigin(double x, double y) {
   origin_.x = x;
   origin_.y = y;
+  pin_offsets_distance_microns_ = -1;
 }
 
 void Macro::SetSize(Point2D<double> size) {
   size_ = size;
+  pin_offsets_distance_microns_ = -1;
 }
 
 void Macro::SetSize(double width, double height) {
   size_.x = width;
   size_.y = height;
+  pin_offsets_distance_microns_ = -1;
 }
 
 void Macro::SetSymmetry(bool x, bool y, bool r90) {
@@ -67,18 +73,20 @@ Pin *Macro::AddPin(
 ) {
   PhyDBExpects(
       !IsPinExisting(pin_name),
-      "Pin " << pin_name << " exists in Macro " << name_
+      "Pin " << pin_name << " exists in Macro " << *name_
              << ", cannot add it again"
   );
   int id = (int) pins_.size();
-  pin_2_id_[pin_name] = id;
   pins_.emplace_back(pin_name, direction, use);
+  pin_offsets_distance_microns_ = -1;
+  pin_2_id_[pins_.back().GetName()] = id;
   return &(pins_.back());
 }
 
 int Macro::GetPinId(std::string const &pin_name) {
-  if (pin_2_id_.find(pin_name) != pin_2_id_.end()) {
-    return pin_2_id_[pin_name];
+  auto res = pin_2_id_.find(pin_name);
+  if (res != pin_2_id_.end()) {
+    return res->second;
   }
   return -1;
 }
@@ -139,8 +147,63 @@ MacroWell *Macro::GetWellPtr() {
   return well_ptr_;
 }
 
+/****
+ * @brief Precompute, for all 8 orientations, the center and the bounding box
+ * of every pin relative to the component location, in DEF database unit. A
+ * pin location then becomes a table lookup plus an add.
+ *
+ * The tables are invalidated by SetSize(), SetOrigin() and AddPin(). If pin
+ * shapes are changed afterwards, this function needs to be called again.
+ *
+ * @param distance_microns: DEF database unit per micron
+ */
+void Macro::ComputePinOffsets(int distance_microns) {
+  size_t num_pins = pins_.size();
+  pin_center_offsets_.assign(8 * num_pins, Point2D<int>());
+  pin_bbox_offsets_.assign(8 * num_pins, Rect2D<int>());
+  for (size_t pin_id = 0; pin_id < num_pins; ++pin_id) {
+    Pin &pin = pins_[pin_id];
+    if (pin.GetLayerRectRef().empty()) continue;
+    Rect2D<double> bbox = pin.GetBoundingBox();
+    for (int i = 0; i < 8; ++i) {
+      auto orient = static_cast<CompOrient>(i);
+      Point2D<double> center(
+          (bbox.LLX() + bbox.URX()) / 2.0,
+          (bbox.LLY() + bbox.URY()) / 2.0
+      );
+      center.Rotate(orient, size_.x, size_.y);
+      Point2D<double> ll = bbox.ll;
+      Point2D<double> ur = bbox.ur;
+      ll.Rotate(orient, size_.x, size_.y);
+      ur.Rotate(orient, size_.x, size_.y);
+
+      size_t index = i * num_pins + pin_id;
+      Point2D<int> &center_offset = pin_center_offsets_[index];
+      center_offset.x =
+          static_cast<int>(std::round(center.x * distance_microns));
+      center_offset.y =
+          static_cast<int>(std::round(center.y * distance_microns));
+      Rect2D<int> &bbox_offset = pin_bbox_offsets_[index];
+      bbox_offset.ll.x =
+          static_cast<int>(std::round(std::min(ll.x, ur.x) * distance_microns));
+      bbox_offset.ll.y =
+          static_cast<int>(std::round(std::min(ll.y, ur.y) * distance_microns));
+      bbox_offset.ur.x =
+          static_cast<int>(std::round(std::max(ll.x, ur.x) * distance_microns));
+      bbox_offset.ur.y =
+          static_cast<int>(std::round(std::max(ll.y, ur.y) * distance_microns));
+    }
+  }
+  pin_offsets_distance_microns_ = distance_microns;
+}
+
+bool Macro::IsPinOffsetsValid(int distance_microns) const {
+  return pin_offsets_distance_microns_ == distance_microns
+      && pin_center_offsets_.size() == 8 * pins_.size();
+}
+
 std::ostream &operator<<(std::ostream &os, const Macro &macro) {
-  os << macro.name_ << std::endl;
+  os << *macro.name_ << std::endl;
   os << macro.origin_ << std::endl;
   os << macro.size_ << std::endl;
 
@@ -153,8 +216,8 @@ std::ostream &operator<<(std::ostream &os, const Macro &macro) {
 }
 
 // get the pointer to the BlockType this well belongs to
-Macro *MacroWell::GetMacroPtr() const {
-  return macro_ptr_;
+MacroId MacroWell::GetMacroId() const {
+  return macro_id_;
 }
 
 // Set the rect_ of N-well
@@ -221,8 +284,7 @@ bool MacroWell::IsNPWellAbutted() const {
 
 // report the information of N/P-well for debugging purposes
 void MacroWell::Report() const {
-  std::cout << "Well of BlockType: " << macro_ptr_->GetName() << "\n"
-            << "    Pwell: " << p_rect_.LLX() << "  " << p_rect_.LLY() << "  "
+  std::cout << "    Pwell: " << p_rect_.LLX() << "  " << p_rect_.LLY() << "  "
             << p_rect_.URX() << "  " << p_rect_.URY() << "\n"
             << "    Nwell: " << n_rect_.LLX() << "  " << n_rect_.LLY() << "  "
             << n_rect_.URX() << "  " << n_rect_.URY() << "\n";
@@ -22,22 +22,28 @@
 #define PHYDB_MACRO_H_
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "datatype.h"
 #include "enumtypes.h"
 #include "obs.h"
 #include "pin.h"
+#include "phydb/common/symboltable.h"
 
 namespace phydb {
 
 class Macro;
 struct MacroWell;
 
+// index of a macro in Tech::macros_
+typedef int MacroId;
+
 class Macro {
+  friend class Snapshot;
  public:
-  Macro() : name_("") {}
-  explicit Macro(std::string const &name) : name_(name) {
+  Macro() : name_(&InternName("")) {}
+  explicit Macro(std::string const &name) : name_(&InternName(name)) {
     size_.x = 0;
     size_.y = 0;
     origin_.x = 0;
@@ -50,7 +56,7 @@ class Macro {
       std::vector<Pin> pins,
       OBS obs
   ) :
-      name_(name),
+      name_(&InternName(name)),
       origin_(origin),
       size_(size),
       pins_(pins),
@@ -97,9 +103,24 @@ class Macro {
   OBS *GetObs();
   MacroWell *GetWellPtr();
 
+  // pin offsets relative to the component location, in DEF database unit
+  void ComputePinOffsets(int distance_microns);
+  bool IsPinOffsetsValid(int distance_microns) const;
+  Point2D<int> const &GetPinCenterOffset(CompOrient orient, int pin_id) const {
+    return pin_center_offsets_[static_cast<int>(orient) * pins_.size()
+        + pin_id];
+  }
+  Rect2D<int> const &GetPinBoundingBoxOffset(
+      CompOrient orient,
+      int pin_id
+  ) const {
+    return pin_bbox_offsets_[static_cast<int>(orient) * pins_.size()
+        + pin_id];
+  }
+
   friend std::ostream &operator<<(std::ostream &, const Macro &);
  private:
-  std::string name_;
+  std::string const *name_;
   MacroClass class_ = MacroClass::CORE;
   Point2D<double> origin_;
   Point2D<double> size_;
@@ -107,17 +128,24 @@ class Macro {
   std::vector<Pin> pins_;
   OBS obs_;
 
-  std::unordered_map<std::string, int> pin_2_id_;
+  std::unordered_map<std::string_view, int> pin_2_id_;
   MacroWell *well_ptr_ = nullptr;
+
+  /****cached pin geometry, indexed by orientation * pin count + pin id,
+   * valid when pin_offsets_distance_microns_ matches the DEF units****/
+  int pin_offsets_distance_microns_ = -1;
+  std::vector<Point2D<int>> pin_center_offsets_;
+  std::vector<Rect2D<int>> pin_bbox_offsets_;
 };
 
 std::ostream &operator<<(std::ostream &, const Macro &);
 
 struct MacroWell {
+  friend class Snapshot;
  public:
-  explicit MacroWell(Macro *type_ptr) : macro_ptr_(type_ptr) {}
+  explicit MacroWell(MacroId macro_id) : macro_id_(macro_id) {}
 
-  Macro *GetMacroPtr() const;
+  MacroId GetMacroId() const;
   void SetNwellRect(double lx, double ly, double ux, double uy);
   Rect2D<double> *GetNwellRectPtr();
   void SetPwellRect(double lx, double ly, double ux, double uy);
@@ -127,7 +155,7 @@ struct MacroWell {
   bool IsNPWellAbutted() const;
   void Report() const;
  private:
-  Macro *macro_ptr_; // pointer to BlockType
+  MacroId macro_id_; // id of BlockType
   bool is_n_set_ = false; // whether N-well shape_ is Set or not
   bool is_p_set_ = false; // whether P-well shape_ is Set or not
   Rect2D<double> n_rect_; // N-well rect_
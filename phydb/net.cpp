@@ -47,7 +47,7 @@ Path *Net::AddPath(std::string &layer_name, std::string shape, int width) {
 }
 
 const std::string &Net::GetName() const {
-  return name_;
+  return *name_;
 }
 
 std::vector<PhydbPin> &Net::GetPinsRef() {
@@ -58,7 +58,7 @@ std::vector<int> &Net::GetIoPinIdsRef() {
   return iopins_;
 }
 
-std::vector<Rect3D<int>> &Net::GetRoutingGuidesRef() {
+GeometryVector<Rect3D<int>> &Net::GetRoutingGuidesRef() {
   return guides_;
 }
 
@@ -67,12 +67,12 @@ void Net::SetDriverPin(bool is_driver_io_pin, int pin_id) {
   driver_pin_id_ = pin_id;
 }
 
-std::vector<Path> &Net::GetPathsRef() {
+GeometryVector<Path> &Net::GetPathsRef() {
   return paths_;
 }
 
 void Net::Report() {
-  std::cout << "NET: " << name_
+  std::cout << "NET: " << *name_
             << "  weight: " << weight_
             << " size: " << pins_.size() << "\n";
   for (auto &iopin_id : iopins_) {
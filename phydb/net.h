@@ -25,15 +25,21 @@
 #include "enumtypes.h"
 #include "snet.h"
 #include "phydb/common/logging.h"
+#include "phydb/common/symboltable.h"
 #include "phydb/timing/actphydbtimingapi.h"
 
 namespace phydb {
 
 class Net {
+  friend class Snapshot;
  public:
   Net() {}
-  Net(const std::string &name, double weight)
-      : name_(name), weight_(weight) {}
+  explicit Net(GeometryAllocator alloc) : guides_(alloc), paths_(alloc) {}
+  Net(const std::string &name, double weight, GeometryAllocator alloc = {})
+      : name_(&InternName(name)),
+        weight_(weight),
+        guides_(alloc),
+        paths_(alloc) {}
 
   void AddIoPin(int iopin_id);
   void AddCompPin(int comp_id, int pin_id);
@@ -50,8 +56,8 @@ class Net {
   const std::string &GetName() const;
   std::vector<PhydbPin> &GetPinsRef();
   std::vector<int> &GetIoPinIdsRef();
-  std::vector<Rect3D<int>> &GetRoutingGuidesRef();
-  std::vector<Path> &GetPathsRef();
+  GeometryVector<Rect3D<int>> &GetRoutingGuidesRef();
+  GeometryVector<Path> &GetPathsRef();
 
   void SetDriverPin(bool is_driver_io_pin, int pin_id);
   bool IsDriverIoPin() const { return is_driver_io_pin_; }
@@ -59,16 +65,16 @@ class Net {
 
   void Report();
  private:
-  std::string name_;
+  std::string const *name_ = &InternName("");
   SignalUse use_ = SignalUse::SIGNAL;
 
   double weight_ = 1.0;
 
   std::vector<PhydbPin> pins_;
   std::vector<int> iopins_;
-  std::vector<Rect3D<int>> guides_;
+  GeometryVector<Rect3D<int>> guides_;
 
-  std::vector<Path> paths_;
+  GeometryVector<Path> paths_;
 
   // cached info
   bool is_driver_io_pin_ = false;
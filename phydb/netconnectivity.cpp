@@ -0,0 +1,169 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "netconnectivity.h"
+
+#include <algorithm>
+
+#include "design.h"
+
+namespace phydb {
+
+/****
+ * @brief Build both directions of the connectivity from the per-net pin
+ * lists, and find the driver of every net.
+ */
+void NetConnectivity::Build() {
+  auto &nets = design_ptr_->GetNetsRef();
+  auto &components = design_ptr_->GetComponentsRef();
+  size_t num_iopins = design_ptr_->GetIoPinsRef().size();
+  Tech *tech_ptr = design_ptr_->GetTechPtr();
+  PhyDBExpects(
+      tech_ptr != nullptr || components.empty(),
+      "Design has no technology, cannot look up macros of components"
+  );
+
+  net_pin_offsets_.assign(nets.size() + 1, 0);
+  for (size_t i = 0; i < nets.size(); ++i) {
+    net_pin_offsets_[i + 1] = net_pin_offsets_[i]
+        + static_cast<int>(nets[i].GetPinsRef().size()
+            + nets[i].GetIoPinIdsRef().size());
+  }
+  size_t num_pins = net_pin_offsets_.back();
+  pin_comp_ids_.resize(num_pins);
+  pin_ids_.resize(num_pins);
+  pin_net_ids_.resize(num_pins);
+
+  comp_pin_offsets_.assign(components.size() + 1, 0);
+  for (size_t i = 0; i < components.size(); ++i) {
+    MacroId macro_id = components[i].GetMacroId();
+    int num_macro_pins = macro_id < 0 ? 0 : static_cast<int>(
+        tech_ptr->GetMacro(macro_id).GetPinsRef().size()
+    );
+    comp_pin_offsets_[i + 1] = comp_pin_offsets_[i] + num_macro_pins;
+  }
+  comp_pin_slots_.assign(comp_pin_offsets_.back(), -1);
+  iopin_net_ids_.assign(num_iopins, -1);
+  net_driver_pins_.assign(nets.size(), -1);
+
+  for (size_t i = 0; i < nets.size(); ++i) {
+    int net_id = static_cast<int>(i);
+    int pin = net_pin_offsets_[i];
+    for (auto &phydb_pin : nets[i].GetPinsRef()) {
+      int comp_id = phydb_pin.InstanceId();
+      pin_comp_ids_[pin] = comp_id;
+      pin_ids_[pin] = phydb_pin.PinId();
+      pin_net_ids_[pin] = net_id;
+      int slot = comp_pin_offsets_[comp_id] + phydb_pin.PinId();
+      PhyDBExpects(
+          slot < comp_pin_offsets_[comp_id + 1],
+          "Pin id " << phydb_pin.PinId() << " out of range for component "
+                    << comp_id
+      );
+      comp_pin_slots_[slot] = pin;
+      ++pin;
+    }
+    for (int iopin_id : nets[i].GetIoPinIdsRef()) {
+      pin_comp_ids_[pin] = -1;
+      pin_ids_[pin] = iopin_id;
+      pin_net_ids_[pin] = net_id;
+      iopin_net_ids_[iopin_id] = net_id;
+      ++pin;
+    }
+    net_driver_pins_[i] = FindDriverPin(net_id);
+  }
+}
+
+/****
+ * @return the id of the net connected to a component pin, or -1
+ */
+int NetConnectivity::GetComponentPinNetId(int comp_id, int pin_id) const {
+  int pin = GetComponentPin(comp_id, pin_id);
+  return pin < 0 ? -1 : pin_net_ids_[pin];
+}
+
+/****
+ * @brief Collect the nets connected to some components, e.g., the nets whose
+ * wirelength or parasitics change when these components move.
+ *
+ * @param comp_ids: the component ids
+ * @param net_ids: receives the net ids in increasing order, without
+ * duplicates
+ */
+void NetConnectivity::CollectNetsOfComponents(
+    std::vector<int> const &comp_ids,
+    std::vector<int> &net_ids
+) const {
+  net_ids.clear();
+  for (int comp_id : comp_ids) {
+    int end = comp_pin_offsets_[comp_id + 1];
+    for (int slot = comp_pin_offsets_[comp_id]; slot < end; ++slot) {
+      int pin = comp_pin_slots_[slot];
+      if (pin < 0) continue;
+      net_ids.push_back(pin_net_ids_[pin]);
+    }
+  }
+  std::sort(net_ids.begin(), net_ids.end());
+  net_ids.erase(std::unique(net_ids.begin(), net_ids.end()), net_ids.end());
+}
+
+/****
+ * @brief Find the pin driving a net. The driver set by Net::SetDriverPin()
+ * comes first; otherwise it is the first component pin whose macro pin is an
+ * output, or else the first IO pin of direction INPUT, i.e., a primary input.
+ *
+ * @return the driver pin, or -1 if the net has none
+ */
+int NetConnectivity::FindDriverPin(int net_id) {
+  Net &net = design_ptr_->GetNetsRef()[net_id];
+  int begin = GetNetPinBegin(net_id);
+  int end = GetNetPinEnd(net_id);
+  int driver_pin_id = net.GetDriverPinId();
+  if (driver_pin_id >= 0) {
+    if (!net.IsDriverIoPin()) {
+      // component pins of a net come first, in the order of Net::GetPinsRef()
+      int pin = begin + driver_pin_id;
+      if (pin < end && !IsIoPin(pin)) return pin;
+    } else {
+      for (int pin = begin; pin < end; ++pin) {
+        if (IsIoPin(pin) && pin_ids_[pin] == driver_pin_id) return pin;
+      }
+    }
+  }
+
+  auto &components = design_ptr_->GetComponentsRef();
+  auto &iopins = design_ptr_->GetIoPinsRef();
+  Tech *tech_ptr = design_ptr_->GetTechPtr();
+  for (int pin = begin; pin < end; ++pin) {
+    if (IsIoPin(pin)) {
+      if (iopins[pin_ids_[pin]].GetDirection() == SignalDirection::INPUT) {
+        return pin;
+      }
+      continue;
+    }
+    MacroId macro_id = components[pin_comp_ids_[pin]].GetMacroId();
+    if (macro_id < 0) continue;
+    auto &macro_pins = tech_ptr->GetMacro(macro_id).GetPinsRef();
+    if (macro_pins[pin_ids_[pin]].IsDriverPin()) return pin;
+  }
+  return -1;
+}
+
+}
@@ -0,0 +1,116 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_NETCONNECTIVITY_H_
+#define PHYDB_NETCONNECTIVITY_H_
+
+#include <vector>
+
+namespace phydb {
+
+class Design;
+
+/****
+ * Frozen net-to-pin and component-pin-to-net connectivity of a design.
+ *
+ * All pins of all nets are numbered in net order, component pins of a net
+ * first and then its IO pins, and stored in compressed sparse row format:
+ * the pins of net n are [GetNetPinBegin(n), GetNetPinEnd(n)). Every
+ * component has one slot per pin of its macro holding the index of that pin
+ * in the net-to-pin order, or -1 if the pin is not connected, so the net of
+ * a component pin is found in O(1). A component pin listed in several nets
+ * keeps its last one. The driver of every net is found once, when the
+ * connectivity is built.
+ *
+ * The connectivity is a snapshot of the netlist built by Design, and lives
+ * as long as the design. Adding nets, components or IO pins through Design
+ * marks it out of date and increments Design::GetConnectivityGeneration();
+ * Design::BuildNetConnectivity() then rebuilds it in place, so users keep
+ * their pointer and compare generations to know when to rebuild their own
+ * per-pin data.
+ *
+ * Net keeps its own pin vectors, which the DEF writer and the timing API
+ * use, so this is an extra, contiguous copy of the netlist for fast
+ * traversal rather than a replacement with fewer allocations.
+ */
+class NetConnectivity {
+ public:
+  explicit NetConnectivity(Design *design_ptr) : design_ptr_(design_ptr) {}
+
+  void Build();
+
+  int GetNumNets() const {
+    return static_cast<int>(net_pin_offsets_.size()) - 1;
+  }
+  int GetNumPins() const { return static_cast<int>(pin_net_ids_.size()); }
+
+  /****net to pins****/
+  int GetNetPinBegin(int net_id) const { return net_pin_offsets_[net_id]; }
+  int GetNetPinEnd(int net_id) const { return net_pin_offsets_[net_id + 1]; }
+  int GetNetDegree(int net_id) const {
+    return net_pin_offsets_[net_id + 1] - net_pin_offsets_[net_id];
+  }
+  bool IsIoPin(int pin) const { return pin_comp_ids_[pin] < 0; }
+  // -1 for IO pins
+  int GetPinComponentId(int pin) const { return pin_comp_ids_[pin]; }
+  // pin id in the macro, or IO pin id
+  int GetPinId(int pin) const { return pin_ids_[pin]; }
+  int GetPinNetId(int pin) const { return pin_net_ids_[pin]; }
+  // -1 if the net has no driver
+  int GetNetDriverPin(int net_id) const { return net_driver_pins_[net_id]; }
+
+  /****component pins to net****/
+  int GetComponentPinSlotBegin(int comp_id) const {
+    return comp_pin_offsets_[comp_id];
+  }
+  int GetComponentPinSlotEnd(int comp_id) const {
+    return comp_pin_offsets_[comp_id + 1];
+  }
+  // -1 if the slot is not connected
+  int GetSlotPin(int slot) const { return comp_pin_slots_[slot]; }
+  int GetComponentPin(int comp_id, int pin_id) const {
+    return comp_pin_slots_[comp_pin_offsets_[comp_id] + pin_id];
+  }
+  int GetComponentPinNetId(int comp_id, int pin_id) const;
+  int GetIoPinNetId(int iopin_id) const { return iopin_net_ids_[iopin_id]; }
+  void CollectNetsOfComponents(
+      std::vector<int> const &comp_ids,
+      std::vector<int> &net_ids
+  ) const;
+
+ private:
+  Design *design_ptr_ = nullptr;
+
+  std::vector<int> net_pin_offsets_;
+  std::vector<int> pin_comp_ids_;
+  std::vector<int> pin_ids_;
+  std::vector<int> pin_net_ids_;
+
+  std::vector<int> comp_pin_offsets_;
+  std::vector<int> comp_pin_slots_;
+  std::vector<int> iopin_net_ids_;
+  std::vector<int> net_driver_pins_;
+
+  int FindDriverPin(int net_id);
+};
+
+}
+
+#endif //PHYDB_NETCONNECTIVITY_H_
@@ -0,0 +1,376 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "netwire.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "phydb/common/logging.h"
+#include "phydb/common/symboltable.h"
+
+namespace phydb {
+
+void NetWireStore::Clear() {
+  *this = NetWireStore();
+}
+
+void NetWireStore::Reserve(std::size_t num_segments) {
+  net_ids_.reserve(num_segments);
+  layer_ids_.reserve(num_segments);
+  x0_.reserve(num_segments);
+  y0_.reserve(num_segments);
+  x1_.reserve(num_segments);
+  y1_.reserve(num_segments);
+  widths_.reserve(num_segments);
+  via_ids_.reserve(num_segments);
+}
+
+int NetWireStore::AddViaName(std::string_view via_name) {
+  auto res = via_name_2_id_.find(via_name);
+  if (res != via_name_2_id_.end()) {
+    return res->second;
+  }
+  int id = static_cast<int>(via_names_.size());
+  std::string const &name = InternName(via_name);
+  via_names_.push_back(&name);
+  via_name_2_id_.emplace(name, id);
+  return id;
+}
+
+int NetWireStore::GetViaNameId(std::string_view via_name) const {
+  auto res = via_name_2_id_.find(via_name);
+  if (res == via_name_2_id_.end()) {
+    return -1;
+  }
+  return res->second;
+}
+
+int NetWireStore::AddSegment(
+    int net_id,
+    int layer_id,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    int width,
+    int via_id
+) {
+  PhyDBExpects(net_id >= 0, "negative net id for a wire segment: " << net_id);
+  if (!net_ids_.empty() && net_id < net_ids_.back()) {
+    is_grouped_ = false;
+  }
+  is_index_valid_ = false;
+  int id = static_cast<int>(net_ids_.size());
+  net_ids_.push_back(net_id);
+  layer_ids_.push_back(layer_id);
+  x0_.push_back(x0);
+  y0_.push_back(y0);
+  x1_.push_back(x1);
+  y1_.push_back(y1);
+  widths_.push_back(width);
+  via_ids_.push_back(via_id);
+  return id;
+}
+
+int NetWireStore::AddWire(
+    int net_id,
+    int layer_id,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    int width
+) {
+  return AddSegment(net_id, layer_id, x0, y0, x1, y1, width, -1);
+}
+
+int NetWireStore::AddVia(int net_id, int layer_id, int x, int y, int via_id) {
+  PhyDBExpects(
+      via_id >= 0 && via_id < GetViaCount(),
+      "via id out of bound: " << via_id
+  );
+  return AddSegment(net_id, layer_id, x, y, x, y, 0, via_id);
+}
+
+/****
+ * @brief Starts a new DEF path, i.e., the first segment after ROUTED, FIXED
+ * or COVER, or a NEW segment.
+ *
+ * @param net_id: the net of this path
+ * @param layer_id: the layer of the first routing point
+ */
+void NetWireStore::StartPath(int net_id, int layer_id) {
+  path_net_id_ = net_id;
+  path_layer_id_ = layer_id;
+  path_has_point_ = false;
+}
+
+/****
+ * @brief Adds a routing point to the current path, a wire is created from
+ * the previous point. Zero-length wires are not stored.
+ */
+void NetWireStore::AddPathPoint(int x, int y) {
+  if (path_has_point_ && (x != path_x_ || y != path_y_)) {
+    AddWire(path_net_id_, path_layer_id_, path_x_, path_y_, x, y);
+  }
+  path_has_point_ = true;
+  path_x_ = x;
+  path_y_ = y;
+}
+
+/****
+ * @brief Adds a virtual point to the current path, which is not connected to
+ * the previous point.
+ */
+void NetWireStore::AddPathVirtualPoint(int x, int y) {
+  path_has_point_ = true;
+  path_x_ = x;
+  path_y_ = y;
+}
+
+/****
+ * @brief Adds a via at the last point of the current path. Following points
+ * are on the other layer of the via, which is resolved later.
+ */
+void NetWireStore::AddPathVia(std::string_view via_name) {
+  PhyDBExpects(
+      path_has_point_,
+      "via " << via_name << " has no routing point in DEF wiring"
+  );
+  AddVia(path_net_id_, path_layer_id_, path_x_, path_y_, AddViaName(via_name));
+  path_layer_id_ = kLayerAfterVia;
+}
+
+/****
+ * @brief Appends all segments of another store, via names are merged into
+ * the table of this store.
+ *
+ * @param other: the other store
+ * @param net_id_offset: added to the net ids of the other store
+ */
+void NetWireStore::Append(NetWireStore const &other, int net_id_offset) {
+  std::vector<int> via_id_map(other.via_names_.size());
+  for (size_t i = 0; i < other.via_names_.size(); ++i) {
+    via_id_map[i] = AddViaName(*other.via_names_[i]);
+  }
+  Reserve(Size() + other.Size());
+  for (size_t i = 0; i < other.Size(); ++i) {
+    int via_id = other.via_ids_[i];
+    AddSegment(
+        other.net_ids_[i] + net_id_offset,
+        other.layer_ids_[i],
+        other.x0_[i],
+        other.y0_[i],
+        other.x1_[i],
+        other.y1_[i],
+        other.widths_[i],
+        via_id >= 0 ? via_id_map[via_id] : -1
+    );
+  }
+}
+
+/****
+ * @brief Finds the routing layers of a via from its DEF or LEF definition.
+ * A via defined in DEF takes precedence over a LEF via with the same name.
+ *
+ * @return the ids of routing layers, empty if the via is not found
+ */
+static std::vector<int> FindViaRoutingLayers(
+    std::string const &via_name,
+    Tech &tech,
+    std::unordered_map<std::string_view, DefVia *> &def_vias
+) {
+  std::vector<int> layer_ids;
+  auto add_layer = [&](int layer_id) {
+    if (layer_id < 0) return;
+    if (tech.GetLayersRef()[layer_id].GetType() != LayerType::ROUTING) return;
+    for (int id : layer_ids) {
+      if (id == layer_id) return;
+    }
+    layer_ids.push_back(layer_id);
+  };
+
+  auto res = def_vias.find(via_name);
+  if (res != def_vias.end()) {
+    DefVia *via_ptr = res->second;
+    if (!via_ptr->via_rule_name_.empty()) {
+      add_layer(tech.GetLayerId(via_ptr->layers_[0]));
+      add_layer(tech.GetLayerId(via_ptr->layers_[2]));
+    } else {
+      for (auto &rect : via_ptr->rect2d_layers) {
+        add_layer(tech.GetLayerId(rect.layer));
+      }
+    }
+  } else if (LefVia *via_ptr = tech.GetLefViaPtr(via_name)) {
+    for (auto &layer_rect : via_ptr->GetLayerRectsRef()) {
+      add_layer(tech.ResolveLayerId(layer_rect));
+    }
+  }
+  return layer_ids;
+}
+
+/****
+ * @brief Resolves the layers of segments following vias in DEF paths. Such a
+ * segment is on the layer of the via other than the one the path is on
+ * before the via. This needs via definitions, so it is done after the whole
+ * DEF file is loaded. Unresolvable layers become -1, and segments without a
+ * valid layer are not written to DEF.
+ *
+ * @param tech: the technology containing layers and LEF vias
+ * @param def_vias: vias defined in the VIAS section of DEF
+ */
+void NetWireStore::ResolveLayersAfterVias(
+    Tech &tech,
+    std::vector<DefVia> &def_vias
+) {
+  std::unordered_map<std::string_view, DefVia *> def_via_map;
+  for (auto &via : def_vias) {
+    def_via_map.emplace(via.name_, &via);
+  }
+  std::vector<std::vector<int>> via_layers(via_names_.size());
+  for (size_t i = 0; i < via_names_.size(); ++i) {
+    via_layers[i] = FindViaRoutingLayers(*via_names_[i], tech, def_via_map);
+  }
+
+  int num_invalid = 0;
+  int size = static_cast<int>(Size());
+  for (int i = 0; i < size; ++i) {
+    if (layer_ids_[i] != kLayerAfterVia) {
+      if (layer_ids_[i] < 0) ++num_invalid;
+      continue;
+    }
+    int layer_id = -1;
+    int prev = i - 1;
+    if (prev >= 0 && net_ids_[prev] == net_ids_[i]) {
+      if (via_ids_[prev] < 0) {
+        layer_id = layer_ids_[prev];
+      } else if (layer_ids_[prev] >= 0) {
+        // the other routing layer of the previous via
+        for (int via_layer_id : via_layers[via_ids_[prev]]) {
+          if (via_layer_id != layer_ids_[prev]) {
+            layer_id = via_layer_id;
+            break;
+          }
+        }
+      }
+    }
+    if (layer_id < 0) ++num_invalid;
+    layer_ids_[i] = layer_id;
+  }
+  if (num_invalid > 0) {
+    std::cout << "Warning: " << num_invalid
+              << " net wire segments are on unknown layers\n";
+  }
+}
+
+/****
+ * @brief Regroups segments by net, the order within a net is kept.
+ */
+void NetWireStore::GroupByNet() {
+  if (is_grouped_) return;
+  int size = static_cast<int>(Size());
+  std::vector<int> order(size);
+  for (int i = 0; i < size; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(
+      order.begin(), order.end(),
+      [&](int a, int b) { return net_ids_[a] < net_ids_[b]; }
+  );
+  auto permute = [&](std::vector<int> &values) {
+    std::vector<int> permuted(size);
+    for (int i = 0; i < size; ++i) {
+      permuted[i] = values[order[i]];
+    }
+    values.swap(permuted);
+  };
+  permute(net_ids_);
+  permute(layer_ids_);
+  permute(x0_);
+  permute(y0_);
+  permute(x1_);
+  permute(y1_);
+  permute(widths_);
+  permute(via_ids_);
+  is_grouped_ = true;
+}
+
+/****
+ * @brief Builds the per-net index if segments are added since the last
+ * build. GetNetBegin() and GetNetEnd() build it on demand, so call this
+ * function before querying nets from multiple threads.
+ */
+void NetWireStore::BuildNetIndex() {
+  if (is_index_valid_) return;
+  GroupByNet();
+  int num_nets = net_ids_.empty() ? 0 : net_ids_.back() + 1;
+  net_offsets_.assign(num_nets + 1, 0);
+  for (int net_id : net_ids_) {
+    ++net_offsets_[net_id + 1];
+  }
+  for (int i = 0; i < num_nets; ++i) {
+    net_offsets_[i + 1] += net_offsets_[i];
+  }
+  is_index_valid_ = true;
+}
+
+int NetWireStore::GetNetBegin(int net_id) {
+  BuildNetIndex();
+  if (net_id + 1 >= static_cast<int>(net_offsets_.size())) {
+    return static_cast<int>(Size());
+  }
+  return net_offsets_[net_id];
+}
+
+int NetWireStore::GetNetEnd(int net_id) {
+  BuildNetIndex();
+  if (net_id + 1 >= static_cast<int>(net_offsets_.size())) {
+    return static_cast<int>(Size());
+  }
+  return net_offsets_[net_id + 1];
+}
+
+/****
+ * @brief Checks whether a segment can be written in the same DEF path as the
+ * previous segment, that is, the previous segment is a wire of the same net
+ * on the same layer ending at the beginning of this segment.
+ */
+bool NetWireStore::IsPathContinued(int segment_id) const {
+  int prev = segment_id - 1;
+  return prev >= 0
+      && net_ids_[prev] == net_ids_[segment_id]
+      && via_ids_[prev] < 0
+      && layer_ids_[prev] == layer_ids_[segment_id]
+      && x1_[prev] == x0_[segment_id]
+      && y1_[prev] == y0_[segment_id];
+}
+
+std::size_t NetWireStore::GetMemoryBytes() const {
+  std::size_t bytes = 0;
+  for (auto *values : {&net_ids_, &layer_ids_, &x0_, &y0_, &x1_, &y1_,
+                       &widths_, &via_ids_, &net_offsets_}) {
+    bytes += values->capacity() * sizeof(int);
+  }
+  bytes += via_names_.capacity() * sizeof(std::string const *);
+  return bytes;
+}
+
+}
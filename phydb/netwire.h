@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_NETWIRE_H_
+#define PHYDB_NETWIRE_H_
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "defvia.h"
+#include "tech.h"
+
+namespace phydb {
+
+/****
+ * Routed wiring of regular nets, stored as segments in structure-of-arrays
+ * form, 32 bytes per segment.
+ *
+ * A segment is either a wire from (x0, y0) to (x1, y1) on a routing layer, or
+ * a via at (x0, y0) placed on the layer of the segment, which is the bottom or
+ * the top layer of the via. Via names are kept in a table local to this store,
+ * and segments refer to them by id. A width of 0 means the default width of
+ * the layer, regular wiring in DEF does not specify widths.
+ *
+ * Segments on layers unknown to Tech have layer id -1.
+ *
+ * Segments are grouped by net. Appending to nets in non-decreasing id order,
+ * which is what DEF readers do, keeps segment ids unchanged. Otherwise the
+ * segments are regrouped by net when the per-net index is built next time,
+ * and segment ids change.
+ */
+class NetWireStore {
+  friend class Snapshot;
+ public:
+  // the layer of a segment following a via, which is resolved later by
+  // ResolveLayersAfterVias() because via definitions may come later
+  static constexpr int kLayerAfterVia = -2;
+
+  void Clear();
+  void Reserve(std::size_t num_segments);
+
+  int AddViaName(std::string_view via_name);
+  int GetViaNameId(std::string_view via_name) const;
+  std::string const &GetViaName(int via_id) const { return *via_names_[via_id]; }
+  int GetViaCount() const { return static_cast<int>(via_names_.size()); }
+
+  int AddWire(
+      int net_id,
+      int layer_id,
+      int x0,
+      int y0,
+      int x1,
+      int y1,
+      int width = 0
+  );
+  int AddVia(int net_id, int layer_id, int x, int y, int via_id);
+
+  // appending the routing points of a DEF path one by one
+  void StartPath(int net_id, int layer_id);
+  void AddPathPoint(int x, int y);
+  void AddPathVirtualPoint(int x, int y);
+  void AddPathVia(std::string_view via_name);
+
+  void Append(NetWireStore const &other, int net_id_offset);
+  void ResolveLayersAfterVias(Tech &tech, std::vector<DefVia> &def_vias);
+
+  void BuildNetIndex();
+  int GetNetBegin(int net_id);
+  int GetNetEnd(int net_id);
+  bool IsPathContinued(int segment_id) const;
+
+  std::size_t Size() const { return net_ids_.size(); }
+  std::size_t GetMemoryBytes() const;
+
+  bool IsVia(int i) const { return via_ids_[i] >= 0; }
+  int GetNetId(int i) const { return net_ids_[i]; }
+  int GetLayerId(int i) const { return layer_ids_[i]; }
+  int GetX0(int i) const { return x0_[i]; }
+  int GetY0(int i) const { return y0_[i]; }
+  int GetX1(int i) const { return x1_[i]; }
+  int GetY1(int i) const { return y1_[i]; }
+  int GetWidth(int i) const { return widths_[i]; }
+  int GetViaId(int i) const { return via_ids_[i]; }
+  void SetWidth(int i, int width) { widths_[i] = width; }
+
+ private:
+  std::vector<int> net_ids_;
+  std::vector<int> layer_ids_;
+  std::vector<int> x0_;
+  std::vector<int> y0_;
+  std::vector<int> x1_;
+  std::vector<int> y1_;
+  std::vector<int> widths_;
+  std::vector<int> via_ids_; // -1 for wires
+
+  std::vector<std::string const *> via_names_;
+  std::unordered_map<std::string_view, int> via_name_2_id_;
+
+  // segments of net i are [net_offsets_[i], net_offsets_[i + 1])
+  bool is_grouped_ = true;
+  bool is_index_valid_ = false;
+  std::vector<int> net_offsets_;
+
+  // the DEF path being appended
+  int path_net_id_ = -1;
+  int path_layer_id_ = -1;
+  bool path_has_point_ = false;
+  int path_x_ = 0;
+  int path_y_ = 0;
+
+  int AddSegment(
+      int net_id,
+      int layer_id,
+      int x0,
+      int y0,
+      int x1,
+      int y1,
+      int width,
+      int via_id
+  );
+  void GroupByNet();
+};
+
+}
+
+#endif //PHYDB_NETWIRE_H_
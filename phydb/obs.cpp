@@ -22,8 +22,11 @@
 
 namespace phydb {
 
-LayerRect *OBS::AddLayerRect(std::string &layer_name) {
-  layer_rects_.emplace_back(layer_name);
+LayerRect *OBS::AddLayerRect(
+    std::string const &layer_name,
+    int layer_id
+) {
+  layer_rects_.emplace_back(layer_name, layer_id);
   return &(layer_rects_.back());
 }
 
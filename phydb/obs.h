@@ -38,7 +38,7 @@ class OBS {
   std::vector<LayerRect> &GetLayerRectsRef();
 
   // API to add LayerRect
-  LayerRect *AddLayerRect(std::string &layer_name);
+  LayerRect *AddLayerRect(std::string const &layer_name, int layer_id = -1);
 
   friend std::ostream &operator<<(std::ostream &, const OBS &);
  private:
@@ -0,0 +1,1391 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "paralleldefreader.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include "deftokenizer.h"
+#include "lefdefparser.h"
+#include "phydb/common/arena.h"
+#include "phydb/common/compressedfile.h"
+#include "phydb/common/helper.h"
+#include "phydb/common/logging.h"
+#include "phydb/common/mappedfile.h"
+
+namespace phydb {
+
+/****
+ * The parallel DEF reader works in the following steps:
+ *   1. the whole file is memory-mapped (a gzip or zstd file is decompressed
+ *      into memory instead), and the boundaries of the COMPONENTS, PINS,
+ *      NETS and SPECIALNETS sections are found by a quick line-based scan,
+ *      all tokens are views into the mapping;
+ *   2. each of these sections is split into chunks at statement boundaries,
+ *      and all chunks are parsed concurrently into chunk-local records;
+ *   3. records are merged into the Design in file order, so ids are the same
+ *      as the ones given by the serial Si2 parser;
+ *   4. everything else is small, the header, ROW, TRACKS and GCELLGRID
+ *      statements are parsed in place, and if there is anything else (VIAS,
+ *      BLOCKAGES, ...), the whole remaining text is fed to the Si2 parser
+ *      from memory instead.
+ * Sections not in the section mask are cut out of the text before any
+ * parsing. Lazy sections are cut out as well, only their offsets are kept,
+ * and a loader reading this range of the file again is installed in the
+ * Design.
+ * ****/
+
+enum class DefSectionType {
+  COMPONENTS = 0,
+  PINS = 1,
+  NETS = 2,
+  SPECIALNETS = 3,
+  BLOCKAGES = 4, // parsed by the Si2 parser, found only to be skipped
+  VIAS = 5 // parsed by the Si2 parser, found only to be skipped
+};
+
+struct DefSection {
+  DefSectionType type;
+  int count = 0;
+  const char *begin = nullptr; // the beginning of the section keyword line
+  const char *body_begin = nullptr; // right after the section header
+  const char *body_end = nullptr; // the beginning of the END line
+  const char *end = nullptr; // the end of the END line
+};
+
+struct DefChunk {
+  DefSectionType type;
+  const char *begin;
+  const char *end;
+};
+
+struct DefComponentRecord {
+  std::string name;
+  std::string macro_name;
+  MacroId macro_id = -1;
+  PlaceStatus place_status = PlaceStatus::UNPLACED;
+  int llx = 0;
+  int lly = 0;
+  CompOrient orient = CompOrient::N;
+  CompSource source = CompSource::NETLIST;
+};
+
+struct DefIoPinShape {
+  std::string layer_name;
+  int lx;
+  int ly;
+  int ux;
+  int uy;
+};
+
+struct DefIoPinRecord {
+  std::string name;
+  std::string direction;
+  std::string use = "SIGNAL";
+  PlaceStatus place_status = PlaceStatus::UNPLACED;
+  int x = 0;
+  int y = 0;
+  CompOrient orient = CompOrient::N;
+  std::vector<DefIoPinShape> shapes;
+};
+
+struct DefNetRecord {
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> connections;
+  std::vector<PhydbPin> pins; // resolved connections
+};
+
+struct DefSNetRecord {
+  explicit DefSNetRecord(GeometryAllocator alloc)
+      : polygons(alloc), paths(alloc) {}
+  std::string name;
+  std::string use;
+  GeometryVector<Polygon> polygons;
+  GeometryVector<Path> paths;
+};
+
+struct DefChunkResult {
+  // geometry parsed by the thread of this chunk, copied into the arena of
+  // the design when merged
+  std::unique_ptr<GeometryArena> arena = std::make_unique<GeometryArena>();
+  std::vector<DefComponentRecord> components;
+  std::vector<DefIoPinRecord> iopins;
+  std::vector<DefNetRecord> nets;
+  NetWireStore net_wires; // net ids are indices in nets
+  std::vector<DefSNetRecord> snets;
+};
+
+static const char *DefSectionName(DefSectionType type) {
+  switch (type) {
+    case DefSectionType::COMPONENTS: return "COMPONENTS";
+    case DefSectionType::PINS: return "PINS";
+    case DefSectionType::NETS: return "NETS";
+    case DefSectionType::SPECIALNETS: return "SPECIALNETS";
+    case DefSectionType::BLOCKAGES: return "BLOCKAGES";
+    case DefSectionType::VIAS: return "VIAS";
+  }
+  return "BOGUS";
+}
+
+static DefSectionMask DefSectionBit(DefSectionType type) {
+  switch (type) {
+    case DefSectionType::COMPONENTS: return kDefComponents;
+    case DefSectionType::PINS: return kDefPins;
+    case DefSectionType::NETS: return kDefNets;
+    case DefSectionType::SPECIALNETS: return kDefSpecialNets;
+    case DefSectionType::BLOCKAGES: return kDefBlockages;
+    case DefSectionType::VIAS: return kDefVias;
+  }
+  return 0;
+}
+
+// sections parsed by the in-house parser, the others go to the Si2 parser
+static bool IsInHouseDefSection(DefSectionType type) {
+  return type != DefSectionType::BLOCKAGES && type != DefSectionType::VIAS;
+}
+
+static bool StrToDefSectionType(std::string_view str, DefSectionType &type) {
+  for (auto candidate: {DefSectionType::COMPONENTS, DefSectionType::PINS,
+                        DefSectionType::NETS, DefSectionType::SPECIALNETS,
+                        DefSectionType::BLOCKAGES, DefSectionType::VIAS}) {
+    if (str == DefSectionName(candidate)) {
+      type = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+/****
+ * @brief Finds the COMPONENTS, PINS, NETS, SPECIALNETS, BLOCKAGES and VIAS
+ * sections
+ *
+ * @param begin: the beginning of the DEF text
+ * @param end: the end of the DEF text
+ * @return sections in the order they appear in the file
+ */
+static std::vector<DefSection> FindDefSections(
+    const char *begin,
+    const char *end
+) {
+  std::vector<DefSection> sections;
+  bool is_in_section = false;
+  DefSection section;
+  const char *line = begin;
+  while (line < end) {
+    auto *line_end = static_cast<const char *>(
+        std::memchr(line, '\n', end - line)
+    );
+    if (line_end == nullptr) line_end = end;
+
+    DefTokenizer tokenizer(line, line_end);
+    std::string_view token;
+    if (tokenizer.Next(token)) {
+      if (!is_in_section) {
+        DefSectionType type;
+        if (StrToDefSectionType(token, type)) {
+          const char *context = DefSectionName(type);
+          section = DefSection();
+          section.type = type;
+          section.begin = line;
+          // the section header may span more than one line
+          DefTokenizer header_tokenizer(line, end);
+          header_tokenizer.Next(token);
+          section.count = header_tokenizer.ExpectInt(context);
+          header_tokenizer.ExpectLiteral(";", context);
+          section.body_begin = header_tokenizer.Position();
+          is_in_section = true;
+          line = section.body_begin;
+          continue;
+        }
+      } else if (token == "END") {
+        if (tokenizer.Next(token) && token == DefSectionName(section.type)) {
+          section.body_end = line;
+          section.end = line_end;
+          sections.push_back(section);
+          is_in_section = false;
+        }
+      }
+    }
+    line = line_end + 1;
+  }
+  PhyDBExpects(
+      !is_in_section,
+      "Cannot find END " << DefSectionName(section.type) << " in DEF"
+  );
+  return sections;
+}
+
+/****
+ * @brief Finds the first statement starting after a given position.
+ * A statement starts with a '-' token which follows the ';' of the
+ * previous statement.
+ *
+ * @param pos: the position to start searching from
+ * @param end: the end of the section body
+ * @return the position of the '-', or end if there is no more statement
+ */
+static const char *FindNextDefStatement(const char *pos, const char *end) {
+  while (pos < end) {
+    pos = static_cast<const char *>(std::memchr(pos, ';', end - pos));
+    if (pos == nullptr) return end;
+    ++pos;
+    while (pos < end && std::isspace(static_cast<unsigned char>(*pos))) ++pos;
+    if (pos + 1 < end && *pos == '-'
+        && std::isspace(static_cast<unsigned char>(pos[1]))) {
+      return pos;
+    }
+  }
+  return end;
+}
+
+static void SplitDefSection(
+    DefSection const &section,
+    int num_chunks,
+    std::vector<DefChunk> &chunks
+) {
+  const char *begin = section.body_begin;
+  const char *end = section.body_end;
+  std::size_t length = end - begin;
+  const char *chunk_begin = begin;
+  for (int i = 1; i < num_chunks; ++i) {
+    const char *cut = std::max(begin + length * i / num_chunks, chunk_begin);
+    cut = FindNextDefStatement(cut, end);
+    if (cut >= end) break;
+    chunks.push_back(DefChunk{section.type, chunk_begin, cut});
+    chunk_begin = cut;
+  }
+  chunks.push_back(DefChunk{section.type, chunk_begin, end});
+}
+
+static void ExpectDefStatementStart(
+    std::string_view token,
+    const char *context
+) {
+  PhyDBExpects(
+      token == "-",
+      "Expect - at the beginning of a statement in DEF " << context
+          << ", get: " << token
+  );
+}
+
+// reads "x y )", the opening parenthesis is already consumed
+static void ReadDefPointAfterParen(
+    DefTokenizer &tokenizer,
+    int &x,
+    int &y,
+    const char *context
+) {
+  x = tokenizer.ExpectInt(context);
+  y = tokenizer.ExpectInt(context);
+  tokenizer.ExpectLiteral(")", context);
+}
+
+static void ReadDefPoint(
+    DefTokenizer &tokenizer,
+    int &x,
+    int &y,
+    const char *context
+) {
+  tokenizer.ExpectLiteral("(", context);
+  ReadDefPointAfterParen(tokenizer, x, y, context);
+}
+
+static void ParseDefComponents(
+    PhyDB *phy_db_ptr,
+    DefTokenizer &tokenizer,
+    std::vector<DefComponentRecord> &components
+) {
+  const char *context = "COMPONENTS";
+  std::string_view token;
+  while (tokenizer.Next(token)) {
+    ExpectDefStatementStart(token, context);
+    DefComponentRecord &component = components.emplace_back();
+    tokenizer.Expect(token, context);
+    component.name = std::string(token);
+    tokenizer.Expect(token, context);
+    component.macro_name = std::string(token);
+    component.macro_id = phy_db_ptr->GetMacroId(component.macro_name);
+    PhyDBExpects(component.macro_id >= 0,
+                 "Cannot find " + component.macro_name + " in PhyDB");
+
+    tokenizer.Expect(token, context);
+    while (token != ";") {
+      if (token != "+") {
+        tokenizer.Expect(token, context);
+        continue;
+      }
+      tokenizer.Expect(token, context);
+      if (token == "SOURCE") {
+        tokenizer.Expect(token, context);
+        component.source = StrToCompSource(std::string(token));
+      } else if (token == "PLACED" || token == "FIXED" || token == "COVER") {
+        component.place_status = StrToPlaceStatus(std::string(token));
+        ReadDefPoint(tokenizer, component.llx, component.lly, context);
+        tokenizer.Expect(token, context);
+        component.orient = StrToCompOrient(std::string(token));
+      } else if (token == "UNPLACED") {
+        component.place_status = PlaceStatus::UNPLACED;
+        component.llx = 0;
+        component.lly = 0;
+        component.orient = CompOrient::N;
+      }
+      tokenizer.Expect(token, context);
+    }
+  }
+}
+
+static void ParseDefIoPins(
+    DefTokenizer &tokenizer,
+    std::vector<DefIoPinRecord> &iopins
+) {
+  const char *context = "PINS";
+  std::string_view token;
+  while (tokenizer.Next(token)) {
+    ExpectDefStatementStart(token, context);
+    DefIoPinRecord &iopin = iopins.emplace_back();
+    tokenizer.Expect(token, context);
+    iopin.name = std::string(token);
+
+    tokenizer.Expect(token, context);
+    while (token != ";") {
+      if (token != "+") {
+        tokenizer.Expect(token, context);
+        continue;
+      }
+      tokenizer.Expect(token, context);
+      if (token == "DIRECTION") {
+        tokenizer.Expect(token, context);
+        iopin.direction = std::string(token);
+      } else if (token == "USE") {
+        tokenizer.Expect(token, context);
+        iopin.use = std::string(token);
+      } else if (token == "LAYER") {
+        DefIoPinShape &shape = iopin.shapes.emplace_back();
+        tokenizer.Expect(token, context);
+        shape.layer_name = std::string(token);
+        // skip MASK, SPACING and DESIGNRULEWIDTH
+        do {
+          tokenizer.Expect(token, context);
+        } while (token != "(");
+        int x1, y1, x2, y2;
+        ReadDefPointAfterParen(tokenizer, x1, y1, context);
+        ReadDefPoint(tokenizer, x2, y2, context);
+        shape.lx = std::min(x1, x2);
+        shape.ly = std::min(y1, y2);
+        shape.ux = std::max(x1, x2);
+        shape.uy = std::max(y1, y2);
+      } else if (token == "PLACED" || token == "FIXED" || token == "COVER") {
+        iopin.place_status = StrToPlaceStatus(std::string(token));
+        ReadDefPoint(tokenizer, iopin.x, iopin.y, context);
+        tokenizer.Expect(token, context);
+        iopin.orient = StrToCompOrient(std::string(token));
+      } else if (token == "UNPLACED") {
+        iopin.place_status = PlaceStatus::UNPLACED;
+      } else if (token == "PORT") {
+        PhyDBExpects(false, "multiple pin ports existing in DEF");
+      }
+      tokenizer.Expect(token, context);
+    }
+  }
+}
+
+static bool IsDefOrientToken(std::string_view token) {
+  return token == "N" || token == "S" || token == "E" || token == "W"
+      || token == "FN" || token == "FS" || token == "FE" || token == "FW";
+}
+
+// reads "x y [ext] )" in a routing statement, '*' repeats the previous value
+// in x or y, and ext is -1 if not given
+static void ReadDefRoutingPointValues(
+    DefTokenizer &tokenizer,
+    int &x,
+    int &y,
+    int &ext,
+    const char *context
+) {
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  if (token != "*") x = DefTokenToInt(token);
+  tokenizer.Expect(token, context);
+  if (token != "*") y = DefTokenToInt(token);
+  tokenizer.Expect(token, context);
+  if (token == ")") {
+    ext = -1;
+  } else {
+    ext = DefTokenToInt(token);
+    tokenizer.ExpectLiteral(")", context);
+  }
+}
+
+static void ReadDefRoutingPoint(
+    DefTokenizer &tokenizer,
+    Path &path,
+    int &last_x,
+    int &last_y,
+    const char *context
+) {
+  int ext;
+  ReadDefRoutingPointValues(tokenizer, last_x, last_y, ext, context);
+  path.AddRoutingPoint(last_x, last_y, ext);
+}
+
+/****
+ * @brief Parses the regular wiring following ROUTED/FIXED/COVER/NOSHIELD
+ * into a wire store. Layers after vias are resolved when the whole DEF file
+ * is loaded.
+ *
+ * @param tokenizer: the tokenizer
+ * @param token: the layer name of the first path when called, the token
+ * terminating the wiring ('+' or ';') when returned
+ * @param net_id: the net id in the wire store
+ * @param net_wires: the wire store to append to
+ * @param tech: the technology, for resolving layer ids
+ */
+static void ParseDefRegularWiring(
+    DefTokenizer &tokenizer,
+    std::string_view &token,
+    int net_id,
+    NetWireStore &net_wires,
+    Tech &tech
+) {
+  const char *context = "NETS";
+  while (true) {
+    net_wires.StartPath(net_id, tech.GetLayerId(token));
+
+    int x = 0;
+    int y = 0;
+    int ext;
+    tokenizer.Expect(token, context);
+    while (token != "NEW") {
+      if (token == ";" || token == "+") {
+        return;
+      } else if (token == "(") {
+        ReadDefRoutingPointValues(tokenizer, x, y, ext, context);
+        net_wires.AddPathPoint(x, y);
+      } else if (token == "VIRTUAL") {
+        tokenizer.ExpectLiteral("(", context);
+        ReadDefRoutingPointValues(tokenizer, x, y, ext, context);
+        net_wires.AddPathVirtualPoint(x, y);
+      } else if (token == "RECT") {
+        // patches are not stored
+        for (int i = 0; i < 6; ++i) {
+          tokenizer.Expect(token, context);
+        }
+      } else if (token == "MASK" || token == "STYLE" || token == "TAPERRULE") {
+        tokenizer.Expect(token, context);
+      } else if (token != "TAPER" && !IsDefOrientToken(token)) {
+        net_wires.AddPathVia(token);
+      }
+      tokenizer.Expect(token, context);
+    }
+    tokenizer.Expect(token, context);
+  }
+}
+
+// routed wiring is skipped if net_wires is nullptr
+static void ParseDefNets(
+    DefTokenizer &tokenizer,
+    std::vector<DefNetRecord> &nets,
+    NetWireStore *net_wires,
+    Tech &tech
+) {
+  const char *context = "NETS";
+  std::string_view token;
+  while (tokenizer.Next(token)) {
+    ExpectDefStatementStart(token, context);
+    DefNetRecord &net = nets.emplace_back();
+    int net_id = static_cast<int>(nets.size()) - 1;
+    tokenizer.Expect(token, context);
+    net.name = std::string(token);
+
+    // connections come before the first '+'
+    tokenizer.Expect(token, context);
+    while (token == "(") {
+      std::string_view comp_name, pin_name;
+      tokenizer.Expect(comp_name, context);
+      tokenizer.Expect(pin_name, context);
+      net.connections.emplace_back(comp_name, pin_name);
+      do {
+        tokenizer.Expect(token, context);
+      } while (token != ")");
+      tokenizer.Expect(token, context);
+    }
+    while (token != ";") {
+      if (token != "+") {
+        tokenizer.Expect(token, context);
+        continue;
+      }
+      tokenizer.Expect(token, context);
+      bool is_wiring = token == "ROUTED" || token == "FIXED"
+          || token == "COVER" || token == "NOSHIELD";
+      if (is_wiring && net_wires != nullptr) {
+        tokenizer.Expect(token, context);
+        ParseDefRegularWiring(tokenizer, token, net_id, *net_wires, tech);
+        continue;
+      }
+      tokenizer.Expect(token, context);
+    }
+  }
+}
+
+/****
+ * @brief Parses the special wiring following ROUTED/FIXED/COVER/SHIELD,
+ * one Path is created for the first segment and for each NEW segment.
+ *
+ * @param tokenizer: the tokenizer
+ * @param token: the layer name of the first segment when called, the token
+ * terminating the wiring ('+' or ';') when returned
+ * @param paths: a list of paths to append to
+ * @param tech: the technology, for resolving layer ids
+ */
+static void ParseDefSpecialWiring(
+    DefTokenizer &tokenizer,
+    std::string_view &token,
+    GeometryVector<Path> &paths,
+    Tech &tech
+) {
+  const char *context = "SPECIALNETS";
+  while (true) {
+    Path &path = paths.emplace_back();
+    std::string layer_name(token);
+    path.SetLayerName(layer_name);
+    path.SetLayerId(tech.GetLayerId(token));
+    tokenizer.Expect(token, context);
+    if (token == "TAPER") {
+      tokenizer.Expect(token, context);
+    } else if (token == "TAPERRULE") {
+      tokenizer.Expect(token, context);
+      tokenizer.Expect(token, context);
+    }
+    path.SetWidth(DefTokenToInt(token));
+
+    int last_x = 0;
+    int last_y = 0;
+    tokenizer.Expect(token, context);
+    while (token != "NEW") {
+      if (token == ";") {
+        return;
+      } else if (token == "+") {
+        std::string_view keyword;
+        tokenizer.Peek(keyword);
+        if (keyword == "SHAPE") {
+          tokenizer.Expect(keyword, context);
+          tokenizer.Expect(token, context);
+          std::string shape(token);
+          path.SetShape(shape);
+        } else if (keyword == "STYLE" || keyword == "MASK") {
+          tokenizer.Expect(keyword, context);
+          tokenizer.Expect(token, context);
+        } else {
+          return;
+        }
+      } else if (token == "(") {
+        ReadDefRoutingPoint(tokenizer, path, last_x, last_y, context);
+      } else if (token == "VIRTUAL") {
+        tokenizer.ExpectLiteral("(", context);
+        ReadDefRoutingPoint(tokenizer, path, last_x, last_y, context);
+      } else if (token == "RECT") {
+        tokenizer.ExpectLiteral("(", context);
+        int x1 = tokenizer.ExpectInt(context);
+        int y1 = tokenizer.ExpectInt(context);
+        int x2 = tokenizer.ExpectInt(context);
+        int y2 = tokenizer.ExpectInt(context);
+        tokenizer.ExpectLiteral(")", context);
+        path.SetRect(
+            std::min(x1, x2),
+            std::min(y1, y2),
+            std::max(x1, x2),
+            std::max(y1, y2)
+        );
+      } else if (token == "MASK") {
+        tokenizer.Expect(token, context);
+      } else if (token == "DO") {
+        // DO numX BY numY STEP stepX stepY
+        int num_x = tokenizer.ExpectInt(context);
+        tokenizer.ExpectLiteral("BY", context);
+        int num_y = tokenizer.ExpectInt(context);
+        tokenizer.ExpectLiteral("STEP", context);
+        int step_x = tokenizer.ExpectInt(context);
+        int step_y = tokenizer.ExpectInt(context);
+        path.SetViaArray(num_x, num_y, step_x, step_y);
+      } else if (!IsDefOrientToken(token)) {
+        std::string via_name(token);
+        path.SetViaName(via_name);
+      }
+      tokenizer.Expect(token, context);
+    }
+    tokenizer.Expect(token, context);
+  }
+}
+
+static void ParseDefSNets(
+    DefTokenizer &tokenizer,
+    std::vector<DefSNetRecord> &snets,
+    GeometryAllocator alloc,
+    Tech &tech
+) {
+  const char *context = "SPECIALNETS";
+  std::string_view token;
+  while (tokenizer.Next(token)) {
+    ExpectDefStatementStart(token, context);
+    DefSNetRecord &snet = snets.emplace_back(alloc);
+    tokenizer.Expect(token, context);
+    snet.name = std::string(token);
+
+    tokenizer.Expect(token, context);
+    while (token != ";") {
+      if (token != "+") {
+        tokenizer.Expect(token, context);
+        continue;
+      }
+      tokenizer.Expect(token, context);
+      if (token == "USE") {
+        tokenizer.Expect(token, context);
+        snet.use = std::string(token);
+      } else if (token == "ROUTED" || token == "FIXED" || token == "COVER"
+          || token == "SHIELD") {
+        if (token == "SHIELD") {
+          tokenizer.Expect(token, context);
+        }
+        tokenizer.Expect(token, context);
+        ParseDefSpecialWiring(tokenizer, token, snet.paths, tech);
+        continue;
+      } else if (token == "POLYGON") {
+        tokenizer.Expect(token, context);
+        Polygon &polygon = snet.polygons.emplace_back(std::string(token));
+        polygon.SetLayerId(tech.GetLayerId(token));
+        int last_x = 0;
+        int last_y = 0;
+        tokenizer.Expect(token, context);
+        while (token != "+" && token != ";") {
+          if (token == "(") {
+            tokenizer.Expect(token, context);
+            int x = (token == "*") ? last_x : DefTokenToInt(token);
+            tokenizer.Expect(token, context);
+            int y = (token == "*") ? last_y : DefTokenToInt(token);
+            tokenizer.ExpectLiteral(")", context);
+            polygon.AddRoutingPoint(x, y);
+            last_x = x;
+            last_y = y;
+          }
+          tokenizer.Expect(token, context);
+        }
+        continue;
+      }
+      tokenizer.Expect(token, context);
+    }
+  }
+}
+
+static void ParseDefChunk(
+    PhyDB *phy_db_ptr,
+    DefChunk const &chunk,
+    DefSectionMask sections,
+    DefChunkResult &result
+) {
+  DefTokenizer tokenizer(chunk.begin, chunk.end);
+  switch (chunk.type) {
+    case DefSectionType::COMPONENTS: {
+      ParseDefComponents(phy_db_ptr, tokenizer, result.components);
+      break;
+    }
+    case DefSectionType::PINS: {
+      ParseDefIoPins(tokenizer, result.iopins);
+      break;
+    }
+    case DefSectionType::NETS: {
+      ParseDefNets(
+          tokenizer,
+          result.nets,
+          (sections & kDefNetWiring) ? &result.net_wires : nullptr,
+          *phy_db_ptr->GetTechPtr()
+      );
+      break;
+    }
+    case DefSectionType::SPECIALNETS: {
+      ParseDefSNets(
+          tokenizer,
+          result.snets,
+          result.arena->GetAllocator(),
+          *phy_db_ptr->GetTechPtr()
+      );
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+/****
+ * @brief Converts pin names of nets into ids. This is done after all
+ * components and IO pins are merged, and it only reads name maps.
+ *
+ * @param design: the design containing all components and IO pins
+ * @param nets: a list of nets parsed from a chunk
+ */
+static void ResolveDefNetPins(
+    Design &design,
+    std::vector<DefNetRecord> &nets
+) {
+  auto &component_2_id = design.GetComponentNameMapRef();
+  auto &iopin_2_id = design.GetIoPinNameMapRef();
+  auto &components = design.GetComponentsRef();
+  for (auto &net: nets) {
+    net.pins.reserve(net.connections.size());
+    for (auto &[comp_name, pin_name]: net.connections) {
+      if (comp_name == "PIN") {
+        auto res = iopin_2_id.find(pin_name);
+        PhyDBExpects(
+            res != iopin_2_id.end(),
+            "Cannot add a nonexistent iopin to a net: " << pin_name
+        );
+        net.pins.emplace_back(-1, res->second);
+      } else {
+        auto res = component_2_id.find(comp_name);
+        PhyDBExpects(
+            res != component_2_id.end(),
+            "Cannot add a nonexistent component to a net: " << comp_name
+        );
+        Macro &macro = design.GetTechPtr()->GetMacro(
+            components[res->second].GetMacroId()
+        );
+        int pin_id = macro.GetPinId(pin_name);
+        PhyDBExpects(
+            pin_id >= 0,
+            "Macro " << macro.GetName()
+                     << " does not contain a pin with name " << pin_name
+        );
+        net.pins.emplace_back(res->second, pin_id);
+      }
+    }
+    net.connections.clear();
+    net.connections.shrink_to_fit();
+  }
+}
+
+struct DefRowRecord {
+  std::string_view name;
+  std::string_view site_name;
+  std::string_view orient;
+  int orig_x = 0;
+  int orig_y = 0;
+  int num_x = 0;
+  int num_y = 0;
+  int step_x = 0;
+  int step_y = 0;
+};
+
+struct DefTrackRecord {
+  XYDirection direction = XYDirection::X;
+  int start = 0;
+  int num = 0;
+  int step = 0;
+  std::vector<std::string_view> layer_names;
+};
+
+struct DefHeaderRecord {
+  bool has_version = false;
+  double version = 0;
+  bool has_units = false;
+  double units = 0;
+  bool has_die_area = false;
+  int die_area[4] = {0, 0, 0, 0};
+  std::string_view divider_char;
+  std::string_view bus_bit_char;
+  std::string_view design_name;
+  std::vector<DefRowRecord> rows;
+  std::vector<DefTrackRecord> tracks;
+  std::vector<DefTrackRecord> gcell_grids;
+};
+
+static bool TryReadDefLiteral(DefTokenizer &tokenizer, const char *literal) {
+  std::string_view token;
+  return tokenizer.Next(token) && token == literal;
+}
+
+static bool TryReadDefInt(DefTokenizer &tokenizer, int &value) {
+  std::string_view token;
+  return tokenizer.Next(token) && TryDefTokenToInt(token, value);
+}
+
+static bool TryReadDefPoint(DefTokenizer &tokenizer, int &x, int &y) {
+  return TryReadDefLiteral(tokenizer, "(")
+      && TryReadDefInt(tokenizer, x)
+      && TryReadDefInt(tokenizer, y)
+      && TryReadDefLiteral(tokenizer, ")");
+}
+
+static bool TryReadDefXYDirection(
+    DefTokenizer &tokenizer,
+    XYDirection &direction
+) {
+  std::string_view token;
+  if (!tokenizer.Next(token)) return false;
+  if (token == "X") {
+    direction = XYDirection::X;
+  } else if (token == "Y") {
+    direction = XYDirection::Y;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// TRACKS and GCELLGRID share the "X|Y start DO num STEP step" part
+static bool TryReadDefTrackPattern(
+    DefTokenizer &tokenizer,
+    DefTrackRecord &track
+) {
+  return TryReadDefXYDirection(tokenizer, track.direction)
+      && TryReadDefInt(tokenizer, track.start)
+      && TryReadDefLiteral(tokenizer, "DO")
+      && TryReadDefInt(tokenizer, track.num)
+      && TryReadDefLiteral(tokenizer, "STEP")
+      && TryReadDefInt(tokenizer, track.step);
+}
+
+/****
+ * @brief Parses one statement outside of COMPONENTS, PINS, NETS and
+ * SPECIALNETS. Only the plain forms of the statements written by common
+ * placers and routers are supported, i.e., VERSION, DIVIDERCHAR, BUSBITCHARS,
+ * DESIGN, UNITS, DIEAREA with two points, ROW with DO/STEP, TRACKS without
+ * masks, GCELLGRID, and END DESIGN.
+ *
+ * @param tokenizer: the tokenizer positioned at the beginning of a statement
+ * @param keyword: the first token of the statement, already consumed
+ * @param header: the record to store the statement
+ * @return false if the statement is not supported
+ */
+static bool TryParseDefHeaderStatement(
+    DefTokenizer &tokenizer,
+    std::string_view keyword,
+    DefHeaderRecord &header
+) {
+  std::string_view token;
+  if (keyword == "VERSION") {
+    header.has_version = tokenizer.Next(token)
+        && TryDefTokenToDouble(token, header.version);
+    return header.has_version && TryReadDefLiteral(tokenizer, ";");
+  }
+  if (keyword == "DIVIDERCHAR") {
+    return tokenizer.Next(header.divider_char)
+        && TryReadDefLiteral(tokenizer, ";");
+  }
+  if (keyword == "BUSBITCHARS") {
+    return tokenizer.Next(header.bus_bit_char)
+        && TryReadDefLiteral(tokenizer, ";");
+  }
+  if (keyword == "DESIGN") {
+    return tokenizer.Next(header.design_name)
+        && TryReadDefLiteral(tokenizer, ";");
+  }
+  if (keyword == "UNITS") {
+    header.has_units = TryReadDefLiteral(tokenizer, "DISTANCE")
+        && TryReadDefLiteral(tokenizer, "MICRONS")
+        && tokenizer.Next(token)
+        && TryDefTokenToDouble(token, header.units);
+    return header.has_units && TryReadDefLiteral(tokenizer, ";");
+  }
+  if (keyword == "DIEAREA") {
+    header.has_die_area = TryReadDefPoint(
+        tokenizer, header.die_area[0], header.die_area[1]
+    ) && TryReadDefPoint(
+        tokenizer, header.die_area[2], header.die_area[3]
+    );
+    return header.has_die_area && TryReadDefLiteral(tokenizer, ";");
+  }
+  if (keyword == "ROW") {
+    DefRowRecord row;
+    bool is_supported = tokenizer.Next(row.name)
+        && tokenizer.Next(row.site_name)
+        && TryReadDefInt(tokenizer, row.orig_x)
+        && TryReadDefInt(tokenizer, row.orig_y)
+        && tokenizer.Next(row.orient)
+        && TryReadDefLiteral(tokenizer, "DO")
+        && TryReadDefInt(tokenizer, row.num_x)
+        && TryReadDefLiteral(tokenizer, "BY")
+        && TryReadDefInt(tokenizer, row.num_y)
+        && TryReadDefLiteral(tokenizer, "STEP")
+        && TryReadDefInt(tokenizer, row.step_x)
+        && TryReadDefInt(tokenizer, row.step_y)
+        && TryReadDefLiteral(tokenizer, ";");
+    if (is_supported) {
+      header.rows.push_back(row);
+    }
+    return is_supported;
+  }
+  if (keyword == "TRACKS") {
+    DefTrackRecord track;
+    if (!TryReadDefTrackPattern(tokenizer, track)) return false;
+    if (!tokenizer.Next(token)) return false;
+    if (token == "LAYER") {
+      while (tokenizer.Next(token) && token != ";") {
+        track.layer_names.push_back(token);
+      }
+    }
+    if (token != ";") return false;
+    header.tracks.push_back(std::move(track));
+    return true;
+  }
+  if (keyword == "GCELLGRID") {
+    DefTrackRecord grid;
+    bool is_supported = TryReadDefTrackPattern(tokenizer, grid)
+        && TryReadDefLiteral(tokenizer, ";");
+    if (is_supported) {
+      header.gcell_grids.push_back(grid);
+    }
+    return is_supported;
+  }
+  return false;
+}
+
+/****
+ * @brief Parses the DEF text outside of COMPONENTS, PINS, NETS and SPECIALNETS
+ * in place.
+ *
+ * @param segments: the text pieces between these sections, in file order
+ * @param header: the record to store the result
+ * @return false if any statement is not supported, then the Si2 parser
+ * should be used for these pieces
+ */
+static bool TryParseDefHeader(
+    std::vector<std::string_view> const &segments,
+    DefHeaderRecord &header
+) {
+  for (auto &segment: segments) {
+    DefTokenizer tokenizer(segment.data(), segment.data() + segment.size());
+    std::string_view keyword;
+    while (tokenizer.Next(keyword)) {
+      if (keyword == "END") {
+        return TryReadDefLiteral(tokenizer, "DESIGN");
+      }
+      if (!TryParseDefHeaderStatement(tokenizer, keyword, header)) {
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+static void AddDefHeader(PhyDB *phy_db_ptr, DefHeaderRecord const &header) {
+  if (header.has_version) {
+    phy_db_ptr->SetDefVersion(header.version);
+  }
+  if (!header.divider_char.empty()) {
+    phy_db_ptr->SetDefDividerChar(std::string(header.divider_char));
+  }
+  if (!header.bus_bit_char.empty()) {
+    phy_db_ptr->SetDefBusBitChar(std::string(header.bus_bit_char));
+  }
+  if (!header.design_name.empty()) {
+    phy_db_ptr->SetDefName(std::string(header.design_name));
+  }
+  if (header.has_units) {
+    phy_db_ptr->SetUnitsDistanceMicrons(static_cast<int>(header.units));
+  }
+  if (header.has_die_area) {
+    phy_db_ptr->SetDieArea(
+        header.die_area[0],
+        header.die_area[1],
+        header.die_area[2],
+        header.die_area[3]
+    );
+  }
+  for (auto &row: header.rows) {
+    phy_db_ptr->AddRow(
+        std::string(row.name),
+        std::string(row.site_name),
+        std::string(row.orient),
+        row.orig_x,
+        row.orig_y,
+        row.num_x,
+        row.num_y,
+        row.step_x,
+        row.step_y
+    );
+  }
+  for (auto &track: header.tracks) {
+    std::vector<std::string> layer_names(
+        track.layer_names.begin(),
+        track.layer_names.end()
+    );
+    phy_db_ptr->AddTrack(
+        track.direction,
+        track.start,
+        track.num,
+        track.step,
+        layer_names
+    );
+  }
+  for (auto &grid: header.gcell_grids) {
+    phy_db_ptr->AddGcellGrid(grid.direction, grid.start, grid.num, grid.step);
+  }
+}
+
+/****
+ * @brief The whole text of a DEF file. A plain file is memory-mapped, and a
+ * gzip or zstd file is decompressed into memory.
+ */
+class DefText {
+ public:
+  explicit DefText(std::string const &def_file_name) {
+    if (GetFileCompression(def_file_name) == FileCompression::NONE) {
+      mapped_file_ = std::make_unique<MappedFile>(def_file_name);
+      begin_ = mapped_file_->Begin();
+      end_ = mapped_file_->End();
+    } else {
+      decompressed_content_ = ReadWholeFile(def_file_name);
+      begin_ = decompressed_content_.data();
+      end_ = begin_ + decompressed_content_.size();
+    }
+  }
+  const char *Begin() const { return begin_; }
+  const char *End() const { return end_; }
+ private:
+  std::unique_ptr<MappedFile> mapped_file_;
+  std::string decompressed_content_;
+  const char *begin_ = nullptr;
+  const char *end_ = nullptr;
+};
+
+/****
+ * @brief Splits sections into chunks and parses all chunks concurrently.
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database
+ * @param sections: sections to parse, all of them are in-house sections
+ * @param mask: DEF sections to load, only kDefNetWiring matters here
+ * @param num_threads: the number of threads
+ * @return chunk results in file order
+ */
+static std::vector<DefChunkResult> ParseDefSections(
+    PhyDB *phy_db_ptr,
+    std::vector<DefSection> const &sections,
+    DefSectionMask mask,
+    int num_threads
+) {
+  // small sections are not worth splitting
+  constexpr std::size_t kMinChunkSize = 1 << 16;
+  std::vector<DefChunk> chunks;
+  for (auto &section: sections) {
+    std::size_t length = section.body_end - section.body_begin;
+    int num_chunks = static_cast<int>(std::min<std::size_t>(
+        4 * num_threads, length / kMinChunkSize + 1
+    ));
+    SplitDefSection(section, num_chunks, chunks);
+  }
+
+  int num_chunks = static_cast<int>(chunks.size());
+  std::vector<DefChunkResult> results(num_chunks);
+  ParallelFor(num_chunks, num_threads, [&](int i) {
+    ParseDefChunk(phy_db_ptr, chunks[i], mask, results[i]);
+  });
+  return results;
+}
+
+static void AddDefSNets(
+    PhyDB *phy_db_ptr,
+    std::vector<DefChunkResult> &results
+) {
+  for (auto &result: results) {
+    for (auto &snet: result.snets) {
+      SNet *snet_ptr = phy_db_ptr->AddSNet(snet.name, StrToSignalUse(snet.use));
+      // the arenas differ, so this copies the geometry into the design arena
+      snet_ptr->GetPolygonsRef() = std::move(snet.polygons);
+      snet_ptr->GetPathsRef() = std::move(snet.paths);
+    }
+    result.snets.clear();
+  }
+}
+
+/****
+ * @brief Loads a section skipped by ParallelReadDef() in lazy mode, and
+ * parses only its text.
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database
+ * @param def_file_name: the DEF file name
+ * @param type: the section type, SPECIALNETS or BLOCKAGES
+ * @param begin: the section keyword
+ * @param end: the end of the END line of the section
+ * @param num_threads: the number of threads
+ */
+static void LoadLazyDefSection(
+    PhyDB *phy_db_ptr,
+    std::string const &def_file_name,
+    DefSectionType type,
+    const char *begin,
+    const char *end,
+    int num_threads
+) {
+  const char *context = DefSectionName(type);
+  std::vector<DefSection> sections = FindDefSections(begin, end);
+  PhyDBExpects(
+      sections.size() == 1 && sections[0].type == type,
+      "DEF file is changed after it is read, cannot load " << context
+          << " lazily: " << def_file_name
+  );
+
+  if (IsInHouseDefSection(type)) {
+    std::vector<DefChunkResult> results = ParseDefSections(
+        phy_db_ptr,
+        sections,
+        kDefAllSections,
+        num_threads
+    );
+    AddDefSNets(phy_db_ptr, results);
+    return;
+  }
+
+  // the Si2 parser needs the header statements which affect the syntax
+  std::string text;
+  if (phy_db_ptr->GetDefVersion() > 0) {
+    text += "VERSION " + std::to_string(phy_db_ptr->GetDefVersion()) + " ;\n";
+  }
+  if (!phy_db_ptr->GetDefDividerChar().empty()) {
+    text += "DIVIDERCHAR \"" + phy_db_ptr->GetDefDividerChar() + "\" ;\n";
+  }
+  if (!phy_db_ptr->GetDefBusBitChar().empty()) {
+    text += "BUSBITCHARS \"" + phy_db_ptr->GetDefBusBitChar() + "\" ;\n";
+  }
+  text.append(begin, end);
+  text += "\nEND DESIGN\n";
+  FILE *f = fmemopen(text.data(), text.size(), "r");
+  PhyDBExpects(f != nullptr, "Cannot create an in-memory stream for DEF");
+  Si2ReadDefFromStream(phy_db_ptr, f, def_file_name, DefSectionBit(type));
+  fclose(f);
+}
+
+/****
+ * @brief Loads a DEF file using multiple threads. COMPONENTS, PINS, NETS and
+ * SPECIALNETS are parsed concurrently, and the result is the same as
+ * Si2ReadDef(), including the ids of components, IO pins, nets and special nets.
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database
+ * @param def_file_name: the DEF file name
+ * @param num_threads: the number of threads, non-positive means all cores
+ * @param sections: DEF sections to load, the others are skipped
+ * @param lazy_sections: sections in kDefLazySections which are loaded on the
+ * first access instead. A plain file must not be changed before that, the
+ * text of these sections in a compressed file is kept in memory.
+ */
+void ParallelReadDef(
+    PhyDB *phy_db_ptr,
+    std::string const &def_file_name,
+    int num_threads,
+    DefSectionMask sections,
+    DefSectionMask lazy_sections
+) {
+  num_threads = ResolveNumThreads(num_threads);
+  lazy_sections &= sections & kDefLazySections;
+
+  bool is_compressed =
+      GetFileCompression(def_file_name) != FileCompression::NONE;
+  DefText def_text(def_file_name);
+  const char *begin = def_text.Begin();
+  const char *end = def_text.End();
+
+  // in-house sections and skipped sections are cut out of the text, requested
+  // BLOCKAGES and VIAS stay there for the Si2 parser
+  std::vector<DefSection> sections_to_parse;
+  std::vector<std::string_view> segments;
+  const char *segment_begin = begin;
+  for (auto &section: FindDefSections(begin, end)) {
+    DefSectionMask bit = DefSectionBit(section.type);
+    bool is_loaded_now = (sections & bit) && !(lazy_sections & bit);
+    if (is_loaded_now && !IsInHouseDefSection(section.type)) continue;
+    if (is_loaded_now) {
+      sections_to_parse.push_back(section);
+    } else if (lazy_sections & bit) {
+      DefSectionType type = section.type;
+      std::function<void()> loader;
+      if (is_compressed) {
+        // decompressing the whole file again would cost more than keeping
+        // the text of this section
+        auto text = std::make_shared<std::string>(section.begin, section.end);
+        loader = [=]() {
+          LoadLazyDefSection(
+              phy_db_ptr,
+              def_file_name,
+              type,
+              text->data(),
+              text->data() + text->size(),
+              num_threads
+          );
+        };
+      } else {
+        // a plain file is mapped again, only the offsets are kept
+        std::size_t begin_offset = section.begin - begin;
+        std::size_t end_offset = section.end - begin;
+        loader = [=]() {
+          DefText lazy_text(def_file_name);
+          PhyDBExpects(
+              end_offset <= static_cast<std::size_t>(
+                  lazy_text.End() - lazy_text.Begin()),
+              "DEF file is changed after it is read, cannot load "
+                  << DefSectionName(type) << " lazily: " << def_file_name
+          );
+          LoadLazyDefSection(
+              phy_db_ptr,
+              def_file_name,
+              type,
+              lazy_text.Begin() + begin_offset,
+              lazy_text.Begin() + end_offset,
+              num_threads
+          );
+        };
+      }
+      if (type == DefSectionType::SPECIALNETS) {
+        phy_db_ptr->GetDesignPtr()->SetLazySNetLoader(loader);
+      } else {
+        phy_db_ptr->GetDesignPtr()->SetLazyBlockageLoader(loader);
+      }
+    }
+    segments.emplace_back(segment_begin, section.begin - segment_begin);
+    segment_begin = section.end;
+  }
+  segments.emplace_back(segment_begin, end - segment_begin);
+
+  std::vector<DefChunkResult> results = ParseDefSections(
+      phy_db_ptr,
+      sections_to_parse,
+      sections,
+      num_threads
+  );
+  int num_chunks = static_cast<int>(results.size());
+
+  for (auto &section: sections_to_parse) {
+    switch (section.type) {
+      case DefSectionType::COMPONENTS: {
+        phy_db_ptr->SetComponentCount(section.count);
+        break;
+      }
+      case DefSectionType::PINS: {
+        phy_db_ptr->SetIoPinCount(section.count);
+        break;
+      }
+      case DefSectionType::NETS: {
+        phy_db_ptr->SetNetCount(section.count);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+
+  // merge in the order of chunks, which is the order of the file
+  for (auto &result: results) {
+    for (auto &component: result.components) {
+      phy_db_ptr->GetDesignPtr()->AddComponent(
+          component.name,
+          component.macro_id,
+          component.place_status,
+          component.llx,
+          component.lly,
+          component.orient,
+          component.source
+      );
+    }
+    result.components.clear();
+  }
+
+  for (auto &result: results) {
+    for (auto &iopin: result.iopins) {
+      IOPin *io_pin_ptr = phy_db_ptr->AddIoPin(
+          iopin.name,
+          StrToSignalDirection(iopin.direction),
+          StrToSignalUse(iopin.use)
+      );
+      io_pin_ptr->SetPlacement(
+          iopin.place_status,
+          iopin.x,
+          iopin.y,
+          iopin.orient
+      );
+      for (auto &shape: iopin.shapes) {
+        io_pin_ptr->SetShape(
+            shape.layer_name,
+            shape.lx,
+            shape.ly,
+            shape.ux,
+            shape.uy
+        );
+        io_pin_ptr->SetLayerId(
+            phy_db_ptr->GetTechPtr()->GetLayerId(shape.layer_name)
+        );
+      }
+    }
+    result.iopins.clear();
+  }
+
+  Design *design_ptr = phy_db_ptr->GetDesignPtr();
+  ParallelFor(num_chunks, num_threads, [&](int i) {
+    ResolveDefNetPins(*design_ptr, results[i].nets);
+  });
+  for (auto &result: results) {
+    int net_id_offset = static_cast<int>(design_ptr->GetNetsRef().size());
+    design_ptr->GetNetWiresRef().Append(result.net_wires, net_id_offset);
+    result.net_wires.Clear();
+    for (auto &net: result.nets) {
+      phy_db_ptr->AddNet(net.name);
+      int net_id = static_cast<int>(design_ptr->GetNetsRef().size()) - 1;
+      for (auto &pin: net.pins) {
+        if (pin.IsComponentPin()) {
+          design_ptr->AddCompPinToNet(pin.InstanceId(), pin.PinId(), net_id);
+        } else {
+          design_ptr->AddIoPinToNet(pin.PinId(), net_id);
+        }
+      }
+    }
+    result.nets.clear();
+  }
+
+  AddDefSNets(phy_db_ptr, results);
+
+  DefHeaderRecord header;
+  if (TryParseDefHeader(segments, header)) {
+    AddDefHeader(phy_db_ptr, header);
+    return;
+  }
+
+  // statements not supported by the in-house parser go to the Si2 parser
+  std::string residual;
+  for (auto &segment: segments) {
+    residual.append(segment);
+  }
+  FILE *f = fmemopen(residual.data(), residual.size(), "r");
+  PhyDBExpects(f != nullptr, "Cannot create an in-memory stream for DEF");
+  Si2ReadDefFromStream(
+      phy_db_ptr,
+      f,
+      def_file_name,
+      sections & ~lazy_sections
+  );
+  fclose(f);
+}
+
+}
@@ -0,0 +1,485 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "paralleldefwriter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+#include "phydb/common/compressedfile.h"
+#include "phydb/common/helper.h"
+#include "phydb/common/logging.h"
+
+namespace phydb {
+
+/****
+ * Keywords of enum values, converted once instead of once per object.
+ */
+struct DefKeywords {
+  std::string orients[8];
+  std::string place_statuses[4];
+  std::string sources[4];
+  std::string directions[5];
+  std::string uses[8];
+
+  DefKeywords() {
+    for (int i = 0; i < 8; ++i) {
+      orients[i] = CompOrientStr(static_cast<CompOrient>(i));
+      uses[i] = SignalUseStr(static_cast<SignalUse>(i));
+    }
+    for (int i = 0; i < 4; ++i) {
+      place_statuses[i] = PlaceStatusStr(static_cast<PlaceStatus>(i));
+      sources[i] = CompSourceStr(static_cast<CompSource>(i));
+    }
+    for (int i = 0; i < 5; ++i) {
+      directions[i] = SignalDirectionStr(static_cast<SignalDirection>(i));
+    }
+  }
+  std::string const &Orient(CompOrient orient) const {
+    return orients[static_cast<int>(orient)];
+  }
+  std::string const &Status(PlaceStatus status) const {
+    return place_statuses[static_cast<int>(status)];
+  }
+  std::string const &Source(CompSource source) const {
+    return sources[static_cast<int>(source)];
+  }
+  std::string const &Direction(SignalDirection direction) const {
+    return directions[static_cast<int>(direction)];
+  }
+  std::string const &Use(SignalUse use) const {
+    return uses[static_cast<int>(use)];
+  }
+};
+
+/****
+ * A text buffer with cheap appends of DEF tokens.
+ */
+class DefBuffer {
+ public:
+  std::string &Str() { return str_; }
+
+  DefBuffer &operator<<(std::string_view text) {
+    str_.append(text.data(), text.size());
+    return *this;
+  }
+  DefBuffer &operator<<(char c) {
+    str_.push_back(c);
+    return *this;
+  }
+  DefBuffer &operator<<(int value) {
+    char digits[16];
+    auto res = std::to_chars(digits, digits + sizeof(digits), value);
+    str_.append(digits, res.ptr - digits);
+    return *this;
+  }
+  DefBuffer &operator<<(double value) {
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%.11g", value);
+    str_.append(digits, length);
+    return *this;
+  }
+  DefBuffer &Point(int x, int y) {
+    return *this << "( " << x << ' ' << y << " )";
+  }
+
+ private:
+  std::string str_;
+};
+
+/****
+ * A range [begin, end) of objects in a DEF section, formatted by one task.
+ */
+struct DefWriteChunk {
+  int section;
+  int begin;
+  int end;
+};
+
+static void FormatDefHeader(PhyDB *phy_db_ptr, DefBuffer &buffer) {
+  Design &design = phy_db_ptr->design();
+  int version = static_cast<int>(design.GetVersion() * 10 + 0.5);
+  buffer << "VERSION " << version / 10 << '.' << version % 10 << " ;\n\n";
+  buffer << "DIVIDERCHAR \"" << design.GetDividerChar() << "\" ;\n\n";
+  buffer << "BUSBITCHARS \"" << design.GetBusBitChar() << "\" ;\n\n";
+  buffer << "DESIGN " << design.GetName() << " ;\n\n";
+  buffer << "UNITS DISTANCE MICRONS " << design.GetUnitsDistanceMicrons()
+         << " ;\n\n";
+  Rect2D<int> die_area = design.GetDieArea();
+  buffer << "DIEAREA ";
+  buffer.Point(die_area.LLX(), die_area.LLY()) << ' ';
+  buffer.Point(die_area.URX(), die_area.URY()) << " ;\n\n";
+
+  auto &sites = phy_db_ptr->GetSitesRef();
+  for (auto &row : design.GetRowVec()) {
+    buffer << "ROW " << row.GetName() << ' '
+           << sites[row.GetSiteId()].GetName() << ' '
+           << row.GetOriginX() << ' ' << row.GetOriginY() << ' '
+           << CompOrientStr(row.GetOrient())
+           << " DO " << row.GetNumX() << " BY " << row.GetNumY()
+           << " STEP " << row.GetStepX() << ' ' << row.GetStepY() << " ;\n";
+  }
+  if (!design.GetRowVec().empty()) buffer << '\n';
+
+  for (auto &track : design.GetTracksRef()) {
+    buffer << "TRACKS " << XYDirectionStr(track.GetDirection()) << ' '
+           << track.GetStart() << " DO " << track.GetNTracks()
+           << " STEP " << track.GetStep();
+    if (!track.GetLayerNames().empty()) {
+      buffer << " LAYER";
+      for (auto &layer_name : track.GetLayerNames()) {
+        buffer << ' ' << layer_name;
+      }
+    }
+    buffer << " ;\n";
+  }
+  if (!design.GetTracksRef().empty()) buffer << '\n';
+
+  for (auto &grid : design.GetGcellGridsRef()) {
+    buffer << "GCELLGRID " << XYDirectionStr(grid.GetDirection()) << ' '
+           << grid.GetStart() << " DO " << grid.GetNBoundaries()
+           << " STEP " << grid.GetStep() << " ;\n";
+  }
+  if (!design.GetGcellGridsRef().empty()) buffer << '\n';
+}
+
+static void FormatDefComponent(
+    Component &comp,
+    std::vector<Macro> &macros,
+    DefKeywords const &keywords,
+    DefBuffer &buffer
+) {
+  buffer << "   - " << comp.GetName() << ' '
+         << macros[comp.GetMacroId()].GetName()
+         << "\n      + SOURCE " << keywords.Source(comp.GetSource())
+         << "\n      + " << keywords.Status(comp.GetPlacementStatus());
+  if (comp.GetPlacementStatus() != PlaceStatus::UNPLACED) {
+    Point2D<int> location = comp.GetLocation();
+    buffer << ' ';
+    buffer.Point(location.x, location.y);
+    buffer << ' ' << keywords.Orient(comp.GetOrientation());
+  }
+  buffer << " ;\n";
+}
+
+static void FormatDefIoPin(
+    Design &design,
+    IOPin &iopin,
+    DefKeywords const &keywords,
+    DefBuffer &buffer
+) {
+  // NET is required in DEF, a dangling IO pin uses its own name
+  int net_id = iopin.GetNetId();
+  buffer << "   - " << iopin.GetName() << " + NET "
+         << (net_id >= 0 ? design.GetNetsRef()[net_id].GetName()
+                         : iopin.GetName())
+         << "\n      + DIRECTION " << keywords.Direction(iopin.GetDirection())
+         << "\n      + USE " << keywords.Use(iopin.GetUse());
+  if (!iopin.GetLayerName().empty()) {
+    Rect2D<int> rect = iopin.GetRect();
+    buffer << "\n      + LAYER " << iopin.GetLayerName() << ' ';
+    buffer.Point(rect.LLX(), rect.LLY()) << ' ';
+    buffer.Point(rect.URX(), rect.URY());
+  }
+  if (iopin.GetPlacementStatus() != PlaceStatus::UNPLACED) {
+    Point2D<int> location = iopin.GetLocation();
+    buffer << "\n      + " << keywords.Status(iopin.GetPlacementStatus())
+           << ' ';
+    buffer.Point(location.x, location.y);
+    buffer << ' ' << keywords.Orient(iopin.GetOrientation());
+  }
+  buffer << " ;\n";
+}
+
+static void FormatDefNet(
+    Design &design,
+    std::vector<Macro> &macros,
+    std::vector<Layer> &layers,
+    int net_id,
+    DefBuffer &buffer
+) {
+  Net &net = design.GetNetsRef()[net_id];
+  auto &components = design.GetComponentsRef();
+  auto &iopins = design.GetIoPinsRef();
+  buffer << "   - " << net.GetName() << "\n     ";
+  // names are read from the components and macros directly, no lookup
+  int count = 0;
+  for (int iopin_id : net.GetIoPinIdsRef()) {
+    buffer << " ( PIN " << iopins[iopin_id].GetName() << " )";
+    if (++count % 4 == 0) buffer << "\n     ";
+  }
+  for (auto &pin : net.GetPinsRef()) {
+    Component &comp = components[pin.InstanceId()];
+    buffer << " ( " << comp.GetName() << ' '
+           << macros[comp.GetMacroId()].GetPinsRef()[pin.PinId()].GetName()
+           << " )";
+    if (++count % 4 == 0) buffer << "\n     ";
+  }
+
+  // consecutive wires are merged into one path when possible
+  NetWireStore &net_wires = design.GetNetWiresRef();
+  bool has_path = false;
+  int end = net_wires.GetNetEnd(net_id);
+  for (int i = net_wires.GetNetBegin(net_id); i < end; ++i) {
+    int layer_id = net_wires.GetLayerId(i);
+    if (layer_id < 0) continue;
+    if (!net_wires.IsPathContinued(i)) {
+      buffer << (has_path ? "\n      NEW " : "\n      + ROUTED ")
+             << layers[layer_id].GetName() << ' ';
+      buffer.Point(net_wires.GetX0(i), net_wires.GetY0(i));
+      has_path = true;
+    }
+    if (net_wires.IsVia(i)) {
+      buffer << ' ' << net_wires.GetViaName(net_wires.GetViaId(i));
+    } else {
+      buffer << ' ';
+      buffer.Point(net_wires.GetX1(i), net_wires.GetY1(i));
+    }
+  }
+  buffer << " ;\n";
+}
+
+static void FormatDefSNet(
+    SNet &snet,
+    DefKeywords const &keywords,
+    DefBuffer &buffer
+) {
+  std::string name = snet.GetName();
+  buffer << "   - " << name << " ( * " << name << " )"
+         << "\n      + USE " << keywords.Use(snet.GetUse());
+  for (auto &polygon : snet.GetPolygonsRef()) {
+    buffer << "\n      + POLYGON " << polygon.GetLayerName();
+    for (auto &point : polygon.GetRoutingPointsRef()) {
+      buffer << ' ';
+      buffer.Point(point.x, point.y);
+    }
+  }
+  auto &paths = snet.GetPathsRef();
+  for (size_t i = 0; i < paths.size(); ++i) {
+    Path &path = paths[i];
+    std::string shape = path.GetShape();
+    buffer << (i == 0 ? "\n      + ROUTED " : "\n      NEW ")
+           << path.GetLayerName() << ' ' << path.GetWidth()
+           << " + SHAPE " << (shape.empty() ? "STRIPE" : shape);
+    for (auto &point : path.GetRoutingPointsRef()) {
+      buffer << " ( " << point.x << ' ' << point.y;
+      if (point.z != -1) buffer << ' ' << point.z;
+      buffer << " )";
+    }
+    std::string via_name = path.GetViaName();
+    if (!via_name.empty()) {
+      buffer << ' ' << via_name;
+      if (path.IsViaArray()) {
+        buffer << " DO " << path.GetViaNumX() << " BY " << path.GetViaNumY()
+               << " STEP " << path.GetViaStepX() << ' '
+               << path.GetViaStepY();
+      }
+    }
+  }
+  buffer << " ;\n";
+}
+
+static void FormatDefBlockages(Design &design, DefBuffer &buffer) {
+  auto &blockages = design.GetBlockagesRef();
+  if (blockages.empty()) return;
+  buffer << "BLOCKAGES " << static_cast<int>(blockages.size()) << " ;\n";
+  for (auto &blockage : blockages) {
+    if (blockage.GetLayer() != nullptr) {
+      buffer << "   - LAYER " << blockage.GetLayer()->GetName();
+      if (blockage.IsSlots()) {
+        buffer << "\n      + SLOTS";
+      } else if (blockage.IsFills()) {
+        buffer << "\n      + FILLS";
+      }
+      if (blockage.IsPushdown()) buffer << "\n      + PUSHDOWN";
+      if (blockage.IsExceptpgnet()) buffer << "\n      + EXCEPTPGNET";
+      if (blockage.GetComponent() != nullptr) {
+        buffer << "\n      + COMPONENT " << blockage.GetComponent()->GetName();
+      }
+      if (blockage.GetMaskNum() > 0) {
+        buffer << "\n      + MASK " << blockage.GetMaskNum();
+      }
+      if (blockage.GetSpacing() >= 0) {
+        buffer << "\n      + SPACING " << blockage.GetSpacing();
+      } else if (blockage.GetDesignRuleWidth() >= 0) {
+        buffer << "\n      + DESIGNRULEWIDTH "
+               << blockage.GetDesignRuleWidth();
+      }
+    } else if (blockage.IsPlacement()) {
+      buffer << "   - PLACEMENT";
+      if (blockage.IsSoft()) {
+        buffer << "\n      + SOFT";
+      } else if (blockage.GetMaxPlacementDensity() > 0) {
+        buffer << "\n      + PARTIAL " << blockage.GetMaxPlacementDensity();
+      }
+      if (blockage.IsPushdown()) buffer << "\n      + PUSHDOWN";
+      if (blockage.GetComponent() != nullptr) {
+        buffer << "\n      + COMPONENT " << blockage.GetComponent()->GetName();
+      }
+    } else {
+      PhyDBExpects(false, "blockage has no layer and placement?");
+    }
+    for (auto &rect : blockage.GetRectsRef()) {
+      buffer << "\n      RECT ";
+      buffer.Point(rect.LLX(), rect.LLY()) << ' ';
+      buffer.Point(rect.URX(), rect.URY());
+    }
+    for (auto &polygon : blockage.GetPolygonRef()) {
+      buffer << "\n      POLYGON";
+      for (auto &point : polygon.GetPointsRef()) {
+        buffer << ' ';
+        buffer.Point(point.x, point.y);
+      }
+    }
+    buffer << " ;\n";
+  }
+  buffer << "END BLOCKAGES\n\n";
+}
+
+/****
+ * @brief Writes a DEF file using multiple threads. COMPONENTS, PINS,
+ * SPECIALNETS and NETS are split into chunks which are formatted concurrently
+ * into separate buffers, then all buffers are written to the file in order.
+ * Connection names are read from components and macros directly, and routed
+ * wires of nets are written from the wire store.
+ *
+ * The statements are the same as those written by Si2WriteDef(), so the file
+ * can be loaded by both the Si2 parser and ParallelReadDef().
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database
+ * @param def_file_name: the DEF file name
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void ParallelWriteDef(
+    PhyDB *phy_db_ptr,
+    std::string const &def_file_name,
+    int num_threads
+) {
+  CompressedFile def_file(def_file_name, "w");
+  FILE *f = def_file.Stream();
+  PhyDBExpects(f != nullptr, "Couldn't open Write def file");
+  std::cout << "Writing def to " << def_file_name << std::endl;
+
+  Design &design = phy_db_ptr->design();
+  auto &macros = phy_db_ptr->GetTechPtr()->GetMacrosRef();
+  auto &layers = phy_db_ptr->GetTechPtr()->GetLayersRef();
+  DefKeywords keywords;
+  // built before formatting nets concurrently
+  design.GetNetWiresRef().BuildNetIndex();
+
+  enum Section { COMPONENTS = 0, PINS = 1, SPECIALNETS = 2, NETS = 3 };
+  const char *section_names[4] = {"COMPONENTS", "PINS", "SPECIALNETS", "NETS"};
+  int section_sizes[4] = {
+      static_cast<int>(design.GetComponentsRef().size()),
+      static_cast<int>(design.GetIoPinsRef().size()),
+      static_cast<int>(design.GetSNetRef().size()),
+      static_cast<int>(design.GetNetsRef().size())
+  };
+
+  constexpr int kChunkSize = 8192;
+  std::vector<DefWriteChunk> chunks;
+  for (int section = 0; section < 4; ++section) {
+    for (int begin = 0; begin < section_sizes[section]; begin += kChunkSize) {
+      chunks.push_back(
+          DefWriteChunk{
+              section,
+              begin,
+              std::min(begin + kChunkSize, section_sizes[section])
+          }
+      );
+    }
+  }
+
+  std::vector<DefBuffer> buffers(chunks.size());
+  ParallelFor(static_cast<int>(chunks.size()), num_threads, [&](int i) {
+    DefWriteChunk &chunk = chunks[i];
+    DefBuffer &buffer = buffers[i];
+    for (int id = chunk.begin; id < chunk.end; ++id) {
+      switch (chunk.section) {
+        case COMPONENTS: {
+          FormatDefComponent(
+              design.GetComponentsRef()[id], macros, keywords, buffer
+          );
+          break;
+        }
+        case PINS: {
+          FormatDefIoPin(design, design.GetIoPinsRef()[id], keywords, buffer);
+          break;
+        }
+        case SPECIALNETS: {
+          FormatDefSNet(design.GetSNetRef()[id], keywords, buffer);
+          break;
+        }
+        default: {
+          FormatDefNet(design, macros, layers, id, buffer);
+        }
+      }
+    }
+  });
+
+  DefBuffer head;
+  time_t now = time(nullptr);
+  struct tm tstruct = *localtime(&now);
+  char date[80];
+  strftime(date, sizeof(date), "%Y-%m-%d.%X", &tstruct);
+  head << "###########################\n"
+       << "# Written by PhyDB at " << date << "\n"
+       << "###########################\n";
+  FormatDefHeader(phy_db_ptr, head);
+  fwrite(head.Str().data(), 1, head.Str().size(), f);
+
+  size_t next_chunk = 0;
+  for (int section = 0; section < 4; ++section) {
+    DefBuffer section_head;
+    if (section == SPECIALNETS) {
+      FormatDefBlockages(design, section_head);
+      // an empty SPECIALNETS section is omitted, like Si2WriteDef()
+      if (section_sizes[section] == 0) {
+        fwrite(section_head.Str().data(), 1, section_head.Str().size(), f);
+        continue;
+      }
+    }
+    section_head << section_names[section] << ' ' << section_sizes[section]
+                 << " ;\n";
+    fwrite(section_head.Str().data(), 1, section_head.Str().size(), f);
+    while (next_chunk < chunks.size()
+        && chunks[next_chunk].section == section) {
+      std::string &str = buffers[next_chunk].Str();
+      fwrite(str.data(), 1, str.size(), f);
+      std::string().swap(str);
+      ++next_chunk;
+    }
+    DefBuffer section_tail;
+    section_tail << "END " << section_names[section] << "\n\n";
+    fwrite(section_tail.Str().data(), 1, section_tail.Str().size(), f);
+  }
+  const char *tail = "END DESIGN\n";
+  fwrite(tail, 1, strlen(tail), f);
+
+  PhyDBExpects(ferror(f) == 0, "Error writing def file " << def_file_name);
+  PhyDBExpects(def_file.Close(), def_file.GetErrorMessage());
+  std::cout << "def writing completes" << std::endl;
+}
+
+}
@@ -0,0 +1,541 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "parallellefreader.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#include "deftokenizer.h"
+#include "lefdefparser.h"
+#include "snapshot.h"
+#include "phydb/common/compressedfile.h"
+#include "phydb/common/helper.h"
+#include "phydb/common/logging.h"
+#include "phydb/common/mappedfile.h"
+
+namespace phydb {
+
+/****
+ * The macro library reader loads cell library LEF files, which only contain
+ * sites and macros, in the following steps:
+ *   1. each file is parsed by one task, and all tasks run concurrently, LEF
+ *      has the same lexical rules as DEF, so the DEF tokenizer is used;
+ *   2. if a cache directory is given, a file whose content hash has a cache
+ *      entry is loaded from the cache instead, and a parsed file is saved to
+ *      the cache;
+ *   3. libraries are merged into Tech in the order of files, and layer ids
+ *      are resolved at this time, so cache entries do not depend on the
+ *      technology LEF.
+ * A file with anything else (LAYER, VIA, ...) is read by the Si2 parser when
+ * it is its turn to be merged.
+ * ****/
+
+// 64-bit FNV-1a
+static uint64_t HashLefBytes(const char *begin, const char *end) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char *p = begin; p < end; ++p) {
+    hash ^= static_cast<unsigned char>(*p);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static std::string LefCacheFileName(
+    std::string const &cache_dir,
+    uint64_t hash
+) {
+  char hash_str[17];
+  std::snprintf(
+      hash_str,
+      sizeof(hash_str),
+      "%016llx",
+      static_cast<unsigned long long>(hash)
+  );
+  return cache_dir + "/" + hash_str + ".lefcache";
+}
+
+static void SkipLefStatement(DefTokenizer &tokenizer, const char *context) {
+  std::string_view token;
+  do {
+    tokenizer.Expect(token, context);
+  } while (token != ";");
+}
+
+// joins tokens until ';', for example "CORE TIEHIGH" or "OUTPUT TRISTATE"
+static std::string ReadLefWords(DefTokenizer &tokenizer, const char *context) {
+  std::string words;
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  while (token != ";") {
+    if (!words.empty()) words += ' ';
+    words += token;
+    tokenizer.Expect(token, context);
+  }
+  return words;
+}
+
+static double ExpectLefDouble(DefTokenizer &tokenizer, const char *context) {
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  double value = 0;
+  PhyDBExpects(
+      TryDefTokenToDouble(token, value),
+      "Expect a number in LEF " << context << ", get: " << token
+  );
+  return value;
+}
+
+// reads "[MASK n] x1 y1 x2 y2 ;" after RECT
+static void ReadLefRect(
+    DefTokenizer &tokenizer,
+    LayerRect *layer_rect_ptr,
+    const char *context
+) {
+  PhyDBExpects(
+      layer_rect_ptr != nullptr,
+      "RECT without LAYER in LEF " << context
+  );
+  std::string_view token;
+  tokenizer.Peek(token);
+  if (token == "MASK") {
+    tokenizer.Expect(token, context);
+    tokenizer.Expect(token, context);
+  }
+  double x[4];
+  for (double &value: x) {
+    tokenizer.Peek(token);
+    if (token == "(" || token == ")") tokenizer.Expect(token, context);
+    value = ExpectLefDouble(tokenizer, context);
+  }
+  SkipLefStatement(tokenizer, context);
+  layer_rect_ptr->AddRect(
+      std::min(x[0], x[2]),
+      std::min(x[1], x[3]),
+      std::max(x[0], x[2]),
+      std::max(x[1], x[3])
+  );
+}
+
+/****
+ * @brief Parses LAYER and RECT statements until END, other geometries are
+ * not supported and skipped, the same as the Si2 callbacks.
+ *
+ * @param tokenizer: the tokenizer, right after PORT or OBS
+ * @param layer_rects: the list of layer rectangles to append to
+ * @param context: the name used in error messages
+ */
+static void ParseLefGeometries(
+    DefTokenizer &tokenizer,
+    std::vector<LayerRect> &layer_rects,
+    const char *context
+) {
+  LayerRect *layer_rect_ptr = nullptr;
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  while (token != "END") {
+    if (token == "LAYER") {
+      tokenizer.Expect(token, context);
+      layer_rect_ptr = &layer_rects.emplace_back(token);
+      SkipLefStatement(tokenizer, context);
+    } else if (token == "RECT") {
+      ReadLefRect(tokenizer, layer_rect_ptr, context);
+    } else if (token != ";") {
+      SkipLefStatement(tokenizer, context);
+    }
+    tokenizer.Expect(token, context);
+  }
+}
+
+static void ParseLefPin(
+    DefTokenizer &tokenizer,
+    Macro &macro,
+    const char *context
+) {
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  std::string pin_name(token);
+  std::string direction = "INPUT";
+  std::string use = "SIGNAL";
+  std::vector<std::vector<LayerRect>> ports;
+  while (true) {
+    tokenizer.Expect(token, context);
+    if (token == "END") {
+      tokenizer.Expect(token, context);
+      PhyDBExpects(
+          token == pin_name,
+          "Expect END " << pin_name << " in LEF macro " << macro.GetName()
+      );
+      break;
+    } else if (token == "DIRECTION") {
+      direction = ReadLefWords(tokenizer, context);
+    } else if (token == "USE") {
+      use = ReadLefWords(tokenizer, context);
+    } else if (token == "PORT") {
+      ParseLefGeometries(tokenizer, ports.emplace_back(), context);
+    } else {
+      SkipLefStatement(tokenizer, context);
+    }
+  }
+  PhyDBExpects(
+      !ports.empty(),
+      "No physical ports? Macro: " << macro.GetName() << ", pin: " << pin_name
+  );
+
+  Pin *pin_ptr = macro.AddPin(
+      pin_name,
+      StrToSignalDirection(direction),
+      StrToSignalUse(use)
+  );
+  for (auto &port: ports) {
+    for (auto &layer_rect: port) {
+      pin_ptr->GetLayerRectRef().push_back(std::move(layer_rect));
+    }
+  }
+}
+
+/****
+ * @brief Parses a MACRO statement.
+ *
+ * @param tokenizer: the tokenizer, right after MACRO
+ * @param library: the library to add the macro to
+ * @return false if the macro contains any unsupported statement
+ */
+static bool TryParseLefMacro(
+    DefTokenizer &tokenizer,
+    LefMacroLibrary &library
+) {
+  const char *context = "MACRO";
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  Macro &macro = library.macros.emplace_back(std::string(token));
+  bool has_class = false;
+  while (true) {
+    tokenizer.Expect(token, context);
+    if (token == "END") {
+      tokenizer.Expect(token, context);
+      PhyDBExpects(
+          token == macro.GetName(),
+          "Expect END " << macro.GetName() << " in LEF"
+      );
+      break;
+    } else if (token == "CLASS") {
+      macro.SetClass(StrToMacroClass(ReadLefWords(tokenizer, context)));
+      has_class = true;
+    } else if (token == "ORIGIN") {
+      double x = ExpectLefDouble(tokenizer, context);
+      double y = ExpectLefDouble(tokenizer, context);
+      PhyDBExpects(
+          (x == 0) && (y == 0),
+          "Nonzero origin is not supported, macro: " << macro.GetName()
+      );
+      tokenizer.ExpectLiteral(";", context);
+    } else if (token == "SIZE") {
+      double width = ExpectLefDouble(tokenizer, context);
+      tokenizer.ExpectLiteral("BY", context);
+      double height = ExpectLefDouble(tokenizer, context);
+      tokenizer.ExpectLiteral(";", context);
+      macro.SetSize(width, height);
+    } else if (token == "SYMMETRY") {
+      std::string symmetry = " " + ReadLefWords(tokenizer, context) + " ";
+      macro.SetSymmetry(
+          symmetry.find(" X ") != std::string::npos,
+          symmetry.find(" Y ") != std::string::npos,
+          symmetry.find(" R90 ") != std::string::npos
+      );
+    } else if (token == "PIN") {
+      ParseLefPin(tokenizer, macro, context);
+    } else if (token == "OBS") {
+      ParseLefGeometries(
+          tokenizer,
+          macro.GetObs()->GetLayerRectsRef(),
+          context
+      );
+    } else if (token == "FOREIGN" || token == "SITE" || token == "SOURCE"
+        || token == "EEQ" || token == "LEQ" || token == "PROPERTY"
+        || token == "FIXEDMASK" || token == "POWER") {
+      SkipLefStatement(tokenizer, context);
+    } else {
+      return false;
+    }
+  }
+  PhyDBExpects(has_class, "Macro has no class?" << macro.GetName());
+  return true;
+}
+
+static bool TryParseLefSite(
+    DefTokenizer &tokenizer,
+    LefMacroLibrary &library
+) {
+  const char *context = "SITE";
+  std::string_view token;
+  tokenizer.Expect(token, context);
+  std::string site_name(token);
+  std::string class_name;
+  bool has_size = false;
+  double width = 0;
+  double height = 0;
+  std::string symmetry;
+  while (true) {
+    tokenizer.Expect(token, context);
+    if (token == "END") {
+      tokenizer.ExpectLiteral(site_name.c_str(), context);
+      break;
+    } else if (token == "CLASS") {
+      class_name = ReadLefWords(tokenizer, context);
+    } else if (token == "SIZE") {
+      width = ExpectLefDouble(tokenizer, context);
+      tokenizer.ExpectLiteral("BY", context);
+      height = ExpectLefDouble(tokenizer, context);
+      tokenizer.ExpectLiteral(";", context);
+      has_size = true;
+    } else if (token == "SYMMETRY") {
+      symmetry = " " + ReadLefWords(tokenizer, context) + " ";
+    } else {
+      return false;
+    }
+  }
+  PhyDBExpects(has_size, "SITE SIZE information not provided");
+  Site &site = library.sites.emplace_back(
+      site_name,
+      StrToSiteClass(class_name),
+      width,
+      height
+  );
+  site.SetSymmetry(
+      symmetry.find(" X ") != std::string::npos,
+      symmetry.find(" Y ") != std::string::npos,
+      symmetry.find(" R90 ") != std::string::npos
+  );
+  return true;
+}
+
+/****
+ * @brief Parses a cell library LEF file in place.
+ *
+ * @param begin: the beginning of the LEF text
+ * @param end: the end of the LEF text
+ * @param library: the library to store the result
+ * @return false if any statement is not supported, then the Si2 parser
+ * should be used for this file
+ */
+static bool TryParseMacroLef(
+    const char *begin,
+    const char *end,
+    LefMacroLibrary &library
+) {
+  const char *context = "LIBRARY";
+  DefTokenizer tokenizer(begin, end);
+  std::string_view token;
+  while (tokenizer.Next(token)) {
+    if (token == "MACRO") {
+      if (!TryParseLefMacro(tokenizer, library)) return false;
+    } else if (token == "SITE") {
+      if (!TryParseLefSite(tokenizer, library)) return false;
+    } else if (token == "UNITS") {
+      tokenizer.Expect(token, context);
+      while (token != "END") {
+        if (token == "DATABASE") {
+          tokenizer.ExpectLiteral("MICRONS", context);
+          library.database_micron = tokenizer.ExpectInt(context);
+          tokenizer.ExpectLiteral(";", context);
+        } else {
+          SkipLefStatement(tokenizer, context);
+        }
+        tokenizer.Expect(token, context);
+      }
+      tokenizer.ExpectLiteral("UNITS", context);
+    } else if (token == "PROPERTYDEFINITIONS") {
+      tokenizer.Expect(token, context);
+      while (token != "END") {
+        SkipLefStatement(tokenizer, context);
+        tokenizer.Expect(token, context);
+      }
+      tokenizer.ExpectLiteral("PROPERTYDEFINITIONS", context);
+    } else if (token == "MANUFACTURINGGRID") {
+      library.manufacturing_grid = ExpectLefDouble(tokenizer, context);
+      tokenizer.ExpectLiteral(";", context);
+    } else if (token == "VERSION" || token == "BUSBITCHARS"
+        || token == "DIVIDERCHAR" || token == "NAMESCASESENSITIVE"
+        || token == "NOWIREEXTENSIONATPIN") {
+      SkipLefStatement(tokenizer, context);
+    } else if (token == "END") {
+      tokenizer.ExpectLiteral("LIBRARY", context);
+      return true;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Loads one cell library LEF file, from the cache if possible.
+ *
+ * @param lef_file_name: the LEF file name
+ * @param cache_dir: the cache directory, empty means no cache
+ * @param library: the library to store the result
+ */
+static void LoadMacroLef(
+    std::string const &lef_file_name,
+    std::string const &cache_dir,
+    LefMacroLibrary &library
+) {
+  // the key is the hash of the file as it is on disk, so a compressed file
+  // does not need to be decompressed on a cache hit
+  auto mapped_file = std::make_unique<MappedFile>(lef_file_name);
+  std::string cache_file_name;
+  uint64_t file_size = mapped_file->Size();
+  uint64_t file_hash = 0;
+  if (!cache_dir.empty()) {
+    file_hash = HashLefBytes(mapped_file->Begin(), mapped_file->End());
+    cache_file_name = LefCacheFileName(cache_dir, file_hash);
+    bool is_cached = access(cache_file_name.c_str(), R_OK) == 0
+        && Snapshot::LoadMacroLibrary(
+            library,
+            file_hash,
+            file_size,
+            cache_file_name
+        );
+    if (is_cached) return;
+    library = LefMacroLibrary();
+  }
+
+  if (GetFileCompression(lef_file_name) == FileCompression::NONE) {
+    library.is_supported = TryParseMacroLef(
+        mapped_file->Begin(),
+        mapped_file->End(),
+        library
+    );
+  } else {
+    mapped_file.reset();
+    std::string content = ReadWholeFile(lef_file_name);
+    library.is_supported = TryParseMacroLef(
+        content.data(),
+        content.data() + content.size(),
+        library
+    );
+  }
+  if (!library.is_supported) {
+    library = LefMacroLibrary();
+    library.is_supported = false;
+    return;
+  }
+
+  if (!cache_dir.empty()) {
+    // other processes may read the cache at the same time, so the entry is
+    // written to a temporary file first, and renamed when it is complete
+    std::ostringstream tmp_file_name;
+    tmp_file_name << cache_file_name << ".tmp." << getpid() << "."
+                  << std::this_thread::get_id();
+    Snapshot::SaveMacroLibrary(library, file_hash, file_size,
+                               tmp_file_name.str());
+    if (std::rename(tmp_file_name.str().c_str(), cache_file_name.c_str())
+        != 0) {
+      std::remove(tmp_file_name.str().c_str());
+    }
+  }
+}
+
+static void AddMacroLibrary(PhyDB *phy_db_ptr, LefMacroLibrary &library) {
+  Tech *tech_ptr = phy_db_ptr->GetTechPtr();
+  if (library.database_micron > 0) {
+    tech_ptr->SetDatabaseMicron(library.database_micron);
+  }
+  if (library.manufacturing_grid > 0) {
+    tech_ptr->SetManufacturingGrid(library.manufacturing_grid);
+  }
+  for (auto &site: library.sites) {
+    Site *site_ptr = tech_ptr->AddSite(
+        site.GetName(),
+        SiteClassStr(site.GetClass()),
+        site.GetWidth(),
+        site.GetHeight()
+    );
+    Symmetry symmetry = site.GetSymmetry();
+    site_ptr->SetSymmetry(
+        symmetry.GetXSymmetry(),
+        symmetry.GetYSymmetry(),
+        symmetry.GetR90Symmetry()
+    );
+  }
+  for (auto &macro: library.macros) {
+    for (auto &pin: macro.GetPinsRef()) {
+      for (auto &layer_rect: pin.GetLayerRectRef()) {
+        layer_rect.layer_id_ = tech_ptr->GetLayerId(layer_rect.GetLayerName());
+      }
+    }
+    for (auto &layer_rect: macro.GetObs()->GetLayerRectsRef()) {
+      layer_rect.layer_id_ = tech_ptr->GetLayerId(layer_rect.GetLayerName());
+    }
+    tech_ptr->AddMacro(std::move(macro));
+  }
+  library = LefMacroLibrary();
+}
+
+/****
+ * @brief Loads cell library LEF files using multiple threads. The result is
+ * the same as calling Si2ReadLef() for these files one by one.
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database, layers should have
+ * been loaded from the technology LEF
+ * @param lef_file_names: LEF file names
+ * @param num_threads: the number of threads, non-positive means all cores
+ * @param cache_dir: the directory of the parsed library cache, empty means no
+ * cache
+ */
+void ParallelReadMacroLefs(
+    PhyDB *phy_db_ptr,
+    std::vector<std::string> const &lef_file_names,
+    int num_threads,
+    std::string const &cache_dir
+) {
+  std::string usable_cache_dir = cache_dir;
+  if (!cache_dir.empty() && access(cache_dir.c_str(), R_OK | W_OK) != 0) {
+    PhyDBWarns(
+        true,
+        "Cannot access LEF cache directory " << cache_dir
+            << ", LEF files are parsed without cache"
+    );
+    usable_cache_dir.clear();
+  }
+
+  int num_files = static_cast<int>(lef_file_names.size());
+  std::vector<LefMacroLibrary> libraries(num_files);
+  ParallelFor(num_files, num_threads, [&](int i) {
+    LoadMacroLef(lef_file_names[i], usable_cache_dir, libraries[i]);
+  });
+
+  for (int i = 0; i < num_files; ++i) {
+    if (libraries[i].is_supported) {
+      AddMacroLibrary(phy_db_ptr, libraries[i]);
+    } else {
+      Si2ReadLef(phy_db_ptr, lef_file_names[i]);
+    }
+  }
+}
+
+}
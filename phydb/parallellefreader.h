@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_PARALLELLEFREADER_H_
+#define PHYDB_PARALLELLEFREADER_H_
+
+#include <string>
+#include <vector>
+
+#include "phydb.h"
+
+namespace phydb {
+
+/****
+ * @brief Sites and macros parsed from one cell library LEF file, layer ids
+ * in pins and OBS are not resolved until the library is merged into Tech.
+ */
+struct LefMacroLibrary {
+  bool is_supported = true; // false if the file needs the Si2 parser
+  int database_micron = -1;
+  double manufacturing_grid = -1;
+  std::vector<Site> sites;
+  std::vector<Macro> macros;
+};
+
+void ParallelReadMacroLefs(
+    PhyDB *phy_db_ptr,
+    std::vector<std::string> const &lef_file_names,
+    int num_threads,
+    std::string const &cache_dir
+);
+
+}
+
+#endif //PHYDB_PARALLELLEFREADER_H_
@@ -28,6 +28,10 @@
 #include "phydb/common/helper.h"
 #include "phydb/timing/techconfigparser.h"
 #include "lefdefparser.h"
+#include "paralleldefreader.h"
+#include "paralleldefwriter.h"
+#include "parallellefreader.h"
+#include "snapshot.h"
 
 namespace phydb {
 
@@ -113,6 +117,10 @@ Macro *PhyDB::GetMacroPtr(std::string const &macro_name) {
   return tech_.GetMacroPtr(macro_name);
 }
 
+MacroId PhyDB::GetMacroId(std::string const &macro_name) {
+  return tech_.GetMacroId(macro_name);
+}
+
 bool PhyDB::IsLefViaExisting(std::string const &name) {
   return tech_.IsLefViaExisting(name);
 }
@@ -200,7 +208,7 @@ Component *PhyDB::AddComponent(
 ) {
   return design_.AddComponent(
       comp_name,
-      macro_ptr,
+      tech_.GetMacroId(macro_ptr),
       place_status,
       llx,
       lly,
@@ -217,6 +225,14 @@ int PhyDB::GetComponentId(std::string const &comp_name) {
   return design_.GetComponentId(comp_name);
 }
 
+SpatialIndex *PhyDB::BuildSpatialIndex() {
+  return design_.BuildSpatialIndex();
+}
+
+SpatialIndex *PhyDB::GetSpatialIndexPtr() {
+  return design_.GetSpatialIndexPtr();
+}
+
 Track *PhyDB::AddTrack(
     XYDirection direction,
     int start,
@@ -380,8 +396,8 @@ void PhyDB::AddIoPinToNet(
     PhydbPin tmp_pin = timing_api_.ActCompPinPtr2Id(act_io_pin_ptr);
     if (tmp_pin.IsComponentPin()) {
       Component &comp = design_.GetComponentsRef()[tmp_pin.InstanceId()];
-      Macro *tmp_macro_ptr = comp.GetMacro();
-      Pin &pin = tmp_macro_ptr->GetPinsRef()[tmp_pin.PinId()];
+      Macro &tmp_macro = tech_.GetMacro(comp.GetMacroId());
+      Pin &pin = tmp_macro.GetPinsRef()[tmp_pin.PinId()];
       PhyDBExpects(
           false,
           "IO pin, " << io_pin_name
@@ -418,7 +434,7 @@ void PhyDB::AddCompPinToNet(
       "Cannot add a nonexistent component to a net: " << comp_name
   );
   Component *comp_ptr = GetComponentPtr(comp_name);
-  Macro *macro_ptr = comp_ptr->GetMacro();
+  Macro *macro_ptr = &tech_.GetMacro(comp_ptr->GetMacroId());
   PhyDBExpects(
       macro_ptr->IsPinExisting(pin_name),
       "Macro " << macro_ptr->GetName() << " does not contain a pin with name "
@@ -435,8 +451,8 @@ void PhyDB::AddCompPinToNet(
   if (timing_api_.IsActComPinPtrExisting(act_comp_pin_ptr)) {
     PhydbPin tmp_pin = timing_api_.ActCompPinPtr2Id(act_comp_pin_ptr);
     Component &comp = design_.GetComponentsRef()[tmp_pin.InstanceId()];
-    Macro *tmp_macro_ptr = comp.GetMacro();
-    Pin &pin = tmp_macro_ptr->GetPinsRef()[tmp_pin.PinId()];
+    Macro &tmp_macro = tech_.GetMacro(comp.GetMacroId());
+    Pin &pin = tmp_macro.GetPinsRef()[tmp_pin.PinId()];
     PhyDBExpects(
         false,
         "Component pin: " << comp.GetName() << " " << pin.GetName()
@@ -456,6 +472,22 @@ SNet *PhyDB::GetSNet(std::string const &net_name) {
   return design_.GetSNet(net_name);
 }
 
+NetWireStore &PhyDB::GetNetWiresRef() {
+  return design_.GetNetWiresRef();
+}
+
+NetConnectivity *PhyDB::BuildNetConnectivity() {
+  return design_.BuildNetConnectivity();
+}
+
+NetConnectivity *PhyDB::GetNetConnectivityPtr() {
+  return design_.GetNetConnectivityPtr();
+}
+
+uint64_t PhyDB::GetConnectivityGeneration() const {
+  return design_.GetConnectivityGeneration();
+}
+
 std::vector<SNet> &PhyDB::GetSNetRef() {
   return design_.GetSNetRef();
 }
@@ -488,7 +520,7 @@ MacroWell *PhyDB::AddMacrowell(std::string const &macro_name) {
   Macro *macro_ptr = GetMacroPtr(macro_name);
   PhyDBExpects(macro_ptr != nullptr,
                "Macro does not exist, cannot add well info: " + macro_name);
-  tech_.wells_.emplace_back(macro_ptr);
+  tech_.wells_.emplace_back(tech_.GetMacroId(macro_ptr));
   macro_ptr->SetWellPtr(&(tech_.wells_.back()));
   return macro_ptr->GetWellPtr();
 }
@@ -527,7 +559,7 @@ SpecialMacroRectLayout *PhyDB::CreatePpNpMacroAndComponent(
       CompSource::USER
   );
   return design_.CreatePpNpMacroAndComponent(
-      plus_filling_macro,
+      tech_.GetMacroId(plus_filling_macro),
       llx,
       lly,
       urx,
@@ -562,7 +594,7 @@ SpecialMacroRectLayout *PhyDB::CreateWellLayerMacroAndComponent(
       CompSource::USER
   );
   return design_.CreateWellLayerMacroAndComponent(
-      well_filling_macro,
+      tech_.GetMacroId(well_filling_macro),
       llx,
       lly,
       urx,
@@ -684,9 +716,10 @@ void PhyDB::SetGetPerformanceWitnessCB(
 
 bool PhyDB::IsDriverPin(PhydbPin &phydb_pin) {
   int comp_id = phydb_pin.InstanceId();
-  Macro *macro_ptr = design_.GetComponentsRef()[comp_id].GetMacro();
+  MacroId macro_id = design_.GetComponentsRef()[comp_id].GetMacroId();
+  Macro &macro = tech_.GetMacro(macro_id);
   int pin_id = phydb_pin.PinId();
-  return macro_ptr->GetPinsRef()[pin_id].IsDriverPin();
+  return macro.GetPinsRef()[pin_id].IsDriverPin();
 }
 
 std::string PhyDB::GetFullCompPinName(
@@ -698,7 +731,7 @@ std::string PhyDB::GetFullCompPinName(
   Component &comp = design_.GetComponentsRef()[comp_id];
   const std::string &comp_name = comp.GetName();
   const std::string &pin_name =
-      comp.GetMacro()->GetPinsRef()[pin_id].GetName();
+      tech_.GetMacro(comp.GetMacroId()).GetPinsRef()[pin_id].GetName();
   std::string full_name(comp_name);
   full_name.push_back(delimiter);
   full_name.append(pin_name);
@@ -812,9 +845,82 @@ void PhyDB::ReadLef(std::string const &lef_file_name) {
   Si2ReadLef(this, lef_file_name);
 }
 
-void PhyDB::ReadDef(std::string const &def_file_name) {
+/**
+ * @brief Load cell library LEF files, which contain sites and macros.
+ * The technology LEF should be loaded by ReadLef() first, because layer ids
+ * of pins and OBS are resolved against existing layers.
+ *
+ * @param lef_file_names: LEF file names, they are merged in this order, and
+ * the result is the same as calling ReadLef() for them one by one.
+ * @param num_threads: files are parsed concurrently using this many threads,
+ * non-positive values mean using all cores. A file containing anything other
+ * than sites and macros is loaded by the Si2 parser instead.
+ * @param cache_dir: if not empty, parsed files are saved in this directory,
+ * and a file with the same content is loaded from there next time.
+ * @return nothing
+ */
+void PhyDB::ReadMacroLefs(
+    std::vector<std::string> const &lef_file_names,
+    int num_threads,
+    std::string const &cache_dir
+) {
+  ParallelReadMacroLefs(this, lef_file_names, num_threads, cache_dir);
+}
+
+/**
+ * @brief Load a DEF file.
+ *
+ * @param def_file_name: the DEF file name, files ending with ".gz" or ".zst"
+ * are decompressed on the fly.
+ * @param num_threads: 1 means using the serial Si2 parser, otherwise the
+ * in-house reader maps the file into memory and parses COMPONENTS, PINS, NETS
+ * and SPECIALNETS using this many threads, and non-positive values mean using
+ * all cores. Both give the same database. Afterwards, layers of routed net
+ * wires after vias are resolved. Pin offset tables of macros and the net
+ * connectivity are built on first use.
+ * @param sections: DEF sections to load, e.g., kDefConnectivitySections for
+ * tools which do not need special nets, blockages or routing. The header is
+ * always loaded, and NETS needs COMPONENTS and PINS.
+ * @param lazy_sections: SPECIALNETS and BLOCKAGES can be loaded on the first
+ * access to them instead, e.g., through GetSNetRef() or GetBlockagesRef().
+ * For a plain file, only the offsets of these sections are kept, so the file
+ * must not be changed before that. For a compressed file, the text of these
+ * sections is kept in memory instead, so the file is not decompressed again.
+ * This always uses the in-house reader, which is the one finding sections.
+ * @return nothing
+ */
+void PhyDB::ReadDef(
+    std::string const &def_file_name,
+    int num_threads,
+    DefSectionMask sections,
+    DefSectionMask lazy_sections
+) {
+  bool is_placement_loaded =
+      (sections & kDefPlacementSections) == kDefPlacementSections;
+  PhyDBExpects(
+      !(sections & kDefNets) || is_placement_loaded,
+      "Loading NETS needs COMPONENTS and PINS"
+  );
+  PhyDBExpects(
+      (lazy_sections & ~kDefLazySections) == 0,
+      "Only SPECIALNETS and BLOCKAGES can be loaded lazily"
+  );
   design_.SetDefName(def_file_name);
-  Si2ReadDef(this, def_file_name);
+  if (num_threads == 1 && (lazy_sections & sections) == 0) {
+    Si2ReadDef(this, def_file_name, sections);
+  } else {
+    ParallelReadDef(
+        this,
+        def_file_name,
+        num_threads,
+        sections,
+        lazy_sections
+    );
+  }
+  design_.GetNetWiresRef().ResolveLayersAfterVias(
+      tech_,
+      design_.GetDefViasRef()
+  );
 }
 
 /**
@@ -1050,9 +1156,11 @@ bool PhyDB::ReadTechConfigFile(std::string const &tech_config_file_name) {
 
   ReadTechnologyConfigurationFile(this, tech_config_file_name);
 
-  // fix the last entry in the resistance over table
-  // and use this technology configuration table to set r/c units
+  // fix the last entry in the resistance over table, compile tables for
+  // spacing-aware queries, and use this technology configuration table to
+  // set r/c units
   tech_.FixResOverTable();
+  tech_.CompileTechConfigTables();
   tech_.SetResistanceUnit(true, false);
   tech_.SetCapacitanceUnit(true, false);
 
@@ -1088,8 +1196,22 @@ bool PhyDB::ReadTechConfigFile(int argc, char **argv) {
   return true;
 }
 
-void PhyDB::WriteDef(std::string const &def_file_name) {
-  Si2WriteDef(this, def_file_name);
+/**
+ * @brief Write the database to a DEF file.
+ *
+ * @param def_file_name: the DEF file name, files ending with ".gz" or ".zst"
+ * are compressed on the fly.
+ * @param num_threads: 1 means using the Si2 writer, otherwise sections are
+ * formatted into memory buffers using this many threads and written to the
+ * file in order, and non-positive values mean using all cores.
+ * @return nothing
+ */
+void PhyDB::WriteDef(std::string const &def_file_name, int num_threads) {
+  if (num_threads == 1) {
+    Si2WriteDef(this, def_file_name);
+  } else {
+    ParallelWriteDef(this, def_file_name, num_threads);
+  }
 }
 
 void PhyDB::WriteCluster(std::string const &cluster_file_name) {
@@ -1147,6 +1269,30 @@ void PhyDB::WriteGuide(std::string const &guide_file_name) {
   }
 }
 
+/**
+ * @brief Save the whole database to a binary snapshot file, which can be
+ * loaded much faster than parsing LEF/DEF/CELL/cluster/technology
+ * configuration files again.
+ *
+ * @param snapshot_file_name: the snapshot file name.
+ * @return nothing
+ */
+void PhyDB::SaveSnapshot(std::string const &snapshot_file_name) {
+  Snapshot::Save(this, snapshot_file_name);
+}
+
+/**
+ * @brief Load a binary snapshot file saved by SaveSnapshot().
+ * This PhyDB must be empty before loading. ACT pointers and timing callbacks
+ * are not part of a snapshot, they need to be set up again.
+ *
+ * @param snapshot_file_name: the snapshot file name.
+ * @return nothing
+ */
+void PhyDB::LoadSnapshot(std::string const &snapshot_file_name) {
+  Snapshot::Load(this, snapshot_file_name);
+}
+
 #if PHYDB_USE_GALOIS
 void PhyDB::BindPhydbPinToActPin_(PhydbPin &phydb_pin) {
   auto *timer_adaptor = GetNetlistAdaptor();
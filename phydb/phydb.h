@@ -26,13 +26,19 @@
 
 #include "design.h"
 #include "tech.h"
+#include "phydb/common/symboltable.h"
 #include "phydb/timing/actphydbtimingapi.h"
 
 namespace phydb {
 
+// include netconnectivity.h or spatialindex.h to use them, spatialindex.h
+// pulls in boost/geometry
+class NetConnectivity;
+class SpatialIndex;
+
 class PhyDB {
  public:
-  PhyDB() = default;
+  PhyDB() { design_.SetTechPtr(&tech_); }
   ~PhyDB();
 
   Tech *GetTechPtr();
@@ -70,6 +76,7 @@ class PhyDB {
   bool IsMacroExisting(std::string const &macro_name);
   Macro *AddMacro(std::string const &macro_name);
   Macro *GetMacroPtr(std::string const &macro_name);
+  MacroId GetMacroId(std::string const &macro_name);
 
   bool IsLefViaExisting(std::string const &name);
   LefVia *AddLefVia(std::string const &name);
@@ -143,6 +150,8 @@ class PhyDB {
   );
   Component *GetComponentPtr(std::string const &comp_name);
   int GetComponentId(std::string const &comp_name);
+  SpatialIndex *BuildSpatialIndex();
+  SpatialIndex *GetSpatialIndexPtr();
 
   void SetIoPinCount(int count);
   bool IsIoPinExisting(std::string const &iopin_name);
@@ -179,6 +188,10 @@ class PhyDB {
       std::string const &net_name,
       void *act_comp_pin_ptr = nullptr
   );
+  NetWireStore &GetNetWiresRef();
+  NetConnectivity *BuildNetConnectivity();
+  NetConnectivity *GetNetConnectivityPtr();
+  uint64_t GetConnectivityGeneration() const;
 
   SNet *AddSNet(std::string const &net_name, SignalUse use);
   SNet *GetSNet(std::string const &net_name);
@@ -310,18 +323,33 @@ class PhyDB {
   * ************************************************/
 
   void ReadLef(std::string const &lef_file_name);
-  void ReadDef(std::string const &def_file_name);
+  void ReadMacroLefs(
+      std::vector<std::string> const &lef_file_names,
+      int num_threads = 1,
+      std::string const &cache_dir = ""
+  );
+  void ReadDef(
+      std::string const &def_file_name,
+      int num_threads = 1,
+      DefSectionMask sections = kDefAllSections,
+      DefSectionMask lazy_sections = 0
+  );
   void OverrideComponentLocsFromDef(std::string const &def_file_name);
   void ReadCell(std::string const &cell_file_name);
   void ReadCluster(std::string const &cluster_file_name);
   bool ReadTechConfigFile(std::string const &tech_config_file_name);
   bool ReadTechConfigFile(int argc, char **argv);
 
-  void WriteDef(std::string const &def_file_name);
+  void WriteDef(std::string const &def_file_name, int num_threads = 1);
   void WriteCluster(std::string const &cluster_file_name);
   void WriteGuide(std::string const &guide_file_name);
 
+  void SaveSnapshot(std::string const &snapshot_file_name);
+  void LoadSnapshot(std::string const &snapshot_file_name);
+
  private:
+  // declared first, so that interned names are freed after everything else
+  SymbolTableUser symbol_table_user_;
   Tech tech_;
   Design design_;
   ActPhyDBTimingAPI timing_api_;
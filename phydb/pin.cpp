@@ -25,20 +25,23 @@
 namespace phydb {
 
 void Pin::SetName(std::string &name) {
-  name_ = name;
+  name_ = &InternName(name);
 }
 
 void Pin::SetUse(SignalUse &use) {
   use_ = use;
 }
 
-LayerRect *Pin::AddLayerRect(std::string &layer_name) {
-  layer_rects_.emplace_back(layer_name);
+LayerRect *Pin::AddLayerRect(
+    std::string const &layer_name,
+    int layer_id
+) {
+  layer_rects_.emplace_back(layer_name, layer_id);
   return &(layer_rects_.back());
 }
 
 const std::string &Pin::GetName() {
-  return name_;
+  return *name_;
 }
 
 SignalDirection Pin::GetDirection() {
@@ -87,7 +90,7 @@ Rect2D<double> Pin::GetBoundingBox() {
 }
 
 std::ostream &operator<<(std::ostream &os, const Pin &p) {
-  os << p.name_ << " "
+  os << *p.name_ << " "
      << SignalDirectionStr(p.direction_) << " "
      << SignalUseStr(p.use_) << "\n";
   os << p.antenna_diff_area_layer_ << " " << p.antenna_diff_area_ << "\n";
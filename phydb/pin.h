@@ -26,13 +26,15 @@
 
 #include "datatype.h"
 #include "enumtypes.h"
+#include "phydb/common/symboltable.h"
 
 namespace phydb {
 
 class Pin {
+  friend class Snapshot;
  public:
   Pin() :
-      name_(""),
+      name_(&InternName("")),
       direction_(SignalDirection::INPUT),
       use_(SignalUse::SIGNAL),
       antenna_diff_area_layer_(""),
@@ -41,7 +43,7 @@ class Pin {
       SignalDirection direction,
       SignalUse use
   ) :
-      name_(name),
+      name_(&InternName(name)),
       direction_(direction),
       use_(use) {}
   Pin(
@@ -52,7 +54,7 @@ class Pin {
       double antennaDiffArea,
       std::vector<LayerRect> layerRects
   ) :
-      name_(name),
+      name_(&InternName(name)),
       direction_(direction),
       use_(use),
       antenna_diff_area_layer_(antennaDiffAreaLayer),
@@ -61,7 +63,7 @@ class Pin {
 
   void SetName(std::string &name);
   void SetUse(SignalUse &use);
-  LayerRect *AddLayerRect(std::string &layer_name);
+  LayerRect *AddLayerRect(std::string const &layer_name, int layer_id = -1);
 
   const std::string &GetName();
   SignalDirection GetDirection();
@@ -73,7 +75,7 @@ class Pin {
 
   friend std::ostream &operator<<(std::ostream &, const Pin &);
  private:
-  std::string name_;
+  std::string const *name_;
   SignalDirection direction_;
   SignalUse use_;
   std::string antenna_diff_area_layer_;
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "pinlocator.h"
+
+#include <algorithm>
+
+#include "phydb/common/helper.h"
+
+namespace phydb {
+
+/****
+ * @brief Size the coordinate arrays for the pins of a connectivity. Pins are
+ * not located.
+ *
+ * @param db_ptr: the database the pins belong to
+ * @param connectivity_ptr: the connectivity of its design
+ */
+void PinLocator::Reset(
+    PhyDB *db_ptr,
+    NetConnectivity const *connectivity_ptr
+) {
+  db_ptr_ = db_ptr;
+  connectivity_ptr_ = connectivity_ptr;
+  int num_pins = connectivity_ptr_->GetNumPins();
+  pin_x_.assign(num_pins, 0);
+  pin_y_.assign(num_pins, 0);
+}
+
+/****
+ * @brief Locate all pins in parallel.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void PinLocator::LocateAllPins(int num_threads) {
+  int num_pins = GetNumPins();
+  const int chunk_size = 4096;
+  int num_chunks = (num_pins + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads, [&](int chunk) {
+    int end = std::min(num_pins, (chunk + 1) * chunk_size);
+    for (int pin = chunk * chunk_size; pin < end; ++pin) {
+      LocatePin(pin);
+    }
+  });
+}
+
+void PinLocator::LocateNetPins(int net_id) {
+  int end = connectivity_ptr_->GetNetPinEnd(net_id);
+  for (int pin = connectivity_ptr_->GetNetPinBegin(net_id); pin < end;
+       ++pin) {
+    LocatePin(pin);
+  }
+}
+
+void PinLocator::LocatePin(int pin) {
+  Design &design = db_ptr_->design();
+  int comp_id = connectivity_ptr_->GetPinComponentId(pin);
+  if (comp_id < 0) {
+    Point2D<int> location = design.GetIoPinLocation(
+        connectivity_ptr_->GetPinId(pin)
+    );
+    pin_x_[pin] = location.x;
+    pin_y_[pin] = location.y;
+    return;
+  }
+  Component &comp = design.GetComponentsRef()[comp_id];
+  Macro &macro = db_ptr_->tech().GetMacro(comp.GetMacroId());
+  Point2D<int> const &offset = macro.GetPinCenterOffset(
+      comp.GetOrientation(), connectivity_ptr_->GetPinId(pin)
+  );
+  Point2D<int> location = comp.GetLocation();
+  pin_x_[pin] = location.x + offset.x;
+  pin_y_[pin] = location.y + offset.y;
+}
+
+}
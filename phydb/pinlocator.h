@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_PINLOCATOR_H_
+#define PHYDB_PINLOCATOR_H_
+
+#include <vector>
+
+#include "netconnectivity.h"
+#include "phydb.h"
+
+namespace phydb {
+
+/****
+ * Coordinates of the pins of a NetConnectivity, shared by the wirelength
+ * and RC engines.
+ *
+ * Coordinates are stored as two flat arrays in the pin order of the
+ * connectivity, so the pins of a net are contiguous integers. A component
+ * pin is at the center of its bounding box given by the macro pin offset
+ * tables, which must be computed before pins are located; an IO pin is at
+ * Design::GetIoPinLocation(). All values are in DEF database unit.
+ *
+ * Locating different pins from different threads is safe, e.g., the pins
+ * of different nets.
+ */
+class PinLocator {
+ public:
+  void Reset(PhyDB *db_ptr, NetConnectivity const *connectivity_ptr);
+
+  void LocateAllPins(int num_threads);
+  void LocateNetPins(int net_id);
+  void LocatePin(int pin);
+
+  int GetNumPins() const { return static_cast<int>(pin_x_.size()); }
+  int GetX(int pin) const { return pin_x_[pin]; }
+  int GetY(int pin) const { return pin_y_[pin]; }
+  Point2D<int> GetLocation(int pin) const {
+    return Point2D<int>(pin_x_[pin], pin_y_[pin]);
+  }
+  int const *GetXPtr(int pin) const { return pin_x_.data() + pin; }
+  int const *GetYPtr(int pin) const { return pin_y_.data() + pin; }
+
+ private:
+  PhyDB *db_ptr_ = nullptr;
+  NetConnectivity const *connectivity_ptr_ = nullptr;
+  std::vector<int> pin_x_;
+  std::vector<int> pin_y_;
+};
+
+}
+
+#endif //PHYDB_PINLOCATOR_H_
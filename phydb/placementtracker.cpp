@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "placementtracker.h"
+
+#include <algorithm>
+
+namespace phydb {
+
+/****
+ * @brief Grow the per-component epochs to a number of components. New
+ * components start at epoch 0, which means they never changed.
+ */
+void PlacementTracker::SetComponentCount(size_t count) {
+  component_epochs_.resize(count, 0);
+}
+
+void PlacementTracker::MarkComponentChanged(int comp_id) {
+  ++epoch_;
+  component_epochs_[comp_id] = epoch_;
+  AppendLog(comp_id);
+}
+
+/****
+ * @brief Mark a batch of components as changed in a single epoch.
+ */
+void PlacementTracker::MarkComponentsChanged(std::vector<int> const &comp_ids) {
+  if (comp_ids.empty()) return;
+  ++epoch_;
+  for (int comp_id: comp_ids) {
+    component_epochs_[comp_id] = epoch_;
+    AppendLog(comp_id);
+  }
+}
+
+/****
+ * @brief Drop the log once it is longer than a full scan over all
+ * components, queries older than the log then fall back to the scan. The
+ * current epoch may already have entries in the dropped part, so the log is
+ * only trusted for later epochs.
+ */
+void PlacementTracker::AppendLog(int comp_id) {
+  if (log_.size() >= component_epochs_.size()) {
+    log_.clear();
+    log_begin_epoch_ = epoch_;
+  }
+  log_.push_back(Change{epoch_, comp_id});
+}
+
+/****
+ * @brief Get the ids of components whose placement changed after an epoch.
+ *
+ * @param epoch: an epoch returned by GetEpoch() earlier
+ * @param comp_ids: receives the component ids in increasing order
+ */
+void PlacementTracker::GetComponentsChangedSince(
+    uint64_t epoch,
+    std::vector<int> &comp_ids
+) const {
+  comp_ids.clear();
+  if (epoch >= epoch_) return;
+  if (epoch < log_begin_epoch_) {
+    for (size_t i = 0; i < component_epochs_.size(); ++i) {
+      if (component_epochs_[i] > epoch) {
+        comp_ids.push_back(static_cast<int>(i));
+      }
+    }
+    return;
+  }
+  // a component changed several times is reported by its latest log entry
+  for (auto it = log_.rbegin(); it != log_.rend() && it->epoch > epoch; ++it) {
+    if (component_epochs_[it->comp_id] == it->epoch) {
+      comp_ids.push_back(it->comp_id);
+    }
+  }
+  std::sort(comp_ids.begin(), comp_ids.end());
+  comp_ids.erase(
+      std::unique(comp_ids.begin(), comp_ids.end()),
+      comp_ids.end()
+  );
+}
+
+}
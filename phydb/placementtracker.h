@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_PLACEMENTTRACKER_H_
+#define PHYDB_PLACEMENTTRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace phydb {
+
+/****
+ * Records which components changed their placement, and when.
+ *
+ * The tracker keeps a global epoch counter and the epoch of the last
+ * placement change of every component. Each single change, and each batch
+ * of changes, advances the epoch by one. A consumer caching something
+ * derived from the placement remembers the epoch it was synced at, and
+ * later asks for the components changed since then:
+ *
+ *   std::vector<int> moved;
+ *   tracker.GetComponentsChangedSince(synced_epoch, moved);
+ *   hpwl_engine.UpdateComponents(moved);
+ *   synced_epoch = tracker.GetEpoch();
+ *
+ * Several consumers can sync at different epochs. Recent changes are also
+ * kept in a short log, so a query for a recent epoch costs the number of
+ * changes rather than the number of components.
+ */
+class PlacementTracker {
+ public:
+  void SetComponentCount(size_t count);
+  void MarkComponentChanged(int comp_id);
+  void MarkComponentsChanged(std::vector<int> const &comp_ids);
+
+  uint64_t GetEpoch() const { return epoch_; }
+  uint64_t GetComponentEpoch(int comp_id) const {
+    return component_epochs_[comp_id];
+  }
+  bool IsComponentChangedSince(int comp_id, uint64_t epoch) const {
+    return component_epochs_[comp_id] > epoch;
+  }
+  void GetComponentsChangedSince(
+      uint64_t epoch,
+      std::vector<int> &comp_ids
+  ) const;
+
+ private:
+  struct Change {
+    uint64_t epoch;
+    int comp_id;
+  };
+  void AppendLog(int comp_id);
+
+  uint64_t epoch_ = 0;
+  std::vector<uint64_t> component_epochs_;
+  // every change after log_begin_epoch_, in the order of epochs
+  std::vector<Change> log_;
+  uint64_t log_begin_epoch_ = 0;
+};
+
+}
+
+#endif //PHYDB_PLACEMENTTRACKER_H_
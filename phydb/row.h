@@ -29,6 +29,7 @@
 namespace phydb {
 
 class Row {
+  friend class Snapshot;
  public:
   Row() = default;
   Row(
@@ -0,0 +1,1320 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "snapshot.h"
+
+#include <algorithm>
+
+#include "parallellefreader.h"
+#include "phydb.h"
+
+namespace phydb {
+
+// the following types contain floating point numbers, and have no padding
+template<typename T>
+struct IsSnapshotPod<Point2D<T>> : std::integral_constant<
+    bool,
+    IsSnapshotPod<T>::value && sizeof(Point2D<T>) == 2 * sizeof(T)
+> {};
+
+template<typename T>
+struct IsSnapshotPod<Rect2D<T>> : std::integral_constant<
+    bool,
+    IsSnapshotPod<Point2D<T>>::value
+        && sizeof(Rect2D<T>) == 2 * sizeof(Point2D<T>)
+> {};
+
+template<>
+struct IsSnapshotPod<SpacingTableInfluence> : std::integral_constant<
+    bool,
+    sizeof(SpacingTableInfluence) == 3 * sizeof(double)
+> {};
+
+template<>
+struct IsSnapshotPod<EolSpacing> : std::integral_constant<
+    bool,
+    sizeof(EolSpacing) == 5 * sizeof(double)
+> {};
+
+template<>
+struct IsSnapshotPod<AdjacentCutSpacing> : std::integral_constant<
+    bool,
+    sizeof(AdjacentCutSpacing) == sizeof(double) + 2 * sizeof(int)
+> {};
+
+static const char kSnapshotMagic[8] = {'P', 'H', 'Y', 'D', 'B', 'S', 'N', 'P'};
+static const uint32_t kSnapshotVersion = 1;
+static const uint32_t kSnapshotByteOrderMark = 0x01020304;
+static const uint32_t kSnapshotTechTag = 0x48434554; // "TECH"
+static const uint32_t kSnapshotDesignTag = 0x4e475344; // "DSGN"
+static const char kMacroLibraryMagic[8] = {
+    'P', 'H', 'Y', 'D', 'B', 'L', 'E', 'F'
+};
+static const std::size_t kSnapshotBufferSize = 1 << 24;
+
+SnapshotWriter::SnapshotWriter(std::string const &file_name) :
+    ost_(file_name, std::ios::out | std::ios::binary | std::ios::trunc) {
+  PhyDBExpects(ost_.is_open(), "Cannot open output file " << file_name);
+  buffer_.reserve(kSnapshotBufferSize);
+}
+
+SnapshotWriter::~SnapshotWriter() {
+  Flush();
+  ost_.close();
+}
+
+void SnapshotWriter::Flush() {
+  ost_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  PhyDBExpects(ost_.good(), "Failed to write snapshot");
+  buffer_.clear();
+}
+
+void SnapshotWriter::WriteBytes(const void *data, std::size_t size) {
+  if (buffer_.size() + size > kSnapshotBufferSize) {
+    Flush();
+  }
+  if (size > kSnapshotBufferSize) {
+    ost_.write(
+        static_cast<const char *>(data),
+        static_cast<std::streamsize>(size)
+    );
+    PhyDBExpects(ost_.good(), "Failed to write snapshot");
+    return;
+  }
+  auto *bytes = static_cast<const char *>(data);
+  buffer_.insert(buffer_.end(), bytes, bytes + size);
+}
+
+void SnapshotWriter::WriteString(std::string_view str) {
+  Write<uint64_t>(str.size());
+  WriteBytes(str.data(), str.size());
+}
+
+void SnapshotWriter::WriteStringVector(std::vector<std::string> const &vec) {
+  Write<uint64_t>(vec.size());
+  for (auto &str: vec) {
+    WriteString(str);
+  }
+}
+
+void SnapshotWriter::WriteNameMap(
+    std::unordered_map<std::string, int> const &name_map
+) {
+  std::vector<std::pair<int, std::string_view>> entries;
+  entries.reserve(name_map.size());
+  for (auto &[name, id]: name_map) {
+    entries.emplace_back(id, name);
+  }
+  WriteNameEntries(entries);
+}
+
+void SnapshotWriter::WriteNameMap(
+    std::unordered_map<std::string_view, int> const &name_map
+) {
+  std::vector<std::pair<int, std::string_view>> entries;
+  entries.reserve(name_map.size());
+  for (auto &[name, id]: name_map) {
+    entries.emplace_back(id, name);
+  }
+  WriteNameEntries(entries);
+}
+
+void SnapshotWriter::WriteNameEntries(
+    std::vector<std::pair<int, std::string_view>> &entries
+) {
+  // entries are sorted so that saving the same database always produces the
+  // same bytes, no matter how the hash table was populated
+  std::sort(entries.begin(), entries.end());
+  Write<uint64_t>(entries.size());
+  for (auto &[id, name]: entries) {
+    WriteString(name);
+    Write<int>(id);
+  }
+}
+
+void SnapshotWriter::WriteNameSet(
+    std::unordered_set<std::string> const &name_set
+) {
+  std::vector<std::string const *> names;
+  names.reserve(name_set.size());
+  for (auto &name: name_set) {
+    names.push_back(&name);
+  }
+  std::sort(names.begin(), names.end(),
+            [](std::string const *lhs, std::string const *rhs) {
+              return *lhs < *rhs;
+            });
+  Write<uint64_t>(names.size());
+  for (auto name: names) {
+    WriteString(*name);
+  }
+}
+
+SnapshotReader::SnapshotReader(std::string const &file_name) :
+    file_(file_name) {
+  PhyDBExpects(file_.Size() > 0, "Empty snapshot file " << file_name);
+}
+
+const char *SnapshotReader::ReadBytes(std::size_t size) {
+  PhyDBExpects(
+      size <= file_.Size() - pos_,
+      "Snapshot file is truncated or corrupted"
+  );
+  const char *res = file_.Begin() + pos_;
+  pos_ += size;
+  return res;
+}
+
+std::size_t SnapshotReader::ReadSize() {
+  auto size = Read<uint64_t>();
+  PhyDBExpects(
+      size <= file_.Size(),
+      "Snapshot file is corrupted, bad size " << size
+  );
+  return static_cast<std::size_t>(size);
+}
+
+std::string SnapshotReader::ReadString() {
+  return std::string(ReadStringView());
+}
+
+// the view points into the mapped file, it is valid as long as the reader
+std::string_view SnapshotReader::ReadStringView() {
+  std::size_t size = ReadSize();
+  const char *data = ReadBytes(size);
+  return std::string_view(data, size);
+}
+
+void SnapshotReader::ReadStringVector(std::vector<std::string> &vec) {
+  std::size_t size = ReadSize();
+  vec.clear();
+  vec.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    vec.emplace_back(ReadString());
+  }
+}
+
+void SnapshotReader::ReadNameMap(
+    std::unordered_map<std::string, int> &name_map
+) {
+  std::size_t size = ReadSize();
+  name_map.clear();
+  name_map.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    std::string name = ReadString();
+    int id = Read<int>();
+    name_map.emplace(std::move(name), id);
+  }
+}
+
+// keys are interned, so the map does not refer to the mapped file
+void SnapshotReader::ReadNameMap(
+    std::unordered_map<std::string_view, int> &name_map
+) {
+  std::size_t size = ReadSize();
+  name_map.clear();
+  name_map.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    std::string const &name = InternName(ReadStringView());
+    int id = Read<int>();
+    name_map.emplace(name, id);
+  }
+}
+
+void SnapshotReader::ReadNameSet(std::unordered_set<std::string> &name_set) {
+  std::size_t size = ReadSize();
+  name_set.clear();
+  name_set.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    name_set.emplace(ReadString());
+  }
+}
+
+static void WriteLayerRects(
+    SnapshotWriter &writer,
+    std::vector<LayerRect> &layer_rects
+) {
+  writer.Write<uint64_t>(layer_rects.size());
+  for (auto &layer_rect: layer_rects) {
+    writer.WriteString(*layer_rect.layer_name_);
+    writer.Write(layer_rect.layer_id_);
+    writer.WriteVector(layer_rect.rects_);
+  }
+}
+
+static void ReadLayerRects(
+    SnapshotReader &reader,
+    std::vector<LayerRect> &layer_rects
+) {
+  layer_rects.resize(reader.ReadSize());
+  for (auto &layer_rect: layer_rects) {
+    layer_rect.layer_name_ = &InternName(reader.ReadStringView());
+    reader.Read(layer_rect.layer_id_);
+    reader.ReadVector(layer_rect.rects_);
+  }
+}
+
+static void WriteConfigTables(
+    SnapshotWriter &writer,
+    std::vector<ConfigTable> &tables
+) {
+  writer.Write<uint64_t>(tables.size());
+  for (auto &table: tables) {
+    writer.Write(table.Type());
+    writer.Write(table.Width());
+    writer.Write(table.LayerIndex());
+    writer.Write(table.Index0());
+    writer.Write(table.Index1());
+    writer.Write<uint64_t>(table.GetTable().size());
+    for (auto &entry: table.GetTable()) {
+      writer.Write(entry.distance_);
+      writer.Write(entry.coupling_cap_);
+      writer.Write(entry.fringe_cap_);
+      writer.Write(entry.res_);
+    }
+  }
+}
+
+static void ReadConfigTables(
+    SnapshotReader &reader,
+    std::vector<ConfigTable> &tables
+) {
+  std::size_t size = reader.ReadSize();
+  tables.clear();
+  tables.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    auto type = reader.Read<TableType>();
+    auto width = reader.Read<double>();
+    auto layer_index = reader.Read<int>();
+    auto index0 = reader.Read<int>();
+    auto index1 = reader.Read<int>();
+    ConfigTable &table = tables.emplace_back(type, layer_index, index0, index1);
+    table.SetWidth(width);
+    std::size_t num_entries = reader.ReadSize();
+    table.GetTable().reserve(num_entries);
+    for (std::size_t j = 0; j < num_entries; ++j) {
+      auto distance = reader.Read<double>();
+      auto coupling_cap = reader.Read<double>();
+      auto fringe_cap = reader.Read<double>();
+      auto res = reader.Read<double>();
+      table.AddEntry(distance, coupling_cap, fringe_cap, res);
+    }
+  }
+}
+
+void Snapshot::WriteLayer(SnapshotWriter &writer, Layer &layer) {
+  writer.WriteString(layer.name_);
+  writer.Write(layer.type_);
+  writer.Write(layer.id_);
+  writer.Write(layer.direction_);
+  writer.Write(layer.pitchx_);
+  writer.Write(layer.pitchy_);
+  writer.Write(layer.width_);
+  writer.Write(layer.area_);
+  writer.Write(layer.min_width_);
+  writer.Write(layer.offset_);
+
+  writer.Write(layer.spacing_table_.n_col_);
+  writer.Write(layer.spacing_table_.n_row_);
+  writer.WriteVector(layer.spacing_table_.parallel_run_length_);
+  writer.WriteVector(layer.spacing_table_.width_);
+  writer.WriteVector(layer.spacing_table_.spacing_);
+  writer.WriteVector(layer.spacing_table_influences_);
+  writer.WriteVector(layer.eol_spacings_);
+  writer.Write(layer.corner_spacing_.eol_width_);
+  writer.WriteVector(layer.corner_spacing_.width_);
+  writer.WriteVector(layer.corner_spacing_.spacing_);
+  writer.Write(layer.spacing_);
+  writer.Write(layer.adjacent_cut_spacing_);
+
+  writer.WriteVector(layer.unit_area_cap_);
+  writer.WriteVector(layer.unit_edge_cap_);
+  writer.WriteVector(layer.unit_res_);
+  writer.Write(layer.capacitance_cpersqdist_);
+  writer.Write(layer.capmultiplier_);
+  writer.Write(layer.edgecapacitance_);
+  writer.Write(layer.resistance_rpersq_);
+
+  bool has_tech_config = (layer.layer_tech_config_ != nullptr);
+  writer.Write(has_tech_config);
+  if (has_tech_config) {
+    auto &corners = layer.layer_tech_config_->corners_;
+    writer.Write<uint64_t>(corners.size());
+    for (auto &corner: corners) {
+      writer.Write(corner.model_index_);
+      WriteConfigTables(writer, corner.res_over_);
+      WriteConfigTables(writer, corner.cap_over_);
+      WriteConfigTables(writer, corner.cap_under_);
+      WriteConfigTables(writer, corner.cap_diagunder_);
+      WriteConfigTables(writer, corner.cap_overunder_);
+    }
+  }
+}
+
+void Snapshot::ReadLayer(SnapshotReader &reader, Tech &tech) {
+  std::string name = reader.ReadString();
+  auto type = reader.Read<LayerType>();
+  Layer &layer = tech.layers_.emplace_back(
+      name,
+      type,
+      MetalDirection::VERTICAL
+  );
+  reader.Read(layer.id_);
+  reader.Read(layer.direction_);
+  reader.Read(layer.pitchx_);
+  reader.Read(layer.pitchy_);
+  reader.Read(layer.width_);
+  reader.Read(layer.area_);
+  reader.Read(layer.min_width_);
+  reader.Read(layer.offset_);
+
+  reader.Read(layer.spacing_table_.n_col_);
+  reader.Read(layer.spacing_table_.n_row_);
+  reader.ReadVector(layer.spacing_table_.parallel_run_length_);
+  reader.ReadVector(layer.spacing_table_.width_);
+  reader.ReadVector(layer.spacing_table_.spacing_);
+  reader.ReadVector(layer.spacing_table_influences_);
+  reader.ReadVector(layer.eol_spacings_);
+  reader.Read(layer.corner_spacing_.eol_width_);
+  reader.ReadVector(layer.corner_spacing_.width_);
+  reader.ReadVector(layer.corner_spacing_.spacing_);
+  reader.Read(layer.spacing_);
+  reader.Read(layer.adjacent_cut_spacing_);
+
+  reader.ReadVector(layer.unit_area_cap_);
+  reader.ReadVector(layer.unit_edge_cap_);
+  reader.ReadVector(layer.unit_res_);
+  reader.Read(layer.capacitance_cpersqdist_);
+  reader.Read(layer.capmultiplier_);
+  reader.Read(layer.edgecapacitance_);
+  reader.Read(layer.resistance_rpersq_);
+
+  if (reader.Read<bool>()) {
+    layer.InitLayerTechConfig();
+    auto &corners = layer.layer_tech_config_->corners_;
+    std::size_t num_corners = reader.ReadSize();
+    corners.reserve(num_corners);
+    for (std::size_t i = 0; i < num_corners; ++i) {
+      auto &corner = corners.emplace_back(reader.Read<int>());
+      ReadConfigTables(reader, corner.res_over_);
+      ReadConfigTables(reader, corner.cap_over_);
+      ReadConfigTables(reader, corner.cap_under_);
+      ReadConfigTables(reader, corner.cap_diagunder_);
+      ReadConfigTables(reader, corner.cap_overunder_);
+      corner.CompileTables();
+    }
+  }
+}
+
+void Snapshot::WriteMacro(SnapshotWriter &writer, Macro &macro) {
+  writer.WriteString(*macro.name_);
+  writer.Write(macro.class_);
+  writer.Write(macro.origin_);
+  writer.Write(macro.size_);
+  writer.Write(macro.symmetry_);
+  writer.Write<uint64_t>(macro.pins_.size());
+  for (auto &pin: macro.pins_) {
+    writer.WriteString(*pin.name_);
+    writer.Write(pin.direction_);
+    writer.Write(pin.use_);
+    writer.WriteString(pin.antenna_diff_area_layer_);
+    writer.Write(pin.antenna_diff_area_);
+    WriteLayerRects(writer, pin.layer_rects_);
+  }
+  WriteLayerRects(writer, macro.obs_.GetLayerRectsRef());
+}
+
+void Snapshot::ReadMacro(SnapshotReader &reader, Macro &macro) {
+  macro.name_ = &InternName(reader.ReadStringView());
+  reader.Read(macro.class_);
+  reader.Read(macro.origin_);
+  reader.Read(macro.size_);
+  reader.Read(macro.symmetry_);
+  std::size_t num_pins = reader.ReadSize();
+  macro.pins_.resize(num_pins);
+  macro.pin_2_id_.reserve(num_pins);
+  for (std::size_t i = 0; i < num_pins; ++i) {
+    Pin &pin = macro.pins_[i];
+    pin.name_ = &InternName(reader.ReadStringView());
+    reader.Read(pin.direction_);
+    reader.Read(pin.use_);
+    pin.antenna_diff_area_layer_ = reader.ReadString();
+    reader.Read(pin.antenna_diff_area_);
+    ReadLayerRects(reader, pin.layer_rects_);
+    macro.pin_2_id_.emplace(*pin.name_, static_cast<int>(i));
+  }
+  ReadLayerRects(reader, macro.obs_.GetLayerRectsRef());
+}
+
+void Snapshot::WriteTech(SnapshotWriter &writer, Tech &tech) {
+  writer.Write(kSnapshotTechTag);
+  writer.WriteString(tech.version_);
+  writer.WriteString(tech.bus_bit_char_);
+  writer.WriteString(tech.divier_char_);
+  writer.WriteString(tech.clearance_measure_);
+  writer.Write(tech.manufacturing_grid_);
+  writer.Write(tech.database_micron_);
+  writer.WriteString(tech.lef_name_);
+
+  writer.Write<uint64_t>(tech.sites_.size());
+  for (auto &site: tech.sites_) {
+    writer.WriteString(site.GetName());
+    writer.Write(site.GetClass());
+    writer.Write(site.GetWidth());
+    writer.Write(site.GetHeight());
+    writer.Write(site.GetSymmetry());
+  }
+  writer.WriteNameMap(tech.site_2_id_);
+
+  writer.Write<uint64_t>(tech.layers_.size());
+  for (auto &layer: tech.layers_) {
+    WriteLayer(writer, layer);
+  }
+  writer.WriteNameMap(tech.layer_2_id_);
+
+  // macros are written in the order of their ids
+  writer.Write<uint64_t>(tech.macros_.size());
+  for (auto &macro: tech.macros_) {
+    WriteMacro(writer, macro);
+  }
+
+  writer.Write<uint64_t>(tech.vias_.size());
+  for (auto &via: tech.vias_) {
+    writer.WriteString(via.name_);
+    writer.Write(via.is_default_);
+    WriteLayerRects(writer, via.layer_rects_);
+  }
+  writer.WriteNameMap(tech.via_2_id_);
+
+  writer.Write<uint64_t>(tech.via_rule_generates_.size());
+  for (auto &via_rule: tech.via_rule_generates_) {
+    writer.WriteString(via_rule.name_);
+    writer.Write(via_rule.is_default_);
+    for (auto &via_rule_layer: via_rule.layers_) {
+      writer.WriteString(via_rule_layer.layer_name_);
+      writer.Write(via_rule_layer.rect_);
+      writer.Write(via_rule_layer.spacing_);
+      writer.Write(via_rule_layer.enclosure_);
+    }
+  }
+  writer.WriteNameMap(tech.via_rule_generate_2_id_);
+
+  writer.Write(tech.is_placement_grid_set_);
+  writer.Write(tech.placement_grid_value_x_);
+  writer.Write(tech.placement_grid_value_y_);
+
+  writer.Write(tech.is_n_well_layer_set_);
+  writer.Write(tech.is_p_well_layer_set_);
+  for (WellLayer *well_layer: {tech.n_layer_ptr_, tech.p_layer_ptr_}) {
+    writer.Write(well_layer != nullptr);
+    if (well_layer != nullptr) {
+      writer.Write(well_layer->GetWidth());
+      writer.Write(well_layer->GetSpacing());
+      writer.Write(well_layer->GetOpSpacing());
+      writer.Write(well_layer->GetMaxPlugDist());
+      writer.Write(well_layer->GetOverhang());
+    }
+  }
+  writer.Write(tech.same_diff_spacing_);
+  writer.Write(tech.any_diff_spacing_);
+
+  writer.Write<uint64_t>(tech.wells_.size());
+  for (auto &well: tech.wells_) {
+    writer.Write(well.macro_id_);
+    writer.Write(well.is_n_set_);
+    writer.Write(well.is_p_set_);
+    writer.Write(well.n_rect_);
+    writer.Write(well.p_rect_);
+    writer.Write(well.p_n_edge_);
+    // the macro refers back to its well
+    writer.Write(tech.macros_[well.macro_id_].well_ptr_ == &well);
+  }
+
+  writer.Write(tech.tech_config_.is_diagmodel_on_);
+  writer.Write(tech.tech_config_.layer_count_);
+  writer.Write(tech.tech_config_.corner_count_);
+  writer.WriteVector(tech.tech_config_.data_rate_table_);
+
+  writer.Write<uint64_t>(tech.metal_layers_.size());
+  for (Layer *layer_ptr: tech.metal_layers_) {
+    writer.Write(static_cast<int>(layer_ptr - tech.layers_.data()));
+  }
+}
+
+void Snapshot::ReadTech(SnapshotReader &reader, Tech &tech) {
+  PhyDBExpects(reader.Read<uint32_t>() == kSnapshotTechTag,
+               "Snapshot file is corrupted, cannot find Tech");
+  tech.version_ = reader.ReadString();
+  tech.bus_bit_char_ = reader.ReadString();
+  tech.divier_char_ = reader.ReadString();
+  tech.clearance_measure_ = reader.ReadString();
+  reader.Read(tech.manufacturing_grid_);
+  reader.Read(tech.database_micron_);
+  tech.lef_name_ = reader.ReadString();
+
+  std::size_t num_sites = reader.ReadSize();
+  tech.sites_.reserve(num_sites);
+  for (std::size_t i = 0; i < num_sites; ++i) {
+    std::string name = reader.ReadString();
+    auto site_class = reader.Read<SiteClass>();
+    auto width = reader.Read<double>();
+    auto height = reader.Read<double>();
+    auto symmetry = reader.Read<Symmetry>();
+    Site &site = tech.sites_.emplace_back(name, site_class, width, height);
+    site.SetSymmetry(
+        symmetry.GetXSymmetry(),
+        symmetry.GetYSymmetry(),
+        symmetry.GetR90Symmetry()
+    );
+  }
+  reader.ReadNameMap(tech.site_2_id_);
+
+  // layers own their technology configuration, so they must not be relocated
+  std::size_t num_layers = reader.ReadSize();
+  tech.layers_.reserve(num_layers);
+  for (std::size_t i = 0; i < num_layers; ++i) {
+    ReadLayer(reader, tech);
+  }
+  reader.ReadNameMap(tech.layer_2_id_);
+
+  std::size_t num_macros = reader.ReadSize();
+  tech.macros_.resize(num_macros);
+  tech.macro_2_id_.reserve(num_macros);
+  for (std::size_t i = 0; i < num_macros; ++i) {
+    Macro &macro = tech.macros_[i];
+    ReadMacro(reader, macro);
+    tech.macro_2_id_.emplace(*macro.name_, static_cast<MacroId>(i));
+  }
+
+  std::size_t num_vias = reader.ReadSize();
+  tech.vias_.reserve(num_vias);
+  for (std::size_t i = 0; i < num_vias; ++i) {
+    LefVia &via = tech.vias_.emplace_back(reader.ReadString());
+    reader.Read(via.is_default_);
+    ReadLayerRects(reader, via.layer_rects_);
+  }
+  reader.ReadNameMap(tech.via_2_id_);
+
+  std::size_t num_via_rules = reader.ReadSize();
+  tech.via_rule_generates_.reserve(num_via_rules);
+  for (std::size_t i = 0; i < num_via_rules; ++i) {
+    auto &via_rule = tech.via_rule_generates_.emplace_back(reader.ReadString());
+    reader.Read(via_rule.is_default_);
+    for (auto &via_rule_layer: via_rule.layers_) {
+      via_rule_layer.layer_name_ = reader.ReadString();
+      reader.Read(via_rule_layer.rect_);
+      reader.Read(via_rule_layer.spacing_);
+      reader.Read(via_rule_layer.enclosure_);
+    }
+  }
+  reader.ReadNameMap(tech.via_rule_generate_2_id_);
+
+  reader.Read(tech.is_placement_grid_set_);
+  reader.Read(tech.placement_grid_value_x_);
+  reader.Read(tech.placement_grid_value_y_);
+
+  reader.Read(tech.is_n_well_layer_set_);
+  reader.Read(tech.is_p_well_layer_set_);
+  for (WellLayer **well_layer_ptr: {&tech.n_layer_ptr_, &tech.p_layer_ptr_}) {
+    if (reader.Read<bool>()) {
+      auto width = reader.Read<double>();
+      auto spacing = reader.Read<double>();
+      auto op_spacing = reader.Read<double>();
+      auto max_plug_dist = reader.Read<double>();
+      auto overhang = reader.Read<double>();
+      delete *well_layer_ptr;
+      *well_layer_ptr = new WellLayer(
+          width,
+          spacing,
+          op_spacing,
+          max_plug_dist,
+          overhang
+      );
+    }
+  }
+  reader.Read(tech.same_diff_spacing_);
+  reader.Read(tech.any_diff_spacing_);
+
+  std::size_t num_wells = reader.ReadSize();
+  for (std::size_t i = 0; i < num_wells; ++i) {
+    auto macro_id = reader.Read<int>();
+    PhyDBExpects(
+        macro_id >= 0 && macro_id < static_cast<int>(tech.macros_.size()),
+        "Snapshot file is corrupted, bad macro id " << macro_id
+    );
+    MacroWell &well = tech.wells_.emplace_back(macro_id);
+    reader.Read(well.is_n_set_);
+    reader.Read(well.is_p_set_);
+    reader.Read(well.n_rect_);
+    reader.Read(well.p_rect_);
+    reader.Read(well.p_n_edge_);
+    if (reader.Read<bool>()) {
+      tech.macros_[macro_id].SetWellPtr(&well);
+    }
+  }
+
+  reader.Read(tech.tech_config_.is_diagmodel_on_);
+  reader.Read(tech.tech_config_.layer_count_);
+  reader.Read(tech.tech_config_.corner_count_);
+  reader.ReadVector(tech.tech_config_.data_rate_table_);
+
+  std::size_t num_metal_layers = reader.ReadSize();
+  tech.metal_layers_.reserve(num_metal_layers);
+  for (std::size_t i = 0; i < num_metal_layers; ++i) {
+    auto layer_id = reader.Read<int>();
+    PhyDBExpects(
+        layer_id >= 0 && layer_id < static_cast<int>(tech.layers_.size()),
+        "Snapshot file is corrupted, bad layer id " << layer_id
+    );
+    tech.metal_layers_.push_back(&tech.layers_[layer_id]);
+  }
+}
+
+/****
+ * @brief Resize a list of objects holding geometry to a given size, creating
+ * the objects with the geometry allocator of a design. A plain resize()
+ * would allocate their geometry on the heap.
+ */
+template<typename T>
+static void ResizeInArena(
+    std::vector<T> &objects,
+    std::size_t size,
+    Design &design
+) {
+  objects.clear();
+  objects.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    objects.emplace_back(design.GetGeometryAllocator());
+  }
+}
+
+void Snapshot::WritePath(SnapshotWriter &writer, Path &path) {
+  writer.WriteString(*path.layer_name_);
+  writer.Write(path.layer_id_);
+  writer.Write(path.width_);
+  writer.WriteString(path.shape_);
+  writer.WriteString(path.via_name_);
+  writer.Write(path.via_num_x_);
+  writer.Write(path.via_num_y_);
+  writer.Write(path.via_step_x_);
+  writer.Write(path.via_step_y_);
+  writer.Write(path.via_rect_);
+  writer.WriteVector(path.routing_points_);
+}
+
+void Snapshot::ReadPath(SnapshotReader &reader, Path &path) {
+  path.layer_name_ = &InternName(reader.ReadStringView());
+  reader.Read(path.layer_id_);
+  reader.Read(path.width_);
+  path.shape_ = reader.ReadString();
+  path.via_name_ = reader.ReadString();
+  reader.Read(path.via_num_x_);
+  reader.Read(path.via_num_y_);
+  reader.Read(path.via_step_x_);
+  reader.Read(path.via_step_y_);
+  reader.Read(path.via_rect_);
+  reader.ReadVector(path.routing_points_);
+}
+
+void Snapshot::WriteSpecialMacroRectLayout(
+    SnapshotWriter &writer,
+    SpecialMacroRectLayout *layout
+) {
+  writer.Write(layout != nullptr);
+  if (layout == nullptr) return;
+  writer.Write(layout->macro_id_);
+  writer.Write(layout->bbox_);
+  writer.Write<uint64_t>(layout->rects_.size());
+  for (auto &rect: layout->rects_) {
+    writer.WriteString(rect.SignalName());
+    writer.WriteString(rect.LayerName());
+    writer.Write(rect.Rect());
+  }
+}
+
+SpecialMacroRectLayout *Snapshot::ReadSpecialMacroRectLayout(
+    SnapshotReader &reader,
+    std::size_t num_macros
+) {
+  if (!reader.Read<bool>()) return nullptr;
+  auto macro_id = reader.Read<MacroId>();
+  PhyDBExpects(
+      macro_id >= 0 && macro_id < static_cast<MacroId>(num_macros),
+      "Snapshot file is corrupted, bad macro id " << macro_id
+  );
+  auto bbox = reader.Read<Rect2D<int>>();
+  auto *layout = new SpecialMacroRectLayout(
+      macro_id,
+      bbox.LLX(),
+      bbox.LLY(),
+      bbox.URX(),
+      bbox.URY()
+  );
+  std::size_t num_rects = reader.ReadSize();
+  layout->rects_.reserve(num_rects);
+  for (std::size_t i = 0; i < num_rects; ++i) {
+    std::string signal_name = reader.ReadString();
+    std::string layer_name = reader.ReadString();
+    auto rect = reader.Read<Rect2D<int>>();
+    layout->AddRectSignalLayer(
+        signal_name,
+        layer_name,
+        rect.LLX(),
+        rect.LLY(),
+        rect.URX(),
+        rect.URY()
+    );
+  }
+  return layout;
+}
+
+void Snapshot::WriteDesign(SnapshotWriter &writer, Design &design, Tech &tech) {
+  // a snapshot does not refer to the DEF file, so everything is loaded
+  design.LoadLazySections();
+  writer.Write(kSnapshotDesignTag);
+  writer.WriteString(design.name_);
+  writer.Write(design.version_);
+  writer.WriteString(design.divider_char_);
+  writer.WriteString(design.bus_bit_char_);
+  writer.Write(design.die_area_);
+  writer.Write(design.unit_distance_micron_);
+  writer.WriteString(design.def_name_);
+
+  writer.Write<uint64_t>(design.rows_.size());
+  for (auto &row: design.rows_) {
+    writer.WriteString(row.name_);
+    writer.Write(row.site_id_);
+    writer.Write(row.orient_);
+    writer.Write(row.orig_x_);
+    writer.Write(row.orig_y_);
+    writer.Write(row.num_x_);
+    writer.Write(row.num_y_);
+    writer.Write(row.step_x_);
+    writer.Write(row.step_y_);
+  }
+  writer.WriteNameSet(design.row_set_);
+
+  writer.Write<uint64_t>(design.tracks_.size());
+  for (auto &track: design.tracks_) {
+    writer.Write(track.direction_);
+    writer.Write(track.start_);
+    writer.Write(track.n_tracks_);
+    writer.Write(track.step_);
+    writer.WriteStringVector(track.layer_names_);
+    writer.WriteVector(track.layer_ids_);
+  }
+  writer.WriteNameMap(design.layer_name_2_trackid_);
+
+  writer.WriteVector(design.gcell_grids_);
+
+  writer.Write<uint64_t>(design.components_.size());
+  for (auto &component: design.components_) {
+    writer.WriteString(*component.name_);
+    writer.Write(component.macro_id_);
+    writer.Write(component.id_);
+    writer.Write(component.source_);
+    writer.Write(component.place_status_);
+    writer.Write(component.location_);
+    writer.Write(component.orient_);
+    writer.Write(component.weight_);
+  }
+  writer.WriteNameMap(design.component_2_id_);
+
+  writer.Write<uint64_t>(design.iopins_.size());
+  for (auto &iopin: design.iopins_) {
+    writer.WriteString(*iopin.name_);
+    writer.Write(iopin.id_);
+    writer.Write(iopin.net_id_);
+    writer.Write(iopin.direction_);
+    writer.Write(iopin.use_);
+    writer.WriteString(*iopin.layer_name_);
+    writer.Write(iopin.layer_id_);
+    writer.Write(iopin.rect_);
+    writer.Write(iopin.location_);
+    writer.Write(iopin.orient_);
+    writer.Write(iopin.place_status_);
+  }
+  writer.WriteNameMap(design.iopin_2_id_);
+
+  writer.Write<uint64_t>(design.nets_.size());
+  for (auto &net: design.nets_) {
+    writer.WriteString(*net.name_);
+    writer.Write(net.use_);
+    writer.Write(net.weight_);
+    writer.WriteVector(net.pins_);
+    writer.WriteVector(net.iopins_);
+    writer.WriteVector(net.guides_);
+    writer.Write<uint64_t>(net.paths_.size());
+    for (auto &path: net.paths_) {
+      WritePath(writer, path);
+    }
+    writer.Write(net.is_driver_io_pin_);
+    writer.Write(net.driver_pin_id_);
+  }
+  writer.WriteNameMap(design.net_2_id_);
+
+  NetWireStore &net_wires = design.net_wires_;
+  writer.WriteVector(net_wires.net_ids_);
+  writer.WriteVector(net_wires.layer_ids_);
+  writer.WriteVector(net_wires.x0_);
+  writer.WriteVector(net_wires.y0_);
+  writer.WriteVector(net_wires.x1_);
+  writer.WriteVector(net_wires.y1_);
+  writer.WriteVector(net_wires.widths_);
+  writer.WriteVector(net_wires.via_ids_);
+  writer.Write<uint64_t>(net_wires.via_names_.size());
+  for (auto *via_name: net_wires.via_names_) {
+    writer.WriteString(*via_name);
+  }
+  writer.Write(net_wires.is_grouped_);
+
+  writer.Write<uint64_t>(design.snets_.size());
+  for (auto &snet: design.snets_) {
+    writer.WriteString(snet.name_);
+    writer.Write(snet.use_);
+    writer.Write<uint64_t>(snet.paths_.size());
+    for (auto &path: snet.paths_) {
+      WritePath(writer, path);
+    }
+    writer.Write<uint64_t>(snet.polygons_.size());
+    for (auto &polygon: snet.polygons_) {
+      writer.WriteString(*polygon.layer_name_);
+      writer.Write(polygon.layer_id_);
+      writer.WriteVector(polygon.routing_points_);
+    }
+  }
+  writer.WriteNameMap(design.snet_2_id_);
+
+  writer.Write<uint64_t>(design.vias_.size());
+  for (auto &via: design.vias_) {
+    writer.WriteString(via.name_);
+    writer.WriteString(via.via_rule_name_);
+    writer.Write(via.cut_size_);
+    for (auto &layer_name: via.layers_) {
+      writer.WriteString(layer_name);
+    }
+    writer.Write(via.cut_spacing_);
+    writer.Write(via.bot_enc_);
+    writer.Write(via.top_enc_);
+    writer.Write(via.num_cut_rows_);
+    writer.Write(via.num_cut_cols_);
+    writer.Write(via.origin_);
+    writer.Write(via.bot_offset_);
+    writer.Write(via.top_offset_);
+    writer.Write<uint64_t>(via.rect2d_layers.size());
+    for (auto &rect2d_layer: via.rect2d_layers) {
+      writer.WriteString(rect2d_layer.layer);
+      writer.Write(static_cast<Rect2D<int> const &>(rect2d_layer));
+    }
+    writer.WriteString(via.pattern_);
+  }
+  writer.WriteNameMap(design.def_via_2_id_);
+  writer.WriteNameMap(design.via_2_id_);
+
+  writer.Write<uint64_t>(design.cluster_cols_.size());
+  for (auto &cluster_col: design.cluster_cols_) {
+    writer.WriteString(cluster_col.name_);
+    writer.WriteString(cluster_col.bot_signal_);
+    writer.Write(cluster_col.lx_);
+    writer.Write(cluster_col.ux_);
+    writer.WriteVector(cluster_col.ly_);
+    writer.WriteVector(cluster_col.uy_);
+  }
+
+  writer.Write<uint64_t>(design.blockages_.size());
+  for (auto &blockage: design.blockages_) {
+    int layer_id = -1;
+    if (blockage.layer_ptr_ != nullptr) {
+      layer_id = static_cast<int>(blockage.layer_ptr_ - tech.layers_.data());
+    }
+    writer.Write(layer_id);
+    int comp_id = -1;
+    if (blockage.component_ptr_ != nullptr) {
+      comp_id = blockage.component_ptr_->GetId();
+    }
+    writer.Write(comp_id);
+    writer.Write(blockage.is_slots_);
+    writer.Write(blockage.is_fills_);
+    writer.Write(blockage.is_pushdown_);
+    writer.Write(blockage.is_exceptpgnet_);
+    writer.Write(blockage.min_spacing_);
+    writer.Write(blockage.effective_width_);
+    writer.Write(blockage.mask_num_);
+    writer.Write(blockage.is_placement_);
+    writer.Write(blockage.is_soft_);
+    writer.Write(blockage.max_density_);
+    writer.WriteVector(blockage.rects_);
+    writer.Write<uint64_t>(blockage.polygons_.size());
+    for (auto &polygon: blockage.polygons_) {
+      writer.WriteVector(polygon.GetPointsRef());
+    }
+  }
+
+  WriteSpecialMacroRectLayout(writer, design.plus_filling_);
+  WriteSpecialMacroRectLayout(writer, design.well_filling_);
+}
+
+void Snapshot::ReadDesign(SnapshotReader &reader, Design &design, Tech &tech) {
+  PhyDBExpects(reader.Read<uint32_t>() == kSnapshotDesignTag,
+               "Snapshot file is corrupted, cannot find Design");
+  design.name_ = reader.ReadString();
+  reader.Read(design.version_);
+  design.divider_char_ = reader.ReadString();
+  design.bus_bit_char_ = reader.ReadString();
+  reader.Read(design.die_area_);
+  reader.Read(design.unit_distance_micron_);
+  design.def_name_ = reader.ReadString();
+
+  design.rows_.resize(reader.ReadSize());
+  for (auto &row: design.rows_) {
+    row.name_ = reader.ReadString();
+    reader.Read(row.site_id_);
+    reader.Read(row.orient_);
+    reader.Read(row.orig_x_);
+    reader.Read(row.orig_y_);
+    reader.Read(row.num_x_);
+    reader.Read(row.num_y_);
+    reader.Read(row.step_x_);
+    reader.Read(row.step_y_);
+  }
+  reader.ReadNameSet(design.row_set_);
+
+  design.tracks_.resize(reader.ReadSize());
+  for (auto &track: design.tracks_) {
+    reader.Read(track.direction_);
+    reader.Read(track.start_);
+    reader.Read(track.n_tracks_);
+    reader.Read(track.step_);
+    reader.ReadStringVector(track.layer_names_);
+    reader.ReadVector(track.layer_ids_);
+  }
+  reader.ReadNameMap(design.layer_name_2_trackid_);
+
+  reader.ReadVector(design.gcell_grids_);
+
+  design.components_.resize(reader.ReadSize());
+  for (auto &component: design.components_) {
+    component.name_ = &InternName(reader.ReadStringView());
+    reader.Read(component.macro_id_);
+    PhyDBExpects(
+        component.macro_id_ >= 0
+            && component.macro_id_ < static_cast<MacroId>(tech.macros_.size()),
+        "Snapshot file is corrupted, bad macro id " << component.macro_id_
+    );
+    reader.Read(component.id_);
+    reader.Read(component.source_);
+    reader.Read(component.place_status_);
+    reader.Read(component.location_);
+    reader.Read(component.orient_);
+    reader.Read(component.weight_);
+    component.placement_tracker_ptr_ = &design.placement_tracker_;
+    component.tech_ptr_ = &tech;
+  }
+  design.placement_tracker_.SetComponentCount(design.components_.size());
+  reader.ReadNameMap(design.component_2_id_);
+
+  design.iopins_.resize(reader.ReadSize());
+  for (auto &iopin: design.iopins_) {
+    iopin.name_ = &InternName(reader.ReadStringView());
+    reader.Read(iopin.id_);
+    reader.Read(iopin.net_id_);
+    reader.Read(iopin.direction_);
+    reader.Read(iopin.use_);
+    iopin.layer_name_ = &InternName(reader.ReadStringView());
+    reader.Read(iopin.layer_id_);
+    reader.Read(iopin.rect_);
+    reader.Read(iopin.location_);
+    reader.Read(iopin.orient_);
+    reader.Read(iopin.place_status_);
+  }
+  reader.ReadNameMap(design.iopin_2_id_);
+
+  ResizeInArena(design.nets_, reader.ReadSize(), design);
+  for (auto &net: design.nets_) {
+    net.name_ = &InternName(reader.ReadStringView());
+    reader.Read(net.use_);
+    reader.Read(net.weight_);
+    reader.ReadVector(net.pins_);
+    reader.ReadVector(net.iopins_);
+    reader.ReadVector(net.guides_);
+    net.paths_.resize(reader.ReadSize());
+    for (auto &path: net.paths_) {
+      ReadPath(reader, path);
+    }
+    reader.Read(net.is_driver_io_pin_);
+    reader.Read(net.driver_pin_id_);
+  }
+  reader.ReadNameMap(design.net_2_id_);
+
+  NetWireStore &net_wires = design.net_wires_;
+  net_wires.Clear();
+  reader.ReadVector(net_wires.net_ids_);
+  reader.ReadVector(net_wires.layer_ids_);
+  reader.ReadVector(net_wires.x0_);
+  reader.ReadVector(net_wires.y0_);
+  reader.ReadVector(net_wires.x1_);
+  reader.ReadVector(net_wires.y1_);
+  reader.ReadVector(net_wires.widths_);
+  reader.ReadVector(net_wires.via_ids_);
+  std::size_t num_via_names = reader.ReadSize();
+  for (std::size_t i = 0; i < num_via_names; ++i) {
+    net_wires.AddViaName(reader.ReadStringView());
+  }
+  reader.Read(net_wires.is_grouped_);
+
+  ResizeInArena(design.snets_, reader.ReadSize(), design);
+  for (auto &snet: design.snets_) {
+    snet.name_ = reader.ReadString();
+    reader.Read(snet.use_);
+    snet.paths_.resize(reader.ReadSize());
+    for (auto &path: snet.paths_) {
+      ReadPath(reader, path);
+    }
+    snet.polygons_.resize(reader.ReadSize());
+    for (auto &polygon: snet.polygons_) {
+      polygon.layer_name_ = &InternName(reader.ReadStringView());
+      reader.Read(polygon.layer_id_);
+      reader.ReadVector(polygon.routing_points_);
+    }
+  }
+  reader.ReadNameMap(design.snet_2_id_);
+
+  design.vias_.resize(reader.ReadSize());
+  for (auto &via: design.vias_) {
+    via.name_ = reader.ReadString();
+    via.via_rule_name_ = reader.ReadString();
+    reader.Read(via.cut_size_);
+    for (auto &layer_name: via.layers_) {
+      layer_name = reader.ReadString();
+    }
+    reader.Read(via.cut_spacing_);
+    reader.Read(via.bot_enc_);
+    reader.Read(via.top_enc_);
+    reader.Read(via.num_cut_rows_);
+    reader.Read(via.num_cut_cols_);
+    reader.Read(via.origin_);
+    reader.Read(via.bot_offset_);
+    reader.Read(via.top_offset_);
+    via.rect2d_layers.resize(reader.ReadSize());
+    for (auto &rect2d_layer: via.rect2d_layers) {
+      rect2d_layer.layer = reader.ReadString();
+      static_cast<Rect2D<int> &>(rect2d_layer) = reader.Read<Rect2D<int>>();
+    }
+    via.pattern_ = reader.ReadString();
+  }
+  reader.ReadNameMap(design.def_via_2_id_);
+  reader.ReadNameMap(design.via_2_id_);
+
+  design.cluster_cols_.resize(reader.ReadSize());
+  for (auto &cluster_col: design.cluster_cols_) {
+    cluster_col.name_ = reader.ReadString();
+    cluster_col.bot_signal_ = reader.ReadString();
+    reader.Read(cluster_col.lx_);
+    reader.Read(cluster_col.ux_);
+    reader.ReadVector(cluster_col.ly_);
+    reader.ReadVector(cluster_col.uy_);
+  }
+
+  ResizeInArena(design.blockages_, reader.ReadSize(), design);
+  for (auto &blockage: design.blockages_) {
+    auto layer_id = reader.Read<int>();
+    if (layer_id >= 0) {
+      PhyDBExpects(
+          layer_id < static_cast<int>(tech.layers_.size()),
+          "Snapshot file is corrupted, bad layer id " << layer_id
+      );
+      blockage.layer_ptr_ = &tech.layers_[layer_id];
+    }
+    auto comp_id = reader.Read<int>();
+    if (comp_id >= 0) {
+      PhyDBExpects(
+          comp_id < static_cast<int>(design.components_.size()),
+          "Snapshot file is corrupted, bad component id " << comp_id
+      );
+      blockage.component_ptr_ = &design.components_[comp_id];
+    }
+    reader.Read(blockage.is_slots_);
+    reader.Read(blockage.is_fills_);
+    reader.Read(blockage.is_pushdown_);
+    reader.Read(blockage.is_exceptpgnet_);
+    reader.Read(blockage.min_spacing_);
+    reader.Read(blockage.effective_width_);
+    reader.Read(blockage.mask_num_);
+    reader.Read(blockage.is_placement_);
+    reader.Read(blockage.is_soft_);
+    reader.Read(blockage.max_density_);
+    reader.ReadVector(blockage.rects_);
+    blockage.polygons_.resize(reader.ReadSize());
+    for (auto &polygon: blockage.polygons_) {
+      reader.ReadVector(polygon.GetPointsRef());
+    }
+  }
+
+  delete design.plus_filling_;
+  design.plus_filling_ = ReadSpecialMacroRectLayout(
+      reader, tech.macros_.size()
+  );
+  delete design.well_filling_;
+  design.well_filling_ = ReadSpecialMacroRectLayout(
+      reader, tech.macros_.size()
+  );
+}
+
+/****
+ * @brief Saves Tech and Design of a PhyDB to a binary snapshot file.
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database
+ * @param file_name: the snapshot file name
+ */
+void Snapshot::Save(PhyDB *phy_db_ptr, std::string const &file_name) {
+  SnapshotWriter writer(file_name);
+  writer.WriteBytes(kSnapshotMagic, sizeof(kSnapshotMagic));
+  writer.Write(kSnapshotVersion);
+  writer.Write(kSnapshotByteOrderMark);
+  WriteTech(writer, phy_db_ptr->tech());
+  WriteDesign(writer, phy_db_ptr->design(), phy_db_ptr->tech());
+}
+
+/****
+ * @brief Loads a binary snapshot file into an empty PhyDB.
+ *
+ * @param phy_db_ptr: the pointer to the PhyDB database, it must be empty
+ * @param file_name: the snapshot file name
+ */
+void Snapshot::Load(PhyDB *phy_db_ptr, std::string const &file_name) {
+  Tech &tech = phy_db_ptr->tech();
+  Design &design = phy_db_ptr->design();
+  PhyDBExpects(
+      tech.layers_.empty() && tech.macros_.empty()
+          && design.components_.empty() && design.nets_.empty(),
+      "A snapshot can only be loaded into an empty PhyDB"
+  );
+
+  SnapshotReader reader(file_name);
+  const char *magic = reader.ReadBytes(sizeof(kSnapshotMagic));
+  PhyDBExpects(
+      std::memcmp(magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0,
+      file_name << " is not a PhyDB snapshot file"
+  );
+  auto version = reader.Read<uint32_t>();
+  PhyDBExpects(
+      version == kSnapshotVersion,
+      "Unsupported snapshot version " << version
+                                      << ", expect " << kSnapshotVersion
+  );
+  PhyDBExpects(
+      reader.Read<uint32_t>() == kSnapshotByteOrderMark,
+      "Snapshot file was saved on a machine with a different byte order"
+  );
+  ReadTech(reader, tech);
+  ReadDesign(reader, design, tech);
+  PhyDBExpects(reader.IsEnd(), "Unexpected data at the end of snapshot file");
+  // connectivity built before loading does not cover the loaded nets
+  design.InvalidateNetConnectivity();
+}
+
+/****
+ * @brief Saves sites and macros parsed from a cell library LEF file. The
+ * hash and the size of the LEF file are saved in the header, so that a stale
+ * file can be detected.
+ *
+ * @param library: the parsed library
+ * @param lef_file_hash: the hash of the LEF file
+ * @param lef_file_size: the size of the LEF file
+ * @param file_name: the output file name
+ */
+void Snapshot::SaveMacroLibrary(
+    LefMacroLibrary &library,
+    uint64_t lef_file_hash,
+    uint64_t lef_file_size,
+    std::string const &file_name
+) {
+  SnapshotWriter writer(file_name);
+  writer.WriteBytes(kMacroLibraryMagic, sizeof(kMacroLibraryMagic));
+  writer.Write(kSnapshotVersion);
+  writer.Write(kSnapshotByteOrderMark);
+  writer.Write(lef_file_hash);
+  writer.Write(lef_file_size);
+  writer.Write(library.database_micron);
+  writer.Write(library.manufacturing_grid);
+  writer.Write<uint64_t>(library.sites.size());
+  for (auto &site: library.sites) {
+    writer.WriteString(site.GetName());
+    writer.Write(site.GetClass());
+    writer.Write(site.GetWidth());
+    writer.Write(site.GetHeight());
+    writer.Write(site.GetSymmetry());
+  }
+  writer.Write<uint64_t>(library.macros.size());
+  for (auto &macro: library.macros) {
+    WriteMacro(writer, macro);
+  }
+}
+
+/****
+ * @brief Loads sites and macros saved by SaveMacroLibrary().
+ *
+ * @param library: the library to store the result
+ * @param lef_file_hash: the hash of the LEF file
+ * @param lef_file_size: the size of the LEF file
+ * @param file_name: the input file name
+ * @return false if the file is saved by another version of PhyDB or for
+ * another LEF file, the library is not touched in this case
+ */
+bool Snapshot::LoadMacroLibrary(
+    LefMacroLibrary &library,
+    uint64_t lef_file_hash,
+    uint64_t lef_file_size,
+    std::string const &file_name
+) {
+  SnapshotReader reader(file_name);
+  const char *magic = reader.ReadBytes(sizeof(kMacroLibraryMagic));
+  bool is_valid =
+      std::memcmp(magic, kMacroLibraryMagic, sizeof(kMacroLibraryMagic)) == 0
+          && reader.Read<uint32_t>() == kSnapshotVersion
+          && reader.Read<uint32_t>() == kSnapshotByteOrderMark
+          && reader.Read<uint64_t>() == lef_file_hash
+          && reader.Read<uint64_t>() == lef_file_size;
+  if (!is_valid) return false;
+
+  reader.Read(library.database_micron);
+  reader.Read(library.manufacturing_grid);
+  library.sites.resize(reader.ReadSize());
+  for (auto &site: library.sites) {
+    site.SetName(reader.ReadString());
+    site.SetClass(reader.Read<SiteClass>());
+    site.SetWidth(reader.Read<double>());
+    site.SetHeight(reader.Read<double>());
+    auto symmetry = reader.Read<Symmetry>();
+    site.SetSymmetry(
+        symmetry.GetXSymmetry(),
+        symmetry.GetYSymmetry(),
+        symmetry.GetR90Symmetry()
+    );
+  }
+  library.macros.resize(reader.ReadSize());
+  for (auto &macro: library.macros) {
+    ReadMacro(reader, macro);
+  }
+  PhyDBExpects(reader.IsEnd(), "Unexpected data at the end of " << file_name);
+  return true;
+}
+
+}
@@ -0,0 +1,224 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_SNAPSHOT_H_
+#define PHYDB_SNAPSHOT_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "phydb/common/logging.h"
+#include "phydb/common/mappedfile.h"
+#include "phydb/common/symboltable.h"
+
+namespace phydb {
+
+class PhyDB;
+class Tech;
+class Design;
+class Layer;
+class Macro;
+class Path;
+struct SpecialMacroRectLayout;
+struct LefMacroLibrary;
+
+/****
+ * @brief Whether the bytes of a T are fully determined by its value, which
+ * is what makes saving the same database twice give identical files. Types
+ * with padding have to be written field by field. Floating point numbers
+ * are accepted, and structs of them need a specialization which checks that
+ * they have no padding.
+ */
+template<typename T>
+struct IsSnapshotPod : std::integral_constant<
+    bool,
+    std::has_unique_object_representations<T>::value
+        || std::is_floating_point<T>::value
+> {};
+
+/****
+ * @brief A buffered binary writer for PhyDB snapshots.
+ *
+ * Values without padding are written as raw bytes in the native byte
+ * order, strings and vectors are prefixed by their sizes.
+ */
+class SnapshotWriter {
+ public:
+  explicit SnapshotWriter(std::string const &file_name);
+  ~SnapshotWriter();
+
+  void WriteBytes(const void *data, std::size_t size);
+
+  template<typename T>
+  void Write(T const &value) {
+    static_assert(IsSnapshotPod<T>::value,
+                  "only types without padding can be written directly");
+    WriteBytes(&value, sizeof(T));
+  }
+
+  void WriteString(std::string_view str);
+
+  template<typename T, typename Allocator>
+  void WriteVector(std::vector<T, Allocator> const &vec) {
+    static_assert(
+        IsSnapshotPod<T>::value,
+        "only vectors of types without padding can be written directly"
+    );
+    Write<uint64_t>(vec.size());
+    WriteBytes(vec.data(), vec.size() * sizeof(T));
+  }
+
+  void WriteStringVector(std::vector<std::string> const &vec);
+  void WriteNameMap(std::unordered_map<std::string, int> const &name_map);
+  void WriteNameMap(
+      std::unordered_map<std::string_view, int> const &name_map
+  );
+  void WriteNameSet(std::unordered_set<std::string> const &name_set);
+
+ private:
+  std::ofstream ost_;
+  std::vector<char> buffer_;
+  void Flush();
+  void WriteNameEntries(std::vector<std::pair<int, std::string_view>> &entries);
+};
+
+/****
+ * @brief A binary reader for PhyDB snapshots, the file is memory-mapped and
+ * values are copied out of the mapping directly.
+ */
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(std::string const &file_name);
+
+  const char *ReadBytes(std::size_t size);
+
+  template<typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable types can be read directly");
+    T value;
+    std::memcpy(static_cast<void *>(&value), ReadBytes(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  template<typename T>
+  void Read(T &value) {
+    value = Read<T>();
+  }
+
+  std::string ReadString();
+  std::string_view ReadStringView();
+
+  template<typename T, typename Allocator>
+  void ReadVector(std::vector<T, Allocator> &vec) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "only vectors of trivially copyable types can be read directly"
+    );
+    std::size_t size = ReadSize();
+    const char *data = ReadBytes(size * sizeof(T));
+    vec.resize(size);
+    if (size > 0) {
+      std::memcpy(static_cast<void *>(vec.data()), data, size * sizeof(T));
+    }
+  }
+
+  std::size_t ReadSize();
+  void ReadStringVector(std::vector<std::string> &vec);
+  void ReadNameMap(std::unordered_map<std::string, int> &name_map);
+  void ReadNameMap(std::unordered_map<std::string_view, int> &name_map);
+  void ReadNameSet(std::unordered_set<std::string> &name_set);
+
+  bool IsEnd() const { return pos_ == file_.Size(); }
+
+ private:
+  MappedFile file_;
+  std::size_t pos_ = 0;
+};
+
+/****
+ * @brief Saves and loads the whole PhyDB in a native binary format.
+ *
+ * A snapshot contains Tech (sites, layers with spacing rules and technology
+ * configuration corners, macros, wells, vias) and Design (rows, tracks,
+ * components, IO pins, nets and their routed wires, special nets, vias,
+ * blockages, cluster columns, N/P-well and Nplus/Pplus filling). Pointers
+ * are stored as ids and fixed up during loading. Timing related information,
+ * such as ACT pointers and callbacks, is not saved because it is only valid
+ * in a running process.
+ *
+ * The format uses the native byte order and object layout, so a snapshot is
+ * only guaranteed to be readable by the same build of PhyDB. The header
+ * contains a version number, which needs to be bumped whenever the data model
+ * changes.
+ *
+ * Macros of a cell library LEF file can also be saved on their own, which is
+ * used as the cache of the parallel macro LEF reader.
+ */
+class Snapshot {
+ public:
+  static void Save(PhyDB *phy_db_ptr, std::string const &file_name);
+  static void Load(PhyDB *phy_db_ptr, std::string const &file_name);
+  static void SaveMacroLibrary(
+      LefMacroLibrary &library,
+      uint64_t lef_file_hash,
+      uint64_t lef_file_size,
+      std::string const &file_name
+  );
+  static bool LoadMacroLibrary(
+      LefMacroLibrary &library,
+      uint64_t lef_file_hash,
+      uint64_t lef_file_size,
+      std::string const &file_name
+  );
+
+ private:
+  static void WriteTech(SnapshotWriter &writer, Tech &tech);
+  static void ReadTech(SnapshotReader &reader, Tech &tech);
+  static void WriteLayer(SnapshotWriter &writer, Layer &layer);
+  static void ReadLayer(SnapshotReader &reader, Tech &tech);
+  static void WriteMacro(SnapshotWriter &writer, Macro &macro);
+  static void ReadMacro(SnapshotReader &reader, Macro &macro);
+
+  static void WriteDesign(SnapshotWriter &writer, Design &design, Tech &tech);
+  static void ReadDesign(SnapshotReader &reader, Design &design, Tech &tech);
+  static void WritePath(SnapshotWriter &writer, Path &path);
+  static void ReadPath(SnapshotReader &reader, Path &path);
+  static void WriteSpecialMacroRectLayout(
+      SnapshotWriter &writer,
+      SpecialMacroRectLayout *layout
+  );
+  static SpecialMacroRectLayout *ReadSpecialMacroRectLayout(
+      SnapshotReader &reader,
+      std::size_t num_macros
+  );
+};
+
+}
+
+#endif //PHYDB_SNAPSHOT_H_
@@ -23,7 +23,12 @@
 namespace phydb {
 
 void Polygon::SetLayerName(std::string const &layer_name) {
-  layer_name_ = layer_name;
+  layer_name_ = &InternName(layer_name);
+  layer_id_ = -1;
+}
+
+void Polygon::SetLayerId(int layer_id) {
+  layer_id_ = layer_id;
 }
 
 void Polygon::AddRoutingPoint(Point2D<int> p) {
@@ -34,16 +39,20 @@ void Polygon::AddRoutingPoint(int x, int y) {
   routing_points_.emplace_back(x, y);
 }
 
-std::vector<Point2D<int>> &Polygon::GetRoutingPointsRef() {
+GeometryVector<Point2D<int>> &Polygon::GetRoutingPointsRef() {
   return routing_points_;
 }
 
-std::string Polygon::GetLayerName() const {
-  return layer_name_;
+std::string const &Polygon::GetLayerName() const {
+  return *layer_name_;
+}
+
+int Polygon::GetLayerId() const {
+  return layer_id_;
 }
 
 void Polygon::Report() const {
-  std::cout << "POLYGON " << layer_name_ << " ";
+  std::cout << "POLYGON " << *layer_name_ << " ";
   for (auto &point : routing_points_) {
     std::cout << " ( " << point.x << " " << point.y << " ) ";
   }
@@ -51,7 +60,12 @@ void Polygon::Report() const {
 }
 
 void Path::SetLayerName(std::string &layer_name) {
-  layer_name_ = layer_name;
+  layer_name_ = &InternName(layer_name);
+  layer_id_ = -1;
+}
+
+void Path::SetLayerId(int layer_id) {
+  layer_id_ = layer_id;
 }
 
 void Path::SetWidth(int width) {
@@ -66,6 +80,21 @@ void Path::SetViaName(std::string &via_name) {
   via_name_ = via_name;
 }
 
+/****
+ * @brief Turn the via of this path into an array of vias.
+ *
+ * @param num_x: number of columns
+ * @param num_y: number of rows
+ * @param step_x: distance between columns, in DEF database unit
+ * @param step_y: distance between rows, in DEF database unit
+ */
+void Path::SetViaArray(int num_x, int num_y, int step_x, int step_y) {
+  via_num_x_ = num_x;
+  via_num_y_ = num_y;
+  via_step_x_ = step_x;
+  via_step_y_ = step_y;
+}
+
 void Path::SetRect(int lx, int ly, int ux, int uy) {
   via_rect_ = Rect2D<int>(lx, ly, ux, uy);
 }
@@ -82,8 +111,12 @@ void Path::AddRoutingPoint(int x, int y, int ext) {
   routing_points_.emplace_back(x, y, ext);
 }
 
-std::string Path::GetLayerName() const {
-  return layer_name_;
+std::string const &Path::GetLayerName() const {
+  return *layer_name_;
+}
+
+int Path::GetLayerId() const {
+  return layer_id_;
 }
 
 int Path::GetWidth() const {
@@ -98,16 +131,36 @@ std::string Path::GetViaName() const {
   return via_name_;
 }
 
+bool Path::IsViaArray() const {
+  return via_num_x_ != 1 || via_num_y_ != 1;
+}
+
+int Path::GetViaNumX() const {
+  return via_num_x_;
+}
+
+int Path::GetViaNumY() const {
+  return via_num_y_;
+}
+
+int Path::GetViaStepX() const {
+  return via_step_x_;
+}
+
+int Path::GetViaStepY() const {
+  return via_step_y_;
+}
+
 Rect2D<int> Path::GetRect() const {
   return via_rect_;
 }
 
-std::vector<Point3D<int>> &Path::GetRoutingPointsRef() {
+GeometryVector<Point3D<int>> &Path::GetRoutingPointsRef() {
   return routing_points_;
 }
 
 void Path::Report() {
-  std::cout << " NEW " << layer_name_ << " " << width_ << " + SHAPE "
+  std::cout << " NEW " << *layer_name_ << " " << width_ << " + SHAPE "
             << shape_;
 
   for (auto &point : routing_points_) {
@@ -124,6 +177,9 @@ void Path::Report() {
               << via_rect_.ur.x << " " << via_rect_.ur.y << ")";
   if (!via_name_.empty())
     std::cout << via_name_;
+  if (IsViaArray())
+    std::cout << " DO " << via_num_x_ << " BY " << via_num_y_ << " STEP "
+              << via_step_x_ << " " << via_step_y_;
 
   std::cout << "\n";
 }
@@ -164,18 +220,18 @@ SignalUse SNet::GetUse() const {
   return use_;
 }
 
-std::vector<Path> &SNet::GetPathsRef() {
+GeometryVector<Path> &SNet::GetPathsRef() {
   return paths_;
 }
 
-std::vector<Polygon> &SNet::GetPolygonsRef() {
+GeometryVector<Polygon> &SNet::GetPolygonsRef() {
   return polygons_;
 }
 
 void SNet::Report() {
   std::cout << "SNET: " << name_
             << " use: " << SignalUseStr(use_) << "\n";
-  for (auto p : paths_) {
+  for (auto &p : paths_) {
     p.Report();
   }
 }
@@ -26,79 +26,158 @@
 
 #include "datatype.h"
 #include "enumtypes.h"
+#include "phydb/common/arena.h"
 #include "phydb/common/logging.h"
+#include "phydb/common/symboltable.h"
 
 namespace phydb {
 
 class Polygon {
+  friend class Snapshot;
  private:
-  std::string layer_name_;
-  std::vector<Point2D<int>> routing_points_;
+  int layer_id_ = -1; // index in Tech::layers_, -1 if not resolved
+  std::string const *layer_name_ = &InternName("");
+  GeometryVector<Point2D<int>> routing_points_;
 
  public:
-  Polygon() {}
-  Polygon(std::string layer_name) : layer_name_(layer_name) {}
+  // lets containers in an arena pass their allocator on
+  using allocator_type = GeometryAllocator;
 
+  Polygon() {}
+  explicit Polygon(allocator_type alloc) : routing_points_(alloc) {}
+  Polygon(std::string const &layer_name, allocator_type alloc = {})
+      : layer_name_(&InternName(layer_name)), routing_points_(alloc) {}
+  Polygon(Polygon const &other, allocator_type alloc)
+      : layer_id_(other.layer_id_),
+        layer_name_(other.layer_name_),
+        routing_points_(other.routing_points_, alloc) {}
+  Polygon(Polygon &&other, allocator_type alloc)
+      : layer_id_(other.layer_id_),
+        layer_name_(other.layer_name_),
+        routing_points_(std::move(other.routing_points_), alloc) {}
+  Polygon(Polygon const &) = default;
+  Polygon(Polygon &&) = default;
+  Polygon &operator=(Polygon const &) = default;
+  Polygon &operator=(Polygon &&) = default;
+
+  // the layer id becomes unknown until SetLayerId() is called
   void SetLayerName(std::string const &layer_name);
+  void SetLayerId(int layer_id);
   void AddRoutingPoint(Point2D<int> p);
   void AddRoutingPoint(int x, int y);
 
-  std::string GetLayerName() const;
-  std::vector<Point2D<int>> &
-  GetRoutingPointsRef();
+  std::string const &GetLayerName() const;
+  int GetLayerId() const;
+  GeometryVector<Point2D<int>> &GetRoutingPointsRef();
 
   void Report() const;
 
 };
 
 class Path {
+  friend class Snapshot;
  private:
-  std::string layer_name_;
+  int layer_id_ = -1; // index in Tech::layers_, -1 if not resolved
+  std::string const *layer_name_ = &InternName("");
   int width_;
   std::string shape_;
   std::string via_name_;
+  // via array of DO numX BY numY STEP stepX stepY, 1 by 1 for a single via
+  int via_num_x_ = 1;
+  int via_num_y_ = 1;
+  int via_step_x_ = 0;
+  int via_step_y_ = 0;
 
   Rect2D<int> via_rect_;
-  std::vector<Point3D<int>> routing_points_;
+  GeometryVector<Point3D<int>> routing_points_;
 
  public:
+  // lets containers in an arena pass their allocator on
+  using allocator_type = GeometryAllocator;
+
   Path() : width_(0) {}
-  Path(std::string &layer_name, std::string &shape, int width) :
-      layer_name_(layer_name),
+  explicit Path(allocator_type alloc) : width_(0), routing_points_(alloc) {}
+  Path(
+      std::string &layer_name,
+      std::string &shape,
+      int width,
+      allocator_type alloc = {}
+  ) :
+      layer_name_(&InternName(layer_name)),
       width_(width),
-      shape_(shape) {}
-
+      shape_(shape),
+      routing_points_(alloc) {}
+  Path(Path const &other, allocator_type alloc) :
+      layer_id_(other.layer_id_),
+      layer_name_(other.layer_name_),
+      width_(other.width_),
+      shape_(other.shape_),
+      via_name_(other.via_name_),
+      via_num_x_(other.via_num_x_),
+      via_num_y_(other.via_num_y_),
+      via_step_x_(other.via_step_x_),
+      via_step_y_(other.via_step_y_),
+      via_rect_(other.via_rect_),
+      routing_points_(other.routing_points_, alloc) {}
+  Path(Path &&other, allocator_type alloc) :
+      layer_id_(other.layer_id_),
+      layer_name_(other.layer_name_),
+      width_(other.width_),
+      shape_(std::move(other.shape_)),
+      via_name_(std::move(other.via_name_)),
+      via_num_x_(other.via_num_x_),
+      via_num_y_(other.via_num_y_),
+      via_step_x_(other.via_step_x_),
+      via_step_y_(other.via_step_y_),
+      via_rect_(other.via_rect_),
+      routing_points_(std::move(other.routing_points_), alloc) {}
+  Path(Path const &) = default;
+  Path(Path &&) = default;
+  Path &operator=(Path const &) = default;
+  Path &operator=(Path &&) = default;
+
+  // the layer id becomes unknown until SetLayerId() is called
   void SetLayerName(std::string &);
+  void SetLayerId(int layer_id);
   void SetWidth(int);
   void SetShape(std::string &);
   void SetViaName(std::string &);
+  void SetViaArray(int num_x, int num_y, int step_x, int step_y);
   void SetRect(int lx, int ly, int ux, int uy);
   void SetRect(Rect2D<int> rect);
   void AddRoutingPoint(Point3D<int> p);
   void AddRoutingPoint(int x, int y, int ext = -1);
 
-  std::string GetLayerName() const;
+  std::string const &GetLayerName() const;
+  int GetLayerId() const;
   int GetWidth() const;
   std::string GetShape() const;
   std::string GetViaName() const;
+  bool IsViaArray() const;
+  int GetViaNumX() const;
+  int GetViaNumY() const;
+  int GetViaStepX() const;
+  int GetViaStepY() const;
 
   Rect2D<int> GetRect() const;
-  std::vector<Point3D<int>> &
-  GetRoutingPointsRef();
+  GeometryVector<Point3D<int>> &GetRoutingPointsRef();
 
   void Report();
 };
 
 class SNet {
+  friend class Snapshot;
  private:
   std::string name_;
   SignalUse use_; // POWER or GROUND
-  std::vector<Path> paths_;
-  std::vector<Polygon> polygons_;
+  GeometryVector<Path> paths_;
+  GeometryVector<Polygon> polygons_;
  public:
   SNet() {}
+  explicit SNet(GeometryAllocator alloc) : paths_(alloc), polygons_(alloc) {}
   SNet(std::string const &name) : name_(name) {}
-  SNet(std::string const &name, SignalUse use) : name_(name), use_(use) {}
+  SNet(std::string const &name, SignalUse use, GeometryAllocator alloc = {})
+      : name_(name), use_(use), paths_(alloc), polygons_(alloc) {}
 
   void SetName(std::string &);
   void SetUse(SignalUse);
@@ -108,8 +187,8 @@ class SNet {
 
   std::string GetName() const;
   SignalUse GetUse() const;
-  std::vector<Path> &GetPathsRef();
-  std::vector<Polygon> &GetPolygonsRef();
+  GeometryVector<Path> &GetPathsRef();
+  GeometryVector<Polygon> &GetPolygonsRef();
 
   void Report();
 };
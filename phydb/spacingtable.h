@@ -28,6 +28,7 @@
 namespace phydb {
 
 class SpacingTable {
+  friend class Snapshot;
  public:
   SpacingTable() = default;
   SpacingTable(int nC, int nR) : n_col_(nC), n_row_(nR) {
@@ -0,0 +1,356 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "spatialindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "design.h"
+
+namespace phydb {
+
+namespace bgi = boost::geometry::index;
+
+/****
+ * @brief Transform a rectangle in macro coordinates (micron) to a rectangle
+ * in the design (DEF database unit) for a given component placement.
+ */
+static Rect2D<int> MacroRectToDesign(
+    Rect2D<double> const &rect,
+    double width,
+    double height,
+    CompOrient orient,
+    Point2D<int> location,
+    int distance_microns
+) {
+  Point2D<double> ll = rect.ll;
+  Point2D<double> ur = rect.ur;
+  ll.Rotate(orient, width, height);
+  ur.Rotate(orient, width, height);
+  Rect2D<int> box;
+  box.ll.x = location.x
+      + static_cast<int>(std::round(std::min(ll.x, ur.x) * distance_microns));
+  box.ll.y = location.y
+      + static_cast<int>(std::round(std::min(ll.y, ur.y) * distance_microns));
+  box.ur.x = location.x
+      + static_cast<int>(std::round(std::max(ll.x, ur.x) * distance_microns));
+  box.ur.y = location.y
+      + static_cast<int>(std::round(std::max(ll.y, ur.y) * distance_microns));
+  return box;
+}
+
+SpatialIndex::SpatialIndex(Design *design_ptr) : design_ptr_(design_ptr) {}
+
+SpatialIndex::~SpatialIndex() {
+  for (auto &component: design_ptr_->GetComponentsRef()) {
+    if (component.spatial_index_ptr_ == this) {
+      component.spatial_index_ptr_ = nullptr;
+    }
+  }
+}
+
+/****
+ * @brief Bulk-load the index from the current design. Components are hooked
+ * to this index so that later placement changes keep it up to date.
+ */
+void SpatialIndex::Build() {
+  std::vector<Component> &components = design_ptr_->GetComponentsRef();
+  std::vector<IOPin> &iopins = design_ptr_->GetIoPinsRef();
+  component_objects_.assign(components.size(), {});
+  iopin_objects_.assign(iopins.size(), {});
+
+  std::vector<SpatialObject> placement_objects;
+  std::vector<std::vector<SpatialObject>> layer_objects;
+  auto distribute = [&](std::vector<SpatialObject> const &objects) {
+    for (auto &obj: objects) {
+      if (obj.layer_id == kPlacementLayer) {
+        placement_objects.push_back(obj);
+        continue;
+      }
+      if (obj.layer_id >= static_cast<int>(layer_objects.size())) {
+        layer_objects.resize(obj.layer_id + 1);
+      }
+      layer_objects[obj.layer_id].push_back(obj);
+    }
+  };
+
+  for (auto &component: components) {
+    auto &objects = component_objects_[component.GetId()];
+    CollectComponentObjects(component, objects);
+    distribute(objects);
+    component.spatial_index_ptr_ = this;
+  }
+  for (size_t i = 0; i < iopins.size(); ++i) {
+    CollectIoPinObjects(static_cast<int>(i), iopin_objects_[i]);
+    distribute(iopin_objects_[i]);
+  }
+  std::vector<SpatialObject> blockage_objects;
+  CollectBlockageObjects(blockage_objects);
+  distribute(blockage_objects);
+
+  // the range constructor uses STR packing, which is much faster and gives
+  // a better tree than inserting objects one by one
+  placement_tree_ = SpatialRTree(
+      placement_objects.begin(),
+      placement_objects.end()
+  );
+  layer_trees_.clear();
+  layer_trees_.reserve(layer_objects.size());
+  for (auto &objects: layer_objects) {
+    layer_trees_.emplace_back(objects.begin(), objects.end());
+  }
+}
+
+/****
+ * @brief Re-index a component after its location, orientation or placement
+ * status changes. Copies of components which do not live in the design are
+ * ignored.
+ *
+ * @param component: the component in Design::components_
+ */
+void SpatialIndex::UpdateComponent(Component &component) {
+  std::vector<Component> &components = design_ptr_->GetComponentsRef();
+  int id = component.GetId();
+  if (id < 0 || id >= static_cast<int>(components.size())
+      || &components[id] != &component) {
+    return;
+  }
+  if (id >= static_cast<int>(component_objects_.size())) {
+    component_objects_.resize(id + 1);
+  }
+  auto &objects = component_objects_[id];
+  RemoveObjects(objects);
+  objects.clear();
+  CollectComponentObjects(component, objects);
+  InsertObjects(objects);
+  component.spatial_index_ptr_ = this;
+}
+
+/****
+ * @brief Re-index an IO pin after its shape or placement changes.
+ *
+ * @param iopin_id: index of this IO pin
+ */
+void SpatialIndex::UpdateIoPin(int iopin_id) {
+  PhyDBExpects(
+      iopin_id >= 0
+          && iopin_id < static_cast<int>(design_ptr_->GetIoPinsRef().size()),
+      "IO pin id out of range: " << iopin_id
+  );
+  if (iopin_id >= static_cast<int>(iopin_objects_.size())) {
+    iopin_objects_.resize(iopin_id + 1);
+  }
+  auto &objects = iopin_objects_[iopin_id];
+  RemoveObjects(objects);
+  objects.clear();
+  CollectIoPinObjects(iopin_id, objects);
+  InsertObjects(objects);
+}
+
+/****
+ * @brief Find all objects on a layer whose boxes intersect a region.
+ *
+ * @param region: the query region, in DEF database unit
+ * @param result: found objects are appended to this vector
+ * @param layer_id: layer index, or kPlacementLayer for component bounding
+ * boxes and placement blockages
+ */
+void SpatialIndex::QueryRegion(
+    Rect2D<int> const &region,
+    std::vector<SpatialObject> &result,
+    int layer_id
+) const {
+  SpatialRTree const *tree = GetTree(layer_id);
+  if (tree == nullptr) return;
+  tree->query(bgi::intersects(region), std::back_inserter(result));
+}
+
+void SpatialIndex::QueryRegionAllLayers(
+    Rect2D<int> const &region,
+    std::vector<SpatialObject> &result
+) const {
+  QueryRegion(region, result, kPlacementLayer);
+  for (auto &tree: layer_trees_) {
+    tree.query(bgi::intersects(region), std::back_inserter(result));
+  }
+}
+
+/****
+ * @brief Find the k objects on a layer closest to a point.
+ *
+ * @param point: the query point, in DEF database unit
+ * @param k: the number of objects to find
+ * @param result: found objects are appended to this vector
+ * @param layer_id: layer index, or kPlacementLayer
+ */
+void SpatialIndex::QueryNearest(
+    Point2D<int> const &point,
+    int k,
+    std::vector<SpatialObject> &result,
+    int layer_id
+) const {
+  SpatialRTree const *tree = GetTree(layer_id);
+  if (tree == nullptr || k <= 0) return;
+  tree->query(
+      bgi::nearest(point, static_cast<unsigned>(k)),
+      std::back_inserter(result)
+  );
+}
+
+size_t SpatialIndex::Size() const {
+  size_t size = placement_tree_.size();
+  for (auto &tree: layer_trees_) {
+    size += tree.size();
+  }
+  return size;
+}
+
+SpatialRTree *SpatialIndex::GetTree(int layer_id) {
+  if (layer_id == kPlacementLayer) return &placement_tree_;
+  PhyDBExpects(layer_id >= 0, "Invalid layer id: " << layer_id);
+  if (layer_id >= static_cast<int>(layer_trees_.size())) {
+    layer_trees_.resize(layer_id + 1);
+  }
+  return &layer_trees_[layer_id];
+}
+
+SpatialRTree const *SpatialIndex::GetTree(int layer_id) const {
+  if (layer_id == kPlacementLayer) return &placement_tree_;
+  if (layer_id < 0 || layer_id >= static_cast<int>(layer_trees_.size())) {
+    return nullptr;
+  }
+  return &layer_trees_[layer_id];
+}
+
+void SpatialIndex::CollectComponentObjects(
+    Component &component,
+    std::vector<SpatialObject> &objects
+) {
+  if (component.GetMacroId() < 0
+      || component.GetPlacementStatus() == PlaceStatus::UNPLACED) {
+    return;
+  }
+  Tech &tech = *design_ptr_->GetTechPtr();
+  Macro *macro_ptr = &tech.GetMacro(component.GetMacroId());
+  int id = component.GetId();
+  int distance_microns = design_ptr_->GetUnitsDistanceMicrons();
+  CompOrient orient = component.GetOrientation();
+  Point2D<int> location = component.GetLocation();
+  double width = macro_ptr->GetWidth();
+  double height = macro_ptr->GetHeight();
+
+  Rect2D<double> outline;
+  outline.ur.Set(width, height);
+  objects.push_back(
+      SpatialObject{
+          SpatialObjectType::COMPONENT, id, -1, kPlacementLayer,
+          MacroRectToDesign(
+              outline, width, height, orient, location, distance_microns
+          )
+      }
+  );
+
+  std::vector<Pin> &pins = macro_ptr->GetPinsRef();
+  for (size_t pin_id = 0; pin_id < pins.size(); ++pin_id) {
+    for (auto &layer_rect: pins[pin_id].GetLayerRectRef()) {
+      int layer_id = tech.ResolveLayerId(layer_rect);
+      if (layer_id < 0) continue;
+      for (auto &rect: layer_rect.rects_) {
+        objects.push_back(
+            SpatialObject{
+                SpatialObjectType::COMPONENT_PIN, id,
+                static_cast<int>(pin_id), layer_id,
+                MacroRectToDesign(
+                    rect, width, height, orient, location, distance_microns
+                )
+            }
+        );
+      }
+    }
+  }
+}
+
+void SpatialIndex::CollectIoPinObjects(
+    int iopin_id,
+    std::vector<SpatialObject> &objects
+) {
+  IOPin &iopin = design_ptr_->GetIoPinsRef()[iopin_id];
+  // IO pins shaped through IOPin::SetShape() have no layer id yet
+  int layer_id = iopin.GetLayerId();
+  if (layer_id < 0) {
+    layer_id = design_ptr_->GetTechPtr()->GetLayerId(iopin.GetLayerName());
+  }
+  if (iopin.GetPlacementStatus() == PlaceStatus::UNPLACED || layer_id < 0) {
+    return;
+  }
+  // IO pin shapes are relative to the pin location, and rotated around it
+  Rect2D<int> rect = iopin.GetRect();
+  Point2D<int> location = iopin.GetLocation();
+  rect.ll.Rotate(iopin.GetOrientation(), 0, 0);
+  rect.ur.Rotate(iopin.GetOrientation(), 0, 0);
+  Rect2D<int> box;
+  box.ll.x = location.x + std::min(rect.ll.x, rect.ur.x);
+  box.ll.y = location.y + std::min(rect.ll.y, rect.ur.y);
+  box.ur.x = location.x + std::max(rect.ll.x, rect.ur.x);
+  box.ur.y = location.y + std::max(rect.ll.y, rect.ur.y);
+  objects.push_back(
+      SpatialObject{
+          SpatialObjectType::IOPIN, iopin_id, -1, layer_id, box
+      }
+  );
+}
+
+void SpatialIndex::CollectBlockageObjects(std::vector<SpatialObject> &objects) {
+  std::vector<Blockage> &blockages = design_ptr_->GetBlockagesRef();
+  for (size_t i = 0; i < blockages.size(); ++i) {
+    Blockage &blockage = blockages[i];
+    Layer *layer_ptr = blockage.GetLayer();
+    int layer_id = kPlacementLayer;
+    if (!blockage.IsPlacement() && layer_ptr != nullptr) {
+      layer_id = layer_ptr->GetID();
+      if (layer_id < 0) continue;
+    }
+    GeometryVector<Rect2D<int>> &rects = blockage.GetRectsRef();
+    for (size_t j = 0; j < rects.size(); ++j) {
+      objects.push_back(
+          SpatialObject{
+              SpatialObjectType::BLOCKAGE, static_cast<int>(i),
+              static_cast<int>(j), layer_id, rects[j]
+          }
+      );
+    }
+  }
+}
+
+void SpatialIndex::InsertObjects(std::vector<SpatialObject> const &objects) {
+  for (auto &obj: objects) {
+    GetTree(obj.layer_id)->insert(obj);
+  }
+}
+
+void SpatialIndex::RemoveObjects(std::vector<SpatialObject> const &objects) {
+  for (auto &obj: objects) {
+    GetTree(obj.layer_id)->remove(obj);
+  }
+}
+
+}
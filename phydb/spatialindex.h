@@ -0,0 +1,154 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_SPATIALINDEX_H_
+#define PHYDB_SPATIALINDEX_H_
+
+#include <vector>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/register/box.hpp>
+#include <boost/geometry/geometries/register/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "datatype.h"
+
+BOOST_GEOMETRY_REGISTER_POINT_2D(
+    phydb::Point2D<int>, int, boost::geometry::cs::cartesian, x, y
+)
+BOOST_GEOMETRY_REGISTER_BOX(phydb::Rect2D<int>, phydb::Point2D<int>, ll, ur)
+
+namespace phydb {
+
+class Component;
+class Design;
+
+enum class SpatialObjectType {
+  COMPONENT = 0,
+  COMPONENT_PIN = 1,
+  BLOCKAGE = 2,
+  IOPIN = 3
+};
+
+/****
+ * An entry of the spatial index. All boxes are in DEF database units.
+ *
+ * id: component id, blockage index or IO pin id, depending on the type
+ * sub_id: pin id for COMPONENT_PIN, rectangle index for BLOCKAGE, -1 otherwise
+ * layer_id: index in Tech::layers_, SpatialIndex::kPlacementLayer for
+ *     component bounding boxes and placement blockages
+ */
+struct SpatialObject {
+  SpatialObjectType type = SpatialObjectType::COMPONENT;
+  int id = -1;
+  int sub_id = -1;
+  int layer_id = -1;
+  Rect2D<int> box;
+};
+
+struct SpatialObjectIndexable {
+  using result_type = Rect2D<int> const &;
+  result_type operator()(SpatialObject const &obj) const { return obj.box; }
+};
+
+struct SpatialObjectEqual {
+  bool operator()(SpatialObject const &lhs, SpatialObject const &rhs) const {
+    return lhs.type == rhs.type && lhs.id == rhs.id
+        && lhs.sub_id == rhs.sub_id && lhs.layer_id == rhs.layer_id
+        && lhs.box.ll.x == rhs.box.ll.x && lhs.box.ll.y == rhs.box.ll.y
+        && lhs.box.ur.x == rhs.box.ur.x && lhs.box.ur.y == rhs.box.ur.y;
+  }
+};
+
+using SpatialRTree = boost::geometry::index::rtree<
+    SpatialObject,
+    boost::geometry::index::rstar<16>,
+    SpatialObjectIndexable,
+    SpatialObjectEqual
+>;
+
+/****
+ * An R-tree index over placed component bounding boxes, transformed
+ * component pin shapes, blockage rectangles and placed IO pins.
+ *
+ * Component bounding boxes and placement blockages are kept in a placement
+ * tree, every other shape is kept in the tree of its routing layer. Shapes
+ * added with a layer name only are looked up in Tech by name, shapes on
+ * unknown layers are not indexed.
+ *
+ * Once built, components are re-indexed in O(log n) whenever
+ * Component::SetLocation/SetOrientation/SetPlacementStatus is called.
+ * Blockages are indexed when the index is built, IO pins can be re-indexed
+ * by UpdateIoPin(). The index is not thread-safe, components must not be
+ * moved concurrently while the index exists.
+ */
+class SpatialIndex {
+ public:
+  static constexpr int kPlacementLayer = -1;
+
+  explicit SpatialIndex(Design *design_ptr);
+  ~SpatialIndex();
+  SpatialIndex(SpatialIndex const &) = delete;
+  SpatialIndex &operator=(SpatialIndex const &) = delete;
+
+  void Build();
+  void UpdateComponent(Component &component);
+  void UpdateIoPin(int iopin_id);
+
+  void QueryRegion(
+      Rect2D<int> const &region,
+      std::vector<SpatialObject> &result,
+      int layer_id = kPlacementLayer
+  ) const;
+  void QueryRegionAllLayers(
+      Rect2D<int> const &region,
+      std::vector<SpatialObject> &result
+  ) const;
+  void QueryNearest(
+      Point2D<int> const &point,
+      int k,
+      std::vector<SpatialObject> &result,
+      int layer_id = kPlacementLayer
+  ) const;
+
+  size_t Size() const;
+
+ private:
+  Design *design_ptr_;
+  SpatialRTree placement_tree_;
+  std::vector<SpatialRTree> layer_trees_;
+  std::vector<std::vector<SpatialObject>> component_objects_;
+  std::vector<std::vector<SpatialObject>> iopin_objects_;
+
+  SpatialRTree *GetTree(int layer_id);
+  SpatialRTree const *GetTree(int layer_id) const;
+  void CollectComponentObjects(
+      Component &component,
+      std::vector<SpatialObject> &objects
+  );
+  void CollectIoPinObjects(int iopin_id, std::vector<SpatialObject> &objects);
+  void CollectBlockageObjects(std::vector<SpatialObject> &objects);
+  void InsertObjects(std::vector<SpatialObject> const &objects);
+  void RemoveObjects(std::vector<SpatialObject> const &objects);
+};
+
+}
+
+#endif //PHYDB_SPATIALINDEX_H_
@@ -61,12 +61,12 @@ std::ostream &operator<<(
 }
 
 SpecialMacroRectLayout::SpecialMacroRectLayout(
-    Macro *macro_ptr,
+    MacroId macro_id,
     int llx,
     int lly,
     int urx,
     int ury
-) : macro_ptr_(macro_ptr) {
+) : macro_id_(macro_id) {
   bbox_.Set(llx, lly, urx, ury);
 }
 
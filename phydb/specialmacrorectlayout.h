@@ -54,13 +54,14 @@ struct RectSignalLayer {
 };
 
 struct SpecialMacroRectLayout {
+  friend class Snapshot;
  private:
-  Macro *macro_ptr_;
+  MacroId macro_id_;
   Rect2D<int> bbox_;
   std::vector<RectSignalLayer> rects_;
  public:
   explicit SpecialMacroRectLayout(
-      Macro *macro_ptr,
+      MacroId macro_id,
       int llx,
       int lly,
       int urx,
@@ -19,9 +19,13 @@
  *
  ******************************************************************************/
 
+#include <algorithm>
+#include <climits>
 #include <cmath>
 #include "stats.h"
 
+#include "phydb/common/helper.h"
+
 namespace phydb {
 
 void Stats::SetGcellSize(int size) {
@@ -43,7 +47,8 @@ PhyDB *Stats::GetDbPtr() {
 
 void Stats::AddStatsComponent(Component &component) {
   int dbuPerMicron = GetDbPtr()->design().GetUnitsDistanceMicrons();
-  stats_components_.emplace_back(component, dbuPerMicron);
+  Macro &macro = GetDbPtr()->tech().GetMacro(component.GetMacroId());
+  stats_components_.emplace_back(component, macro, dbuPerMicron);
 }
 
 std::vector<StatsComponent> &Stats::GetStatsComponentsRef() {
@@ -54,27 +59,29 @@ StatsPin &Stats::GetStatsPin(int component_id, int pin_id) {
   return stats_components_[component_id].pins_[pin_id];
 }
 
-StatsComponent::StatsComponent(Component &component, int dbuPerMicron) {
+StatsComponent::StatsComponent(
+    Component &component,
+    Macro &macro,
+    int dbuPerMicron
+) {
   this->name_ = component.GetName();
 
   //auto location = component.GetLocation();
 
-  Macro *macro_ptr = component.GetMacro();
-
   Point2D<int> orig;
-  orig.x = macro_ptr->GetOriginX() * dbuPerMicron;
-  orig.y = macro_ptr->GetOriginY() * dbuPerMicron;
+  orig.x = macro.GetOriginX() * dbuPerMicron;
+  orig.y = macro.GetOriginY() * dbuPerMicron;
 
-  size_.x = macro_ptr->GetWidth() * dbuPerMicron;
-  size_.y = macro_ptr->GetHeight() * dbuPerMicron;
+  size_.x = macro.GetWidth() * dbuPerMicron;
+  size_.y = macro.GetHeight() * dbuPerMicron;
 
   location_ = component.GetLocation();
   //enlarge by dbuPermicron
-  for (auto &pin : macro_ptr->GetPinsRef()) {
+  for (auto &pin : macro.GetPinsRef()) {
     pins_.emplace_back(pin, dbuPerMicron);
   }
   phydb::OBS obs;
-  auto obs_ptr = macro_ptr->GetObs();
+  auto obs_ptr = macro.GetObs();
 
   obs_ = *obs_ptr; // make a copy of obs
 
@@ -325,140 +332,477 @@ void StatsComponent::ComputeLocation(
   }
 }
 
+/****
+ * @brief Set the number of threads used to compute the RUDY map.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void Stats::SetNumThreads(int num_threads) {
+  num_threads_ = num_threads;
+}
+
+int Stats::GetNumThreads() const {
+  return num_threads_;
+}
+
+/****
+ * @brief Compute the RUDY (Rectangular Uniform wire DensitY) map of the
+ * design. Each gcell is Gcell_size_ times the minimum routing pitch wide.
+ * Every net spreads (h + v) / (h * v) uniformly over the gcells covered by its
+ * bounding box, where h and v are the width and height of this box in gcells.
+ *
+ * Component and net data are read in place, pin locations come from the
+ * per-orientation pin offset tables of macros. Net boxes are computed in
+ * parallel, and the map is accumulated with each thread owning a band of
+ * rows, so no atomics or per-thread copies of the map are needed.
+ */
 void Stats::ComputeRUDY() {
-  if (GetDbPtr() == nullptr) {
-    std::cout << "Error: please initialize db_ptr in Stats" << std::endl;
-    return;
-  }
-  int dbuPerMicron = GetDbPtr()->design().GetUnitsDistanceMicrons();
-  if (GetStatsComponentsRef().size() == 0) {
-    auto components = GetDbPtr()->design().GetComponentsRef();
+  PhyDBExpects(GetDbPtr() != nullptr, "Please initialize db_ptr in Stats");
+  BuildRudyGrid();
+  GetDbPtr()->tech().ComputePinOffsets(
+      GetDbPtr()->design().GetUnitsDistanceMicrons()
+  );
+  BuildComponentNets();
+  ComputeRudyNetBoxes();
+  AccumulateRudy();
+}
 
-    for (auto comp : components) {
-      AddStatsComponent(comp);
+/****
+ * @brief Update the RUDY map after some components are moved or rotated.
+ * Only nets connected to these components are re-evaluated. The netlist and
+ * the die area must not change after the last call to ComputeRUDY().
+ *
+ * @param component_ids: ids of the components which have been moved
+ */
+void Stats::UpdateRUDY(std::vector<int> const &component_ids) {
+  PhyDBExpects(
+      !rudy_.empty(),
+      "Please call ComputeRUDY() before UpdateRUDY()"
+  );
+  auto &nets = GetDbPtr()->design().GetNetsRef();
+  std::vector<int> affected_nets;
+  std::vector<bool> is_affected(nets.size(), false);
+  for (int comp_id: component_ids) {
+    for (int i = comp_net_offsets_[comp_id];
+         i < comp_net_offsets_[comp_id + 1]; ++i) {
+      int net_id = comp_nets_[i];
+      if (!is_affected[net_id]) {
+        is_affected[net_id] = true;
+        affected_nets.push_back(net_id);
+      }
     }
   }
 
+  // when a large part of the design moves, a full pass is cheaper
+  if (affected_nets.size() * 4 > nets.size()) {
+    ComputeRudyNetBoxes();
+    AccumulateRudy();
+    return;
+  }
+  for (int net_id: affected_nets) {
+    AddRudyNetBox(rudy_net_boxes_[net_id], -1);
+    rudy_net_boxes_[net_id] = ComputeRudyNetBox(nets[net_id]);
+    AddRudyNetBox(rudy_net_boxes_[net_id], 1);
+  }
+}
+
+/****
+ * @brief Get the default gcell width, Gcell_size_ times the minimum pitch of
+ * all routing layers, in DEF database unit.
+ */
+double Stats::GetDefaultGcellWidth() {
+  int dbuPerMicron = GetDbPtr()->design().GetUnitsDistanceMicrons();
   double min_pitch = 100.0;
-  auto layers = GetDbPtr()->tech().GetLayersRef();
-  for (auto layer : layers) {
+  for (auto &layer : GetDbPtr()->tech().GetLayersRef()) {
     if (layer.GetType() == phydb::LayerType::ROUTING) {
       double tmp_min = std::min(layer.GetPitchX(), layer.GetPitchY());
       min_pitch = std::min(min_pitch, tmp_min);
     }
   }
-  double Gcell_size = min_pitch * dbuPerMicron;
-  auto die_area = GetDbPtr()->design().GetDieArea();
-  int grid_x = (int) std::ceil(
-      (double) (die_area.URX() - die_area.LLX()) / (double) Gcell_size);
-  int grid_y = (int) std::ceil(
-      (double) (die_area.URY() - die_area.LLY()) / (double) Gcell_size);
+  double gcell_width = Gcell_size_ * min_pitch * dbuPerMicron;
+  PhyDBExpects(gcell_width > 0, "Non-positive gcell width in stats");
+  return gcell_width;
+}
 
-  RUDY_ = new double[grid_x * grid_y];
+void Stats::BuildRudyGrid() {
+  rudy_gcell_width_ = GetDefaultGcellWidth();
 
-  for (int i = 0; i < grid_x * grid_y; i++) {
-    RUDY_[i] = 0;
+  auto die_area = GetDbPtr()->design().GetDieArea();
+  rudy_grid_origin_ = die_area.ll;
+  rudy_grid_x_ = std::max(1, (int) std::ceil(
+      (double) (die_area.URX() - die_area.LLX()) / rudy_gcell_width_));
+  rudy_grid_y_ = std::max(1, (int) std::ceil(
+      (double) (die_area.URY() - die_area.LLY()) / rudy_gcell_width_));
+  rudy_.assign((size_t) rudy_grid_x_ * rudy_grid_y_, 0);
+}
+
+void Stats::BuildComponentNets() {
+  auto &design = GetDbPtr()->design();
+  auto &nets = design.GetNetsRef();
+  size_t num_components = design.GetComponentsRef().size();
+  comp_net_offsets_.assign(num_components + 1, 0);
+  for (auto &net : nets) {
+    for (auto &pin : net.GetPinsRef()) {
+      ++comp_net_offsets_[pin.InstanceId() + 1];
+    }
+  }
+  for (size_t i = 0; i < num_components; ++i) {
+    comp_net_offsets_[i + 1] += comp_net_offsets_[i];
   }
+  comp_nets_.resize(comp_net_offsets_.back());
+  std::vector<int> next(comp_net_offsets_.begin(), comp_net_offsets_.end() - 1);
+  for (int net_id = 0; net_id < (int) nets.size(); ++net_id) {
+    for (auto &pin : nets[net_id].GetPinsRef()) {
+      comp_nets_[next[pin.InstanceId()]++] = net_id;
+    }
+  }
+}
 
-  auto nets = GetDbPtr()->design().GetNetsRef();
+RudyNetBox Stats::ComputeRudyNetBox(Net &net) {
+  RudyNetBox box;
+  auto &design = GetDbPtr()->design();
+  auto &components = design.GetComponentsRef();
+  int num_pins = 0;
+  int min_x = INT_MAX, min_y = INT_MAX;
+  int max_x = INT_MIN, max_y = INT_MIN;
+  for (auto &pin : net.GetPinsRef()) {
+    Component &comp = components[pin.InstanceId()];
+    Macro &macro = GetDbPtr()->tech().GetMacro(comp.GetMacroId());
+    Rect2D<int> const &offset = macro.GetPinBoundingBoxOffset(
+        comp.GetOrientation(), pin.PinId()
+    );
+    Point2D<int> location = comp.GetLocation();
+    min_x = std::min(min_x, location.x + offset.ll.x);
+    min_y = std::min(min_y, location.y + offset.ll.y);
+    max_x = std::max(max_x, location.x + offset.ur.x);
+    max_y = std::max(max_y, location.y + offset.ur.y);
+    ++num_pins;
+  }
+  for (int iopin_id : net.GetIoPinIdsRef()) {
+    Point2D<int> location = design.GetIoPinLocation(iopin_id);
+    min_x = std::min(min_x, location.x);
+    min_y = std::min(min_y, location.y);
+    max_x = std::max(max_x, location.x);
+    max_y = std::max(max_y, location.y);
+    ++num_pins;
+  }
+  if (num_pins < 2) return box;
+
+  auto to_bin = [this](int coordinate, int origin, int num_bins) {
+    int bin = (int) std::floor((coordinate - origin) / rudy_gcell_width_);
+    return std::max(0, std::min(bin, num_bins - 1));
+  };
+  box.lx = to_bin(min_x, rudy_grid_origin_.x, rudy_grid_x_);
+  box.ly = to_bin(min_y, rudy_grid_origin_.y, rudy_grid_y_);
+  box.ux = to_bin(max_x, rudy_grid_origin_.x, rudy_grid_x_);
+  box.uy = to_bin(max_y, rudy_grid_origin_.y, rudy_grid_y_);
+  double h = box.ux - box.lx + 1;
+  double v = box.uy - box.ly + 1;
+  box.value = (h + v) / (h * v);
+  return box;
+}
 
-  for (auto net : nets) {
-    int net_min_x = grid_x - 1, net_min_y = grid_y - 1;
-    int net_max_x = 0, net_max_y = 0;
+void Stats::AddRudyNetBox(RudyNetBox const &box, double sign) {
+  double value = sign * box.value;
+  for (int y = box.ly; y <= box.uy; ++y) {
+    double *row = rudy_.data() + (size_t) y * rudy_grid_x_;
+    for (int x = box.lx; x <= box.ux; ++x) {
+      row[x] += value;
+    }
+  }
+}
 
-    auto phydb_pins = net.GetPinsRef();
-    for (auto phydb_pin : phydb_pins) {
-      int pin_min_x = grid_x - 1, pin_min_y = grid_y - 1;
-      int pin_max_x = 0, pin_max_y = 0;
-      auto stats_pin = GetStatsPin(phydb_pin.InstanceId(), phydb_pin.PinId());
+void Stats::ComputeRudyNetBoxes() {
+  auto &nets = GetDbPtr()->design().GetNetsRef();
+  int num_nets = (int) nets.size();
+  rudy_net_boxes_.resize(num_nets);
+  const int chunk_size = 4096;
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    for (int i = chunk * chunk_size; i < end; ++i) {
+      rudy_net_boxes_[i] = ComputeRudyNetBox(nets[i]);
+    }
+  });
+}
 
-      for (auto layer_rect : stats_pin.layer_rects_) {
-        for (auto rect : layer_rect.rects_) {
-          pin_min_x = std::min((int) rect.LLX(), pin_min_x);
-          pin_min_y = std::min((int) rect.LLY(), pin_min_y);
-          pin_max_x = std::max((int) rect.URX(), pin_max_x);
-          pin_max_y = std::max((int) rect.URY(), pin_max_y);
-        }
+/****
+ * @brief Accumulate all net boxes into the RUDY map. Each band of rows is
+ * owned by one task: net boxes clipped to the band are added to a 2D
+ * difference array in O(1), followed by prefix sums within the band.
+ */
+void Stats::AccumulateRudy() {
+  std::fill(rudy_.begin(), rudy_.end(), 0);
+  int num_bands = std::min(ResolveNumThreads(num_threads_), rudy_grid_y_);
+  int grid_x = rudy_grid_x_;
+  ParallelFor(num_bands, num_threads_, [&](int band) {
+    int y_begin = rudy_grid_y_ * band / num_bands;
+    int y_end = rudy_grid_y_ * (band + 1) / num_bands;
+    auto diff = [&](int y, int x) -> double & {
+      return rudy_[(size_t) y * grid_x + x];
+    };
+    for (auto &box : rudy_net_boxes_) {
+      if (box.ux < box.lx || box.uy < y_begin || box.ly >= y_end) continue;
+      int ly = std::max(box.ly, y_begin);
+      int uy = std::min(box.uy, y_end - 1);
+      bool has_right = box.ux + 1 < grid_x;
+      diff(ly, box.lx) += box.value;
+      if (has_right) diff(ly, box.ux + 1) -= box.value;
+      if (uy + 1 < y_end) {
+        diff(uy + 1, box.lx) -= box.value;
+        if (has_right) diff(uy + 1, box.ux + 1) += box.value;
       }
-
-      net_min_x = std::min(net_min_x, pin_min_x / grid_x);
-      net_min_y = std::min(net_min_y, pin_min_y / grid_y);
-      net_max_x = std::max(net_max_x, pin_max_x / grid_x);
-      net_max_y = std::max(net_max_y, pin_max_y / grid_y);
     }
-    double h = net_max_x - net_min_x + 1;
-    double v = net_max_y - net_min_y + 1;
-    double net_rudy = (h + v) / (h * v);
-
-    for (int x = net_min_x; x <= net_max_x; x++) {
-      for (int y = net_min_y; y <= net_max_y; y++) {
-        RUDY_[y * grid_x + x] += net_rudy;
+    for (int y = y_begin; y < y_end; ++y) {
+      double *row = rudy_.data() + (size_t) y * grid_x;
+      for (int x = 1; x < grid_x; ++x) {
+        row[x] += row[x - 1];
+      }
+      if (y == y_begin) continue;
+      double *prev_row = row - grid_x;
+      for (int x = 0; x < grid_x; ++x) {
+        row[x] += prev_row[x];
       }
     }
-  }
+  });
 }
 
+/****
+ * @brief Compute the pin-density map: the number of net pins whose centers
+ * fall in each gcell, for all layers together and for every layer. Bins come
+ * from the DEF GCELLGRID statements; an axis without GCELLGRID uses uniform
+ * gcells of Gcell_size_ minimum routing pitches over the die area.
+ *
+ * Pin locations are computed in parallel over components, and counts are
+ * accumulated with each task owning a band of rows in every map.
+ */
 void Stats::ComputePinDensity() {
-  if (GetDbPtr() == nullptr) {
-    std::cout << "Error: please initialize db_ptr in Stats" << std::endl;
-    return;
-  }
-  int dbuPerMicron = GetDbPtr()->design().GetUnitsDistanceMicrons();
-  if (GetStatsComponentsRef().size() == 0) {
-    auto components = GetDbPtr()->design().GetComponentsRef();
-
-    for (auto comp : components) {
-      AddStatsComponent(comp);
+  PhyDBExpects(GetDbPtr() != nullptr, "Please initialize db_ptr in Stats");
+  BuildPinDensityGrid();
+  GetDbPtr()->tech().ComputePinOffsets(
+      GetDbPtr()->design().GetUnitsDistanceMicrons()
+  );
+  BuildPinDensityEntries();
+
+  auto &components = GetDbPtr()->design().GetComponentsRef();
+  int grid_x = GetPinDensityGridX();
+  int grid_y = GetPinDensityGridY();
+  size_t num_bins = (size_t) grid_x * grid_y;
+  size_t num_maps = GetDbPtr()->tech().GetLayersRef().size() + 1;
+  pin_density_.assign(num_maps * num_bins, 0);
+
+  int num_components = (int) components.size();
+  const int chunk_size = 1024;
+  int num_chunks = (num_components + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    int end = std::min(num_components, (chunk + 1) * chunk_size);
+    for (int i = chunk * chunk_size; i < end; ++i) {
+      for (int j = comp_pin_density_offsets_[i];
+           j < comp_pin_density_offsets_[i + 1]; ++j) {
+        PinDensityEntry &entry = pin_density_entries_[j];
+        entry.bin = ComputePinDensityBin(components[i], entry);
+      }
     }
-  }
+  });
+
+  int num_bands = std::min(ResolveNumThreads(num_threads_), grid_y);
+  ParallelFor(num_bands, num_threads_, [&](int band) {
+    int bin_begin = grid_y * band / num_bands * grid_x;
+    int bin_end = grid_y * (band + 1) / num_bands * grid_x;
+    for (auto &entry : pin_density_entries_) {
+      if (entry.bin < bin_begin || entry.bin >= bin_end) continue;
+      ++pin_density_[(entry.layer_id + 1) * num_bins + entry.bin];
+    }
+  });
+}
 
-  double min_pitch = 100.0;
-  auto layers = GetDbPtr()->tech().GetLayersRef();
-  for (auto layer : layers) {
-    if (layer.GetType() == phydb::LayerType::ROUTING) {
-      double tmp_min = std::min(layer.GetPitchX(), layer.GetPitchY());
-      min_pitch = std::min(min_pitch, tmp_min);
+/****
+ * @brief Update the pin-density map after some components are moved or
+ * rotated. The netlist and the gcell grid must not change after the last call
+ * to ComputePinDensity().
+ *
+ * @param component_ids: ids of the components which have been moved
+ */
+void Stats::UpdatePinDensity(std::vector<int> const &component_ids) {
+  PhyDBExpects(
+      !pin_density_.empty(),
+      "Please call ComputePinDensity() before UpdatePinDensity()"
+  );
+  auto &components = GetDbPtr()->design().GetComponentsRef();
+  size_t num_bins = (size_t) GetPinDensityGridX() * GetPinDensityGridY();
+  for (int comp_id : component_ids) {
+    for (int j = comp_pin_density_offsets_[comp_id];
+         j < comp_pin_density_offsets_[comp_id + 1]; ++j) {
+      PinDensityEntry &entry = pin_density_entries_[j];
+      int bin = ComputePinDensityBin(components[comp_id], entry);
+      if (bin == entry.bin) continue;
+      int *map = pin_density_.data() + (entry.layer_id + 1) * num_bins;
+      if (entry.bin >= 0) --map[entry.bin];
+      if (bin >= 0) ++map[bin];
+      entry.bin = bin;
     }
   }
-  double Gcell_size = min_pitch * dbuPerMicron;
-  auto die_area = GetDbPtr()->design().GetDieArea();
-  int grid_x = (int) std::ceil(
-      (double) (die_area.URX() - die_area.LLX()) / (double) Gcell_size);
-  int grid_y = (int) std::ceil(
-      (double) (die_area.URY() - die_area.LLY()) / (double) Gcell_size);
+}
 
-  pin_density_ = new double[grid_x * grid_y];
+int Stats::GetPinDensityGridX() const {
+  return std::max(0, (int) pin_density_x_boundaries_.size() - 1);
+}
 
-  for (int i = 0; i < grid_x * grid_y; i++) {
-    pin_density_[i] = 0;
-  }
+int Stats::GetPinDensityGridY() const {
+  return std::max(0, (int) pin_density_y_boundaries_.size() - 1);
+}
 
-  auto nets = GetDbPtr()->design().GetNetsRef();
+std::vector<int> &Stats::GetPinDensityXBoundariesRef() {
+  return pin_density_x_boundaries_;
+}
 
-  for (auto net : nets) {
+std::vector<int> &Stats::GetPinDensityYBoundariesRef() {
+  return pin_density_y_boundaries_;
+}
 
-    auto phydb_pins = net.GetPinsRef();
-    for (auto phydb_pin : phydb_pins) {
-      int pin_min_x = grid_x - 1, pin_min_y = grid_y - 1;
-      int pin_max_x = 0, pin_max_y = 0;
-      auto stats_pin = GetStatsPin(phydb_pin.InstanceId(), phydb_pin.PinId());
+/****
+ * @brief Get the number of pins in a gcell, all layers together.
+ *
+ * @param x: column of the gcell
+ * @param y: row of the gcell
+ */
+int Stats::GetPinDensity(int x, int y) const {
+  return GetLayerPinDensity(-1, x, y);
+}
 
-      for (auto layer_rect : stats_pin.layer_rects_) {
-        for (auto rect : layer_rect.rects_) {
-          pin_min_x = std::min((int) rect.LLX(), pin_min_x);
-          pin_min_y = std::min((int) rect.LLY(), pin_min_y);
-          pin_max_x = std::max((int) rect.URX(), pin_max_x);
-          pin_max_y = std::max((int) rect.URY(), pin_max_y);
-        }
-      }
+/****
+ * @brief Get the number of pins having a shape on a layer in a gcell.
+ *
+ * @param layer_id: index of the layer, -1 means all layers
+ * @param x: column of the gcell
+ * @param y: row of the gcell
+ */
+int Stats::GetLayerPinDensity(int layer_id, int x, int y) const {
+  int grid_x = GetPinDensityGridX();
+  size_t num_bins = (size_t) grid_x * GetPinDensityGridY();
+  return pin_density_[(layer_id + 1) * num_bins + y * grid_x + x];
+}
+
+void Stats::BuildPinDensityGrid() {
+  pin_density_x_boundaries_.clear();
+  pin_density_y_boundaries_.clear();
+  for (auto &gcell_grid : GetDbPtr()->design().GetGcellGridsRef()) {
+    auto &boundaries = (gcell_grid.GetDirection() == XYDirection::X) ?
+                       pin_density_x_boundaries_ : pin_density_y_boundaries_;
+    for (int i = 0; i < gcell_grid.GetNBoundaries(); ++i) {
+      boundaries.push_back(gcell_grid.GetStart() + i * gcell_grid.GetStep());
+    }
+  }
+
+  auto die_area = GetDbPtr()->design().GetDieArea();
+  auto finalize = [&](std::vector<int> &boundaries, int lo, int hi) {
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(
+        std::unique(boundaries.begin(), boundaries.end()),
+        boundaries.end()
+    );
+    if (boundaries.size() >= 2) return;
+    boundaries.clear();
+    double gcell_width = GetDefaultGcellWidth();
+    int num_bins = std::max(1, (int) std::ceil((hi - lo) / gcell_width));
+    for (int i = 0; i < num_bins; ++i) {
+      boundaries.push_back(lo + (int) std::round(i * gcell_width));
+    }
+    boundaries.push_back(std::max(hi, boundaries.back() + 1));
+  };
+  finalize(pin_density_x_boundaries_, die_area.LLX(), die_area.URX());
+  finalize(pin_density_y_boundaries_, die_area.LLY(), die_area.URY());
+}
+
+void Stats::BuildPinDensityEntries() {
+  auto &design = GetDbPtr()->design();
+  auto &components = design.GetComponentsRef();
+  auto &tech = GetDbPtr()->tech();
+  int dbuPerMicron = design.GetUnitsDistanceMicrons();
+  int num_layers = (int) tech.GetLayersRef().size();
+
+  // net pins of each component, in compressed sparse row format
+  std::vector<int> pin_offsets(components.size() + 1, 0);
+  for (auto &net : design.GetNetsRef()) {
+    for (auto &pin : net.GetPinsRef()) {
+      ++pin_offsets[pin.InstanceId() + 1];
+    }
+  }
+  for (size_t i = 0; i < components.size(); ++i) {
+    pin_offsets[i + 1] += pin_offsets[i];
+  }
+  std::vector<int> pin_ids(pin_offsets.back());
+  std::vector<int> next(pin_offsets.begin(), pin_offsets.end() - 1);
+  for (auto &net : design.GetNetsRef()) {
+    for (auto &pin : net.GetPinsRef()) {
+      pin_ids[next[pin.InstanceId()]++] = pin.PinId();
+    }
+  }
 
-      for (int x = pin_min_x; x <= pin_max_x; x++) {
-        for (int y = pin_min_y; y <= pin_max_y; y++) {
-          pin_density_[y * grid_x + x] += 1;
+  auto center_offset = [&](Rect2D<double> const &rect) {
+    return Point2D<int>(
+        (int) std::round((rect.LLX() + rect.URX()) / 2.0 * dbuPerMicron),
+        (int) std::round((rect.LLY() + rect.URY()) / 2.0 * dbuPerMicron)
+    );
+  };
+
+  comp_pin_density_offsets_.assign(components.size() + 1, 0);
+  pin_density_entries_.clear();
+  for (size_t i = 0; i < components.size(); ++i) {
+    Macro *macro_ptr = &tech.GetMacro(components[i].GetMacroId());
+    auto begin = pin_ids.begin() + pin_offsets[i];
+    auto end = pin_ids.begin() + pin_offsets[i + 1];
+    std::sort(begin, end);
+    end = std::unique(begin, end);
+    for (auto it = begin; it != end; ++it) {
+      Pin &pin = macro_ptr->GetPinsRef()[*it];
+      if (pin.GetLayerRectRef().empty()) continue;
+      PinDensityEntry entry;
+      entry.offset = macro_ptr->GetPinCenterOffset(CompOrient::N, *it);
+      pin_density_entries_.push_back(entry);
+      for (auto &layer_rect : pin.GetLayerRectRef()) {
+        int layer_id = tech.ResolveLayerId(layer_rect);
+        if (layer_id < 0 || layer_id >= num_layers
+            || layer_rect.rects_.empty()) {
+          continue;
         }
+        entry.offset = center_offset(layer_rect.GetBoundingBox());
+        entry.layer_id = layer_id;
+        pin_density_entries_.push_back(entry);
       }
     }
+    comp_pin_density_offsets_[i + 1] = (int) pin_density_entries_.size();
   }
 }
 
+int Stats::FindPinDensityBin(Point2D<int> location) const {
+  auto find = [](std::vector<int> const &boundaries, int coordinate) {
+    int index = (int) (std::upper_bound(
+        boundaries.begin(), boundaries.end(), coordinate
+    ) - boundaries.begin()) - 1;
+    return std::max(0, std::min(index, (int) boundaries.size() - 2));
+  };
+  return find(pin_density_y_boundaries_, location.y) * GetPinDensityGridX()
+      + find(pin_density_x_boundaries_, location.x);
+}
+
+int Stats::ComputePinDensityBin(
+    Component &comp,
+    PinDensityEntry const &entry
+) {
+  if (comp.GetPlacementStatus() == PlaceStatus::UNPLACED) return -1;
+  int dbuPerMicron = GetDbPtr()->design().GetUnitsDistanceMicrons();
+  Macro *macro_ptr = &GetDbPtr()->tech().GetMacro(comp.GetMacroId());
+  Point2D<int> offset = entry.offset;
+  offset.Rotate(
+      comp.GetOrientation(),
+      (int) std::round(macro_ptr->GetWidth() * dbuPerMicron),
+      (int) std::round(macro_ptr->GetHeight() * dbuPerMicron)
+  );
+  Point2D<int> location = comp.GetLocation();
+  location.x += offset.x;
+  location.y += offset.y;
+  return FindPinDensityBin(location);
+}
+
 } //namespace phydb
@@ -60,7 +60,7 @@ class StatsComponent {
       Point2D<int> size
   );
 
-  StatsComponent(Component &, int);
+  StatsComponent(Component &, Macro &, int);
  private:
   std::string name_;
   phydb::Point2D<int> location_;
@@ -69,33 +69,99 @@ class StatsComponent {
   phydb::OBS obs_;
 };
 
+/****
+ * The bounding box of a net in gcell bins (inclusive), and the RUDY value
+ * added to every bin inside this box. The box is empty if ux < lx.
+ */
+struct RudyNetBox {
+  int lx = 0;
+  int ly = 0;
+  int ux = -1;
+  int uy = -1;
+  double value = 0;
+};
+
+/****
+ * A pin counted in the pin-density map. The offset is the pin (or pin shape)
+ * center relative to the component location in the N orientation, in DEF
+ * database unit. layer_id is -1 for the all-layer map. bin is the gcell this
+ * pin is currently counted in, -1 if it is not counted.
+ */
+struct PinDensityEntry {
+  Point2D<int> offset;
+  int layer_id = -1;
+  int bin = -1;
+};
+
 class Stats {
  public:
   Stats() {}
   Stats(PhyDB *db_ptr) : db_ptr_(db_ptr) {}
 
-  ~Stats() {
-    delete[] RUDY_;
-    delete[] pin_density_;
-  }
-
   void SetDbPtr(PhyDB *);
   PhyDB *GetDbPtr();
   void SetGcellSize(int);
   int GetGcellSize() const;
+  void SetNumThreads(int num_threads);
+  int GetNumThreads() const;
   void AddStatsComponent(Component &);
   std::vector<StatsComponent> &GetStatsComponentsRef();
 
   StatsPin &GetStatsPin(int component_id, int pin_id);
 
   void ComputeRUDY();
+  void UpdateRUDY(std::vector<int> const &component_ids);
+  std::vector<double> &GetRudyRef() { return rudy_; }
+  int GetRudyGridX() const { return rudy_grid_x_; }
+  int GetRudyGridY() const { return rudy_grid_y_; }
+  double GetRudyGcellWidth() const { return rudy_gcell_width_; }
+
   void ComputePinDensity();
+  void UpdatePinDensity(std::vector<int> const &component_ids);
+  int GetPinDensityGridX() const;
+  int GetPinDensityGridY() const;
+  std::vector<int> &GetPinDensityXBoundariesRef();
+  std::vector<int> &GetPinDensityYBoundariesRef();
+  int GetPinDensity(int x, int y) const;
+  int GetLayerPinDensity(int layer_id, int x, int y) const;
  private:
   PhyDB *db_ptr_ = nullptr;
   int Gcell_size_ = 15; //in the unit of the min pitch of all layers
+  int num_threads_ = 1;
   std::vector<StatsComponent> stats_components_;
-  double *RUDY_;
-  double *pin_density_;
+
+  /****RUDY map, row-major, rudy_grid_x_ bins per row****/
+  int rudy_grid_x_ = 0;
+  int rudy_grid_y_ = 0;
+  double rudy_gcell_width_ = 0; // in DEF database unit
+  Point2D<int> rudy_grid_origin_;
+  std::vector<double> rudy_;
+  std::vector<RudyNetBox> rudy_net_boxes_;
+
+  /****nets of each component, in compressed sparse row format****/
+  std::vector<int> comp_net_offsets_;
+  std::vector<int> comp_nets_;
+
+  /****pin-density map, pin counts of the all-layer map followed by one map
+   * per layer, each row-major with GetPinDensityGridX() bins per row****/
+  std::vector<int> pin_density_x_boundaries_;
+  std::vector<int> pin_density_y_boundaries_;
+  std::vector<int> pin_density_;
+  std::vector<int> comp_pin_density_offsets_;
+  std::vector<PinDensityEntry> pin_density_entries_;
+
+  double GetDefaultGcellWidth();
+  void BuildRudyGrid();
+  void BuildComponentNets();
+  RudyNetBox ComputeRudyNetBox(Net &net);
+  void AddRudyNetBox(RudyNetBox const &box, double sign);
+  void ComputeRudyNetBoxes();
+  void AccumulateRudy();
+
+  void BuildPinDensityGrid();
+  void BuildPinDensityEntries();
+  int FindPinDensityBin(Point2D<int> location) const;
+  int ComputePinDensityBin(Component &comp, PinDensityEntry const &entry);
 };
 
 } //namespace phydb
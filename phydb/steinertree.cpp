@@ -0,0 +1,484 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "steinertree.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+
+#include "phydb/common/helper.h"
+
+namespace phydb {
+
+void SteinerTreeEngine::SetDbPtr(PhyDB *db_ptr) {
+  db_ptr_ = db_ptr;
+}
+
+/****
+ * @brief Set the number of threads used to build trees.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void SteinerTreeEngine::SetNumThreads(int num_threads) {
+  num_threads_ = num_threads;
+}
+
+int SteinerTreeEngine::GetNumThreads() const {
+  return num_threads_;
+}
+
+/****
+ * @brief Take the connectivity of the design, building it if needed, then
+ * locate all pins and build the trees of all nets.
+ */
+void SteinerTreeEngine::Build() {
+  PhyDBExpects(
+      db_ptr_ != nullptr,
+      "Please initialize db_ptr in SteinerTreeEngine"
+  );
+  Design &design = db_ptr_->design();
+  db_ptr_->tech().ComputePinOffsets(design.GetUnitsDistanceMicrons());
+  connectivity_ptr_ = design.GetNetConnectivityPtr();
+  if (connectivity_ptr_ == nullptr) {
+    connectivity_ptr_ = design.BuildNetConnectivity();
+  }
+  connectivity_generation_ = design.GetConnectivityGeneration();
+
+  int num_pins = connectivity_ptr_->GetNumPins();
+  int num_nets = connectivity_ptr_->GetNumNets();
+  pin_locator_.Reset(db_ptr_, connectivity_ptr_);
+  node_x_.assign(2 * static_cast<size_t>(num_pins), 0);
+  node_y_.assign(2 * static_cast<size_t>(num_pins), 0);
+  edges_.assign(2 * static_cast<size_t>(num_pins), SteinerEdge());
+  net_num_nodes_.assign(num_nets, 0);
+  net_wirelength_.assign(num_nets, 0);
+
+  pin_locator_.LocateAllPins(num_threads_);
+
+  std::vector<int> net_ids(num_nets);
+  std::iota(net_ids.begin(), net_ids.end(), 0);
+  BuildTrees(net_ids);
+  total_wirelength_ = 0;
+  for (int64_t wirelength : net_wirelength_) {
+    total_wirelength_ += wirelength;
+  }
+  synced_epoch_ = design.GetPlacementEpoch();
+}
+
+/****
+ * @brief Rebuild the trees of nets touching components whose placement
+ * changed since the last Build() or Update(). If the netlist changed, all
+ * trees are built again.
+ */
+void SteinerTreeEngine::Update() {
+  if (IsConnectivityStale()) {
+    Build();
+    return;
+  }
+  PlacementTracker &tracker = db_ptr_->design().GetPlacementTrackerRef();
+  std::vector<int> component_ids;
+  tracker.GetComponentsChangedSince(synced_epoch_, component_ids);
+  UpdateComponents(component_ids);
+  synced_epoch_ = tracker.GetEpoch();
+}
+
+/****
+ * @brief Rebuild the trees after some components are moved or rotated.
+ * Only nets connected to these components are re-evaluated. If the
+ * netlist changed, all trees are built again.
+ *
+ * @param component_ids: ids of the components which have been moved
+ * @return the change of the total wirelength, in DEF database unit
+ */
+int64_t SteinerTreeEngine::UpdateComponents(
+    std::vector<int> const &component_ids
+) {
+  if (IsConnectivityStale()) {
+    int64_t old_total_wirelength = total_wirelength_;
+    Build();
+    return total_wirelength_ - old_total_wirelength;
+  }
+  std::vector<int> affected_nets;
+  connectivity_ptr_->CollectNetsOfComponents(component_ids, affected_nets);
+  int64_t delta = 0;
+  for (int net_id : affected_nets) {
+    pin_locator_.LocateNetPins(net_id);
+    delta -= net_wirelength_[net_id];
+  }
+  BuildTrees(affected_nets);
+  for (int net_id : affected_nets) {
+    delta += net_wirelength_[net_id];
+  }
+  total_wirelength_ += delta;
+  return delta;
+}
+
+bool SteinerTreeEngine::IsConnectivityStale() const {
+  PhyDBExpects(
+      connectivity_ptr_ != nullptr,
+      "Please build SteinerTreeEngine before updating it"
+  );
+  return connectivity_generation_
+      != db_ptr_->design().GetConnectivityGeneration();
+}
+
+int64_t SteinerTreeEngine::Distance(size_t base, int a, int b) const {
+  return std::abs((int64_t) node_x_[base + a] - node_x_[base + b])
+      + std::abs((int64_t) node_y_[base + a] - node_y_[base + b]);
+}
+
+/****
+ * @brief Build the trees of some nets in parallel, using the current pin
+ * coordinates. Nets write to disjoint parts of the node and edge arrays.
+ */
+void SteinerTreeEngine::BuildTrees(std::vector<int> const &net_ids) {
+  const int chunk_size = 256;
+  int num_nets = static_cast<int>(net_ids.size());
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    Workspace workspace;
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    for (int i = chunk * chunk_size; i < end; ++i) {
+      BuildNetTree(net_ids[i], workspace);
+    }
+  });
+}
+
+void SteinerTreeEngine::BuildNetTree(int net_id, Workspace &workspace) {
+  int begin = connectivity_ptr_->GetNetPinBegin(net_id);
+  int num_pins = connectivity_ptr_->GetNetPinEnd(net_id) - begin;
+  size_t base = GetNodeOffset(net_id);
+  std::copy_n(pin_locator_.GetXPtr(begin), num_pins, &node_x_[base]);
+  std::copy_n(pin_locator_.GetYPtr(begin), num_pins, &node_y_[base]);
+
+  int num_nodes = num_pins;
+  if (num_pins >= 2) {
+    if (num_pins > kMaxPrimDegree) {
+      BuildSparseSpanningTree(base, num_pins, workspace);
+    } else {
+      BuildSpanningTree(base, num_pins, workspace);
+    }
+    num_nodes = Steinerize(base, num_pins, workspace);
+    int num_edges = 0;
+    for (int u = 0; u < num_nodes; ++u) {
+      for (int v : workspace.adjacency[u]) {
+        if (u < v) {
+          edges_[base + num_edges++] = SteinerEdge{u, v};
+        }
+      }
+    }
+  }
+  net_num_nodes_[net_id] = num_nodes;
+
+  int64_t wirelength = 0;
+  for (int i = 0; i < num_nodes - 1; ++i) {
+    SteinerEdge const &edge = edges_[base + i];
+    wirelength += Distance(base, edge.u, edge.v);
+  }
+  net_wirelength_[net_id] = wirelength;
+}
+
+/****
+ * @brief Prim's algorithm on the complete graph of the pins of a net, the
+ * tree is left in the adjacency lists of the workspace.
+ */
+void SteinerTreeEngine::BuildSpanningTree(
+    size_t base,
+    int num_pins,
+    Workspace &workspace
+) {
+  auto &adjacency = workspace.adjacency;
+  if (adjacency.size() < 2 * static_cast<size_t>(num_pins)) {
+    adjacency.resize(2 * static_cast<size_t>(num_pins));
+  }
+  for (int u = 0; u < 2 * num_pins; ++u) {
+    adjacency[u].clear();
+  }
+  // distance to the tree, -1 once a pin is in the tree
+  auto &distance = workspace.distance;
+  auto &parent = workspace.parent;
+  distance.assign(num_pins, INT64_MAX);
+  parent.assign(num_pins, -1);
+
+  int u = 0;
+  distance[u] = -1;
+  for (int k = 1; k < num_pins; ++k) {
+    int next = -1;
+    int64_t next_distance = INT64_MAX;
+    for (int v = 0; v < num_pins; ++v) {
+      if (distance[v] < 0) continue;
+      int64_t d = Distance(base, u, v);
+      if (d < distance[v]) {
+        distance[v] = d;
+        parent[v] = u;
+      }
+      if (distance[v] < next_distance) {
+        next_distance = distance[v];
+        next = v;
+      }
+    }
+    distance[next] = -1;
+    adjacency[next].push_back(parent[next]);
+    adjacency[parent[next]].push_back(next);
+    u = next;
+  }
+}
+
+/****
+ * @brief Improve a spanning tree by merging pairs of edges sharing a node.
+ * Edges u-v and u-w are replaced by a star from the median point s of u, v
+ * and w, which saves |uv| + |uw| minus the half perimeter of their bounding
+ * box. When s falls on v or w, an edge is simply moved there. The best
+ * merge of a node is applied until none saves wirelength, over a few
+ * passes, and every merge strictly shortens the tree.
+ *
+ * @return the number of nodes, pins followed by Steiner points
+ */
+int SteinerTreeEngine::Steinerize(
+    size_t base,
+    int num_pins,
+    Workspace &workspace
+) {
+  auto &adjacency = workspace.adjacency;
+  auto remove_edge = [&](int a, int b) {
+    auto &list = adjacency[a];
+    *std::find(list.begin(), list.end(), b) = list.back();
+    list.pop_back();
+  };
+  auto add_edge = [&](int a, int b) {
+    adjacency[a].push_back(b);
+    adjacency[b].push_back(a);
+  };
+  auto median = [](int a, int b, int c) {
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+  };
+
+  const int max_passes = 4;
+  int capacity = 2 * num_pins;
+  int num_nodes = num_pins;
+  bool is_improved = true;
+  for (int pass = 0; pass < max_passes && is_improved; ++pass) {
+    is_improved = false;
+    for (int u = 0; u < num_nodes && num_nodes < capacity; ++u) {
+      while (num_nodes < capacity) {
+        auto &neighbors = adjacency[u];
+        int64_t best_gain = 0;
+        int best_v = -1;
+        int best_w = -1;
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+          int v = neighbors[i];
+          int64_t uv = Distance(base, u, v);
+          for (size_t j = i + 1; j < neighbors.size(); ++j) {
+            int w = neighbors[j];
+            int64_t half_perimeter =
+                (int64_t) std::max({node_x_[base + u], node_x_[base + v],
+                                    node_x_[base + w]})
+                    - std::min({node_x_[base + u], node_x_[base + v],
+                                node_x_[base + w]})
+                    + std::max({node_y_[base + u], node_y_[base + v],
+                                node_y_[base + w]})
+                    - std::min({node_y_[base + u], node_y_[base + v],
+                                node_y_[base + w]});
+            int64_t gain = uv + Distance(base, u, w) - half_perimeter;
+            if (gain > best_gain) {
+              best_gain = gain;
+              best_v = v;
+              best_w = w;
+            }
+          }
+        }
+        if (best_v < 0) break;
+
+        int v = best_v;
+        int w = best_w;
+        int sx = median(
+            node_x_[base + u],
+            node_x_[base + v],
+            node_x_[base + w]
+        );
+        int sy = median(
+            node_y_[base + u],
+            node_y_[base + v],
+            node_y_[base + w]
+        );
+        if (sx == node_x_[base + v] && sy == node_y_[base + v]) {
+          remove_edge(u, w);
+          remove_edge(w, u);
+          add_edge(v, w);
+        } else if (sx == node_x_[base + w] && sy == node_y_[base + w]) {
+          remove_edge(u, v);
+          remove_edge(v, u);
+          add_edge(w, v);
+        } else {
+          int s = num_nodes++;
+          node_x_[base + s] = sx;
+          node_y_[base + s] = sy;
+          adjacency[s].clear();
+          remove_edge(u, v);
+          remove_edge(v, u);
+          remove_edge(u, w);
+          remove_edge(w, u);
+          add_edge(u, s);
+          add_edge(s, v);
+          add_edge(s, w);
+        }
+        is_improved = true;
+      }
+    }
+  }
+  return num_nodes;
+}
+
+/****
+ * @brief Kruskal's algorithm on a sparse graph of a large net. Every pin is
+ * connected to the pins in its own and the neighboring cells of a grid,
+ * which covers the nearest neighbors of most pins, and to the next
+ * kWindowSize pins in x and y order, which keeps the graph connected. The
+ * tree is left in the adjacency lists of the workspace.
+ */
+void SteinerTreeEngine::BuildSparseSpanningTree(
+    size_t base,
+    int num_pins,
+    Workspace &workspace
+) {
+  auto &adjacency = workspace.adjacency;
+  if (adjacency.size() < 2 * static_cast<size_t>(num_pins)) {
+    adjacency.resize(2 * static_cast<size_t>(num_pins));
+  }
+  for (int u = 0; u < 2 * num_pins; ++u) {
+    adjacency[u].clear();
+  }
+
+  auto &order = workspace.order;
+  auto &candidates = workspace.candidates;
+  order.resize(num_pins);
+  candidates.clear();
+  int const *xs = &node_x_[base];
+  int const *ys = &node_y_[base];
+  auto add_window_edges = [&](auto key) {
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      return key(a) < key(b);
+    });
+    for (int i = 0; i < num_pins; ++i) {
+      int end = std::min(num_pins, i + 1 + kWindowSize);
+      for (int j = i + 1; j < end; ++j) {
+        candidates.emplace_back(
+            Distance(base, order[i], order[j]),
+            SteinerEdge{order[i], order[j]}
+        );
+      }
+    }
+  };
+  add_window_edges([&](int a) { return (int64_t) xs[a]; });
+  add_window_edges([&](int a) { return (int64_t) ys[a]; });
+
+  // bucket pins into a grid of about two pins per cell, and connect every
+  // pin to the pins of its cell and the neighboring cells
+  auto x_range = std::minmax_element(xs, xs + num_pins);
+  auto y_range = std::minmax_element(ys, ys + num_pins);
+  int grid_size = std::max(1, (int) std::sqrt(num_pins / 2.0));
+  double cell_width = ((double) *x_range.second - *x_range.first + 1)
+      / grid_size;
+  double cell_height = ((double) *y_range.second - *y_range.first + 1)
+      / grid_size;
+  auto &cells = workspace.distance;
+  cells.resize(num_pins);
+  for (int a = 0; a < num_pins; ++a) {
+    int cx = std::min(grid_size - 1,
+                      (int) ((xs[a] - *x_range.first) / cell_width));
+    int cy = std::min(grid_size - 1,
+                      (int) ((ys[a] - *y_range.first) / cell_height));
+    cells[a] = (int64_t) cy * grid_size + cx;
+  }
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return cells[a] < cells[b];
+  });
+  auto &cell_begins = workspace.parent;
+  cell_begins.assign(grid_size * grid_size + 1, 0);
+  for (int a = 0; a < num_pins; ++a) {
+    ++cell_begins[cells[a] + 1];
+  }
+  std::partial_sum(
+      cell_begins.begin(),
+      cell_begins.end(),
+      cell_begins.begin()
+  );
+  for (int cy = 0; cy < grid_size; ++cy) {
+    for (int cx = 0; cx < grid_size; ++cx) {
+      int cell = cy * grid_size + cx;
+      for (int i = cell_begins[cell]; i < cell_begins[cell + 1]; ++i) {
+        // same cell, then the cells to the right and in the row above
+        for (int j = i + 1; j < cell_begins[cell + 1]; ++j) {
+          candidates.emplace_back(
+              Distance(base, order[i], order[j]),
+              SteinerEdge{order[i], order[j]}
+          );
+        }
+        int const neighbors[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+        for (auto const &neighbor : neighbors) {
+          int nx = cx + neighbor[0];
+          int ny = cy + neighbor[1];
+          if (nx < 0 || nx >= grid_size || ny >= grid_size) continue;
+          int other = ny * grid_size + nx;
+          for (int j = cell_begins[other]; j < cell_begins[other + 1]; ++j) {
+            candidates.emplace_back(
+                Distance(base, order[i], order[j]),
+                SteinerEdge{order[i], order[j]}
+            );
+          }
+        }
+      }
+    }
+  }
+  std::sort(
+      candidates.begin(),
+      candidates.end(),
+      [](auto const &a, auto const &b) { return a.first < b.first; }
+  );
+
+  // union-find over pins, in the parent array of the workspace
+  auto &parent = workspace.parent;
+  parent.resize(num_pins);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](int a) {
+    while (parent[a] != a) {
+      parent[a] = parent[parent[a]];
+      a = parent[a];
+    }
+    return a;
+  };
+  int num_edges = 0;
+  for (auto const &candidate : candidates) {
+    SteinerEdge const &edge = candidate.second;
+    int root_u = find(edge.u);
+    int root_v = find(edge.v);
+    if (root_u == root_v) continue;
+    parent[root_u] = root_v;
+    adjacency[edge.u].push_back(edge.v);
+    adjacency[edge.v].push_back(edge.u);
+    if (++num_edges == num_pins - 1) break;
+  }
+}
+
+}
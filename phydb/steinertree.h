@@ -0,0 +1,149 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_STEINERTREE_H_
+#define PHYDB_STEINERTREE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "netconnectivity.h"
+#include "phydb.h"
+#include "pinlocator.h"
+
+namespace phydb {
+
+// an edge of a Steiner tree, between two nodes of the same net
+struct SteinerEdge {
+  int u = -1;
+  int v = -1;
+};
+
+/****
+ * Rectilinear Steiner tree engine over all nets of a design.
+ *
+ * A net of degree n has at most 2n nodes. The first n nodes are its pins,
+ * in the pin order of the NetConnectivity of the design, the rest are
+ * Steiner points. Nodes and edges of all nets are stored in flat arrays,
+ * the storage of a net starts at twice the index of its first pin, so nets
+ * are built in parallel without any allocation shared between threads.
+ *
+ * A tree starts as a rectilinear minimum spanning tree of the pins. Nets
+ * with up to kMaxPrimDegree pins run Prim's algorithm on the complete
+ * graph; larger nets run Kruskal's algorithm on a sparse graph connecting
+ * every pin to the pins in neighboring cells of a uniform grid, which
+ * stays near-minimal at O(n log n) cost. The spanning tree is then improved
+ * by repeatedly merging two edges at a node through the median point of
+ * the three nodes. This gives optimal trees for three pins, and trees
+ * within a few percent of the minimum for larger nets.
+ *
+ * Trees are cached. Update() rebuilds only the trees of nets touching
+ * components moved since the last Build() or Update(), as recorded by the
+ * PlacementTracker of the design. If the netlist changed in between, the
+ * connectivity generation of the design moves on and the whole engine is
+ * built again.
+ */
+class SteinerTreeEngine {
+ public:
+  SteinerTreeEngine() = default;
+  explicit SteinerTreeEngine(PhyDB *db_ptr) : db_ptr_(db_ptr) {}
+
+  void SetDbPtr(PhyDB *db_ptr);
+  void SetNumThreads(int num_threads);
+  int GetNumThreads() const;
+
+  void Build();
+  void Update();
+  int64_t UpdateComponents(std::vector<int> const &component_ids);
+
+  NetConnectivity const &GetConnectivity() const { return *connectivity_ptr_; }
+  // generation of the design connectivity the trees are built on
+  uint64_t GetConnectivityGeneration() const {
+    return connectivity_generation_;
+  }
+  int64_t GetTotalWirelength() const { return total_wirelength_; }
+  int64_t GetNetWirelength(int net_id) const {
+    return net_wirelength_[net_id];
+  }
+  std::vector<int64_t> &GetNetWirelengthRef() { return net_wirelength_; }
+
+  // nodes and edges of a net are stored from this offset in flat arrays of
+  // GetStorageSize() entries, so users can keep per-node data alike
+  size_t GetNodeOffset(int net_id) const {
+    return 2 * static_cast<size_t>(connectivity_ptr_->GetNetPinBegin(net_id));
+  }
+  size_t GetStorageSize() const { return node_x_.size(); }
+  int GetNumNodes(int net_id) const { return net_num_nodes_[net_id]; }
+  int GetNumEdges(int net_id) const {
+    return std::max(net_num_nodes_[net_id] - 1, 0);
+  }
+  Point2D<int> GetNodeLocation(int net_id, int node) const {
+    size_t index = GetNodeOffset(net_id) + node;
+    return Point2D<int>(node_x_[index], node_y_[index]);
+  }
+  SteinerEdge const &GetEdge(int net_id, int edge) const {
+    return edges_[GetNodeOffset(net_id) + edge];
+  }
+
+ private:
+  static constexpr int kMaxPrimDegree = 256;
+  static constexpr int kWindowSize = 2;
+  // scratch space of a thread, reused between nets
+  struct Workspace {
+    std::vector<std::vector<int>> adjacency;
+    std::vector<int64_t> distance;
+    std::vector<int> parent;
+    std::vector<int> order;
+    std::vector<std::pair<int64_t, SteinerEdge>> candidates;
+  };
+
+  PhyDB *db_ptr_ = nullptr;
+  int num_threads_ = 1;
+  uint64_t synced_epoch_ = 0;
+
+  NetConnectivity const *connectivity_ptr_ = nullptr;
+  uint64_t connectivity_generation_ = 0;
+  PinLocator pin_locator_;
+
+  std::vector<int> node_x_;
+  std::vector<int> node_y_;
+  std::vector<SteinerEdge> edges_;
+  std::vector<int> net_num_nodes_;
+  std::vector<int64_t> net_wirelength_;
+  int64_t total_wirelength_ = 0;
+
+  bool IsConnectivityStale() const;
+  int64_t Distance(size_t base, int a, int b) const;
+  void BuildTrees(std::vector<int> const &net_ids);
+  void BuildNetTree(int net_id, Workspace &workspace);
+  void BuildSpanningTree(size_t base, int num_pins, Workspace &workspace);
+  void BuildSparseSpanningTree(
+      size_t base,
+      int num_pins,
+      Workspace &workspace
+  );
+  int Steinerize(size_t base, int num_pins, Workspace &workspace);
+};
+
+}
+
+#endif //PHYDB_STEINERTREE_H_
@@ -90,7 +90,7 @@ Site *Tech::AddSite(
   SiteClass site_class = StrToSiteClass(class_name);
   int id = static_cast<int>(sites_.size());
   sites_.emplace_back(site_name, site_class, width, height);
-  site_2_id_[site_name] = id;
+  site_2_id_[InternName(site_name)] = id;
   return &(sites_[id]);
 }
 
@@ -143,7 +143,7 @@ Layer *Tech::AddLayer(
   );
   int id = static_cast<int>(layers_.size());
   layers_.emplace_back(layer_name, type, direction);
-  layer_2_id_[layer_name] = id;
+  layer_2_id_[InternName(layer_name)] = id;
   layers_[id].SetID(id);
   return &(layers_[id]);
 }
@@ -156,12 +156,26 @@ Layer *Tech::GetLayerPtr(std::string const &layer_name) {
   return &(layers_[id]);
 }
 
-int Tech::GetLayerId(std::string const &layer_name) {
-  if (!IsLayerExisting(layer_name)) {
+int Tech::GetLayerId(std::string_view layer_name) {
+  auto res = layer_2_id_.find(layer_name);
+  if (res == layer_2_id_.end()) {
     return -1;
   }
-  int id = layer_2_id_[layer_name];
-  return id;
+  return res->second;
+}
+
+/****
+ * @brief Returns the layer id of a LayerRect. Shapes added by name only,
+ * e.g., through Pin::AddLayerRect(), have no id yet, their id is looked up
+ * by name.
+ *
+ * @return the layer id, or -1 if the layer does not exist
+ */
+int Tech::ResolveLayerId(LayerRect const &layer_rect) {
+  if (layer_rect.layer_id_ >= 0) {
+    return layer_rect.layer_id_;
+  }
+  return GetLayerId(layer_rect.GetLayerName());
 }
 
 const std::string &Tech::GetLayerName(int layer_id) {
@@ -180,8 +194,13 @@ std::vector<Layer *> &Tech::GetMetalLayersRef() {
   return metal_layers_;
 }
 
+void Tech::SetMacroCount(int count) {
+  macros_.reserve(count);
+  macro_2_id_.reserve(count);
+}
+
 bool Tech::IsMacroExisting(std::string const &macro_name) {
-  return macro_2_ptr_.find(macro_name) != macro_2_ptr_.end();
+  return macro_2_id_.find(macro_name) != macro_2_id_.end();
 }
 
 Macro *Tech::AddMacro(std::string const &macro_name) {
@@ -189,22 +208,72 @@ Macro *Tech::AddMacro(std::string const &macro_name) {
       !IsMacroExisting(macro_name),
       "Macro name_ exists, cannot use it again: " << macro_name
   );
+  MacroId id = static_cast<MacroId>(macros_.size());
   macros_.emplace_back(macro_name);
-  macro_2_ptr_[macro_name] = &macros_.back();
-  return &(macros_.back());
+  macro_2_id_[macros_[id].GetName()] = id;
+  return &(macros_[id]);
+}
+
+Macro *Tech::AddMacro(Macro &&macro) {
+  PhyDBExpects(
+      !IsMacroExisting(macro.GetName()),
+      "Macro name_ exists, cannot use it again: " << macro.GetName()
+  );
+  MacroId id = static_cast<MacroId>(macros_.size());
+  macros_.push_back(std::move(macro));
+  macro_2_id_[macros_[id].GetName()] = id;
+  return &(macros_[id]);
 }
 
 Macro *Tech::GetMacroPtr(std::string const &macro_name) {
-  if (!IsMacroExisting(macro_name)) {
+  auto res = macro_2_id_.find(macro_name);
+  if (res == macro_2_id_.end()) {
     return nullptr;
   }
-  return macro_2_ptr_[macro_name];
+  return &(macros_[res->second]);
+}
+
+/****
+ * @brief Returns the id of a macro, or -1 if there is no macro with this name.
+ */
+MacroId Tech::GetMacroId(std::string const &macro_name) {
+  auto res = macro_2_id_.find(macro_name);
+  if (res == macro_2_id_.end()) {
+    return -1;
+  }
+  return res->second;
 }
 
-std::list<Macro> &Tech::GetMacrosRef() {
+/****
+ * @brief Returns the id of a macro from its pointer, which must be given by
+ * this Tech and still be valid.
+ */
+MacroId Tech::GetMacroId(Macro const *macro_ptr) const {
+  PhyDBExpects(
+      macro_ptr >= macros_.data() && macro_ptr < macros_.data() + macros_.size(),
+      "Macro pointer does not belong to this technology"
+  );
+  return static_cast<MacroId>(macro_ptr - macros_.data());
+}
+
+std::vector<Macro> &Tech::GetMacrosRef() {
   return macros_;
 }
 
+/****
+ * @brief Compute pin offset tables of all macros whose tables are missing or
+ * out of date. Call this before querying pin locations from several threads.
+ *
+ * @param distance_microns: DEF database unit per micron
+ */
+void Tech::ComputePinOffsets(int distance_microns) {
+  for (auto &macro: macros_) {
+    if (!macro.IsPinOffsetsValid(distance_microns)) {
+      macro.ComputePinOffsets(distance_microns);
+    }
+  }
+}
+
 bool Tech::IsLefViaExisting(std::string const &via_name) {
   return via_2_id_.find(via_name) != via_2_id_.end();
 }
@@ -214,7 +283,7 @@ LefVia *Tech::AddLefVia(std::string const &via_name) {
                "VIA name_ exists, cannot use it again: " << via_name);
   int id = (int) vias_.size();
   vias_.emplace_back(via_name);
-  via_2_id_[via_name] = id;
+  via_2_id_[InternName(via_name)] = id;
   return &(vias_[id]);
 }
 
@@ -239,7 +308,7 @@ ViaRuleGenerate *Tech::AddViaRuleGenerate(std::string const &name) {
                "Macro name_ exists, cannot use it again");
   int id = (int) via_rule_generates_.size();
   via_rule_generates_.emplace_back(name);
-  via_rule_generate_2_id_[name] = id;
+  via_rule_generate_2_id_[InternName(name)] = id;
   return &(via_rule_generates_[id]);
 }
 
@@ -328,6 +397,8 @@ void Tech::GetDiffWellSpacing(
 
 void Tech::ReportWellShape() {
   for (auto &well : wells_) {
+    std::cout << "Well of BlockType: "
+              << macros_[well.GetMacroId()].GetName() << "\n";
     well.Report();
   }
 }
@@ -398,6 +469,15 @@ void Tech::FixResOverTable() {
   }
 }
 
+void Tech::CompileTechConfigTables() {
+  for (auto &metal_ptr : metal_layers_) {
+    auto layer_tech_config = metal_ptr->GetLayerTechConfig();
+    if (layer_tech_config != nullptr) {
+      layer_tech_config->CompileTables();
+    }
+  }
+}
+
 void Tech::SetResistanceUnit(bool from_tech_config, bool is_report) {
   if (from_tech_config) {
     for (auto &metal_ptr : metal_layers_) {
@@ -528,6 +608,8 @@ void Tech::ReportMacroWell() {
 
   std::cout << "Total number of  macro wells: " << wells_.size() << "\n";
   for (auto &macro_well : wells_) {
+    std::cout << "Well of BlockType: "
+              << macros_[macro_well.GetMacroId()].GetName() << "\n";
     macro_well.Report();
   }
   std::cout << "\n";
@@ -24,6 +24,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "layer.h"
@@ -37,7 +38,7 @@ namespace phydb {
 
 class Tech {
   friend class PhyDB;
-  friend class StarPiModelEstimator;
+  friend class Snapshot;
  public:
   Tech() : manufacturing_grid_(-1), database_micron_(-1) {}
   ~Tech();
@@ -71,15 +72,24 @@ class Tech {
       MetalDirection direction = MetalDirection::HORIZONTAL
   );
   Layer *GetLayerPtr(std::string const &layer_name);
-  int GetLayerId(std::string const &layer_name);
+  int GetLayerId(std::string_view layer_name);
+  int ResolveLayerId(LayerRect const &layer_rect);
   const std::string &GetLayerName(int layer_id);
   std::vector<Layer> &GetLayersRef();
   std::vector<Layer *> &GetMetalLayersRef();
 
+  // macro pointers are valid until the next AddMacro(), use MacroId to keep
+  // a reference to a macro
+  void SetMacroCount(int count);
   bool IsMacroExisting(std::string const &macro_name);
   Macro *AddMacro(std::string const &macro_name);
+  Macro *AddMacro(Macro &&macro);
   Macro *GetMacroPtr(std::string const &macro_name);
-  std::list<Macro> &GetMacrosRef();
+  MacroId GetMacroId(std::string const &macro_name);
+  MacroId GetMacroId(Macro const *macro_ptr) const;
+  Macro &GetMacro(MacroId macro_id) { return macros_[macro_id]; }
+  std::vector<Macro> &GetMacrosRef();
+  void ComputePinOffsets(int distance_microns);
 
   bool IsLefViaExisting(std::string const &via_name);
   LefVia *AddLefVia(std::string const &via_name);
@@ -130,6 +140,7 @@ class Tech {
       int corner_index
   );
   void FixResOverTable();
+  void CompileTechConfigTables();
   void SetResistanceUnit(bool from_tech_config, bool is_report);
   void SetCapacitanceUnit(bool from_tech_config, bool is_report);
   void ReportLayersTechConfig();
@@ -159,15 +170,15 @@ class Tech {
 
   std::vector<Site> sites_;
   std::vector<Layer> layers_;
-  std::list<Macro> macros_;
+  std::vector<Macro> macros_;
   std::vector<LefVia> vias_;
   std::vector<ViaRuleGenerate> via_rule_generates_;
 
-  std::unordered_map<std::string, int> layer_2_id_;
-  std::unordered_map<std::string, int> site_2_id_;
-  std::unordered_map<std::string, Macro *> macro_2_ptr_;
-  std::unordered_map<std::string, int> via_2_id_;
-  std::unordered_map<std::string, int> via_rule_generate_2_id_;
+  std::unordered_map<std::string_view, int> layer_2_id_;
+  std::unordered_map<std::string_view, int> site_2_id_;
+  std::unordered_map<std::string_view, MacroId> macro_2_id_;
+  std::unordered_map<std::string_view, int> via_2_id_;
+  std::unordered_map<std::string_view, int> via_rule_generate_2_id_;
 
   /****placement grid parameters****/
   bool is_placement_grid_set_ = false;
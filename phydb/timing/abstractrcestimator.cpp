@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "abstractrcestimator.h"
+
+#include "phydb/netconnectivity.h"
+
+namespace phydb {
+
+/****
+ * @brief Re-estimate the given nets and push them to the manager. This
+ * default implementation has no incremental support, and pushes all nets.
+ *
+ * @param net_ids: the nets to re-estimate
+ */
+void AbstractRcEstimator::PushNetRCToManager(
+    std::vector<int> const &net_ids
+) {
+  (void) net_ids;
+  PushNetRCToManager();
+}
+
+/****
+ * @brief Collect the nets touching components whose placement changed since
+ * the last call, and mark the estimator as synced with the current
+ * placement.
+ *
+ * @param net_ids: output, sorted ids of the changed nets
+ * @return false if all nets need to be estimated, which is the case for the
+ * first call and after the netlist changed
+ */
+bool AbstractRcEstimator::CollectChangedNets(std::vector<int> &net_ids) {
+  net_ids.clear();
+  Design &design = phy_db_->design();
+  NetConnectivity *connectivity_ptr = design.GetNetConnectivityPtr();
+  if (connectivity_ptr == nullptr) {
+    connectivity_ptr = design.BuildNetConnectivity();
+  }
+  PlacementTracker &tracker = design.GetPlacementTrackerRef();
+  uint64_t generation = design.GetConnectivityGeneration();
+  bool is_incremental = is_synced_
+      && (synced_connectivity_generation_ == generation);
+
+  if (is_incremental) {
+    std::vector<int> comp_ids;
+    tracker.GetComponentsChangedSince(synced_epoch_, comp_ids);
+    connectivity_ptr->CollectNetsOfComponents(comp_ids, net_ids);
+  }
+
+  is_synced_ = true;
+  synced_epoch_ = tracker.GetEpoch();
+  synced_connectivity_generation_ = generation;
+  return is_incremental;
+}
+
+/****
+ * @brief Push the parasitics of nets touching moved components, or of all
+ * nets when no earlier push is known.
+ */
+void AbstractRcEstimator::PushChangedNetRCToManager() {
+  std::vector<int> net_ids;
+  if (!CollectChangedNets(net_ids)) {
+    PushNetRCToManager();
+  } else if (!net_ids.empty()) {
+    PushNetRCToManager(net_ids);
+  }
+}
+
+}
@@ -21,10 +21,23 @@
 #ifndef PHYDB_TIMING_ABSTRACTRCESTIMATOR_H_
 #define PHYDB_TIMING_ABSTRACTRCESTIMATOR_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "phydb/phydb.h"
 
 namespace phydb {
 
+/****
+ * Base class of RC estimators, which push the parasitics of nets to the
+ * parasitics manager of a timer.
+ *
+ * Besides a full push, an estimator can keep the manager in sync with the
+ * placement incrementally: CollectChangedNets() reports the nets touching
+ * components moved since the last sync, and PushNetRCToManager(net_ids)
+ * re-estimates only those nets. Estimators without incremental support
+ * fall back to a full push.
+ */
 class AbstractRcEstimator {
  protected:
   PhyDB *phy_db_;
@@ -33,6 +46,17 @@ class AbstractRcEstimator {
   virtual ~AbstractRcEstimator() = default;
 
   virtual void PushNetRCToManager() = 0;
+  virtual void PushNetRCToManager(std::vector<int> const &net_ids);
+
+  bool CollectChangedNets(std::vector<int> &net_ids);
+  void PushChangedNetRCToManager();
+
+ private:
+  // placement epoch and connectivity generation at the last sync with the
+  // manager
+  bool is_synced_ = false;
+  uint64_t synced_epoch_ = 0;
+  uint64_t synced_connectivity_generation_ = 0;
 };
 
 }
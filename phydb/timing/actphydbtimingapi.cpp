@@ -21,6 +21,9 @@
 
 #include "actphydbtimingapi.h"
 
+#include <algorithm>
+
+#include "abstractrcestimator.h"
 #include "phydb/common/logging.h"
 
 namespace phydb {
@@ -304,12 +307,52 @@ void ActPhyDBTimingAPI::SpecifyTopK(int tc_num, int k) {
   SpecifyTopKCB(tc_num, k);
 }
 
+/****
+ * @brief Set the RC estimator used by UpdateTimingIncremental() to refresh
+ * the parasitics of nets touching moved components.
+ *
+ * @param rc_estimator: the estimator, or nullptr to leave parasitics alone
+ */
+void ActPhyDBTimingAPI::SetRcEstimator(AbstractRcEstimator *rc_estimator) {
+  rc_estimator_ = rc_estimator;
+}
+
 void ActPhyDBTimingAPI::UpdateTimingIncremental() {
   PhyDBExpects(UpdateTimingIncrementalCB != nullptr,
                "Callback function for UpdateTimingIncremental() is not set");
+  PushChangedNetRC();
   UpdateTimingIncrementalCB();
 }
 
+/****
+ * @brief Re-estimate the nets touching components moved since the last
+ * update. Nets without an ACT net are unknown to the timer, so they are
+ * skipped.
+ */
+void ActPhyDBTimingAPI::PushChangedNetRC() {
+  if (rc_estimator_ == nullptr) return;
+  std::vector<int> net_ids;
+  if (!rc_estimator_->CollectChangedNets(net_ids)) {
+    rc_estimator_->PushNetRCToManager();
+    return;
+  }
+  if (!net_id_2_act_.empty()) {
+    net_ids.erase(
+        std::remove_if(
+            net_ids.begin(),
+            net_ids.end(),
+            [this](int net_id) {
+              return net_id_2_act_.find(net_id) == net_id_2_act_.end();
+            }
+        ),
+        net_ids.end()
+    );
+  }
+  if (!net_ids.empty()) {
+    rc_estimator_->PushNetRCToManager(net_ids);
+  }
+}
+
 double ActPhyDBTimingAPI::GetSlack(int tc_num) {
   PhyDBExpects(GetSlackCB != nullptr,
                "Callback function for GetSlack() is not set");
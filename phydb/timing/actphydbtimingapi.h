@@ -38,6 +38,8 @@
 
 namespace phydb {
 
+class AbstractRcEstimator;
+
 /*
  * This is a data structure to represent pins in a net.
  * There are two kind of pins:
@@ -231,6 +233,7 @@ class ActPhyDBTimingAPI {
   int GetNumConstraints();
   void SpecifyTopKs(int k);
   void SpecifyTopK(int tc_num, int k);
+  void SetRcEstimator(AbstractRcEstimator *rc_estimator);
   void UpdateTimingIncremental();
   double GetSlack(int tc_num);
   void GetViolatedTimingConstraints(std::vector<int> &violated_tc_nums);
@@ -311,12 +314,17 @@ class ActPhyDBTimingAPI {
   // act component-pin pointer <=> phydb component-pin index
   std::unordered_map<void *, PhydbPin> component_pin_act_2_id_;
   std::unordered_map<PhydbPin, void *, PhydbPinHasher> component_pin_id_2_act_;
+
+  // re-pushes parasitics of nets touching moved components before timing
+  // is updated
+  AbstractRcEstimator *rc_estimator_ = nullptr;
 #if PHYDB_USE_GALOIS
   galois::eda::parasitics::Manager *para_manager_;
   std::vector<galois::eda::liberty::CellLib *> libs_;
   galois::eda::utility::ExtNetlistAdaptor *adaptor_;
 #endif
 
+  void PushChangedNetRC();
   void TranslateActPathToPhydbPath(
       std::vector<ActEdge> &act_path,
       PhydbPath &phydb_path
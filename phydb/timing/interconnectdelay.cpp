@@ -0,0 +1,273 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "interconnectdelay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "phydb/common/helper.h"
+#include "phydb/netconnectivity.h"
+
+namespace phydb {
+
+/****
+ * @brief Set the number of threads used to compute delays.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void InterconnectDelayEngine::SetNumThreads(int num_threads) {
+  num_threads_ = num_threads;
+}
+
+void InterconnectDelayEngine::SetMetric(WireDelayMetric metric) {
+  metric_ = metric;
+}
+
+/****
+ * @brief Set the input capacitance of a pin, added to its node of the RC
+ * tree in all corners. Pins have no load by default.
+ *
+ * @param phydb_pin: a component pin or an IO pin
+ * @param capacitance: in the unit of the layer capacitance
+ */
+void InterconnectDelayEngine::SetPinCapacitance(
+    PhydbPin phydb_pin,
+    double capacitance
+) {
+  pin_cap_map_[phydb_pin] = capacitance;
+  is_pin_cap_changed_ = true;
+}
+
+/****
+ * @brief Compute the delay and slew of all pins of all nets in parallel.
+ *
+ * @param corner: the RC corner
+ */
+void InterconnectDelayEngine::ComputeAllNets(int corner) {
+  Prepare(corner);
+  std::vector<int> net_ids(connectivity_ptr_->GetNumNets());
+  std::iota(net_ids.begin(), net_ids.end(), 0);
+  ComputeNets(net_ids, corner);
+}
+
+/****
+ * @brief Compute the delay and slew of all pins of a batch of nets in
+ * parallel. Results of other nets are kept if the corner is unchanged.
+ *
+ * @param net_ids: the nets to compute
+ * @param corner: the RC corner
+ */
+void InterconnectDelayEngine::ComputeNets(
+    std::vector<int> const &net_ids,
+    int corner
+) {
+  Prepare(corner);
+  const int chunk_size = 256;
+  int num_nets = static_cast<int>(net_ids.size());
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    Workspace workspace;
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    for (int i = chunk * chunk_size; i < end; ++i) {
+      ComputeNet(net_ids[i], workspace);
+    }
+  });
+}
+
+double InterconnectDelayEngine::GetDelay(PhydbPin phydb_pin) const {
+  int pin = FindPin(phydb_pin);
+  PhyDBExpects(pin >= 0, "Pin is not connected to any net: " << phydb_pin);
+  return delays_[pin];
+}
+
+double InterconnectDelayEngine::GetSlew(PhydbPin phydb_pin) const {
+  int pin = FindPin(phydb_pin);
+  PhyDBExpects(pin >= 0, "Pin is not connected to any net: " << phydb_pin);
+  return slews_[pin];
+}
+
+/****
+ * @brief Check the RC trees, and size the result and pin load arrays to the
+ * connectivity they are built on.
+ */
+void InterconnectDelayEngine::Prepare(int corner) {
+  PhyDBExpects(
+      rc_estimator_ptr_ != nullptr && rc_estimator_ptr_->IsBuilt(),
+      "Please estimate RC trees before computing interconnect delays"
+  );
+  PhyDBExpects(
+      corner >= 0 && corner < rc_estimator_ptr_->GetNumCorners(),
+      "RC corner out of range: " << corner
+  );
+  SteinerTreeEngine const &tree_engine =
+      rc_estimator_ptr_->GetSteinerTreeEngine();
+  connectivity_ptr_ = &tree_engine.GetConnectivity();
+  int num_pins = connectivity_ptr_->GetNumPins();
+  if (tree_engine.GetConnectivityGeneration() != connectivity_generation_
+      || static_cast<int>(delays_.size()) != num_pins
+      || corner != corner_) {
+    connectivity_generation_ = tree_engine.GetConnectivityGeneration();
+    corner_ = corner;
+    delays_.assign(num_pins, 0);
+    slews_.assign(num_pins, 0);
+    is_pin_cap_changed_ = true;
+  }
+  if (is_pin_cap_changed_) {
+    pin_caps_.assign(num_pins, 0);
+    for (auto const &pin_cap : pin_cap_map_) {
+      int pin = FindPin(pin_cap.first);
+      if (pin >= 0) {
+        pin_caps_[pin] = pin_cap.second;
+      }
+    }
+    is_pin_cap_changed_ = false;
+  }
+}
+
+/****
+ * @return the index of a pin in the NetConnectivity, or -1 if it is not
+ * connected to any net
+ */
+int InterconnectDelayEngine::FindPin(PhydbPin phydb_pin) const {
+  if (phydb_pin.IsComponentPin()) {
+    return connectivity_ptr_->GetComponentPin(
+        phydb_pin.InstanceId(),
+        phydb_pin.PinId()
+    );
+  }
+  int net_id = connectivity_ptr_->GetIoPinNetId(phydb_pin.PinId());
+  if (net_id < 0) return -1;
+  int end = connectivity_ptr_->GetNetPinEnd(net_id);
+  for (int pin = connectivity_ptr_->GetNetPinBegin(net_id); pin < end; ++pin) {
+    if (connectivity_ptr_->IsIoPin(pin)
+        && connectivity_ptr_->GetPinId(pin) == phydb_pin.PinId()) {
+      return pin;
+    }
+  }
+  return -1;
+}
+
+/****
+ * @brief Root the tree of a net at its driver, then compute the moments of
+ * all nodes: downstream sums in reverse breadth-first order, path sums in
+ * breadth-first order.
+ */
+void InterconnectDelayEngine::ComputeNet(int net_id, Workspace &workspace) {
+  SteinerRcEstimator const &rc = *rc_estimator_ptr_;
+  SteinerTreeEngine const &trees = rc.GetSteinerTreeEngine();
+  int num_nodes = trees.GetNumNodes(net_id);
+  if (num_nodes == 0) return;
+  int begin = connectivity_ptr_->GetNetPinBegin(net_id);
+  int degree = connectivity_ptr_->GetNetDegree(net_id);
+  int root = connectivity_ptr_->GetNetDriverPin(net_id);
+  root = root < 0 ? 0 : root - begin;
+
+  // edges around every node, in compressed sparse row format
+  int num_edges = trees.GetNumEdges(net_id);
+  auto &offsets = workspace.adjacency_offsets;
+  auto &adjacency = workspace.adjacency;
+  auto &parents = workspace.parents;
+  offsets.assign(num_nodes + 1, 0);
+  for (int e = 0; e < num_edges; ++e) {
+    SteinerEdge const &edge = trees.GetEdge(net_id, e);
+    ++offsets[edge.u + 1];
+    ++offsets[edge.v + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  adjacency.resize(2 * num_edges);
+  parents.assign(offsets.begin(), offsets.end() - 1);
+  for (int e = 0; e < num_edges; ++e) {
+    SteinerEdge const &edge = trees.GetEdge(net_id, e);
+    adjacency[parents[edge.u]++] = e;
+    adjacency[parents[edge.v]++] = e;
+  }
+
+  // breadth-first order from the root
+  auto &order = workspace.order;
+  auto &parent_res = workspace.parent_res;
+  order.clear();
+  order.push_back(root);
+  parents.assign(num_nodes, -1);
+  parent_res.assign(num_nodes, 0);
+  parents[root] = root;
+  for (size_t i = 0; i < order.size(); ++i) {
+    int u = order[i];
+    for (int slot = offsets[u]; slot < offsets[u + 1]; ++slot) {
+      int e = adjacency[slot];
+      SteinerEdge const &edge = trees.GetEdge(net_id, e);
+      int v = edge.u == u ? edge.v : edge.u;
+      if (parents[v] >= 0) continue;
+      parents[v] = u;
+      parent_res[v] = rc.GetEdgeResistance(net_id, e, corner_);
+      order.push_back(v);
+    }
+  }
+
+  auto node_cap = [&](int v) {
+    double cap = rc.GetNodeCapacitance(net_id, v, corner_);
+    return v < degree ? cap + pin_caps_[begin + v] : cap;
+  };
+  auto &down_caps = workspace.down_caps;
+  auto &down_moments = workspace.down_moments;
+  auto &m1 = workspace.m1;
+  auto &m2 = workspace.m2;
+  down_caps.assign(num_nodes, 0);
+  down_moments.assign(num_nodes, 0);
+  m1.assign(num_nodes, 0);
+  m2.assign(num_nodes, 0);
+
+  int num_reached = static_cast<int>(order.size());
+  for (int i = 0; i < num_reached; ++i) {
+    down_caps[order[i]] = node_cap(order[i]);
+  }
+  for (int i = num_reached - 1; i > 0; --i) {
+    int v = order[i];
+    down_caps[parents[v]] += down_caps[v];
+  }
+  for (int i = 1; i < num_reached; ++i) {
+    int v = order[i];
+    m1[v] = m1[parents[v]] + parent_res[v] * down_caps[v];
+  }
+  for (int i = 0; i < num_reached; ++i) {
+    down_moments[order[i]] = node_cap(order[i]) * m1[order[i]];
+  }
+  for (int i = num_reached - 1; i > 0; --i) {
+    int v = order[i];
+    down_moments[parents[v]] += down_moments[v];
+  }
+  for (int i = 1; i < num_reached; ++i) {
+    int v = order[i];
+    m2[v] = m2[parents[v]] + parent_res[v] * down_moments[v];
+  }
+
+  for (int v = 0; v < degree; ++v) {
+    double delay = m1[v];
+    if (metric_ == WireDelayMetric::D2M && m2[v] > 0) {
+      delay = std::log(2.0) * m1[v] * m1[v] / std::sqrt(m2[v]);
+    }
+    delays_[begin + v] = delay;
+    slews_[begin + v] =
+        std::log(9.0) * std::sqrt(std::max(2 * m2[v] - m1[v] * m1[v], 0.0));
+  }
+}
+
+}
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_TIMING_INTERCONNECTDELAY_H_
+#define PHYDB_TIMING_INTERCONNECTDELAY_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "actphydbtimingapi.h"
+#include "steinerrcestimator.h"
+
+namespace phydb {
+
+enum class WireDelayMetric {
+  ELMORE = 0,
+  D2M = 1
+};
+
+/****
+ * Native interconnect delay engine over the RC trees of a
+ * SteinerRcEstimator.
+ *
+ * The tree of every net is rooted at the driver pin found by
+ * NetConnectivity, or at its first pin if the net has no driver. Two moments
+ * of the impulse response at every node come from two passes over the tree:
+ *   m1(v) = sum over nodes k of R(v, k) * C(k)
+ *   m2(v) = sum over nodes k of R(v, k) * C(k) * m1(k)
+ * where R(v, k) is the resistance shared by the paths from the root to v
+ * and to k, and C(k) the capacitance at k, including pin loads. m1 is the
+ * Elmore delay, and D2M = ln(2) * m1^2 / sqrt(m2) is a closer estimate of
+ * the 50% delay. The slew (10%-90%) for a step at the driver is
+ * ln(9) * sqrt(2 * m2 - m1^2). Both are exact for a single RC section.
+ *
+ * Results are kept for one RC corner at a time, per pin in the order of the
+ * NetConnectivity of the design. The RC of the estimator must be up to date
+ * when delays are computed.
+ */
+class InterconnectDelayEngine {
+ public:
+  explicit InterconnectDelayEngine(SteinerRcEstimator *rc_estimator_ptr)
+      : rc_estimator_ptr_(rc_estimator_ptr) {}
+
+  void SetNumThreads(int num_threads);
+  void SetMetric(WireDelayMetric metric);
+  void SetPinCapacitance(PhydbPin phydb_pin, double capacitance);
+
+  void ComputeAllNets(int corner);
+  void ComputeNets(std::vector<int> const &net_ids, int corner);
+
+  // delay and slew from the driver to a pin, in the order of the
+  // NetConnectivity
+  double GetDelay(int pin) const { return delays_[pin]; }
+  double GetSlew(int pin) const { return slews_[pin]; }
+  double GetDelay(PhydbPin phydb_pin) const;
+  double GetSlew(PhydbPin phydb_pin) const;
+
+ private:
+  // scratch space of a thread, reused between nets
+  struct Workspace {
+    std::vector<int> adjacency_offsets;
+    std::vector<int> adjacency;
+    std::vector<int> order;
+    std::vector<int> parents;
+    std::vector<double> parent_res;
+    std::vector<double> down_caps;
+    std::vector<double> down_moments;
+    std::vector<double> m1;
+    std::vector<double> m2;
+  };
+
+  SteinerRcEstimator *rc_estimator_ptr_ = nullptr;
+  int num_threads_ = 1;
+  WireDelayMetric metric_ = WireDelayMetric::ELMORE;
+  int corner_ = 0;
+
+  NetConnectivity const *connectivity_ptr_ = nullptr;
+  uint64_t connectivity_generation_ = 0;
+  std::unordered_map<PhydbPin, double, PhydbPinHasher> pin_cap_map_;
+  bool is_pin_cap_changed_ = true;
+  std::vector<double> pin_caps_;
+  std::vector<double> delays_;
+  std::vector<double> slews_;
+
+  void Prepare(int corner);
+  int FindPin(PhydbPin phydb_pin) const;
+  void ComputeNet(int net_id, Workspace &workspace);
+};
+
+}
+
+#endif //PHYDB_TIMING_INTERCONNECTDELAY_H_
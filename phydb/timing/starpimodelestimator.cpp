@@ -0,0 +1,293 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "starpimodelestimator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "phydb/common/helper.h"
+#include "phydb/netconnectivity.h"
+
+namespace phydb {
+
+StarPiModelEstimator::StarPiModelEstimator(PhyDB *phydb_ptr)
+    : AbstractRcEstimator(phydb_ptr) {
+#if PHYDB_USE_GALOIS
+  batch_writer_ = &StarPiModelEstimator::WriteToParaManager;
+#endif
+}
+
+/****
+ * @brief Set the number of threads used to estimate nets.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void StarPiModelEstimator::SetNumThreads(int num_threads) {
+  num_threads_ = num_threads;
+}
+
+void StarPiModelEstimator::SetBatchSize(int batch_size) {
+  PhyDBExpects(batch_size > 0, "Batch size must be positive: " << batch_size);
+  batch_size_ = batch_size;
+}
+
+/****
+ * @brief Set the layers of horizontal and vertical wires. By default, they
+ * are the lowest horizontal and vertical metal layers above the first metal
+ * layer, which is mostly taken by cell pins.
+ *
+ * @param horizontal_layer_id: index of a metal layer in Tech::GetLayersRef()
+ * @param vertical_layer_id: index of a metal layer in Tech::GetLayersRef()
+ */
+void StarPiModelEstimator::SetWiringLayers(
+    int horizontal_layer_id,
+    int vertical_layer_id
+) {
+  int num_layers = static_cast<int>(phy_db_->tech().GetLayersRef().size());
+  PhyDBExpects(
+      horizontal_layer_id >= 0 && horizontal_layer_id < num_layers
+          && vertical_layer_id >= 0 && vertical_layer_id < num_layers,
+      "Layer id out of range: " << horizontal_layer_id << " "
+                                << vertical_layer_id
+  );
+  horizontal_layer_id_ = horizontal_layer_id;
+  vertical_layer_id_ = vertical_layer_id;
+}
+
+void StarPiModelEstimator::SetBatchWriter(BatchWriter batch_writer) {
+  batch_writer_ = std::move(batch_writer);
+}
+
+void StarPiModelEstimator::Prepare() {
+  Design &design = phy_db_->design();
+  wire_rc_model_.Build(phy_db_, horizontal_layer_id_, vertical_layer_id_);
+  num_corners_ = wire_rc_model_.GetNumCorners();
+  phy_db_->tech().ComputePinOffsets(design.GetUnitsDistanceMicrons());
+  connectivity_ptr_ = design.GetNetConnectivityPtr();
+  if (connectivity_ptr_ == nullptr) {
+    connectivity_ptr_ = design.BuildNetConnectivity();
+  }
+  connectivity_generation_ = design.GetConnectivityGeneration();
+  pin_locator_.Reset(phy_db_, connectivity_ptr_);
+}
+
+/****
+ * @brief Estimate the RC of all nets in parallel, using the current pin
+ * locations.
+ */
+void StarPiModelEstimator::EstimateAllNets() {
+  Prepare();
+  int num_nets = connectivity_ptr_->GetNumNets();
+  int num_pins = connectivity_ptr_->GetNumPins();
+  center_pins_.assign(num_nets, -1);
+  center_locations_.assign(num_nets, Point2D<int>());
+  center_caps_.assign(static_cast<size_t>(num_nets) * num_corners_, 0);
+  branch_res_.assign(static_cast<size_t>(num_pins) * num_corners_, 0);
+  pin_caps_.assign(static_cast<size_t>(num_pins) * num_corners_, 0);
+
+  const int chunk_size = 1024;
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    for (int net_id = chunk * chunk_size; net_id < end; ++net_id) {
+      EstimateNet(net_id);
+    }
+  });
+}
+
+/****
+ * @brief Re-estimate some nets in parallel, using the current pin locations.
+ * Results of other nets are kept. If the netlist changed since the last
+ * estimate, all nets are estimated.
+ *
+ * @param net_ids: the nets to estimate, without duplicates
+ */
+void StarPiModelEstimator::EstimateNets(std::vector<int> const &net_ids) {
+  Design &design = phy_db_->design();
+  if (connectivity_ptr_ == nullptr
+      || connectivity_generation_ != design.GetConnectivityGeneration()
+      || pin_caps_.size() != static_cast<size_t>(
+          connectivity_ptr_->GetNumPins()) * num_corners_) {
+    EstimateAllNets();
+    return;
+  }
+  phy_db_->tech().ComputePinOffsets(design.GetUnitsDistanceMicrons());
+
+  const int chunk_size = 256;
+  int num_nets = static_cast<int>(net_ids.size());
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    for (int i = chunk * chunk_size; i < end; ++i) {
+      EstimateNet(net_ids[i]);
+    }
+  });
+}
+
+/****
+ * @brief Estimate all nets, then pass them to the batch writer in batches.
+ */
+void StarPiModelEstimator::PushNetRCToManager() {
+  PhyDBExpects(
+      batch_writer_ != nullptr,
+      "Please set a batch writer in StarPiModelEstimator"
+  );
+  EstimateAllNets();
+  int num_nets = connectivity_ptr_->GetNumNets();
+  std::vector<int> batch;
+  for (int begin = 0; begin < num_nets; begin += batch_size_) {
+    int end = std::min(num_nets, begin + batch_size_);
+    batch.resize(end - begin);
+    for (int net_id = begin; net_id < end; ++net_id) {
+      batch[net_id - begin] = net_id;
+    }
+    batch_writer_(*this, batch);
+  }
+}
+
+/****
+ * @brief Re-estimate some nets, then pass them to the batch writer in
+ * batches.
+ *
+ * @param net_ids: the nets to re-estimate, without duplicates
+ */
+void StarPiModelEstimator::PushNetRCToManager(
+    std::vector<int> const &net_ids
+) {
+  PhyDBExpects(
+      batch_writer_ != nullptr,
+      "Please set a batch writer in StarPiModelEstimator"
+  );
+  EstimateNets(net_ids);
+  size_t batch_size = static_cast<size_t>(batch_size_);
+  if (net_ids.size() <= batch_size) {
+    batch_writer_(*this, net_ids);
+    return;
+  }
+  std::vector<int> batch;
+  for (size_t begin = 0; begin < net_ids.size(); begin += batch_size) {
+    size_t end = std::min(net_ids.size(), begin + batch_size);
+    batch.assign(net_ids.begin() + begin, net_ids.begin() + end);
+    batch_writer_(*this, batch);
+  }
+}
+
+#if PHYDB_USE_GALOIS
+/****
+ * @brief The default batch writer. Every branch becomes an edge between the
+ * center pin and a sink pin, and half of the wire capacitance is put on each
+ * end. Only nets driven by a component pin are written, and IO pins are
+ * left out, because the timer only knows component pins. Nets and pins must
+ * already be in the manager, see PhyDB::AddNetsAndCompPinsToSpefManager().
+ *
+ * @param net_ids: the nets to write, already estimated
+ */
+void StarPiModelEstimator::WriteToParaManager(
+    std::vector<int> const &net_ids
+) {
+  galois::eda::parasitics::Manager *manager = phy_db_->GetParaManager();
+  PhyDBExpects(
+      manager != nullptr,
+      "Cannot push RC to the timer because the SPEF manager is not set"
+  );
+  ActPhyDBTimingAPI &timing_api = phy_db_->GetTimingApi();
+  auto to_phydb_pin = [&](int pin) {
+    return PhydbPin(
+        connectivity_ptr_->GetPinComponentId(pin),
+        connectivity_ptr_->GetPinId(pin)
+    );
+  };
+  for (int net_id : net_ids) {
+    int center_pin = center_pins_[net_id];
+    if (center_pin < 0 || connectivity_ptr_->IsIoPin(center_pin)) continue;
+    galois::eda::parasitics::Node *center_node =
+        timing_api.PhyDBPinToSpefNode(to_phydb_pin(center_pin));
+    for (int c = 0; c < num_corners_; ++c) {
+      center_node->setC(c, GetCenterCapacitance(net_id, c));
+    }
+    int end = connectivity_ptr_->GetNetPinEnd(net_id);
+    for (int pin = connectivity_ptr_->GetNetPinBegin(net_id); pin < end;
+         ++pin) {
+      if (pin == center_pin || connectivity_ptr_->IsIoPin(pin)) continue;
+      galois::eda::parasitics::Node *node =
+          timing_api.PhyDBPinToSpefNode(to_phydb_pin(pin));
+      galois::eda::parasitics::Edge *edge =
+          manager->findEdge(center_node, node);
+      if (edge == nullptr) {
+        edge = manager->addEdge(center_node, node);
+      }
+      for (int c = 0; c < num_corners_; ++c) {
+        node->setC(c, GetPinCapacitance(pin, c));
+        edge->setR(c, GetBranchResistance(pin, c));
+      }
+    }
+  }
+}
+#endif
+
+/****
+ * @brief Locate the pins of a net, then build its star and fill in its RC
+ * for all corners.
+ *
+ * @param net_id: the net to estimate
+ */
+void StarPiModelEstimator::EstimateNet(int net_id) {
+  int begin = connectivity_ptr_->GetNetPinBegin(net_id);
+  int end = connectivity_ptr_->GetNetPinEnd(net_id);
+  double *center_caps =
+      &center_caps_[static_cast<size_t>(net_id) * num_corners_];
+  std::fill(center_caps, center_caps + num_corners_, 0);
+  if (end - begin < 2) return;
+
+  pin_locator_.LocateNetPins(net_id);
+  int64_t sum_x = 0;
+  int64_t sum_y = 0;
+  for (int pin = begin; pin < end; ++pin) {
+    sum_x += pin_locator_.GetX(pin);
+    sum_y += pin_locator_.GetY(pin);
+  }
+  int center_pin = connectivity_ptr_->GetNetDriverPin(net_id);
+  Point2D<int> center;
+  if (center_pin >= 0) {
+    center = pin_locator_.GetLocation(center_pin);
+  } else {
+    center.x = static_cast<int>(sum_x / (end - begin));
+    center.y = static_cast<int>(sum_y / (end - begin));
+  }
+  center_pins_[net_id] = center_pin;
+  center_locations_[net_id] = center;
+
+  for (int pin = begin; pin < end; ++pin) {
+    if (pin == center_pin) continue;
+    int64_t dx = std::abs((int64_t) pin_locator_.GetX(pin) - center.x);
+    int64_t dy = std::abs((int64_t) pin_locator_.GetY(pin) - center.y);
+    double *res = &branch_res_[static_cast<size_t>(pin) * num_corners_];
+    double *pin_caps = &pin_caps_[static_cast<size_t>(pin) * num_corners_];
+    for (int c = 0; c < num_corners_; ++c) {
+      double cap = 0;
+      wire_rc_model_.ComputeWireRc(dx, dy, c, res[c], cap);
+      pin_caps[c] = cap / 2;
+      center_caps[c] += cap / 2;
+    }
+  }
+}
+
+}
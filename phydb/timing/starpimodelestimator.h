@@ -0,0 +1,122 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_TIMING_STARPIMODELESTIMATOR_H_
+#define PHYDB_TIMING_STARPIMODELESTIMATOR_H_
+
+#include <functional>
+#include <vector>
+
+#include "abstractrcestimator.h"
+#include "phydb/pinlocator.h"
+#include "wirercmodel.h"
+
+namespace phydb {
+
+/****
+ * Star-topology RC estimator with a pi model for every branch.
+ *
+ * Every net becomes a star. Its center is the driver pin if the net has
+ * one, otherwise a virtual node at the centroid of its pins. Each other pin
+ * is connected to the center by an L-shaped wire: the horizontal part is on
+ * the horizontal wiring layer, the vertical part on the vertical wiring
+ * layer. The resistance R and capacitance C of a branch come from a
+ * WireRcModel. In the pi model, C/2 is lumped at the pin and C/2 at the
+ * center.
+ *
+ * Pins are numbered like in the NetConnectivity of the design, and results
+ * of all corners are stored in flat arrays, pin by pin. Nets are estimated
+ * in parallel. PushNetRCToManager() estimates all nets, then hands them to
+ * the batch writer in batches, so the writer, which adds nodes and edges to
+ * the parasitics manager of the timer, never needs to be thread-safe.
+ * PushNetRCToManager(net_ids) does the same for a subset of nets, such as
+ * the nets touching components moved since the last push.
+ *
+ * With Galois, the default batch writer is WriteToParaManager(), which
+ * writes into the parasitics manager of the timing API.
+ */
+class StarPiModelEstimator : public AbstractRcEstimator {
+ public:
+  // writes the results of a batch of nets to a parasitics manager
+  using BatchWriter = std::function<void(
+      StarPiModelEstimator &estimator,
+      std::vector<int> const &net_ids
+  )>;
+
+  explicit StarPiModelEstimator(PhyDB *phydb_ptr);
+
+  void SetNumThreads(int num_threads);
+  void SetBatchSize(int batch_size);
+  void SetWiringLayers(int horizontal_layer_id, int vertical_layer_id);
+  void SetBatchWriter(BatchWriter batch_writer);
+
+  void EstimateAllNets();
+  void EstimateNets(std::vector<int> const &net_ids);
+  void PushNetRCToManager() override;
+  void PushNetRCToManager(std::vector<int> const &net_ids) override;
+#if PHYDB_USE_GALOIS
+  void WriteToParaManager(std::vector<int> const &net_ids);
+#endif
+
+  int GetNumCorners() const { return num_corners_; }
+  NetConnectivity const &GetConnectivity() const { return *connectivity_ptr_; }
+  // the pin at the center of a net, or -1 for a virtual center
+  int GetCenterPin(int net_id) const { return center_pins_[net_id]; }
+  Point2D<int> GetCenterLocation(int net_id) const {
+    return center_locations_[net_id];
+  }
+  double GetCenterCapacitance(int net_id, int corner) const {
+    return center_caps_[net_id * num_corners_ + corner];
+  }
+  // resistance of the wire from the center of its net to a pin
+  double GetBranchResistance(int pin, int corner) const {
+    return branch_res_[pin * num_corners_ + corner];
+  }
+  // half of the capacitance of the wire to a pin, lumped at the pin
+  double GetPinCapacitance(int pin, int corner) const {
+    return pin_caps_[pin * num_corners_ + corner];
+  }
+
+ private:
+  int num_threads_ = 1;
+  int batch_size_ = 4096;
+  int horizontal_layer_id_ = -1;
+  int vertical_layer_id_ = -1;
+  BatchWriter batch_writer_;
+
+  NetConnectivity const *connectivity_ptr_ = nullptr;
+  uint64_t connectivity_generation_ = 0;
+  PinLocator pin_locator_;
+  WireRcModel wire_rc_model_;
+  int num_corners_ = 0;
+
+  std::vector<int> center_pins_;
+  std::vector<Point2D<int>> center_locations_;
+  std::vector<double> center_caps_;
+  std::vector<double> branch_res_;
+  std::vector<double> pin_caps_;
+
+  void Prepare();
+  void EstimateNet(int net_id);
+};
+
+}
+
+#endif //PHYDB_TIMING_STARPIMODELESTIMATOR_H_
@@ -0,0 +1,179 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "steinerrcestimator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+#include "phydb/common/helper.h"
+#include "phydb/netconnectivity.h"
+
+namespace phydb {
+
+SteinerRcEstimator::SteinerRcEstimator(PhyDB *phydb_ptr)
+    : AbstractRcEstimator(phydb_ptr), tree_engine_(phydb_ptr) {}
+
+/****
+ * @brief Set the number of threads used to build trees and estimate nets.
+ *
+ * @param num_threads: the number of threads, non-positive means all cores
+ */
+void SteinerRcEstimator::SetNumThreads(int num_threads) {
+  num_threads_ = num_threads;
+  tree_engine_.SetNumThreads(num_threads);
+}
+
+void SteinerRcEstimator::SetBatchSize(int batch_size) {
+  PhyDBExpects(batch_size > 0, "Batch size must be positive: " << batch_size);
+  batch_size_ = batch_size;
+}
+
+/****
+ * @brief Set the layers of horizontal and vertical wires, see
+ * WireRcModel::Build() for the defaults.
+ */
+void SteinerRcEstimator::SetWiringLayers(
+    int horizontal_layer_id,
+    int vertical_layer_id
+) {
+  horizontal_layer_id_ = horizontal_layer_id;
+  vertical_layer_id_ = vertical_layer_id;
+  is_built_ = false;
+}
+
+void SteinerRcEstimator::SetBatchWriter(BatchWriter batch_writer) {
+  batch_writer_ = std::move(batch_writer);
+}
+
+/****
+ * @brief Build the trees of all nets, then estimate their RC in parallel.
+ */
+void SteinerRcEstimator::EstimateAllNets() {
+  wire_rc_model_.Build(phy_db_, horizontal_layer_id_, vertical_layer_id_);
+  num_corners_ = wire_rc_model_.GetNumCorners();
+  tree_engine_.Build();
+  size_t size = tree_engine_.GetStorageSize() * num_corners_;
+  node_caps_.assign(size, 0);
+  edge_res_.assign(size, 0);
+  is_built_ = true;
+
+  std::vector<int> net_ids(tree_engine_.GetConnectivity().GetNumNets());
+  std::iota(net_ids.begin(), net_ids.end(), 0);
+  EstimateNetList(net_ids);
+}
+
+/****
+ * @brief Rebuild the trees of nets touching components moved since the
+ * last estimate, then re-estimate some nets. If the netlist changed, all
+ * nets are estimated.
+ *
+ * @param net_ids: the nets to estimate, without duplicates
+ */
+void SteinerRcEstimator::EstimateNets(std::vector<int> const &net_ids) {
+  if (!is_built_
+      || tree_engine_.GetConnectivityGeneration()
+          != phy_db_->design().GetConnectivityGeneration()) {
+    EstimateAllNets();
+    return;
+  }
+  tree_engine_.Update();
+  EstimateNetList(net_ids);
+}
+
+/****
+ * @brief Estimate all nets, then pass them to the batch writer in batches.
+ */
+void SteinerRcEstimator::PushNetRCToManager() {
+  PhyDBExpects(
+      batch_writer_ != nullptr,
+      "Please set a batch writer in SteinerRcEstimator"
+  );
+  EstimateAllNets();
+  std::vector<int> net_ids(tree_engine_.GetConnectivity().GetNumNets());
+  std::iota(net_ids.begin(), net_ids.end(), 0);
+  WriteBatches(net_ids);
+}
+
+/****
+ * @brief Re-estimate some nets, then pass them to the batch writer in
+ * batches.
+ *
+ * @param net_ids: the nets to re-estimate, without duplicates
+ */
+void SteinerRcEstimator::PushNetRCToManager(std::vector<int> const &net_ids) {
+  PhyDBExpects(
+      batch_writer_ != nullptr,
+      "Please set a batch writer in SteinerRcEstimator"
+  );
+  EstimateNets(net_ids);
+  WriteBatches(net_ids);
+}
+
+void SteinerRcEstimator::EstimateNetList(std::vector<int> const &net_ids) {
+  const int chunk_size = 256;
+  int num_nets = static_cast<int>(net_ids.size());
+  int num_chunks = (num_nets + chunk_size - 1) / chunk_size;
+  ParallelFor(num_chunks, num_threads_, [&](int chunk) {
+    int end = std::min(num_nets, (chunk + 1) * chunk_size);
+    for (int i = chunk * chunk_size; i < end; ++i) {
+      EstimateNet(net_ids[i]);
+    }
+  });
+}
+
+void SteinerRcEstimator::EstimateNet(int net_id) {
+  int num_nodes = tree_engine_.GetNumNodes(net_id);
+  if (num_nodes == 0) return;
+  double *node_caps = &node_caps_[Index(net_id, 0, 0)];
+  std::fill(node_caps, node_caps + num_nodes * num_corners_, 0);
+  int num_edges = tree_engine_.GetNumEdges(net_id);
+  for (int edge = 0; edge < num_edges; ++edge) {
+    SteinerEdge const &tree_edge = tree_engine_.GetEdge(net_id, edge);
+    Point2D<int> u = tree_engine_.GetNodeLocation(net_id, tree_edge.u);
+    Point2D<int> v = tree_engine_.GetNodeLocation(net_id, tree_edge.v);
+    int64_t dx = std::abs((int64_t) u.x - v.x);
+    int64_t dy = std::abs((int64_t) u.y - v.y);
+    double *res = &edge_res_[Index(net_id, edge, 0)];
+    for (int c = 0; c < num_corners_; ++c) {
+      double cap = 0;
+      wire_rc_model_.ComputeWireRc(dx, dy, c, res[c], cap);
+      node_caps[tree_edge.u * num_corners_ + c] += cap / 2;
+      node_caps[tree_edge.v * num_corners_ + c] += cap / 2;
+    }
+  }
+}
+
+void SteinerRcEstimator::WriteBatches(std::vector<int> const &net_ids) {
+  size_t batch_size = static_cast<size_t>(batch_size_);
+  if (net_ids.size() <= batch_size) {
+    batch_writer_(*this, net_ids);
+    return;
+  }
+  std::vector<int> batch;
+  for (size_t begin = 0; begin < net_ids.size(); begin += batch_size) {
+    size_t end = std::min(net_ids.size(), begin + batch_size);
+    batch.assign(net_ids.begin() + begin, net_ids.begin() + end);
+    batch_writer_(*this, batch);
+  }
+}
+
+}
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_TIMING_STEINERRCESTIMATOR_H_
+#define PHYDB_TIMING_STEINERRCESTIMATOR_H_
+
+#include <functional>
+#include <vector>
+
+#include "abstractrcestimator.h"
+#include "phydb/steinertree.h"
+#include "wirercmodel.h"
+
+namespace phydb {
+
+/****
+ * RC estimator over the rectilinear Steiner trees of nets.
+ *
+ * Every edge of a tree becomes an L-shaped wire, with RC from a
+ * WireRcModel, and a pi section: its resistance sits on the edge, half of
+ * its capacitance on each end node. Nodes and edges are those of the
+ * SteinerTreeEngine owned by the estimator, so the first
+ * GetNetDegree(net_id) nodes of a net are its pins in the order of the
+ * NetConnectivity of the design, followed by Steiner points.
+ *
+ * Unlike a star, the trees share wire between pins, so the load of high
+ * fanout nets is not overestimated. PushNetRCToManager(net_ids) only
+ * rebuilds trees of nets touching moved components.
+ */
+class SteinerRcEstimator : public AbstractRcEstimator {
+ public:
+  // writes the results of a batch of nets to a parasitics manager
+  using BatchWriter = std::function<void(
+      SteinerRcEstimator &estimator,
+      std::vector<int> const &net_ids
+  )>;
+
+  explicit SteinerRcEstimator(PhyDB *phydb_ptr);
+
+  void SetNumThreads(int num_threads);
+  void SetBatchSize(int batch_size);
+  void SetWiringLayers(int horizontal_layer_id, int vertical_layer_id);
+  void SetBatchWriter(BatchWriter batch_writer);
+
+  void EstimateAllNets();
+  void EstimateNets(std::vector<int> const &net_ids);
+  void PushNetRCToManager() override;
+  void PushNetRCToManager(std::vector<int> const &net_ids) override;
+
+  bool IsBuilt() const { return is_built_; }
+  int GetNumCorners() const { return num_corners_; }
+  SteinerTreeEngine const &GetSteinerTreeEngine() const {
+    return tree_engine_;
+  }
+  // capacitance lumped at a node of the tree of a net
+  double GetNodeCapacitance(int net_id, int node, int corner) const {
+    return node_caps_[Index(net_id, node, corner)];
+  }
+  // resistance of an edge of the tree of a net
+  double GetEdgeResistance(int net_id, int edge, int corner) const {
+    return edge_res_[Index(net_id, edge, corner)];
+  }
+
+ private:
+  int num_threads_ = 1;
+  int batch_size_ = 4096;
+  int horizontal_layer_id_ = -1;
+  int vertical_layer_id_ = -1;
+  BatchWriter batch_writer_;
+
+  SteinerTreeEngine tree_engine_;
+  WireRcModel wire_rc_model_;
+  int num_corners_ = 0;
+  bool is_built_ = false;
+  // per node and per edge, results of all corners, in the storage order of
+  // the tree engine
+  std::vector<double> node_caps_;
+  std::vector<double> edge_res_;
+
+  size_t Index(int net_id, int item, int corner) const {
+    return (tree_engine_.GetNodeOffset(net_id) + item) * num_corners_
+        + corner;
+  }
+  void EstimateNetList(std::vector<int> const &net_ids);
+  void EstimateNet(int net_id);
+  void WriteBatches(std::vector<int> const &net_ids);
+};
+
+}
+
+#endif //PHYDB_TIMING_STEINERRCESTIMATOR_H_
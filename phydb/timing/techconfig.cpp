@@ -91,6 +91,130 @@ void ConfigTable::Report() const {
   }
 }
 
+/****
+ * @brief Copy the entries of a table, sorted by distance, into columns.
+ */
+void CompiledConfigTable::Compile(ConfigTable &table) {
+  type_ = table.Type();
+  index0_ = table.Index0();
+  index1_ = table.Index1();
+  std::vector<TableEntry> entries = table.GetTable();
+  std::stable_sort(
+      entries.begin(),
+      entries.end(),
+      [](TableEntry const &a, TableEntry const &b) {
+        return a.distance_ < b.distance_;
+      }
+  );
+  if (entries.size() == 1) {
+    entries.push_back(entries[0]);
+  }
+  size_t size = entries.size();
+  distances_.resize(size);
+  coupling_caps_.resize(size);
+  fringe_caps_.resize(size);
+  res_.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    distances_[i] = entries[i].distance_;
+    coupling_caps_[i] = entries[i].coupling_cap_;
+    fringe_caps_[i] = entries[i].fringe_cap_;
+    res_[i] = entries[i].res_;
+  }
+}
+
+/****
+ * @brief Find the segment [index, index + 1] of a distance, and the weight
+ * of its upper end. The loop runs log2(size) times whatever the distance,
+ * and its only data dependence is a conditional move.
+ */
+void CompiledConfigTable::Locate(
+    double distance,
+    size_t &index,
+    double &weight
+) const {
+  double const *first = distances_.data();
+  double const *base = first;
+  size_t length = distances_.size() - 1;
+  while (length > 1) {
+    size_t half = length / 2;
+    base = (base[half] <= distance) ? base + half : base;
+    length -= half;
+  }
+  index = base - first;
+  double span = base[1] - base[0];
+  weight = span > 0 ? (distance - base[0]) / span : 0;
+  weight = std::min(std::max(weight, 0.0), 1.0);
+}
+
+double CompiledConfigTable::GetCouplingCap(double distance) const {
+  PhyDBExpects(!IsEmpty(), "Cannot query an empty technology table");
+  size_t index;
+  double weight;
+  Locate(distance, index, weight);
+  return Interpolate(coupling_caps_, index, weight);
+}
+
+double CompiledConfigTable::GetFringeCap(double distance) const {
+  PhyDBExpects(!IsEmpty(), "Cannot query an empty technology table");
+  size_t index;
+  double weight;
+  Locate(distance, index, weight);
+  return Interpolate(fringe_caps_, index, weight);
+}
+
+double CompiledConfigTable::GetRes(double distance) const {
+  PhyDBExpects(!IsEmpty(), "Cannot query an empty technology table");
+  size_t index;
+  double weight;
+  Locate(distance, index, weight);
+  return Interpolate(res_, index, weight);
+}
+
+/****
+ * @brief Unit coupling and fringe capacitance of many wire segments.
+ *
+ * @param distances: distance to the neighbor of each segment, in micron
+ * @param count: the number of segments
+ * @param coupling_caps: output, unit coupling capacitance of each segment
+ * @param fringe_caps: output, unit fringe capacitance of each segment
+ */
+void CompiledConfigTable::GetCaps(
+    double const *distances,
+    size_t count,
+    double *coupling_caps,
+    double *fringe_caps
+) const {
+  PhyDBExpects(!IsEmpty(), "Cannot query an empty technology table");
+  for (size_t i = 0; i < count; ++i) {
+    size_t index;
+    double weight;
+    Locate(distances[i], index, weight);
+    coupling_caps[i] = Interpolate(coupling_caps_, index, weight);
+    fringe_caps[i] = Interpolate(fringe_caps_, index, weight);
+  }
+}
+
+/****
+ * @brief Unit resistance of many wire segments.
+ *
+ * @param distances: distance to the neighbor of each segment, in micron
+ * @param count: the number of segments
+ * @param res: output, unit resistance of each segment
+ */
+void CompiledConfigTable::GetRes(
+    double const *distances,
+    size_t count,
+    double *res
+) const {
+  PhyDBExpects(!IsEmpty(), "Cannot query an empty technology table");
+  for (size_t i = 0; i < count; ++i) {
+    size_t index;
+    double weight;
+    Locate(distances[i], index, weight);
+    res[i] = Interpolate(res_, index, weight);
+  }
+}
+
 void TechConfig::SetDiagModelOn(bool is_diagmodel_on) {
   is_diagmodel_on_ = is_diagmodel_on;
 }
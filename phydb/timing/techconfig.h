@@ -21,6 +21,7 @@
 #ifndef PHYDB_TIMING_TECHCONFIG_H_
 #define PHYDB_TIMING_TECHCONFIG_H_
 
+#include <cstddef>
 #include <vector>
 
 namespace phydb {
@@ -110,6 +111,55 @@ struct ConfigTable {
   std::vector<TableEntry> table_;
 };
 
+/****
+ * @brief A ConfigTable compiled for fast queries.
+ *
+ * Entries are sorted by distance and stored column by column. A query finds
+ * the segment containing a distance by a branch-free binary search, whose
+ * number of steps only depends on the table size, then interpolates
+ * linearly inside the segment. Distances outside the table are clamped to
+ * its first or last entry.
+ */
+class CompiledConfigTable {
+ public:
+  void Compile(ConfigTable &table);
+
+  TableType Type() const { return type_; }
+  int Index0() const { return index0_; }
+  int Index1() const { return index1_; }
+  bool IsEmpty() const { return distances_.empty(); }
+
+  double GetCouplingCap(double distance) const;
+  double GetFringeCap(double distance) const;
+  double GetRes(double distance) const;
+  void GetCaps(
+      double const *distances,
+      size_t count,
+      double *coupling_caps,
+      double *fringe_caps
+  ) const;
+  void GetRes(double const *distances, size_t count, double *res) const;
+
+ private:
+  TableType type_ = BAD_TABLE_TYPE;
+  int index0_ = -1;
+  int index1_ = -1;
+  // at least two entries once compiled, a single entry is repeated
+  std::vector<double> distances_;
+  std::vector<double> coupling_caps_;
+  std::vector<double> fringe_caps_;
+  std::vector<double> res_;
+
+  void Locate(double distance, size_t &index, double &weight) const;
+  static double Interpolate(
+      std::vector<double> const &column,
+      size_t index,
+      double weight
+  ) {
+    return column[index] + weight * (column[index + 1] - column[index]);
+  }
+};
+
 class TechConfig {
  public:
   bool is_diagmodel_on_ = false;
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "wirercmodel.h"
+
+#include <algorithm>
+
+namespace phydb {
+
+/****
+ * @brief Choose the wiring layers and compute the per-micron RC
+ * coefficients of all corners.
+ *
+ * @param phy_db: the database providing layers and the DEF database unit
+ * @param horizontal_layer_id: index of a metal layer in Tech::GetLayersRef(),
+ * -1 for the lowest horizontal metal layer above the first metal layer,
+ * which is mostly taken by cell pins
+ * @param vertical_layer_id: the same for vertical wires
+ */
+void WireRcModel::Build(
+    PhyDB *phy_db,
+    int horizontal_layer_id,
+    int vertical_layer_id
+) {
+  Tech &tech = phy_db->tech();
+  auto &layers = tech.GetLayersRef();
+  int num_layers = static_cast<int>(layers.size());
+  PhyDBExpects(
+      horizontal_layer_id < num_layers && vertical_layer_id < num_layers,
+      "Layer id out of range: " << horizontal_layer_id << " "
+                                << vertical_layer_id
+  );
+  dbu_per_micron_ = phy_db->design().GetUnitsDistanceMicrons();
+  PhyDBExpects(
+      dbu_per_micron_ > 0,
+      "DEF database unit is not set, cannot estimate RC"
+  );
+  horizontal_layer_id_ = horizontal_layer_id;
+  vertical_layer_id_ = vertical_layer_id;
+  ChooseWiringLayers(tech);
+
+  Layer &horizontal_layer = layers[horizontal_layer_id_];
+  Layer &vertical_layer = layers[vertical_layer_id_];
+  num_corners_ = std::min(
+      horizontal_layer.GetRcCornerCount(),
+      vertical_layer.GetRcCornerCount()
+  );
+  PhyDBExpects(
+      num_corners_ > 0,
+      "Unit resistance and capacitance are not set for layers "
+          << horizontal_layer.GetName() << " and "
+          << vertical_layer.GetName()
+  );
+
+  // resistance is linear in the length, fringe and area capacitance are
+  // affine in the length, so two samples give the coefficients
+  auto compute = [&](
+      Layer &layer,
+      std::vector<double> &res,
+      std::vector<double> &cap_base,
+      std::vector<double> &cap
+  ) {
+    double width = layer.GetWidth();
+    res.resize(num_corners_);
+    cap_base.resize(num_corners_);
+    cap.resize(num_corners_);
+    double spacing = TrackSpacing(layer);
+    for (int c = 0; c < num_corners_; ++c) {
+      res[c] = layer.GetResistance(width, 1, c);
+      CompiledConfigTable const *table = CapOverSubstrateTable(layer, c);
+      if (table != nullptr) {
+        // fringe capacitance on both sides, like Layer::GetFringeCapacitance
+        double fringe_cap = table->GetFringeCap(spacing);
+        double coupling_cap = table->GetCouplingCap(spacing);
+        cap_base[c] = 2 * fringe_cap * width;
+        cap[c] = 2 * (fringe_cap + coupling_cap);
+        continue;
+      }
+      cap_base[c] = layer.GetFringeCapacitance(width, 0, c)
+          + layer.GetAreaCapacitance(width, 0, c);
+      cap[c] = layer.GetFringeCapacitance(width, 1, c)
+          + layer.GetAreaCapacitance(width, 1, c) - cap_base[c];
+    }
+  };
+  compute(
+      horizontal_layer,
+      horizontal_res_,
+      horizontal_cap_base_,
+      horizontal_cap_
+  );
+  compute(vertical_layer, vertical_res_, vertical_cap_base_, vertical_cap_);
+}
+
+/****
+ * @brief The RC of a wire made of a horizontal and a vertical segment.
+ *
+ * @param dx: length of the horizontal segment, in DEF database unit
+ * @param dy: length of the vertical segment, in DEF database unit
+ * @param corner: the RC corner
+ * @param res: output, resistance of the wire
+ * @param cap: output, capacitance of the wire
+ */
+void WireRcModel::ComputeWireRc(
+    int64_t dx,
+    int64_t dy,
+    int corner,
+    double &res,
+    double &cap
+) const {
+  res = 0;
+  cap = 0;
+  if (dx > 0) {
+    double length = dx / dbu_per_micron_;
+    res += horizontal_res_[corner] * length;
+    cap += horizontal_cap_base_[corner] + horizontal_cap_[corner] * length;
+  }
+  if (dy > 0) {
+    double length = dy / dbu_per_micron_;
+    res += vertical_res_[corner] * length;
+    cap += vertical_cap_base_[corner] + vertical_cap_[corner] * length;
+  }
+}
+
+/****
+ * @brief The distance between a wire and the wires on its adjacent tracks,
+ * in micron. It is the track pitch minus the wire width, or the minimum
+ * spacing of the layer if the pitch is not set.
+ */
+double WireRcModel::TrackSpacing(Layer &layer) {
+  double pitch = layer.GetDirection() == MetalDirection::HORIZONTAL
+                 ? layer.GetPitchY() : layer.GetPitchX();
+  double spacing = pitch - layer.GetWidth();
+  if (spacing <= 0) {
+    spacing = layer.GetSpacing();
+  }
+  return spacing;
+}
+
+/****
+ * @brief The compiled CAP_OVER table over the substrate of a corner, or
+ * nullptr if the layer has no technology configuration for that corner.
+ */
+CompiledConfigTable const *WireRcModel::CapOverSubstrateTable(
+    Layer &layer,
+    int corner
+) {
+  LayerTechConfig *tech_config = layer.GetLayerTechConfig();
+  if (tech_config == nullptr
+      || corner >= static_cast<int>(tech_config->CornersRef().size())) {
+    return nullptr;
+  }
+  return tech_config->CornersRef()[corner].GetCompiledTable(CAP_OVER, -1);
+}
+
+void WireRcModel::ChooseWiringLayers(Tech &tech) {
+  if (horizontal_layer_id_ >= 0 && vertical_layer_id_ >= 0) return;
+  auto &metal_layers = tech.GetMetalLayersRef();
+  Layer *layers = tech.GetLayersRef().data();
+  // only layers still unset are picked, so the second pass only fills in
+  // what the first metal layer can provide
+  auto pick = [&](size_t first) {
+    for (size_t i = first; i < metal_layers.size(); ++i) {
+      int layer_id = static_cast<int>(metal_layers[i] - layers);
+      MetalDirection direction = metal_layers[i]->GetDirection();
+      if (direction == MetalDirection::HORIZONTAL && horizontal_layer_id_ < 0) {
+        horizontal_layer_id_ = layer_id;
+      } else if (direction == MetalDirection::VERTICAL
+          && vertical_layer_id_ < 0) {
+        vertical_layer_id_ = layer_id;
+      }
+    }
+  };
+  pick(1);
+  pick(0);
+  PhyDBExpects(
+      horizontal_layer_id_ >= 0 && vertical_layer_id_ >= 0,
+      "Cannot find a horizontal and a vertical metal layer for RC estimation"
+  );
+}
+
+}
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_TIMING_WIRERCMODEL_H_
+#define PHYDB_TIMING_WIRERCMODEL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "phydb/phydb.h"
+
+namespace phydb {
+
+/****
+ * Resistance and capacitance of estimated wires, per RC corner.
+ *
+ * Horizontal wires are on one metal layer and vertical wires on another,
+ * both with the default width of their layer. The RC comes from
+ * Layer::GetResistance(), GetFringeCapacitance() and GetAreaCapacitance(),
+ * turned into per-micron coefficients once, so estimators can evaluate
+ * wires from many threads.
+ *
+ * When a layer has a compiled CAP_OVER table over the substrate from a
+ * technology configuration file, its capacitance instead comes from that
+ * table at the spacing of wires on adjacent tracks, which adds the
+ * coupling capacitance to both neighbors.
+ */
+class WireRcModel {
+ public:
+  void Build(
+      PhyDB *phy_db,
+      int horizontal_layer_id = -1,
+      int vertical_layer_id = -1
+  );
+
+  int GetNumCorners() const { return num_corners_; }
+  int GetHorizontalLayerId() const { return horizontal_layer_id_; }
+  int GetVerticalLayerId() const { return vertical_layer_id_; }
+  void ComputeWireRc(
+      int64_t dx,
+      int64_t dy,
+      int corner,
+      double &res,
+      double &cap
+  ) const;
+
+ private:
+  int horizontal_layer_id_ = -1;
+  int vertical_layer_id_ = -1;
+  int num_corners_ = 0;
+  double dbu_per_micron_ = 1;
+  // per corner: resistance and capacitance of a wire of length L (micron)
+  // on a layer are res * L and cap_base + cap * L
+  std::vector<double> horizontal_res_;
+  std::vector<double> horizontal_cap_base_;
+  std::vector<double> horizontal_cap_;
+  std::vector<double> vertical_res_;
+  std::vector<double> vertical_cap_base_;
+  std::vector<double> vertical_cap_;
+
+  void ChooseWiringLayers(Tech &tech);
+  static double TrackSpacing(Layer &layer);
+  static CompiledConfigTable const *CapOverSubstrateTable(
+      Layer &layer,
+      int corner
+  );
+};
+
+}
+
+#endif //PHYDB_TIMING_WIRERCMODEL_H_
@@ -42,6 +42,14 @@ std::vector<std::string> &Track::GetLayerNames() {
   return layer_names_;
 }
 
+void Track::SetLayerIds(std::vector<int> const &layer_ids) {
+  layer_ids_ = layer_ids;
+}
+
+std::vector<int> &Track::GetLayerIds() {
+  return layer_ids_;
+}
+
 std::ostream &operator<<(std::ostream &os, const Track &t) {
   os << "direction: " << XYDirectionStr(t.direction_);
   os << " start: " << t.start_ << " numTracks:" << t.n_tracks_ << " step: "
@@ -30,6 +30,7 @@
 namespace phydb {
 
 class Track {
+  friend class Snapshot;
  public:
   Track() {}
   Track(
@@ -37,18 +38,22 @@ class Track {
       int start,
       int nTracks,
       int step,
-      std::vector<std::string> &layerNames
+      std::vector<std::string> const &layer_names,
+      std::vector<int> const &layer_ids
   ) : direction_(direction),
       start_(start),
       n_tracks_(nTracks),
       step_(step),
-      layer_names_(layerNames) {}
+      layer_names_(layer_names),
+      layer_ids_(layer_ids) {}
 
   XYDirection GetDirection() const;
   int GetStart() const;
   int GetNTracks() const;
   int GetStep() const;
   std::vector<std::string> &GetLayerNames();
+  void SetLayerIds(std::vector<int> const &layer_ids);
+  std::vector<int> &GetLayerIds();
 
   friend std::ostream &operator<<(std::ostream &, const Track &);
  private:
@@ -58,6 +63,7 @@ class Track {
   int step_;
 
   std::vector<std::string> layer_names_;
+  std::vector<int> layer_ids_; // indices in Tech::layers_, same order as names
 };
 
 std::ostream &operator<<(std::ostream &, const Track &);
@@ -28,6 +28,7 @@
 namespace phydb {
 
 class ViaRuleGenerateLayer {
+  friend class Snapshot;
  public:
   ViaRuleGenerateLayer() {}
   explicit ViaRuleGenerateLayer(std::string const &layer_name) :
@@ -50,6 +51,7 @@ class ViaRuleGenerateLayer {
 };
 
 class ViaRuleGenerate {
+  friend class Snapshot;
  public:
   ViaRuleGenerate() : is_default_(false) {}
   ViaRuleGenerate(std::string const &name) : name_(name), is_default_(false) {}
@@ -0,0 +1,92 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <chrono>
+#include <iostream>
+
+#include "phydb/common/helper.h"
+#include "phydb/common/logging.h"
+#include "phydb/paralleldefreader.h"
+#include "phydb/phydb.h"
+
+using namespace phydb;
+
+double ReadDefAndMeasure(
+    std::string const &lef_file_name,
+    std::string const &def_file_name,
+    int num_threads,
+    bool is_si2,
+    size_t &num_objects
+) {
+  PhyDB phy_db;
+  phy_db.ReadLef(lef_file_name);
+
+  auto start = std::chrono::steady_clock::now();
+  if (is_si2) {
+    phy_db.ReadDef(def_file_name);
+  } else {
+    ParallelReadDef(&phy_db, def_file_name, num_threads);
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  Design *design_ptr = phy_db.GetDesignPtr();
+  num_objects = design_ptr->GetComponentsRef().size()
+      + design_ptr->GetIoPinsRef().size()
+      + design_ptr->GetNetsRef().size()
+      + design_ptr->GetSNetRef().size()
+      + design_ptr->GetRowVec().size()
+      + design_ptr->GetTracksRef().size();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char **argv) {
+  PhyDBExpects(
+      argc == 3 || argc == 4,
+      "Please provide a LEF file, a DEF file, and optionally the number of threads"
+  );
+  std::string lef_file_name(argv[1]);
+  std::string def_file_name(argv[2]);
+  int num_threads = (argc == 4) ? std::stoi(argv[3]) : 0;
+  num_threads = ResolveNumThreads(num_threads);
+
+  size_t si2_num_objects = 0;
+  double si2_time = ReadDefAndMeasure(
+      lef_file_name, def_file_name, 1, true, si2_num_objects
+  );
+  std::cout << "Si2 DEF parser: " << si2_time << " s\n";
+
+  for (int threads: {1, num_threads}) {
+    size_t num_objects = 0;
+    double time = ReadDefAndMeasure(
+        lef_file_name, def_file_name, threads, false, num_objects
+    );
+    std::cout << "in-house DEF reader, " << threads << " thread(s): "
+              << time << " s, speedup: " << si2_time / time << "x\n";
+    PhyDBExpects(
+        num_objects == si2_num_objects,
+        "The in-house DEF reader gives " << num_objects
+            << " objects, but the Si2 DEF parser gives " << si2_num_objects
+    );
+    if (threads == num_threads) break;
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <random>
+
+#include "phydb/common/helper.h"
+#include "phydb/common/logging.h"
+#include "phydb/hpwl.h"
+#include "phydb/phydb.h"
+
+using namespace phydb;
+
+// the per-pin path every placer used to reimplement
+int64_t NaiveHpwl(Design &design) {
+  int64_t total = 0;
+  for (auto &net : design.GetNetsRef()) {
+    if (net.GetPinsRef().size() + net.GetIoPinIdsRef().size() < 2) continue;
+    int min_x = INT_MAX, min_y = INT_MAX;
+    int max_x = INT_MIN, max_y = INT_MIN;
+    for (auto &pin : net.GetPinsRef()) {
+      Point2D<int> loc =
+          design.GetComponentPinLocation(pin.InstanceId(), pin.PinId());
+      min_x = std::min(min_x, loc.x);
+      min_y = std::min(min_y, loc.y);
+      max_x = std::max(max_x, loc.x);
+      max_y = std::max(max_y, loc.y);
+    }
+    for (int iopin_id : net.GetIoPinIdsRef()) {
+      Point2D<int> loc = design.GetIoPinLocation(iopin_id);
+      min_x = std::min(min_x, loc.x);
+      min_y = std::min(min_y, loc.y);
+      max_x = std::max(max_x, loc.x);
+      max_y = std::max(max_y, loc.y);
+    }
+    total += (int64_t) max_x - min_x + (int64_t) max_y - min_y;
+  }
+  return total;
+}
+
+template<typename Func>
+double Measure(Func func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char **argv) {
+  PhyDBExpects(
+      argc == 3 || argc == 4,
+      "Please provide a LEF file, a DEF file, and optionally the number of threads"
+  );
+  std::string lef_file_name(argv[1]);
+  std::string def_file_name(argv[2]);
+  int num_threads = (argc == 4) ? std::stoi(argv[3]) : 0;
+  num_threads = ResolveNumThreads(num_threads);
+
+  PhyDB phy_db;
+  phy_db.ReadLef(lef_file_name);
+  phy_db.ReadDef(def_file_name, num_threads);
+  Design &design = phy_db.design();
+
+  int64_t naive_hpwl = 0;
+  double naive_time = Measure([&]() { naive_hpwl = NaiveHpwl(design); });
+  std::cout << "naive per-pin HPWL: " << naive_hpwl << ", "
+            << naive_time << " s\n";
+
+  HpwlEngine engine(&phy_db);
+  double build_time = Measure([&]() { engine.Build(); });
+  std::cout << "engine build: " << build_time << " s\n";
+  for (int threads: {1, num_threads}) {
+    engine.SetNumThreads(threads);
+    int64_t hpwl = 0;
+    double time = Measure([&]() {
+      engine.SyncPinLocations();
+      hpwl = engine.GetTotalHpwl();
+    });
+    std::cout << "engine HPWL, " << threads << " thread(s): " << hpwl << ", "
+              << time << " s, speedup: " << naive_time / time << "x\n";
+    PhyDBExpects(
+        hpwl == naive_hpwl,
+        "The HPWL engine gives " << hpwl << ", but the naive path gives "
+                                 << naive_hpwl
+    );
+    if (threads == num_threads) break;
+  }
+
+  // move 1% of the components, and compare the incremental update with a
+  // full naive pass
+  auto &components = design.GetComponentsRef();
+  Rect2D<int> die_area = design.GetDieArea();
+  std::mt19937 rng(0);
+  std::vector<int> moved;
+  for (size_t i = 0; i < components.size() / 100 + 1; ++i) {
+    int comp_id = (int) (rng() % components.size());
+    Component &comp = components[comp_id];
+    if (comp.GetPlacementStatus() == PlaceStatus::FIXED) continue;
+    comp.SetLocation(
+        die_area.LLX() + (int) (rng() % (die_area.GetWidth() + 1)),
+        die_area.LLY() + (int) (rng() % (die_area.GetHeight() + 1))
+    );
+    moved.push_back(comp_id);
+  }
+  int64_t delta = 0;
+  double update_time = Measure([&]() {
+    delta = engine.UpdateComponents(moved);
+  });
+  naive_time = Measure([&]() { naive_hpwl = NaiveHpwl(design); });
+  std::cout << "moved " << moved.size() << " components, delta HPWL: "
+            << delta << ", " << update_time << " s, naive full pass: "
+            << naive_time << " s\n";
+  PhyDBExpects(
+      engine.GetTotalHpwl() == naive_hpwl,
+      "Incremental HPWL " << engine.GetTotalHpwl()
+                          << " differs from the naive path " << naive_hpwl
+  );
+
+  return 0;
+}
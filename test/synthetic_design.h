@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef PHYDB_TEST_SYNTHETIC_DESIGN_H_
+#define PHYDB_TEST_SYNTHETIC_DESIGN_H_
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "phydb/phydb.h"
+
+namespace phydb {
+
+/****
+ * @brief Builds a small random design without LEF/DEF files, so that tests
+ * do not depend on benchmark files.
+ *
+ * Every component is a NAND2 cell with inputs A, B and output Z. Net i is
+ * driven by the output of component i, and takes up to max_fanout input pins
+ * of random components, each input pin belongs to at most one net. Every
+ * tenth net is also connected to an IO pin.
+ *
+ * @param phy_db: an empty database
+ * @param num_components: the number of components
+ * @param num_nets: the number of nets, at most num_components
+ * @param max_fanout: the maximum number of sinks of a net
+ * @param seed: the seed of the random number generator
+ */
+inline void BuildSyntheticDesign(
+    PhyDB &phy_db,
+    int num_components,
+    int num_nets,
+    int max_fanout,
+    unsigned seed
+) {
+  const int die_size = 200000;
+  std::mt19937 rng(seed);
+
+  phy_db.SetDatabaseMicron(1000);
+  phy_db.SetManufacturingGrid(0.005);
+  phy_db.AddSite("core", "CORE", 0.2, 1.4);
+  Layer *metal1 = phy_db.AddLayer(
+      "metal1",
+      LayerType::ROUTING,
+      MetalDirection::HORIZONTAL
+  );
+  metal1->SetWidth(0.1);
+  metal1->SetPitch(0.2, 0.2);
+  metal1->SetSpacing(0.1);
+  Layer *metal2 = phy_db.AddLayer(
+      "metal2",
+      LayerType::ROUTING,
+      MetalDirection::VERTICAL
+  );
+  metal2->SetWidth(0.1);
+  metal2->SetPitch(0.2, 0.2);
+  metal2->SetSpacing(0.1);
+
+  Macro *nand2 = phy_db.AddMacro("NAND2");
+  nand2->SetClass(MacroClass::CORE);
+  nand2->SetOrigin(0, 0);
+  nand2->SetSize(0.8, 1.4);
+  std::string metal1_name("metal1");
+  std::vector<std::pair<std::string, double>> pin_x = {
+      {"A", 0.1}, {"B", 0.3}, {"Z", 0.7}
+  };
+  for (auto &[pin_name, x]: pin_x) {
+    Pin *pin = nand2->AddPin(
+        pin_name,
+        pin_name == "Z" ? SignalDirection::OUTPUT : SignalDirection::INPUT,
+        SignalUse::SIGNAL
+    );
+    LayerRect *layer_rect = pin->AddLayerRect(metal1_name);
+    layer_rect->AddRect(x - 0.05, 0.6, x + 0.05, 0.8);
+  }
+
+  phy_db.SetDefName("synthetic");
+  phy_db.SetUnitsDistanceMicrons(1000);
+  phy_db.SetDieArea(0, 0, die_size, die_size);
+  std::uniform_int_distribution<int> coordinate(0, die_size - 2000);
+  for (int i = 0; i < num_components; ++i) {
+    phy_db.AddComponent(
+        "u" + std::to_string(i),
+        nand2,
+        PlaceStatus::PLACED,
+        coordinate(rng),
+        coordinate(rng),
+        (i % 2 == 0) ? CompOrient::N : CompOrient::FS
+    );
+  }
+
+  std::vector<std::pair<int, std::string>> inputs;
+  for (int i = 0; i < num_components; ++i) {
+    inputs.emplace_back(i, "A");
+    inputs.emplace_back(i, "B");
+  }
+  std::shuffle(inputs.begin(), inputs.end(), rng);
+  std::uniform_int_distribution<int> fanout(1, max_fanout);
+  std::size_t next_input = 0;
+  for (int i = 0; i < num_nets; ++i) {
+    std::string net_name = "n" + std::to_string(i);
+    phy_db.AddNet(net_name);
+    phy_db.AddCompPinToNet("u" + std::to_string(i), "Z", net_name);
+    int num_sinks = fanout(rng);
+    for (int j = 0; j < num_sinks && next_input < inputs.size(); ++j) {
+      auto &[comp_id, pin_name] = inputs[next_input++];
+      phy_db.AddCompPinToNet("u" + std::to_string(comp_id), pin_name, net_name);
+    }
+    if (i % 10 == 0) {
+      std::string iopin_name = "p" + std::to_string(i);
+      IOPin *iopin = phy_db.AddIoPin(
+          iopin_name,
+          SignalDirection::OUTPUT,
+          SignalUse::SIGNAL
+      );
+      iopin->SetShape(metal1_name, -50, -50, 50, 50);
+      iopin->SetPlacement(PlaceStatus::FIXED, 0, coordinate(rng), CompOrient::N);
+      phy_db.AddIoPinToNet(iopin_name, net_name);
+    }
+  }
+}
+
+}
+
+#endif //PHYDB_TEST_SYNTHETIC_DESIGN_H_
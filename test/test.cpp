@@ -85,14 +85,14 @@ void test_datatype() {
   std::cout << "Range test passes!" << std::endl;
 
   //LayerRect
-  std::string layerName = "Metal1";
+  int layerId = 0;
   Rect2D<double> rect1(1.0, 2.0, 3.0, 4.0);
   Rect2D<double> rect2(10.0, 20.0, 30.0, 40.0);
 
   std::vector<Rect2D<double>> v;
   v.push_back(rect1);
   v.push_back(rect2);
-  LayerRect lr(layerName, v);
+  LayerRect lr(layerId, v);
   std::cout << lr << std::endl;
   std::cout << "LayerRect passes!" << std::endl;
 
@@ -0,0 +1,308 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "phydb/componentarrays.h"
+#include "phydb/phydb.h"
+#include "phydb/spatialindex.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+/****
+ * Bulk placement updates through ComponentArrays, flat location arrays and
+ * PlacementUpdate batches must change exactly the components they are given,
+ * record the changed components in one placement epoch, and keep an existing
+ * spatial index equal to an index built from scratch. Small batches go
+ * through single re-indexing, large batches through a bulk rebuild, both
+ * are covered.
+ */
+
+const int kNumComponents = 400;
+const int kNumNets = 300;
+const unsigned kSeed = 5;
+
+static auto ObjectKey(SpatialObject const &object) {
+  return std::make_tuple(
+      (int) object.type,
+      object.id,
+      object.sub_id,
+      object.layer_id,
+      object.box.ll.x,
+      object.box.ll.y,
+      object.box.ur.x,
+      object.box.ur.y
+  );
+}
+
+// every object of an index, sorted
+static std::vector<SpatialObject> AllObjects(SpatialIndex &index) {
+  Rect2D<int> region(-1000000, -1000000, 1000000, 1000000);
+  std::vector<SpatialObject> objects;
+  index.QueryRegionAllLayers(region, objects);
+  std::sort(
+      objects.begin(),
+      objects.end(),
+      [](SpatialObject const &lhs, SpatialObject const &rhs) {
+        return ObjectKey(lhs) < ObjectKey(rhs);
+      }
+  );
+  return objects;
+}
+
+// the spatial index of a design must equal an index built from scratch on a
+// copy of its placement
+static void CheckSpatialIndex(PhyDB &phy_db) {
+  ComponentArrays arrays;
+  phy_db.design().ExportComponentArrays(arrays);
+  PhyDB reference_db;
+  BuildSyntheticDesign(reference_db, kNumComponents, kNumNets, 4, kSeed);
+  reference_db.design().ImportComponentArrays(arrays);
+  SpatialIndex *reference_index = reference_db.BuildSpatialIndex();
+
+  std::vector<SpatialObject> objects = AllObjects(*phy_db.GetSpatialIndexPtr());
+  std::vector<SpatialObject> expected = AllObjects(*reference_index);
+  assert(objects.size() == expected.size());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    assert(ObjectKey(objects[i]) == ObjectKey(expected[i]));
+  }
+}
+
+// the placement of every component must equal the arrays
+static void CheckPlacement(Design &design, ComponentArrays &arrays) {
+  auto &components = design.GetComponentsRef();
+  assert(arrays.Size() == components.size());
+  for (size_t i = 0; i < components.size(); ++i) {
+    Point2D<int> loc = components[i].GetLocation();
+    assert(loc.x == arrays.GetXRef()[i]);
+    assert(loc.y == arrays.GetYRef()[i]);
+    assert(components[i].GetOrientation() == arrays.GetOrientsRef()[i]);
+    assert(
+        components[i].GetPlacementStatus()
+            == arrays.GetPlacementStatusesRef()[i]
+    );
+  }
+}
+
+// components changed since an epoch must be the expected ones, in one epoch
+static void CheckChanged(
+    Design &design,
+    uint64_t epoch,
+    std::vector<int> expected_ids
+) {
+  PlacementTracker &tracker = design.GetPlacementTrackerRef();
+  assert(tracker.GetEpoch() == (expected_ids.empty() ? epoch : epoch + 1));
+  std::vector<int> comp_ids;
+  tracker.GetComponentsChangedSince(epoch, comp_ids);
+  std::sort(comp_ids.begin(), comp_ids.end());
+  std::sort(expected_ids.begin(), expected_ids.end());
+  expected_ids.erase(
+      std::unique(expected_ids.begin(), expected_ids.end()),
+      expected_ids.end()
+  );
+  assert(comp_ids == expected_ids);
+}
+
+static void TestExport(PhyDB &phy_db) {
+  Design &design = phy_db.design();
+  ComponentArrays arrays;
+  design.ExportComponentArrays(arrays);
+  CheckPlacement(design, arrays);
+  MacroId nand2_id = phy_db.tech().GetMacroId("NAND2");
+  for (size_t i = 0; i < arrays.Size(); ++i) {
+    assert(arrays.GetMacroIdsRef()[i] == nand2_id);
+    assert(arrays.GetWidthsRef()[i] == 800);
+    assert(arrays.GetHeightsRef()[i] == 1400);
+  }
+
+  std::vector<int> x(kNumComponents);
+  std::vector<int> y(kNumComponents);
+  design.ExportComponentLocations(x.data(), y.data());
+  assert(x == arrays.GetXRef() && y == arrays.GetYRef());
+
+  // importing an unchanged placement changes nothing
+  uint64_t epoch = design.GetPlacementEpoch();
+  design.ImportComponentArrays(arrays);
+  design.ImportComponentLocations(x.data(), y.data());
+  CheckChanged(design, epoch, {});
+}
+
+// a few components get a new location, orientation or placement status
+static void TestImportArrays(PhyDB &phy_db, std::mt19937 &rng) {
+  Design &design = phy_db.design();
+  std::uniform_int_distribution<int> comp_id(0, kNumComponents - 1);
+  std::uniform_int_distribution<int> coordinate(0, 190000);
+  for (int round = 0; round < 5; ++round) {
+    ComponentArrays arrays;
+    design.ExportComponentArrays(arrays);
+    std::vector<int> changed_ids;
+    for (int i = 0; i < 10; ++i) {
+      int id = comp_id(rng);
+      switch (i % 3) {
+        case 0:
+          arrays.GetXRef()[id] = coordinate(rng);
+          arrays.GetYRef()[id] = coordinate(rng);
+          break;
+        case 1:
+          arrays.GetOrientsRef()[id] = arrays.GetOrientsRef()[id]
+              == CompOrient::N ? CompOrient::FS : CompOrient::N;
+          break;
+        default:
+          arrays.GetPlacementStatusesRef()[id] =
+              arrays.GetPlacementStatusesRef()[id] == PlaceStatus::FIXED
+                  ? PlaceStatus::PLACED : PlaceStatus::FIXED;
+      }
+      changed_ids.push_back(id);
+    }
+    // two changes of the same component may cancel out
+    ComponentArrays before;
+    design.ExportComponentArrays(before);
+    changed_ids.erase(
+        std::remove_if(
+            changed_ids.begin(),
+            changed_ids.end(),
+            [&](int id) {
+              return before.GetXRef()[id] == arrays.GetXRef()[id]
+                  && before.GetYRef()[id] == arrays.GetYRef()[id]
+                  && before.GetOrientsRef()[id] == arrays.GetOrientsRef()[id]
+                  && before.GetPlacementStatusesRef()[id]
+                      == arrays.GetPlacementStatusesRef()[id];
+            }
+        ),
+        changed_ids.end()
+    );
+
+    uint64_t epoch = design.GetPlacementEpoch();
+    design.ImportComponentArrays(arrays);
+    CheckPlacement(design, arrays);
+    CheckChanged(design, epoch, changed_ids);
+    CheckSpatialIndex(phy_db);
+
+    // the round trip keeps the placement
+    ComponentArrays exported;
+    design.ExportComponentArrays(exported);
+    assert(exported.GetXRef() == arrays.GetXRef());
+    assert(exported.GetYRef() == arrays.GetYRef());
+    assert(exported.GetOrientsRef() == arrays.GetOrientsRef());
+    assert(
+        exported.GetPlacementStatusesRef() == arrays.GetPlacementStatusesRef()
+    );
+  }
+}
+
+// most components move, so the spatial index is rebuilt
+static void TestImportLocations(PhyDB &phy_db, std::mt19937 &rng) {
+  Design &design = phy_db.design();
+  std::uniform_int_distribution<int> coordinate(0, 190000);
+  std::vector<int> x(kNumComponents);
+  std::vector<int> y(kNumComponents);
+  design.ExportComponentLocations(x.data(), y.data());
+  ComponentArrays before;
+  design.ExportComponentArrays(before);
+
+  std::vector<int> changed_ids;
+  for (int id = 0; id < kNumComponents; id += 2) {
+    x[id] = coordinate(rng);
+    y[id] = coordinate(rng);
+    changed_ids.push_back(id);
+  }
+  uint64_t epoch = design.GetPlacementEpoch();
+  design.ImportComponentLocations(x.data(), y.data());
+  CheckChanged(design, epoch, changed_ids);
+  CheckSpatialIndex(phy_db);
+
+  // orientations and placement status are kept
+  ComponentArrays arrays;
+  design.ExportComponentArrays(arrays);
+  assert(arrays.GetXRef() == x && arrays.GetYRef() == y);
+  assert(arrays.GetOrientsRef() == before.GetOrientsRef());
+  assert(
+      arrays.GetPlacementStatusesRef() == before.GetPlacementStatusesRef()
+  );
+}
+
+// batches with updates to the current placement and repeated components
+static void TestPlacementUpdates(PhyDB &phy_db, std::mt19937 &rng) {
+  Design &design = phy_db.design();
+  auto &components = design.GetComponentsRef();
+  std::uniform_int_distribution<int> comp_id(0, kNumComponents - 1);
+  std::uniform_int_distribution<int> coordinate(0, 190000);
+  for (int batch_size: {1, 20, 200}) {
+    std::vector<PlacementUpdate> updates;
+    std::vector<int> changed_ids;
+    for (int i = 0; i < batch_size; ++i) {
+      int id = comp_id(rng);
+      Point2D<int> loc = components[id].GetLocation();
+      CompOrient orient = components[id].GetOrientation();
+      if (i % 4 == 0) {
+        // the component stays where it is, so it does not change
+        updates.push_back({id, loc.x, loc.y, orient});
+        continue;
+      }
+      updates.push_back({id, coordinate(rng), coordinate(rng), CompOrient::FN});
+      changed_ids.push_back(id);
+    }
+    // a component updated twice ends at its last update, even if that one
+    // moves it back to where it started
+    uint64_t epoch = design.GetPlacementEpoch();
+    design.ApplyPlacementUpdates(updates);
+    CheckChanged(design, epoch, changed_ids);
+    for (auto it = updates.rbegin(); it != updates.rend(); ++it) {
+      bool is_last = std::find_if(
+          updates.rbegin(),
+          it,
+          [&](PlacementUpdate const &u) { return u.comp_id == it->comp_id; }
+      ) == it;
+      if (!is_last) continue;
+      Component &component = components[it->comp_id];
+      assert(component.GetLocation().x == it->x);
+      assert(component.GetLocation().y == it->y);
+      assert(component.GetOrientation() == it->orient);
+    }
+    CheckSpatialIndex(phy_db);
+  }
+
+  // an empty batch does not advance the epoch
+  uint64_t epoch = design.GetPlacementEpoch();
+  design.ApplyPlacementUpdates(std::vector<PlacementUpdate>{});
+  CheckChanged(design, epoch, {});
+}
+
+int main() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, kNumComponents, kNumNets, 4, kSeed);
+  phy_db.BuildSpatialIndex();
+  std::mt19937 rng(kSeed);
+
+  TestExport(phy_db);
+  TestImportArrays(phy_db, rng);
+  TestImportLocations(phy_db, rng);
+  TestPlacementUpdates(phy_db, rng);
+
+  std::cout << "Component arrays test passes!" << std::endl;
+  return 0;
+}
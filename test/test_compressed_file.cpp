@@ -0,0 +1,113 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "phydb/common/compressedfile.h"
+#include "phydb/common/config.h"
+
+using namespace phydb;
+
+// DEF-like text, much larger than a pipe buffer
+static std::string MakeText() {
+  std::string text;
+  for (int i = 0; i < 200000; ++i) {
+    text += "- u" + std::to_string(i) + " NAND2 + PLACED ( "
+        + std::to_string(i * 7 % 100000) + " " + std::to_string(i % 1400)
+        + " ) N ;\n";
+  }
+  return text;
+}
+
+static std::string ReadRawFile(std::string const &file_name) {
+  std::ifstream ifs(file_name, std::ios::binary);
+  assert(ifs.is_open());
+  return std::string(
+      std::istreambuf_iterator<char>(ifs),
+      std::istreambuf_iterator<char>()
+  );
+}
+
+/****
+ * Text written through a CompressedFile must be compressed according to the
+ * file name extension, and must be the same when read back through a
+ * CompressedFile stream and through ReadWholeFile().
+ */
+static void CheckRoundTrip(
+    std::string const &file_name,
+    std::string const &text,
+    std::string const &magic
+) {
+  {
+    CompressedFile file(file_name, "w");
+    assert(file.Stream() != nullptr);
+    size_t half = text.size() / 2;
+    assert(fwrite(text.data(), 1, half, file.Stream()) == half);
+    assert(fputs(text.c_str() + half, file.Stream()) >= 0);
+    assert(file.Close());
+  }
+
+  std::string raw = ReadRawFile(file_name);
+  assert(raw.compare(0, magic.size(), magic) == 0);
+  if (GetFileCompression(file_name) != FileCompression::NONE) {
+    assert(raw.size() < text.size());
+  }
+
+  std::string read_back;
+  {
+    CompressedFile file(file_name, "r");
+    assert(file.Stream() != nullptr);
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file.Stream())) > 0) {
+      read_back.append(buffer, count);
+    }
+    assert(file.Close());
+  }
+  assert(read_back == text);
+  assert(ReadWholeFile(file_name) == text);
+  std::remove(file_name.c_str());
+}
+
+int main() {
+  assert(GetFileCompression("a.def") == FileCompression::NONE);
+  assert(GetFileCompression("a.def.gz") == FileCompression::GZIP);
+  assert(GetFileCompression("a.def.zst") == FileCompression::ZSTD);
+
+  std::string text = MakeText();
+  CheckRoundTrip("test_compressed_file.def", text, "- u0 ");
+  CheckRoundTrip("test_compressed_file.def.gz", text, "\x1f\x8b");
+#if PHYDB_USE_ZSTD
+  CheckRoundTrip(
+      "test_compressed_file.def.zst",
+      text,
+      std::string("\x28\xb5\x2f\xfd", 4)
+  );
+#endif
+
+  std::cout << "Compressed file test passes!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "phydb/phydb.h"
+#include "phydb/timing/techconfig.h"
+#include "phydb/timing/wirercmodel.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+static bool IsClose(double value, double expected) {
+  return std::fabs(value - expected) <= 1e-12 * (1 + std::fabs(expected));
+}
+
+// linear interpolation by scanning sorted entries, clamped at both ends
+static double ReferenceInterpolate(
+    std::vector<TableEntry> const &entries,
+    double distance,
+    double TableEntry::*column
+) {
+  if (distance <= entries.front().distance_) {
+    return entries.front().*column;
+  }
+  if (distance >= entries.back().distance_) {
+    return entries.back().*column;
+  }
+  for (size_t i = 0; i + 1 < entries.size(); ++i) {
+    TableEntry const &lo = entries[i];
+    TableEntry const &hi = entries[i + 1];
+    if (distance < hi.distance_) {
+      double weight = (distance - lo.distance_) / (hi.distance_ - lo.distance_);
+      return lo.*column + weight * (hi.*column - lo.*column);
+    }
+  }
+  return entries.back().*column;
+}
+
+/****
+ * WireRcModel must take the capacitance of a layer with a CAP_OVER table
+ * over the substrate from the table, at the spacing of adjacent tracks, and
+ * fall back to the unit capacitance of a layer without one.
+ */
+static void TestWireRcModel() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 10, 5, 2, 7);
+  Tech &tech = phy_db.tech();
+  for (auto &layer: tech.GetLayersRef()) {
+    layer.SetRPerSqUnit(0.08);
+    layer.SetCPerSqDist(2e-5);
+    layer.SetEdgeCPerDist(4e-5);
+    layer.SetResistanceUnitFromLef();
+    layer.SetCapacitanceUnitFromLef();
+  }
+  // metal1 wires are 0.1 micron wide on a 0.2 micron pitch, so the table is
+  // queried at a spacing of 0.1 micron, between two entries
+  tech.SetTechConfigLayerCount(2);
+  tech.AddTechConfigCorner(0);
+  ConfigTable &table = tech.InitConfigTable(CAP_OVER, 0, -1, 0, 0);
+  table.AddEntry(0.3, 2e-5, 5e-5, 0);
+  table.AddEntry(0.05, 8e-5, 3e-5, 0);
+  table.AddEntry(0.15, 4e-5, 4e-5, 0);
+  tech.CompileTechConfigTables();
+
+  WireRcModel model;
+  model.Build(&phy_db, 0, 1);
+  Layer &metal1 = tech.GetLayersRef()[0];
+  Layer &metal2 = tech.GetLayersRef()[1];
+  double width = 0.1;
+  double coupling_cap = 6e-5;
+  double fringe_cap = 3.5e-5;
+
+  double res, cap;
+  model.ComputeWireRc(3000, 0, 0, res, cap);
+  assert(IsClose(res, metal1.GetResistance(width, 3, 0)));
+  assert(
+      IsClose(cap, 2 * fringe_cap * width + 2 * (fringe_cap + coupling_cap) * 3)
+  );
+
+  model.ComputeWireRc(0, 2000, 0, res, cap);
+  assert(IsClose(res, metal2.GetResistance(width, 2, 0)));
+  double unit_cap = metal2.GetFringeCapacitance(width, 2, 0)
+      + metal2.GetAreaCapacitance(width, 2, 0);
+  assert(IsClose(cap, unit_cap));
+}
+
+/****
+ * Queries of a compiled table must interpolate linearly between entries,
+ * hit entries exactly, and clamp to the first or last entry outside the
+ * table, for tables of any size and entries in any order.
+ */
+int main() {
+  std::mt19937 rng(37);
+  std::uniform_real_distribution<double> value(0.0, 1.0);
+  for (int num_entries = 1; num_entries <= 33; ++num_entries) {
+    // distinct distances, added out of order
+    std::vector<double> distances;
+    double distance = value(rng);
+    for (int i = 0; i < num_entries; ++i) {
+      distances.push_back(distance);
+      distance += 0.05 + value(rng);
+    }
+    std::shuffle(distances.begin(), distances.end(), rng);
+    ConfigTable table(CAP_OVER, 0, 0);
+    for (double d: distances) {
+      table.AddEntry(d, value(rng), value(rng), value(rng));
+    }
+    CompiledConfigTable compiled;
+    compiled.Compile(table);
+    assert(!compiled.IsEmpty());
+
+    std::vector<TableEntry> entries = table.GetTable();
+    std::sort(
+        entries.begin(),
+        entries.end(),
+        [](TableEntry const &a, TableEntry const &b) {
+          return a.distance_ < b.distance_;
+        }
+    );
+    double first = entries.front().distance_;
+    double last = entries.back().distance_;
+
+    std::vector<double> queries;
+    for (auto &entry: entries) {
+      queries.push_back(entry.distance_);
+    }
+    queries.push_back(first - 1);
+    queries.push_back(-1e9);
+    queries.push_back(last + 1);
+    queries.push_back(1e9);
+    std::uniform_real_distribution<double> inside(first, last);
+    for (int i = 0; i < 200; ++i) {
+      queries.push_back(inside(rng));
+    }
+
+    std::vector<double> coupling_caps(queries.size());
+    std::vector<double> fringe_caps(queries.size());
+    std::vector<double> res(queries.size());
+    compiled.GetCaps(
+        queries.data(),
+        queries.size(),
+        coupling_caps.data(),
+        fringe_caps.data()
+    );
+    compiled.GetRes(queries.data(), queries.size(), res.data());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      double q = queries[i];
+      double coupling_cap =
+          ReferenceInterpolate(entries, q, &TableEntry::coupling_cap_);
+      double fringe_cap =
+          ReferenceInterpolate(entries, q, &TableEntry::fringe_cap_);
+      double resistance = ReferenceInterpolate(entries, q, &TableEntry::res_);
+      assert(IsClose(compiled.GetCouplingCap(q), coupling_cap));
+      assert(IsClose(compiled.GetFringeCap(q), fringe_cap));
+      assert(IsClose(compiled.GetRes(q), resistance));
+      assert(coupling_caps[i] == compiled.GetCouplingCap(q));
+      assert(fringe_caps[i] == compiled.GetFringeCap(q));
+      assert(res[i] == compiled.GetRes(q));
+    }
+  }
+
+  TestWireRcModel();
+
+  std::cout << "Compiled config table test passes!" << std::endl;
+  return 0;
+}
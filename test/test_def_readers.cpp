@@ -0,0 +1,292 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "phydb/common/compressedfile.h"
+#include "phydb/phydb.h"
+
+using namespace phydb;
+
+/****
+ * Reads one DEF through the Si2 reader (single thread) and the parallel
+ * reader, and checks both give the same special net wiring, including via
+ * arrays written as DO numX BY numY STEP stepX stepY.
+ */
+
+static const char *kLef = R"(VERSION 5.8 ;
+BUSBITCHARS "[]" ;
+DIVIDERCHAR "/" ;
+UNITS
+  DATABASE MICRONS 1000 ;
+END UNITS
+MANUFACTURINGGRID 0.005 ;
+LAYER metal1
+  TYPE ROUTING ;
+  DIRECTION HORIZONTAL ;
+  PITCH 0.2 ;
+  WIDTH 0.1 ;
+  SPACING 0.1 ;
+END metal1
+LAYER via1
+  TYPE CUT ;
+END via1
+LAYER metal2
+  TYPE ROUTING ;
+  DIRECTION VERTICAL ;
+  PITCH 0.2 ;
+  WIDTH 0.1 ;
+  SPACING 0.1 ;
+END metal2
+VIA via12 DEFAULT
+  LAYER metal1 ;
+    RECT -0.05 -0.05 0.05 0.05 ;
+  LAYER via1 ;
+    RECT -0.05 -0.05 0.05 0.05 ;
+  LAYER metal2 ;
+    RECT -0.05 -0.05 0.05 0.05 ;
+END via12
+SITE core
+  CLASS CORE ;
+  SIZE 0.2 BY 1.4 ;
+END core
+MACRO INV
+  CLASS CORE ;
+  ORIGIN 0 0 ;
+  SIZE 0.4 BY 1.4 ;
+  SITE core ;
+  PIN A
+    DIRECTION INPUT ;
+    PORT
+      LAYER metal1 ;
+        RECT 0.0 0.6 0.1 0.7 ;
+    END
+  END A
+  PIN Z
+    DIRECTION OUTPUT ;
+    PORT
+      LAYER metal1 ;
+        RECT 0.3 0.6 0.4 0.7 ;
+    END
+  END Z
+END INV
+END LIBRARY
+)";
+
+static const char *kDef = R"(VERSION 5.8 ;
+DIVIDERCHAR "/" ;
+BUSBITCHARS "[]" ;
+DESIGN top ;
+UNITS DISTANCE MICRONS 1000 ;
+DIEAREA ( 0 0 ) ( 10000 10000 ) ;
+COMPONENTS 2 ;
+- u1 INV + PLACED ( 1000 1400 ) N ;
+- u2 INV + PLACED ( 3000 1400 ) FS ;
+END COMPONENTS
+PINS 1 ;
+- in + NET in + DIRECTION INPUT + USE SIGNAL
+  + LAYER metal1 ( 0 0 ) ( 100 100 ) + PLACED ( 0 5000 ) N ;
+END PINS
+BLOCKAGES 2 ;
+- LAYER metal1 RECT ( 100 100 ) ( 900 900 ) ;
+- PLACEMENT RECT ( 5000 5000 ) ( 6000 6000 ) ;
+END BLOCKAGES
+SPECIALNETS 2 ;
+- VDD ( * VDD ) + USE POWER
+  + ROUTED metal1 200 + SHAPE STRIPE ( 0 1000 ) ( 9000 * )
+    NEW metal1 0 + SHAPE STRIPE ( 2000 1000 ) via12 DO 4 BY 2 STEP 400 300
+    NEW metal2 200 + SHAPE STRIPE ( 3000 0 ) ( * 9000 )
+    NEW metal1 0 ( 5000 1000 ) via12 ;
+- VSS ( * VSS ) + USE GROUND
+  + ROUTED metal2 200 + SHAPE STRIPE ( 6000 0 ) ( * 9000 )
+    NEW metal1 0 + SHAPE STRIPE ( 6000 2400 ) via12 DO 1 BY 3 STEP 0 250 ;
+END SPECIALNETS
+NETS 2 ;
+- in ( PIN in ) ( u1 A ) ;
+- n1 ( u1 Z ) ( u2 A ) ;
+END NETS
+END DESIGN
+)";
+
+static void WriteFile(std::string const &file_name, const char *content) {
+  std::ofstream ofs(file_name);
+  assert(ofs.is_open());
+  ofs << content;
+}
+
+static void ExpectSamePath(Path &a, Path &b) {
+  assert(a.GetLayerName() == b.GetLayerName());
+  assert(a.GetLayerId() == b.GetLayerId());
+  assert(a.GetWidth() == b.GetWidth());
+  assert(a.GetShape() == b.GetShape());
+  assert(a.GetViaName() == b.GetViaName());
+  assert(a.GetViaNumX() == b.GetViaNumX());
+  assert(a.GetViaNumY() == b.GetViaNumY());
+  assert(a.GetViaStepX() == b.GetViaStepX());
+  assert(a.GetViaStepY() == b.GetViaStepY());
+  auto &points_a = a.GetRoutingPointsRef();
+  auto &points_b = b.GetRoutingPointsRef();
+  assert(points_a.size() == points_b.size());
+  for (size_t i = 0; i < points_a.size(); ++i) {
+    assert(points_a[i].x == points_b[i].x);
+    assert(points_a[i].y == points_b[i].y);
+  }
+}
+
+static void ExpectSameSNets(PhyDB &a, PhyDB &b) {
+  auto &snets_a = a.GetSNetRef();
+  auto &snets_b = b.GetSNetRef();
+  assert(snets_a.size() == snets_b.size());
+  for (size_t i = 0; i < snets_a.size(); ++i) {
+    assert(snets_a[i].GetName() == snets_b[i].GetName());
+    auto &paths_a = snets_a[i].GetPathsRef();
+    auto &paths_b = snets_b[i].GetPathsRef();
+    assert(paths_a.size() == paths_b.size());
+    for (size_t j = 0; j < paths_a.size(); ++j) {
+      ExpectSamePath(paths_a[j], paths_b[j]);
+    }
+  }
+}
+
+static void ExpectDefBlockages(PhyDB &phy_db) {
+  auto &blockages = phy_db.GetBlockagesRef();
+  assert(blockages.size() == 2);
+  assert(blockages[0].GetLayer() == phy_db.GetLayerPtr("metal1"));
+  assert(!blockages[0].IsPlacement());
+  Rect2D<int> &rect = blockages[0].GetRectsRef()[0];
+  assert(rect.ll.x == 100 && rect.ll.y == 100);
+  assert(rect.ur.x == 900 && rect.ur.y == 900);
+  assert(blockages[1].IsPlacement());
+  assert(blockages[1].GetRectsRef()[0].ur.x == 6000);
+}
+
+/****
+ * Lazy SPECIALNETS and BLOCKAGES are loaded on their first access, each
+ * independently, from plain and gzip DEF files, and give the same result as
+ * an eager read. Sections masked out stay empty, even if they are also
+ * requested lazily.
+ */
+static void TestLazySections(
+    std::string const &lef_file_name,
+    std::string const &def_file_name,
+    PhyDB &eager_db
+) {
+  std::string gz_file_name = def_file_name + ".gz";
+  {
+    CompressedFile gz_file(gz_file_name, "w");
+    assert(fputs(kDef, gz_file.Stream()) >= 0);
+    assert(gz_file.Close());
+  }
+
+  for (std::string const &file_name: {def_file_name, gz_file_name}) {
+    PhyDB lazy_db;
+    lazy_db.ReadLef(lef_file_name);
+    lazy_db.ReadDef(file_name, 4, kDefAllSections, kDefLazySections);
+    Design &design = lazy_db.design();
+    assert(!design.IsSNetLoaded() && !design.IsBlockageLoaded());
+    assert(design.GetComponentsRef().size() == 2);
+    assert(design.GetNetsRef().size() == 2);
+
+    ExpectDefBlockages(lazy_db);
+    assert(design.IsBlockageLoaded() && !design.IsSNetLoaded());
+    ExpectSameSNets(eager_db, lazy_db);
+    assert(design.IsSNetLoaded());
+    // loading happens once
+    assert(lazy_db.GetSNetRef().size() == 2);
+    assert(lazy_db.GetBlockagesRef().size() == 2);
+  }
+
+  PhyDB masked_db;
+  masked_db.ReadLef(lef_file_name);
+  masked_db.ReadDef(def_file_name, 4, kDefPlacementSections, kDefLazySections);
+  assert(masked_db.design().GetComponentsRef().size() == 2);
+  assert(masked_db.design().GetIoPinsRef().size() == 1);
+  assert(masked_db.design().GetNetsRef().empty());
+  assert(masked_db.GetSNetRef().empty());
+  assert(masked_db.GetBlockagesRef().empty());
+  assert(masked_db.design().GetNetWiresRef().Size() == 0);
+
+  std::remove(gz_file_name.c_str());
+}
+
+int main() {
+  std::string lef_file_name = "test_def_readers.lef";
+  std::string def_file_name = "test_def_readers.def";
+  WriteFile(lef_file_name, kLef);
+  WriteFile(def_file_name, kDef);
+
+  PhyDB si2_db;
+  si2_db.ReadLef(lef_file_name);
+  si2_db.ReadDef(def_file_name, 1);
+
+  PhyDB parallel_db;
+  parallel_db.ReadLef(lef_file_name);
+  parallel_db.ReadDef(def_file_name, 4);
+
+  assert(si2_db.GetDesignPtr()->GetComponentsRef().size() == 2);
+  assert(
+      si2_db.GetDesignPtr()->GetComponentsRef().size()
+          == parallel_db.GetDesignPtr()->GetComponentsRef().size()
+  );
+  assert(
+      si2_db.GetDesignPtr()->GetNetsRef().size()
+          == parallel_db.GetDesignPtr()->GetNetsRef().size()
+  );
+
+  auto &si2_snets = si2_db.GetSNetRef();
+  auto &parallel_snets = parallel_db.GetSNetRef();
+  assert(si2_snets.size() == 2);
+  assert(si2_snets.size() == parallel_snets.size());
+  for (size_t i = 0; i < si2_snets.size(); ++i) {
+    assert(si2_snets[i].GetName() == parallel_snets[i].GetName());
+    assert(si2_snets[i].GetUse() == parallel_snets[i].GetUse());
+    auto &si2_paths = si2_snets[i].GetPathsRef();
+    auto &parallel_paths = parallel_snets[i].GetPathsRef();
+    assert(si2_paths.size() == parallel_paths.size());
+    for (size_t j = 0; j < si2_paths.size(); ++j) {
+      ExpectSamePath(si2_paths[j], parallel_paths[j]);
+    }
+  }
+
+  ExpectDefBlockages(si2_db);
+  ExpectDefBlockages(parallel_db);
+  TestLazySections(lef_file_name, def_file_name, parallel_db);
+
+  // the via array must be kept, and must not leak into the next path
+  Path &via_array = parallel_snets[0].GetPathsRef()[1];
+  assert(via_array.GetViaName() == "via12");
+  assert(via_array.IsViaArray());
+  assert(via_array.GetViaNumX() == 4 && via_array.GetViaNumY() == 2);
+  assert(via_array.GetViaStepX() == 400 && via_array.GetViaStepY() == 300);
+  Path &stripe = parallel_snets[0].GetPathsRef()[2];
+  assert(stripe.GetLayerName() == "metal2");
+  assert(stripe.GetViaName().empty() && !stripe.IsViaArray());
+  assert(!parallel_snets[0].GetPathsRef()[3].IsViaArray());
+
+  std::remove(lef_file_name.c_str());
+  std::remove(def_file_name.c_str());
+  std::cout << "DEF readers test passes!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,308 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "phydb/phydb.h"
+
+using namespace phydb;
+
+/****
+ * Writes a DEF with ParallelWriteDef() and with the Si2 writer, and reads
+ * each file back with the parallel reader and the Si2 reader. All must give
+ * the same components, IO pins, nets and routed wires as the database the
+ * file was written from, and the wire and via segments of nets must be the
+ * ones in the original DEF.
+ */
+
+static const char *kLef = R"(VERSION 5.8 ;
+BUSBITCHARS "[]" ;
+DIVIDERCHAR "/" ;
+UNITS
+  DATABASE MICRONS 1000 ;
+END UNITS
+MANUFACTURINGGRID 0.005 ;
+LAYER metal1
+  TYPE ROUTING ;
+  DIRECTION HORIZONTAL ;
+  PITCH 0.2 ;
+  WIDTH 0.1 ;
+  SPACING 0.1 ;
+END metal1
+LAYER via1
+  TYPE CUT ;
+END via1
+LAYER metal2
+  TYPE ROUTING ;
+  DIRECTION VERTICAL ;
+  PITCH 0.2 ;
+  WIDTH 0.1 ;
+  SPACING 0.1 ;
+END metal2
+VIA via12 DEFAULT
+  LAYER metal1 ;
+    RECT -0.05 -0.05 0.05 0.05 ;
+  LAYER via1 ;
+    RECT -0.05 -0.05 0.05 0.05 ;
+  LAYER metal2 ;
+    RECT -0.05 -0.05 0.05 0.05 ;
+END via12
+SITE core
+  CLASS CORE ;
+  SIZE 0.2 BY 1.4 ;
+END core
+MACRO INV
+  CLASS CORE ;
+  ORIGIN 0 0 ;
+  SIZE 0.4 BY 1.4 ;
+  SITE core ;
+  PIN A
+    DIRECTION INPUT ;
+    PORT
+      LAYER metal1 ;
+        RECT 0.0 0.6 0.1 0.7 ;
+    END
+  END A
+  PIN Z
+    DIRECTION OUTPUT ;
+    PORT
+      LAYER metal1 ;
+        RECT 0.3 0.6 0.4 0.7 ;
+    END
+  END Z
+END INV
+END LIBRARY
+)";
+
+static const char *kDef = R"(VERSION 5.8 ;
+DIVIDERCHAR "/" ;
+BUSBITCHARS "[]" ;
+DESIGN top ;
+UNITS DISTANCE MICRONS 1000 ;
+DIEAREA ( 0 0 ) ( 10000 10000 ) ;
+COMPONENTS 3 ;
+- u1 INV + PLACED ( 1000 1400 ) N ;
+- u2 INV + PLACED ( 3000 1400 ) FS ;
+- u3 INV + FIXED ( 5000 2800 ) N ;
+END COMPONENTS
+PINS 2 ;
+- in + NET in + DIRECTION INPUT + USE SIGNAL
+  + LAYER metal1 ( -50 -50 ) ( 50 50 ) + PLACED ( 0 5000 ) N ;
+- out + NET out + DIRECTION OUTPUT + USE SIGNAL
+  + LAYER metal2 ( -50 -50 ) ( 50 50 ) + FIXED ( 10000 3000 ) N ;
+END PINS
+NETS 3 ;
+- in ( PIN in ) ( u1 A )
+  + ROUTED metal1 ( 0 5000 ) ( 1000 * ) via12
+    NEW metal2 ( 1000 5000 ) ( * 2050 ) via12 ;
+- n1 ( u1 Z ) ( u2 A ) ( u3 A )
+  + ROUTED metal1 ( 1350 2050 ) ( 3050 * ) via12
+    NEW metal2 ( 3050 2050 ) ( * 3450 ) via12
+    NEW metal1 ( 3050 3450 ) ( 5050 * ) ;
+- out ( u3 Z ) ( PIN out ) ;
+END NETS
+END DESIGN
+)";
+
+static void WriteFile(std::string const &file_name, const char *content) {
+  std::ofstream ofs(file_name);
+  assert(ofs.is_open());
+  ofs << content;
+}
+
+static void ExpectSameComponents(Design &a, Design &b) {
+  auto &components_a = a.GetComponentsRef();
+  auto &components_b = b.GetComponentsRef();
+  assert(components_a.size() == components_b.size());
+  for (size_t i = 0; i < components_a.size(); ++i) {
+    Component &comp_a = components_a[i];
+    Component &comp_b = components_b[i];
+    assert(comp_a.GetName() == comp_b.GetName());
+    assert(comp_a.GetMacroId() == comp_b.GetMacroId());
+    assert(comp_a.GetPlacementStatus() == comp_b.GetPlacementStatus());
+    assert(comp_a.GetLocation().x == comp_b.GetLocation().x);
+    assert(comp_a.GetLocation().y == comp_b.GetLocation().y);
+    assert(comp_a.GetOrientation() == comp_b.GetOrientation());
+  }
+}
+
+static void ExpectSameIoPins(Design &a, Design &b) {
+  auto &iopins_a = a.GetIoPinsRef();
+  auto &iopins_b = b.GetIoPinsRef();
+  assert(iopins_a.size() == iopins_b.size());
+  for (size_t i = 0; i < iopins_a.size(); ++i) {
+    IOPin &iopin_a = iopins_a[i];
+    IOPin &iopin_b = iopins_b[i];
+    assert(iopin_a.GetName() == iopin_b.GetName());
+    assert(iopin_a.GetNetId() == iopin_b.GetNetId());
+    assert(iopin_a.GetDirection() == iopin_b.GetDirection());
+    assert(iopin_a.GetUse() == iopin_b.GetUse());
+    assert(iopin_a.GetLayerName() == iopin_b.GetLayerName());
+    assert(iopin_a.GetLayerId() == iopin_b.GetLayerId());
+    Rect2D<int> rect_a = iopin_a.GetRect();
+    Rect2D<int> rect_b = iopin_b.GetRect();
+    assert(rect_a.ll.x == rect_b.ll.x && rect_a.ll.y == rect_b.ll.y);
+    assert(rect_a.ur.x == rect_b.ur.x && rect_a.ur.y == rect_b.ur.y);
+    assert(iopin_a.GetPlacementStatus() == iopin_b.GetPlacementStatus());
+    assert(iopin_a.GetLocation().x == iopin_b.GetLocation().x);
+    assert(iopin_a.GetLocation().y == iopin_b.GetLocation().y);
+    assert(iopin_a.GetOrientation() == iopin_b.GetOrientation());
+  }
+}
+
+static void ExpectSameNets(Design &a, Design &b) {
+  auto &nets_a = a.GetNetsRef();
+  auto &nets_b = b.GetNetsRef();
+  assert(nets_a.size() == nets_b.size());
+  for (size_t i = 0; i < nets_a.size(); ++i) {
+    Net &net_a = nets_a[i];
+    Net &net_b = nets_b[i];
+    assert(net_a.GetName() == net_b.GetName());
+    auto &pins_a = net_a.GetPinsRef();
+    auto &pins_b = net_b.GetPinsRef();
+    assert(pins_a.size() == pins_b.size());
+    for (size_t j = 0; j < pins_a.size(); ++j) {
+      assert(pins_a[j].InstanceId() == pins_b[j].InstanceId());
+      assert(pins_a[j].PinId() == pins_b[j].PinId());
+    }
+    assert(net_a.GetIoPinIdsRef() == net_b.GetIoPinIdsRef());
+  }
+}
+
+static void ExpectSameWires(Design &a, Design &b) {
+  NetWireStore &wires_a = a.GetNetWiresRef();
+  NetWireStore &wires_b = b.GetNetWiresRef();
+  assert(wires_a.Size() == wires_b.Size());
+  wires_a.BuildNetIndex();
+  wires_b.BuildNetIndex();
+  for (int net_id = 0; net_id < (int) a.GetNetsRef().size(); ++net_id) {
+    int begin_a = wires_a.GetNetBegin(net_id);
+    int begin_b = wires_b.GetNetBegin(net_id);
+    int count = wires_a.GetNetEnd(net_id) - begin_a;
+    assert(wires_b.GetNetEnd(net_id) - begin_b == count);
+    for (int k = 0; k < count; ++k) {
+      int i = begin_a + k;
+      int j = begin_b + k;
+      assert(wires_a.IsVia(i) == wires_b.IsVia(j));
+      assert(wires_a.GetLayerId(i) == wires_b.GetLayerId(j));
+      assert(wires_a.GetX0(i) == wires_b.GetX0(j));
+      assert(wires_a.GetY0(i) == wires_b.GetY0(j));
+      assert(wires_a.GetX1(i) == wires_b.GetX1(j));
+      assert(wires_a.GetY1(i) == wires_b.GetY1(j));
+      assert(wires_a.GetWidth(i) == wires_b.GetWidth(j));
+      assert(wires_a.IsPathContinued(i) == wires_b.IsPathContinued(j));
+      if (wires_a.IsVia(i)) {
+        assert(
+            wires_a.GetViaName(wires_a.GetViaId(i))
+                == wires_b.GetViaName(wires_b.GetViaId(j))
+        );
+      }
+    }
+  }
+}
+
+struct ExpectedSegment {
+  int net_id;
+  bool is_via;
+  int layer_id;
+  int x0;
+  int y0;
+  int x1;
+  int y1;
+};
+
+// segments of the routed nets in kDef, metal1 is layer 0 and metal2 is 2
+static void ExpectDefWires(Design &design) {
+  static const ExpectedSegment kSegments[] = {
+      {0, false, 0, 0, 5000, 1000, 5000},
+      {0, true, 0, 1000, 5000, 1000, 5000},
+      {0, false, 2, 1000, 5000, 1000, 2050},
+      {0, true, 2, 1000, 2050, 1000, 2050},
+      {1, false, 0, 1350, 2050, 3050, 2050},
+      {1, true, 0, 3050, 2050, 3050, 2050},
+      {1, false, 2, 3050, 2050, 3050, 3450},
+      {1, true, 2, 3050, 3450, 3050, 3450},
+      {1, false, 0, 3050, 3450, 5050, 3450},
+  };
+  NetWireStore &wires = design.GetNetWiresRef();
+  wires.BuildNetIndex();
+  assert(wires.Size() == sizeof(kSegments) / sizeof(kSegments[0]));
+  assert(wires.GetNetEnd(2) == wires.GetNetBegin(2));
+  for (int i = 0; i < (int) wires.Size(); ++i) {
+    ExpectedSegment const &expected = kSegments[i];
+    assert(wires.GetNetId(i) == expected.net_id);
+    assert(wires.IsVia(i) == expected.is_via);
+    assert(wires.GetLayerId(i) == expected.layer_id);
+    assert(wires.GetX0(i) == expected.x0 && wires.GetY0(i) == expected.y0);
+    assert(wires.GetX1(i) == expected.x1 && wires.GetY1(i) == expected.y1);
+    assert(wires.GetWidth(i) == 0);
+    if (expected.is_via) {
+      assert(wires.GetViaName(wires.GetViaId(i)) == "via12");
+    }
+  }
+}
+
+static void ExpectSameDesign(PhyDB &a, PhyDB &b) {
+  ExpectSameComponents(a.design(), b.design());
+  ExpectSameIoPins(a.design(), b.design());
+  ExpectSameNets(a.design(), b.design());
+  ExpectSameWires(a.design(), b.design());
+}
+
+int main() {
+  std::string lef_file_name = "test_def_writer.lef";
+  std::string def_file_name = "test_def_writer.def";
+  std::string out_file_name = "test_def_writer_out.def";
+  WriteFile(lef_file_name, kLef);
+  WriteFile(def_file_name, kDef);
+
+  PhyDB phy_db;
+  phy_db.ReadLef(lef_file_name);
+  phy_db.ReadDef(def_file_name, 4);
+  ExpectDefWires(phy_db.design());
+
+  // ParallelWriteDef() with 4 threads, and the Si2 writer with 1
+  for (int write_threads: {4, 1}) {
+    phy_db.WriteDef(out_file_name, write_threads);
+
+    PhyDB parallel_db;
+    parallel_db.ReadLef(lef_file_name);
+    parallel_db.ReadDef(out_file_name, 4);
+    ExpectSameDesign(phy_db, parallel_db);
+    ExpectDefWires(parallel_db.design());
+
+    PhyDB si2_db;
+    si2_db.ReadLef(lef_file_name);
+    si2_db.ReadDef(out_file_name, 1);
+    ExpectSameDesign(phy_db, si2_db);
+    ExpectDefWires(si2_db.design());
+  }
+
+  std::remove(lef_file_name.c_str());
+  std::remove(def_file_name.c_str());
+  std::remove(out_file_name.c_str());
+  std::cout << "DEF writer test passes!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "phydb/hpwl.h"
+#include "phydb/phydb.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+// HPWL of a net from the pin lists of the net, without the engine
+static int64_t ReferenceNetHpwl(Design &design, Net &net) {
+  int min_x = INT_MAX, max_x = INT_MIN;
+  int min_y = INT_MAX, max_y = INT_MIN;
+  int num_pins = 0;
+  auto add_pin = [&](Point2D<int> const &location) {
+    min_x = std::min(min_x, location.x);
+    max_x = std::max(max_x, location.x);
+    min_y = std::min(min_y, location.y);
+    max_y = std::max(max_y, location.y);
+    ++num_pins;
+  };
+  for (auto &pin: net.GetPinsRef()) {
+    add_pin(design.GetComponentPinLocation(pin.InstanceId(), pin.PinId()));
+  }
+  for (int iopin_id: net.GetIoPinIdsRef()) {
+    add_pin(design.GetIoPinLocation(iopin_id));
+  }
+  if (num_pins < 2) return 0;
+  return (int64_t) max_x - min_x + (int64_t) max_y - min_y;
+}
+
+static void CheckAgainstReference(Design &design, HpwlEngine &hpwl) {
+  auto &nets = design.GetNetsRef();
+  int64_t total = 0;
+  for (int net_id = 0; net_id < (int) nets.size(); ++net_id) {
+    int64_t reference = ReferenceNetHpwl(design, nets[net_id]);
+    assert(hpwl.GetNetHpwl(net_id) == reference);
+    total += reference;
+  }
+  assert(hpwl.GetTotalHpwl() == total);
+}
+
+/****
+ * Incremental HPWL updates after random moves and flips must give the same
+ * result as a full recompute.
+ */
+int main() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 3000, 2500, 5, 11);
+  Design &design = phy_db.design();
+
+  HpwlEngine hpwl(&phy_db);
+  hpwl.SetNumThreads(4);
+  hpwl.Build();
+  CheckAgainstReference(design, hpwl);
+
+  std::mt19937 rng(13);
+  std::uniform_int_distribution<int> coordinate(0, 198000);
+  std::uniform_int_distribution<int> comp_id(0, 2999);
+  auto &components = design.GetComponentsRef();
+  for (int round = 0; round < 20; ++round) {
+    std::vector<int> moved;
+    for (int i = 0; i < 50; ++i) {
+      Component &component = components[comp_id(rng)];
+      component.SetLocation(coordinate(rng), coordinate(rng));
+      if (rng() % 2 == 0) {
+        component.SetOrientation(CompOrient::FN);
+      }
+      moved.push_back(component.GetId());
+    }
+    int64_t total_before = hpwl.GetTotalHpwl();
+    int64_t delta = (round % 2 == 0) ? hpwl.Update()
+                                     : hpwl.UpdateComponents(moved);
+    assert(hpwl.GetTotalHpwl() == total_before + delta);
+    CheckAgainstReference(design, hpwl);
+  }
+
+  // a full pass over all pins agrees with the incremental state
+  int64_t incremental_total = hpwl.GetTotalHpwl();
+  hpwl.SyncPinLocations();
+  assert(hpwl.GetTotalHpwl() == incremental_total);
+
+  std::cout << "HPWL test passes!" << std::endl;
+  return 0;
+}
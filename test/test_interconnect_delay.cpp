@@ -0,0 +1,156 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "phydb/netconnectivity.h"
+#include "phydb/phydb.h"
+#include "phydb/timing/interconnectdelay.h"
+#include "phydb/timing/steinerrcestimator.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+static bool IsClose(double value, double expected) {
+  return std::fabs(value - expected) <= 1e-9 * std::fabs(expected);
+}
+
+static void SetLayerRc(PhyDB &phy_db) {
+  for (auto &layer: phy_db.GetTechPtr()->GetLayersRef()) {
+    layer.SetRPerSqUnit(0.08);
+    layer.SetCPerSqDist(2e-5);
+    layer.SetEdgeCPerDist(4e-5);
+    layer.SetResistanceUnitFromLef();
+    layer.SetCapacitanceUnitFromLef();
+  }
+}
+
+/****
+ * The driver of a net is found from pin directions, wherever it is listed:
+ * the output of a component in the middle of a net, and a primary input
+ * listed after the sink it drives. Delays start at zero at these drivers.
+ */
+static void TestDriverNotFirst() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 4, 0, 1, 7);
+  SetLayerRc(phy_db);
+  phy_db.AddNet("m");
+  phy_db.AddCompPinToNet("u0", "A", "m");
+  phy_db.AddCompPinToNet("u1", "Z", "m");
+  phy_db.AddCompPinToNet("u2", "A", "m");
+  phy_db.AddNet("pi");
+  phy_db.AddCompPinToNet("u3", "A", "pi");
+  IOPin *iopin = phy_db.AddIoPin(
+      "in0",
+      SignalDirection::INPUT,
+      SignalUse::SIGNAL
+  );
+  iopin->SetShape("metal1", -50, -50, 50, 50);
+  iopin->SetPlacement(PlaceStatus::FIXED, 0, 100000, CompOrient::N);
+  phy_db.AddIoPinToNet("in0", "pi");
+
+  SteinerRcEstimator rc_estimator(&phy_db);
+  rc_estimator.SetWiringLayers(0, 1);
+  rc_estimator.EstimateAllNets();
+  NetConnectivity const &csr =
+      rc_estimator.GetSteinerTreeEngine().GetConnectivity();
+  InterconnectDelayEngine engine(&rc_estimator);
+  engine.ComputeAllNets(0);
+
+  int m_begin = csr.GetNetPinBegin(0);
+  assert(csr.GetNetDriverPin(0) == m_begin + 1);
+  assert(engine.GetDelay(m_begin + 1) == 0);
+  assert(engine.GetDelay(m_begin) > 0);
+  assert(engine.GetDelay(m_begin + 2) > 0);
+
+  int pi_begin = csr.GetNetPinBegin(1);
+  int sink = pi_begin;
+  int driver = pi_begin + 1;
+  assert(csr.IsIoPin(driver));
+  assert(csr.GetNetDriverPin(1) == driver);
+  double res = rc_estimator.GetEdgeResistance(1, 0, 0);
+  double cap = rc_estimator.GetNodeCapacitance(1, 0, 0);
+  assert(res * cap > 0);
+  assert(engine.GetDelay(driver) == 0);
+  assert(IsClose(engine.GetDelay(sink), res * cap));
+}
+
+/****
+ * A two-pin net is a single RC section: the resistance R of its wire, and
+ * the capacitance C at the sink, half of the wire plus the sink load. The
+ * step response at the sink is 1 - exp(-t / RC), so the Elmore delay is RC,
+ * the 50% delay is ln(2) RC, and the 10%-90% slew is ln(9) RC. The engine
+ * must give these values, with the D2M metric for the 50% delay.
+ */
+int main() {
+  PhyDB phy_db;
+  // every net is driven by an output and has one sink, every tenth net also
+  // has an IO pin
+  BuildSyntheticDesign(phy_db, 1000, 1000, 1, 31);
+  SetLayerRc(phy_db);
+
+  SteinerRcEstimator rc_estimator(&phy_db);
+  rc_estimator.SetWiringLayers(0, 1);
+  rc_estimator.EstimateAllNets();
+  NetConnectivity const &csr =
+      rc_estimator.GetSteinerTreeEngine().GetConnectivity();
+
+  InterconnectDelayEngine elmore_engine(&rc_estimator);
+  InterconnectDelayEngine d2m_engine(&rc_estimator);
+  d2m_engine.SetMetric(WireDelayMetric::D2M);
+  // a load on pin A of every other component
+  const double sink_load = 1.5e-3;
+  for (int comp_id = 0; comp_id < 1000; comp_id += 2) {
+    elmore_engine.SetPinCapacitance(PhydbPin(comp_id, 0), sink_load);
+    d2m_engine.SetPinCapacitance(PhydbPin(comp_id, 0), sink_load);
+  }
+  elmore_engine.ComputeAllNets(0);
+  d2m_engine.ComputeAllNets(0);
+
+  int num_checked = 0;
+  for (int net_id = 0; net_id < csr.GetNumNets(); ++net_id) {
+    if (csr.GetNetDegree(net_id) != 2) continue;
+    int driver = csr.GetNetPinBegin(net_id);
+    assert(csr.GetNetDriverPin(net_id) == driver);
+    int sink = driver + 1;
+    double load = (csr.GetPinId(sink) == 0
+        && csr.GetPinComponentId(sink) % 2 == 0) ? sink_load : 0;
+    double res = rc_estimator.GetEdgeResistance(net_id, 0, 0);
+    double cap = rc_estimator.GetNodeCapacitance(net_id, 1, 0) + load;
+    if (res * cap == 0) continue;
+
+    assert(elmore_engine.GetDelay(driver) == 0);
+    assert(elmore_engine.GetSlew(driver) == 0);
+    assert(IsClose(elmore_engine.GetDelay(sink), res * cap));
+    assert(IsClose(elmore_engine.GetSlew(sink), std::log(9.0) * res * cap));
+    assert(IsClose(d2m_engine.GetDelay(sink), std::log(2.0) * res * cap));
+    assert(IsClose(d2m_engine.GetSlew(sink), std::log(9.0) * res * cap));
+    ++num_checked;
+  }
+  assert(num_checked > 500);
+
+  TestDriverNotFirst();
+
+  std::cout << "Interconnect delay test passes!" << std::endl;
+  return 0;
+}
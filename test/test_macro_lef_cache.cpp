@@ -0,0 +1,288 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "phydb/phydb.h"
+
+using namespace phydb;
+
+/****
+ * Cell library LEF files read through the on-disk cache of ReadMacroLefs()
+ * must give the same sites and macros as a fresh parse. A second read must
+ * load every library from its cache entry, and a changed LEF file must not
+ * be loaded from the entry of its old content.
+ */
+
+static const char *kTechLef = R"(VERSION 5.8 ;
+BUSBITCHARS "[]" ;
+DIVIDERCHAR "/" ;
+UNITS
+  DATABASE MICRONS 1000 ;
+END UNITS
+MANUFACTURINGGRID 0.005 ;
+LAYER metal1
+  TYPE ROUTING ;
+  DIRECTION HORIZONTAL ;
+  PITCH 0.2 ;
+  WIDTH 0.1 ;
+  SPACING 0.1 ;
+END metal1
+LAYER via1
+  TYPE CUT ;
+END via1
+LAYER metal2
+  TYPE ROUTING ;
+  DIRECTION VERTICAL ;
+  PITCH 0.2 ;
+  WIDTH 0.1 ;
+  SPACING 0.1 ;
+END metal2
+END LIBRARY
+)";
+
+static const char *kInvLef = R"(VERSION 5.8 ;
+SITE core
+  CLASS CORE ;
+  SIZE 0.2 BY 1.4 ;
+END core
+MACRO INV
+  CLASS CORE ;
+  ORIGIN 0 0 ;
+  SIZE 0.4 BY 1.4 ;
+  SITE core ;
+  PIN A
+    DIRECTION INPUT ;
+    USE SIGNAL ;
+    PORT
+      LAYER metal1 ;
+        RECT 0.0 0.6 0.1 0.7 ;
+    END
+  END A
+  PIN Z
+    DIRECTION OUTPUT ;
+    USE SIGNAL ;
+    PORT
+      LAYER metal1 ;
+        RECT 0.3 0.6 0.4 0.7 ;
+      LAYER metal2 ;
+        RECT 0.3 0.5 0.4 0.9 ;
+    END
+  END Z
+  OBS
+    LAYER metal1 ;
+      RECT 0.1 0.2 0.3 0.3 ;
+  END
+END INV
+END LIBRARY
+)";
+
+static std::string NandLef(double width) {
+  return "VERSION 5.8 ;\n"
+         "MACRO NAND2\n"
+         "  CLASS CORE ;\n"
+         "  ORIGIN 0 0 ;\n"
+         "  SIZE " + std::to_string(width) + " BY 1.4 ;\n"
+         "  SITE core ;\n"
+         "  PIN A\n"
+         "    DIRECTION INPUT ;\n"
+         "    PORT\n"
+         "      LAYER metal1 ;\n"
+         "        RECT 0.0 0.6 0.1 0.7 ;\n"
+         "    END\n"
+         "  END A\n"
+         "  PIN B\n"
+         "    DIRECTION INPUT ;\n"
+         "    PORT\n"
+         "      LAYER metal1 ;\n"
+         "        RECT 0.2 0.6 0.3 0.7 ;\n"
+         "    END\n"
+         "  END B\n"
+         "  PIN Z\n"
+         "    DIRECTION OUTPUT ;\n"
+         "    PORT\n"
+         "      LAYER metal2 ;\n"
+         "        RECT 0.5 0.6 0.6 0.7 ;\n"
+         "    END\n"
+         "  END Z\n"
+         "END NAND2\n"
+         "END LIBRARY\n";
+}
+
+static void WriteFile(
+    std::string const &file_name,
+    std::string const &content
+) {
+  std::ofstream ofs(file_name);
+  assert(ofs.is_open());
+  ofs << content;
+}
+
+// inode of every cache entry, a rewritten entry gets a new inode
+static std::map<std::string, ino_t> ListCacheEntries(
+    std::string const &cache_dir
+) {
+  std::map<std::string, ino_t> entries;
+  DIR *dir = opendir(cache_dir.c_str());
+  assert(dir != nullptr);
+  while (dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    struct stat status;
+    assert(stat((cache_dir + "/" + name).c_str(), &status) == 0);
+    entries[name] = status.st_ino;
+  }
+  closedir(dir);
+  return entries;
+}
+
+static void ReadLibraries(
+    PhyDB &phy_db,
+    std::string const &tech_lef,
+    std::vector<std::string> const &cell_lefs,
+    std::string const &cache_dir
+) {
+  phy_db.ReadLef(tech_lef);
+  phy_db.ReadMacroLefs(cell_lefs, 2, cache_dir);
+}
+
+static void ExpectSameLayerRects(
+    std::vector<LayerRect> &a,
+    std::vector<LayerRect> &b
+) {
+  assert(a.size() == b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    assert(a[i].GetLayerName() == b[i].GetLayerName());
+    assert(a[i].layer_id_ == b[i].layer_id_);
+    assert(a[i].rects_.size() == b[i].rects_.size());
+    for (size_t j = 0; j < a[i].rects_.size(); ++j) {
+      assert(a[i].rects_[j].ll.x == b[i].rects_[j].ll.x);
+      assert(a[i].rects_[j].ll.y == b[i].rects_[j].ll.y);
+      assert(a[i].rects_[j].ur.x == b[i].rects_[j].ur.x);
+      assert(a[i].rects_[j].ur.y == b[i].rects_[j].ur.y);
+    }
+  }
+}
+
+static void ExpectSameLibraries(PhyDB &a, PhyDB &b) {
+  auto &sites_a = a.GetSitesRef();
+  auto &sites_b = b.GetSitesRef();
+  assert(sites_a.size() == sites_b.size());
+  for (size_t i = 0; i < sites_a.size(); ++i) {
+    assert(sites_a[i].GetName() == sites_b[i].GetName());
+    assert(sites_a[i].GetClass() == sites_b[i].GetClass());
+    assert(sites_a[i].GetWidth() == sites_b[i].GetWidth());
+    assert(sites_a[i].GetHeight() == sites_b[i].GetHeight());
+  }
+
+  auto &macros_a = a.tech().GetMacrosRef();
+  auto &macros_b = b.tech().GetMacrosRef();
+  assert(macros_a.size() == macros_b.size());
+  for (size_t i = 0; i < macros_a.size(); ++i) {
+    Macro &macro_a = macros_a[i];
+    Macro &macro_b = macros_b[i];
+    assert(macro_a.GetName() == macro_b.GetName());
+    assert(macro_a.GetClass() == macro_b.GetClass());
+    assert(macro_a.GetOriginX() == macro_b.GetOriginX());
+    assert(macro_a.GetOriginY() == macro_b.GetOriginY());
+    assert(macro_a.GetWidth() == macro_b.GetWidth());
+    assert(macro_a.GetHeight() == macro_b.GetHeight());
+    auto &pins_a = macro_a.GetPinsRef();
+    auto &pins_b = macro_b.GetPinsRef();
+    assert(pins_a.size() == pins_b.size());
+    for (size_t j = 0; j < pins_a.size(); ++j) {
+      assert(pins_a[j].GetName() == pins_b[j].GetName());
+      assert(pins_a[j].GetDirection() == pins_b[j].GetDirection());
+      assert(pins_a[j].GetUse() == pins_b[j].GetUse());
+      ExpectSameLayerRects(
+          pins_a[j].GetLayerRectRef(),
+          pins_b[j].GetLayerRectRef()
+      );
+    }
+    ExpectSameLayerRects(
+        macro_a.GetObs()->GetLayerRectsRef(),
+        macro_b.GetObs()->GetLayerRectsRef()
+    );
+  }
+}
+
+int main() {
+  char cache_dir_template[] = "test_macro_lef_cache_XXXXXX";
+  assert(mkdtemp(cache_dir_template) != nullptr);
+  std::string cache_dir = cache_dir_template;
+  std::string tech_lef = "test_macro_lef_cache_tech.lef";
+  std::string inv_lef = "test_macro_lef_cache_inv.lef";
+  std::string nand_lef = "test_macro_lef_cache_nand.lef";
+  WriteFile(tech_lef, kTechLef);
+  WriteFile(inv_lef, kInvLef);
+  WriteFile(nand_lef, NandLef(0.6));
+  std::vector<std::string> cell_lefs = {inv_lef, nand_lef};
+
+  PhyDB fresh_db;
+  ReadLibraries(fresh_db, tech_lef, cell_lefs, "");
+  assert(fresh_db.tech().GetMacrosRef().size() == 2);
+
+  // the first read parses both files and saves them to the cache
+  PhyDB first_db;
+  ReadLibraries(first_db, tech_lef, cell_lefs, cache_dir);
+  ExpectSameLibraries(fresh_db, first_db);
+  auto entries = ListCacheEntries(cache_dir);
+  assert(entries.size() == 2);
+
+  // the second read loads both files from the cache, so no entry is rewritten
+  PhyDB cached_db;
+  ReadLibraries(cached_db, tech_lef, cell_lefs, cache_dir);
+  ExpectSameLibraries(fresh_db, cached_db);
+  assert(ListCacheEntries(cache_dir) == entries);
+
+  // a changed file misses the cache and gets a new entry
+  WriteFile(nand_lef, NandLef(0.8));
+  PhyDB changed_db;
+  ReadLibraries(changed_db, tech_lef, cell_lefs, cache_dir);
+  Macro *nand2 = changed_db.GetMacroPtr("NAND2");
+  assert(nand2 != nullptr && nand2->GetWidth() == 0.8);
+  auto changed_entries = ListCacheEntries(cache_dir);
+  assert(changed_entries.size() == 3);
+  for (auto &[name, inode]: entries) {
+    assert(changed_entries.at(name) == inode);
+  }
+
+  for (auto &entry: changed_entries) {
+    std::remove((cache_dir + "/" + entry.first).c_str());
+  }
+  rmdir(cache_dir.c_str());
+  std::remove(tech_lef.c_str());
+  std::remove(inv_lef.c_str());
+  std::remove(nand_lef.c_str());
+  std::cout << "Macro LEF cache test passes!" << std::endl;
+  return 0;
+}
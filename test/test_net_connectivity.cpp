@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <iostream>
+
+#include "phydb/hpwl.h"
+#include "phydb/netconnectivity.h"
+#include "phydb/phydb.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+// both directions of the CSR connectivity must agree with the pin lists of
+// the nets
+static void CheckAgainstNets(Design &design, NetConnectivity const &csr) {
+  auto &nets = design.GetNetsRef();
+  assert(csr.GetNumNets() == (int) nets.size());
+  int num_pins = 0;
+  for (int net_id = 0; net_id < (int) nets.size(); ++net_id) {
+    auto &comp_pins = nets[net_id].GetPinsRef();
+    auto &iopin_ids = nets[net_id].GetIoPinIdsRef();
+    int degree = (int) (comp_pins.size() + iopin_ids.size());
+    assert(csr.GetNetDegree(net_id) == degree);
+    assert(csr.GetNetPinBegin(net_id) == num_pins);
+    int pin = csr.GetNetPinBegin(net_id);
+    for (auto &comp_pin: comp_pins) {
+      assert(!csr.IsIoPin(pin));
+      assert(csr.GetPinComponentId(pin) == comp_pin.InstanceId());
+      assert(csr.GetPinId(pin) == comp_pin.PinId());
+      assert(csr.GetPinNetId(pin) == net_id);
+      assert(csr.GetComponentPin(comp_pin.InstanceId(), comp_pin.PinId())
+                 == pin);
+      assert(csr.GetComponentPinNetId(comp_pin.InstanceId(), comp_pin.PinId())
+                 == net_id);
+      ++pin;
+    }
+    for (int iopin_id: iopin_ids) {
+      assert(csr.IsIoPin(pin));
+      assert(csr.GetPinId(pin) == iopin_id);
+      assert(csr.GetPinNetId(pin) == net_id);
+      assert(csr.GetIoPinNetId(iopin_id) == net_id);
+      ++pin;
+    }
+    num_pins += degree;
+  }
+  assert(csr.GetNumPins() == num_pins);
+
+  // every connected slot is listed by a net, so counting them finds the
+  // number of component pins
+  int num_connected_slots = 0;
+  for (int comp_id = 0; comp_id < (int) design.GetComponentsRef().size();
+       ++comp_id) {
+    int end = csr.GetComponentPinSlotEnd(comp_id);
+    for (int i = csr.GetComponentPinSlotBegin(comp_id); i < end; ++i) {
+      if (csr.GetSlotPin(i) >= 0) {
+        assert(csr.GetPinComponentId(csr.GetSlotPin(i)) == comp_id);
+        ++num_connected_slots;
+      }
+    }
+  }
+  int num_comp_pins = 0;
+  for (auto &net: nets) {
+    num_comp_pins += (int) net.GetPinsRef().size();
+  }
+  assert(num_connected_slots == num_comp_pins);
+}
+
+/****
+ * The CSR connectivity must match the pin lists of the nets, and after a
+ * netlist change it must be rebuilt in place with a new generation, which
+ * users such as HpwlEngine pick up.
+ */
+int main() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 2000, 1000, 4, 5);
+  Design &design = phy_db.design();
+  assert(phy_db.GetNetConnectivityPtr() == nullptr);
+
+  NetConnectivity *csr = phy_db.BuildNetConnectivity();
+  assert(phy_db.GetNetConnectivityPtr() == csr);
+  CheckAgainstNets(design, *csr);
+
+  HpwlEngine hpwl(&phy_db);
+  hpwl.Build();
+  uint64_t generation = phy_db.GetConnectivityGeneration();
+
+  // outputs of components beyond the first 1000 are not connected yet
+  phy_db.AddNet("extra");
+  phy_db.AddCompPinToNet("u1500", "Z", "extra");
+  phy_db.AddCompPinToNet("u1600", "Z", "extra");
+  assert(phy_db.GetConnectivityGeneration() > generation);
+  assert(phy_db.GetNetConnectivityPtr() == nullptr);
+
+  hpwl.SyncPinLocations();
+  assert(phy_db.BuildNetConnectivity() == csr);
+  CheckAgainstNets(design, *csr);
+
+  HpwlEngine fresh_hpwl(&phy_db);
+  fresh_hpwl.Build();
+  assert(hpwl.GetTotalHpwl() == fresh_hpwl.GetTotalHpwl());
+  int extra_id = (int) design.GetNetsRef().size() - 1;
+  assert(hpwl.GetNetHpwl(extra_id) > 0);
+
+  std::cout << "Net connectivity test passes!" << std::endl;
+  return 0;
+}
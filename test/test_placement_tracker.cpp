@@ -0,0 +1,89 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "phydb/placementtracker.h"
+
+using namespace phydb;
+
+// components changed after an epoch, found by scanning all components
+static std::vector<int> BruteForceChangedSince(
+    PlacementTracker const &tracker,
+    int num_components,
+    uint64_t epoch
+) {
+  std::vector<int> res;
+  for (int comp_id = 0; comp_id < num_components; ++comp_id) {
+    if (tracker.GetComponentEpoch(comp_id) > epoch) {
+      res.push_back(comp_id);
+    }
+  }
+  return res;
+}
+
+/****
+ * Queries must give the same components as a full scan for every earlier
+ * epoch, including epochs before and after the change log is dropped, and
+ * epochs in the middle of a batch which crosses a drop.
+ */
+int main() {
+  const int num_components = 100;
+  PlacementTracker tracker;
+  tracker.SetComponentCount(num_components);
+
+  std::mt19937 rng(17);
+  std::uniform_int_distribution<int> comp_id(0, num_components - 1);
+  std::uniform_int_distribution<int> batch_size(1, 30);
+  std::vector<uint64_t> epochs = {tracker.GetEpoch()};
+  std::vector<int> comp_ids;
+  // the log holds at most num_components changes, so it is dropped many
+  // times during this loop
+  for (int step = 0; step < 400; ++step) {
+    if (step % 3 == 0) {
+      std::vector<int> batch;
+      int size = batch_size(rng);
+      for (int i = 0; i < size; ++i) {
+        batch.push_back(comp_id(rng));
+      }
+      tracker.MarkComponentsChanged(batch);
+    } else {
+      tracker.MarkComponentChanged(comp_id(rng));
+    }
+    epochs.push_back(tracker.GetEpoch());
+
+    for (uint64_t epoch: epochs) {
+      tracker.GetComponentsChangedSince(epoch, comp_ids);
+      assert(
+          comp_ids == BruteForceChangedSince(tracker, num_components, epoch)
+      );
+    }
+  }
+
+  tracker.GetComponentsChangedSince(tracker.GetEpoch(), comp_ids);
+  assert(comp_ids.empty());
+
+  std::cout << "Placement tracker test passes!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "phydb/netconnectivity.h"
+#include "phydb/phydb.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+static std::string ReadFileBytes(std::string const &file_name) {
+  std::ifstream ifs(file_name, std::ios::in | std::ios::binary);
+  assert(ifs.is_open());
+  return std::string(
+      std::istreambuf_iterator<char>(ifs),
+      std::istreambuf_iterator<char>()
+  );
+}
+
+/****
+ * Saving a database, loading it back and saving it again must give identical
+ * files, and so must saving the same database twice.
+ */
+int main() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 500, 400, 4, 1);
+  SNet *vdd = phy_db.AddSNet("VDD", SignalUse::POWER);
+  std::string metal1_name("metal1");
+  Path *stripe = vdd->AddPath(metal1_name, "STRIPE", 200);
+  stripe->AddRoutingPoint(0, 1000);
+  stripe->AddRoutingPoint(100000, 1000);
+  Path *via_array = vdd->AddPath(metal1_name, "STRIPE", 0);
+  std::string via_name("via12");
+  via_array->SetViaName(via_name);
+  via_array->SetViaArray(4, 2, 400, 300);
+  via_array->AddRoutingPoint(2000, 1000);
+  std::vector<std::string> track_layers = {"metal1", "metal2"};
+  phy_db.AddTrack(XYDirection::Y, 100, 1000, 200, track_layers);
+
+  std::string first_file_name = "test_snapshot_0.phydb";
+  std::string second_file_name = "test_snapshot_1.phydb";
+  std::string third_file_name = "test_snapshot_2.phydb";
+  phy_db.SaveSnapshot(first_file_name);
+  phy_db.SaveSnapshot(second_file_name);
+  std::string first = ReadFileBytes(first_file_name);
+  assert(!first.empty());
+  assert(first == ReadFileBytes(second_file_name));
+
+  PhyDB loaded_db;
+  // connectivity of the empty database must not outlive the load
+  assert(loaded_db.BuildNetConnectivity() != nullptr);
+  loaded_db.LoadSnapshot(first_file_name);
+  assert(loaded_db.GetNetConnectivityPtr() == nullptr);
+  NetConnectivity *connectivity = loaded_db.BuildNetConnectivity();
+  assert(connectivity->GetNetDriverPin(0) >= 0);
+  assert(
+      loaded_db.design().GetComponentsRef().size()
+          == phy_db.design().GetComponentsRef().size()
+  );
+  assert(
+      loaded_db.design().GetNetsRef().size()
+          == phy_db.design().GetNetsRef().size()
+  );
+  Path &loaded_via_array = loaded_db.GetSNetRef()[0].GetPathsRef()[1];
+  assert(loaded_via_array.GetViaNumX() == 4);
+  assert(loaded_via_array.GetViaStepY() == 300);
+  Track &loaded_track = loaded_db.GetTracksRef()[0];
+  assert(loaded_track.GetLayerNames().size() == 2);
+  assert(loaded_track.GetLayerNames()[1] == "metal2");
+  assert(loaded_track.GetLayerIds()[1] == 1);
+  Macro *loaded_macro = loaded_db.GetMacroPtr("NAND2");
+  Pin &loaded_pin = loaded_macro->GetPinsRef()[0];
+  assert(loaded_pin.GetLayerRectRef()[0].GetLayerName() == "metal1");
+  loaded_db.SaveSnapshot(third_file_name);
+  assert(first == ReadFileBytes(third_file_name));
+
+  std::remove(first_file_name.c_str());
+  std::remove(second_file_name.c_str());
+  std::remove(third_file_name.c_str());
+  std::cout << "Snapshot test passes!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,288 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "phydb/phydb.h"
+#include "phydb/spatialindex.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+// component outlines found by scanning all components
+static std::vector<int> BruteForceQuery(
+    Design &design,
+    Rect2D<int> const &region,
+    int width,
+    int height
+) {
+  std::vector<int> res;
+  for (auto &component: design.GetComponentsRef()) {
+    Point2D<int> loc = component.GetLocation();
+    bool is_overlapping = loc.x <= region.ur.x && loc.x + width >= region.ll.x
+        && loc.y <= region.ur.y && loc.y + height >= region.ll.y;
+    if (is_overlapping) {
+      res.push_back(component.GetId());
+    }
+  }
+  return res;
+}
+
+static std::vector<int> IndexQuery(
+    SpatialIndex &index,
+    Rect2D<int> const &region
+) {
+  std::vector<SpatialObject> objects;
+  index.QueryRegion(region, objects);
+  std::vector<int> res;
+  for (auto &object: objects) {
+    if (object.type == SpatialObjectType::COMPONENT) {
+      res.push_back(object.id);
+    }
+  }
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+// every placed IO pin must be found on its layer, its shape is given by
+// layer name only
+static void CheckIoPins(Design &design, SpatialIndex &index) {
+  int metal1_id = design.GetTechPtr()->GetLayerId("metal1");
+  auto &iopins = design.GetIoPinsRef();
+  assert(!iopins.empty());
+  for (int iopin_id = 0; iopin_id < (int) iopins.size(); ++iopin_id) {
+    assert(iopins[iopin_id].GetLayerId() < 0);
+    Point2D<int> loc = iopins[iopin_id].GetLocation();
+    Rect2D<int> region(loc.x - 10, loc.y - 10, loc.x + 10, loc.y + 10);
+    std::vector<SpatialObject> objects;
+    index.QueryRegion(region, objects, metal1_id);
+    int num_found = 0;
+    for (auto &object: objects) {
+      if (object.type == SpatialObjectType::IOPIN && object.id == iopin_id) {
+        assert(object.layer_id == metal1_id);
+        assert(object.box.ll.x == loc.x - 50 && object.box.ur.y == loc.y + 50);
+        ++num_found;
+      }
+    }
+    assert(num_found == 1);
+  }
+}
+
+// objects of a type and id found in a region of a layer
+static int CountObjects(
+    SpatialIndex &index,
+    Rect2D<int> const &region,
+    int layer_id,
+    SpatialObjectType type,
+    int id
+) {
+  std::vector<SpatialObject> objects;
+  index.QueryRegion(region, objects, layer_id);
+  return (int) std::count_if(
+      objects.begin(),
+      objects.end(),
+      [&](SpatialObject const &object) {
+        return object.type == type && object.id == id;
+      }
+  );
+}
+
+// squared distance from a point to a box
+static int64_t SquaredDistance(Point2D<int> const &p, Rect2D<int> const &box) {
+  int64_t dx = std::max({(int64_t) box.ll.x - p.x, (int64_t) 0,
+                         (int64_t) p.x - box.ur.x});
+  int64_t dy = std::max({(int64_t) box.ll.y - p.y, (int64_t) 0,
+                         (int64_t) p.y - box.ur.y});
+  return dx * dx + dy * dy;
+}
+
+// the k nearest components must be as near as the k nearest of a scan
+static void CheckNearest(
+    Design &design,
+    SpatialIndex &index,
+    Point2D<int> const &point,
+    int width,
+    int height
+) {
+  const int k = 5;
+  std::vector<int64_t> expected;
+  for (auto &component: design.GetComponentsRef()) {
+    Point2D<int> loc = component.GetLocation();
+    Rect2D<int> box(loc.x, loc.y, loc.x + width, loc.y + height);
+    expected.push_back(SquaredDistance(point, box));
+  }
+  std::sort(expected.begin(), expected.end());
+  expected.resize(k);
+
+  std::vector<SpatialObject> objects;
+  index.QueryNearest(point, k, objects);
+  assert((int) objects.size() == k);
+  std::vector<int64_t> distances;
+  for (auto &object: objects) {
+    assert(object.type == SpatialObjectType::COMPONENT);
+    distances.push_back(SquaredDistance(point, object.box));
+  }
+  std::sort(distances.begin(), distances.end());
+  assert(distances == expected);
+}
+
+/****
+ * Pin shapes and blockages are indexed on their own layers: the output pin
+ * of a component is found on metal1 and not on metal2, a routing blockage
+ * on metal2, and a placement blockage with the components. An IO pin moved
+ * and re-indexed by UpdateIoPin() is found at its new location only.
+ */
+static void TestLayerShapes() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 50, 20, 2, 11);
+  Design &design = phy_db.design();
+  Tech &tech = phy_db.tech();
+  int metal1_id = tech.GetLayerId("metal1");
+  int metal2_id = tech.GetLayerId("metal2");
+  Blockage *routing_blockage = phy_db.AddBlockage();
+  routing_blockage->SetLayer(tech.GetLayerPtr("metal2"));
+  routing_blockage->AddRect(1000, 1000, 5000, 2000);
+  routing_blockage->AddRect(8000, 1000, 9000, 6000);
+  Blockage *placement_blockage = phy_db.AddBlockage();
+  placement_blockage->SetPlacement();
+  placement_blockage->AddRect(20000, 20000, 30000, 30000);
+  SpatialIndex *index = phy_db.BuildSpatialIndex();
+
+  std::ostringstream component_text;
+  component_text << design.GetComponentsRef()[0];
+  assert(component_text.str().find("NAND2") != std::string::npos);
+
+  // pin Z is at x in [0.65, 0.75] and y in [0.6, 0.8] micron of a 0.8 by 1.4
+  // micron cell, so its box is the same in orientations N and FS
+  for (auto &component: design.GetComponentsRef()) {
+    Point2D<int> loc = component.GetLocation();
+    Rect2D<int> pin_box(loc.x + 650, loc.y + 600, loc.x + 750, loc.y + 800);
+    std::vector<SpatialObject> objects;
+    index->QueryRegion(pin_box, objects, metal1_id);
+    int num_found = 0;
+    for (auto &object: objects) {
+      if (object.type != SpatialObjectType::COMPONENT_PIN
+          || object.id != component.GetId() || object.sub_id != 2) {
+        continue;
+      }
+      assert(object.layer_id == metal1_id);
+      assert(object.box.ll.x == pin_box.ll.x);
+      assert(object.box.ll.y == pin_box.ll.y);
+      assert(object.box.ur.x == pin_box.ur.x);
+      assert(object.box.ur.y == pin_box.ur.y);
+      ++num_found;
+    }
+    assert(num_found == 1);
+    assert(
+        CountObjects(
+            *index, pin_box, metal2_id,
+            SpatialObjectType::COMPONENT_PIN, component.GetId()
+        ) == 0
+    );
+  }
+
+  Rect2D<int> second_rect(8500, 5000, 8600, 5100);
+  std::vector<SpatialObject> objects;
+  index->QueryRegion(second_rect, objects, metal2_id);
+  assert(objects.size() == 1);
+  assert(objects[0].type == SpatialObjectType::BLOCKAGE);
+  assert(objects[0].id == 0 && objects[0].sub_id == 1);
+  assert(
+      CountObjects(
+          *index, second_rect, metal1_id, SpatialObjectType::BLOCKAGE, 0
+      ) == 0
+  );
+  assert(
+      CountObjects(
+          *index, Rect2D<int>(25000, 25000, 25001, 25001),
+          SpatialIndex::kPlacementLayer, SpatialObjectType::BLOCKAGE, 1
+      ) == 1
+  );
+
+  IOPin &iopin = design.GetIoPinsRef()[0];
+  Point2D<int> old_loc = iopin.GetLocation();
+  Rect2D<int> old_region(old_loc.x, old_loc.y, old_loc.x + 1, old_loc.y + 1);
+  assert(
+      CountObjects(*index, old_region, metal1_id, SpatialObjectType::IOPIN, 0)
+          == 1
+  );
+  iopin.SetPlacement(PlaceStatus::FIXED, 150000, 160000, CompOrient::N);
+  index->UpdateIoPin(0);
+  Rect2D<int> new_region(150000, 160000, 150001, 160001);
+  assert(
+      CountObjects(*index, old_region, metal1_id, SpatialObjectType::IOPIN, 0)
+          == 0
+  );
+  assert(
+      CountObjects(*index, new_region, metal1_id, SpatialObjectType::IOPIN, 0)
+          == 1
+  );
+}
+
+/****
+ * Region and nearest queries of the R-tree must find the same components as
+ * a scan over all components, before and after components are moved, and
+ * find every IO pin.
+ */
+int main() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 2000, 1000, 3, 3);
+  Design &design = phy_db.design();
+  // NAND2 is 0.8 by 1.4 micron, and there are 1000 DEF units per micron
+  const int width = 800;
+  const int height = 1400;
+  SpatialIndex *index = phy_db.BuildSpatialIndex();
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> coordinate(0, 200000);
+  std::uniform_int_distribution<int> size(0, 20000);
+  auto check_random_queries = [&]() {
+    for (int i = 0; i < 200; ++i) {
+      int x = coordinate(rng);
+      int y = coordinate(rng);
+      Rect2D<int> region(x, y, x + size(rng), y + size(rng));
+      assert(
+          IndexQuery(*index, region)
+              == BruteForceQuery(design, region, width, height)
+      );
+      CheckNearest(design, *index, region.ll, width, height);
+    }
+  };
+  check_random_queries();
+  CheckIoPins(design, *index);
+
+  auto &components = design.GetComponentsRef();
+  std::uniform_int_distribution<int> comp_id(0, (int) components.size() - 1);
+  for (int i = 0; i < 500; ++i) {
+    components[comp_id(rng)].SetLocation(coordinate(rng), coordinate(rng));
+  }
+  check_random_queries();
+  TestLayerShapes();
+
+  std::cout << "Spatial index test passes!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,230 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "phydb/netconnectivity.h"
+#include "phydb/phydb.h"
+#include "phydb/timing/starpimodelestimator.h"
+#include "phydb/timing/wirercmodel.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+static bool IsClose(double value, double expected) {
+  return std::fabs(value - expected) <= 1e-9 * std::fabs(expected);
+}
+
+static void SetLayerRc(PhyDB &phy_db) {
+  for (auto &layer: phy_db.GetTechPtr()->GetLayersRef()) {
+    layer.SetRPerSqUnit(0.08);
+    layer.SetCPerSqDist(2e-5);
+    layer.SetEdgeCPerDist(4e-5);
+    layer.SetResistanceUnitFromLef();
+    layer.SetCapacitanceUnitFromLef();
+  }
+}
+
+static Point2D<int> LocatePin(
+    Design &design,
+    NetConnectivity const &csr,
+    int pin
+) {
+  if (csr.IsIoPin(pin)) {
+    return design.GetIoPinLocation(csr.GetPinId(pin));
+  }
+  return design.GetComponentPinLocation(
+      csr.GetPinComponentId(pin),
+      csr.GetPinId(pin)
+  );
+}
+
+/****
+ * The star of every net must be centered at its driver, or at the centroid
+ * of its pins if it has none, and the RC of every branch must be the RC
+ * of an L-shaped wire of the same size given by WireRcModel.
+ */
+static void CheckAgainstWireRcModel(
+    PhyDB &phy_db,
+    StarPiModelEstimator &estimator
+) {
+  Design &design = phy_db.design();
+  NetConnectivity const &csr = estimator.GetConnectivity();
+  WireRcModel model;
+  model.Build(&phy_db, 0, 1);
+  int num_corners = estimator.GetNumCorners();
+  assert(num_corners == model.GetNumCorners());
+  for (int net_id = 0; net_id < csr.GetNumNets(); ++net_id) {
+    int begin = csr.GetNetPinBegin(net_id);
+    int end = csr.GetNetPinEnd(net_id);
+    if (end - begin < 2) continue;
+    int center_pin = estimator.GetCenterPin(net_id);
+    assert(center_pin == csr.GetNetDriverPin(net_id));
+    Point2D<int> center = estimator.GetCenterLocation(net_id);
+    if (center_pin >= 0) {
+      Point2D<int> location = LocatePin(design, csr, center_pin);
+      assert(center.x == location.x && center.y == location.y);
+    } else {
+      int64_t sum_x = 0, sum_y = 0;
+      for (int pin = begin; pin < end; ++pin) {
+        Point2D<int> location = LocatePin(design, csr, pin);
+        sum_x += location.x;
+        sum_y += location.y;
+      }
+      assert(center.x == sum_x / (end - begin));
+      assert(center.y == sum_y / (end - begin));
+    }
+
+    for (int c = 0; c < num_corners; ++c) {
+      double center_cap = 0;
+      for (int pin = begin; pin < end; ++pin) {
+        if (pin == center_pin) continue;
+        Point2D<int> location = LocatePin(design, csr, pin);
+        double res = 0, cap = 0;
+        model.ComputeWireRc(
+            std::abs((int64_t) location.x - center.x),
+            std::abs((int64_t) location.y - center.y),
+            c,
+            res,
+            cap
+        );
+        assert(IsClose(estimator.GetBranchResistance(pin, c), res));
+        assert(IsClose(estimator.GetPinCapacitance(pin, c), cap / 2));
+        center_cap += cap / 2;
+      }
+      assert(IsClose(estimator.GetCenterCapacitance(net_id, c), center_cap));
+    }
+  }
+}
+
+/****
+ * Moving one component must push exactly the nets of that component, and
+ * leave the estimator with the same results as a full estimate.
+ */
+static void TestIncrementalPush(PhyDB &phy_db) {
+  Design &design = phy_db.design();
+  StarPiModelEstimator estimator(&phy_db);
+  estimator.SetNumThreads(4);
+  estimator.SetWiringLayers(0, 1);
+  std::vector<int> pushed_net_ids;
+  estimator.SetBatchWriter(
+      [&](StarPiModelEstimator &, std::vector<int> const &net_ids) {
+        pushed_net_ids.insert(
+            pushed_net_ids.end(),
+            net_ids.begin(),
+            net_ids.end()
+        );
+      }
+  );
+  estimator.PushChangedNetRCToManager();
+  int num_nets = static_cast<int>(design.GetNetsRef().size());
+  assert(static_cast<int>(pushed_net_ids.size()) == num_nets);
+
+  pushed_net_ids.clear();
+  estimator.PushChangedNetRCToManager();
+  assert(pushed_net_ids.empty());
+
+  const int moved_comp_id = 42;
+  Component &component = design.GetComponentsRef()[moved_comp_id];
+  Point2D<int> location = component.GetLocation();
+  design.ApplyPlacementUpdates(
+      {{moved_comp_id, location.x + 7000, location.y + 3000, CompOrient::S}}
+  );
+  std::vector<int> expected_net_ids;
+  for (int net_id = 0; net_id < num_nets; ++net_id) {
+    for (auto &pin: design.GetNetsRef()[net_id].GetPinsRef()) {
+      if (pin.InstanceId() == moved_comp_id) {
+        expected_net_ids.push_back(net_id);
+        break;
+      }
+    }
+  }
+  assert(!expected_net_ids.empty());
+  estimator.PushChangedNetRCToManager();
+  std::sort(pushed_net_ids.begin(), pushed_net_ids.end());
+  assert(pushed_net_ids == expected_net_ids);
+
+  StarPiModelEstimator full_estimator(&phy_db);
+  full_estimator.SetWiringLayers(0, 1);
+  full_estimator.EstimateAllNets();
+  NetConnectivity const &csr = estimator.GetConnectivity();
+  for (int net_id = 0; net_id < num_nets; ++net_id) {
+    assert(estimator.GetCenterPin(net_id)
+               == full_estimator.GetCenterPin(net_id));
+    Point2D<int> center = estimator.GetCenterLocation(net_id);
+    Point2D<int> full_center = full_estimator.GetCenterLocation(net_id);
+    assert(center.x == full_center.x && center.y == full_center.y);
+    for (int c = 0; c < estimator.GetNumCorners(); ++c) {
+      assert(estimator.GetCenterCapacitance(net_id, c)
+                 == full_estimator.GetCenterCapacitance(net_id, c));
+    }
+  }
+  for (int pin = 0; pin < csr.GetNumPins(); ++pin) {
+    for (int c = 0; c < estimator.GetNumCorners(); ++c) {
+      assert(estimator.GetBranchResistance(pin, c)
+                 == full_estimator.GetBranchResistance(pin, c));
+      assert(estimator.GetPinCapacitance(pin, c)
+                 == full_estimator.GetPinCapacitance(pin, c));
+    }
+  }
+}
+
+int main() {
+  PhyDB phy_db;
+  // nets are driven by the output of a component
+  BuildSyntheticDesign(phy_db, 1000, 800, 4, 17);
+  SetLayerRc(phy_db);
+  // a net without a driver, all its IO pins are outputs
+  phy_db.AddNet("floating");
+  for (int i = 0; i < 3; ++i) {
+    std::string iopin_name = "q" + std::to_string(i);
+    IOPin *iopin = phy_db.AddIoPin(
+        iopin_name,
+        SignalDirection::OUTPUT,
+        SignalUse::SIGNAL
+    );
+    iopin->SetShape("metal1", -50, -50, 50, 50);
+    iopin->SetPlacement(PlaceStatus::FIXED, 30000 * i, 1000, CompOrient::N);
+    phy_db.AddIoPinToNet(iopin_name, "floating");
+  }
+
+  StarPiModelEstimator estimator(&phy_db);
+  estimator.SetNumThreads(4);
+  estimator.SetWiringLayers(0, 1);
+  estimator.EstimateAllNets();
+  NetConnectivity const &csr = estimator.GetConnectivity();
+  for (int net_id = 0; net_id < 800; ++net_id) {
+    assert(estimator.GetCenterPin(net_id) == csr.GetNetPinBegin(net_id));
+  }
+  assert(estimator.GetCenterPin(800) == -1);
+  assert(estimator.GetCenterCapacitance(800, 0) > 0);
+  CheckAgainstWireRcModel(phy_db, estimator);
+  TestIncrementalPush(phy_db);
+
+  std::cout << "Star pi-model test passes!" << std::endl;
+  return 0;
+}
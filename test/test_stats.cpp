@@ -0,0 +1,149 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "phydb/phydb.h"
+#include "phydb/stats.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+// moves a random subset of components to random locations and orientations
+static std::vector<int> MoveComponents(
+    Design &design,
+    int num_moves,
+    std::mt19937 &rng
+) {
+  int num_components = (int) design.GetComponentsRef().size();
+  std::uniform_int_distribution<int> comp(0, num_components - 1);
+  std::uniform_int_distribution<int> coordinate(0, 190000);
+  std::vector<PlacementUpdate> updates;
+  std::vector<int> component_ids;
+  for (int i = 0; i < num_moves; ++i) {
+    int comp_id = comp(rng);
+    CompOrient orient = (rng() % 2 == 0) ? CompOrient::N : CompOrient::FS;
+    updates.push_back({comp_id, coordinate(rng), coordinate(rng), orient});
+    component_ids.push_back(comp_id);
+  }
+  design.ApplyPlacementUpdates(updates);
+  return component_ids;
+}
+
+// the map kept up to date by UpdateRUDY() must match a full ComputeRUDY()
+static void CheckRudy(PhyDB &phy_db, Stats &stats) {
+  Stats reference(&phy_db);
+  reference.ComputeRUDY();
+  std::vector<double> &expected = reference.GetRudyRef();
+  std::vector<double> &rudy = stats.GetRudyRef();
+  assert(rudy.size() == expected.size());
+  double max_value = *std::max_element(expected.begin(), expected.end());
+  assert(max_value > 0);
+  for (size_t i = 0; i < rudy.size(); ++i) {
+    assert(std::fabs(rudy[i] - expected[i]) <= 1e-9 * max_value);
+  }
+}
+
+/****
+ * RUDY maps updated after moving a few components, which re-evaluates only
+ * their nets, or many components, which falls back to a full pass, must
+ * equal a map computed from scratch.
+ */
+static void TestRudy() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 3000, 2000, 4, 21);
+  Design &design = phy_db.design();
+  Stats stats(&phy_db);
+  stats.SetNumThreads(4);
+  stats.ComputeRUDY();
+  CheckRudy(phy_db, stats);
+
+  std::mt19937 rng(5);
+  for (int round = 0; round < 5; ++round) {
+    std::vector<int> moved = MoveComponents(design, 20, rng);
+    stats.UpdateRUDY(moved);
+    CheckRudy(phy_db, stats);
+  }
+  std::vector<int> moved = MoveComponents(design, 2000, rng);
+  stats.UpdateRUDY(moved);
+  CheckRudy(phy_db, stats);
+}
+
+// the maps kept up to date by UpdatePinDensity() must match a full
+// ComputePinDensity(), for all layers together and for every layer
+static void CheckPinDensity(PhyDB &phy_db, Stats &stats) {
+  Stats reference(&phy_db);
+  reference.ComputePinDensity();
+  int grid_x = reference.GetPinDensityGridX();
+  int grid_y = reference.GetPinDensityGridY();
+  assert(stats.GetPinDensityGridX() == grid_x);
+  assert(stats.GetPinDensityGridY() == grid_y);
+  int num_layers = (int) phy_db.tech().GetLayersRef().size();
+  int num_pins = 0;
+  int num_metal1_pins = 0;
+  for (int layer_id = -1; layer_id < num_layers; ++layer_id) {
+    for (int y = 0; y < grid_y; ++y) {
+      for (int x = 0; x < grid_x; ++x) {
+        int count = reference.GetLayerPinDensity(layer_id, x, y);
+        assert(stats.GetLayerPinDensity(layer_id, x, y) == count);
+        if (layer_id == -1) num_pins += count;
+        if (layer_id == 0) num_metal1_pins += count;
+      }
+    }
+  }
+  // every pin of the synthetic design has its shape on metal1
+  assert(num_pins > 0);
+  assert(num_metal1_pins == num_pins);
+}
+
+/****
+ * Pin-density maps updated after moving and flipping components must equal
+ * maps computed from scratch.
+ */
+static void TestPinDensity() {
+  PhyDB phy_db;
+  BuildSyntheticDesign(phy_db, 3000, 2000, 4, 23);
+  Design &design = phy_db.design();
+  Stats stats(&phy_db);
+  stats.SetNumThreads(4);
+  stats.ComputePinDensity();
+  CheckPinDensity(phy_db, stats);
+
+  std::mt19937 rng(9);
+  for (int round = 0; round < 5; ++round) {
+    std::vector<int> moved = MoveComponents(design, 50, rng);
+    stats.UpdatePinDensity(moved);
+    CheckPinDensity(phy_db, stats);
+  }
+}
+
+int main() {
+  TestRudy();
+  TestPinDensity();
+
+  std::cout << "Stats test passes!" << std::endl;
+  return 0;
+}
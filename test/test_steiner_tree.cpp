@@ -0,0 +1,179 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Jiayuan He, Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "phydb/netconnectivity.h"
+#include "phydb/phydb.h"
+#include "phydb/steinertree.h"
+#include "synthetic_design.h"
+
+using namespace phydb;
+
+static int64_t ManhattanDistance(
+    Point2D<int> const &a,
+    Point2D<int> const &b
+) {
+  return std::abs((int64_t) a.x - b.x) + std::abs((int64_t) a.y - b.y);
+}
+
+// rectilinear minimum spanning tree length, by Prim's algorithm
+static int64_t MinimumSpanningTreeLength(
+    std::vector<Point2D<int>> const &pins
+) {
+  int num_pins = (int) pins.size();
+  if (num_pins < 2) return 0;
+  std::vector<int64_t> distance(num_pins, INT64_MAX);
+  std::vector<bool> is_in_tree(num_pins, false);
+  distance[0] = 0;
+  int64_t length = 0;
+  for (int k = 0; k < num_pins; ++k) {
+    int u = -1;
+    for (int v = 0; v < num_pins; ++v) {
+      if (!is_in_tree[v] && (u < 0 || distance[v] < distance[u])) u = v;
+    }
+    is_in_tree[u] = true;
+    length += distance[u];
+    for (int v = 0; v < num_pins; ++v) {
+      if (!is_in_tree[v]) {
+        distance[v] = std::min(
+            distance[v],
+            ManhattanDistance(pins[u], pins[v])
+        );
+      }
+    }
+  }
+  return length;
+}
+
+static int64_t HalfPerimeter(std::vector<Point2D<int>> const &pins) {
+  int min_x = INT_MAX, max_x = INT_MIN;
+  int min_y = INT_MAX, max_y = INT_MIN;
+  for (auto const &pin: pins) {
+    min_x = std::min(min_x, pin.x);
+    max_x = std::max(max_x, pin.x);
+    min_y = std::min(min_y, pin.y);
+    max_y = std::max(max_y, pin.y);
+  }
+  return (int64_t) max_x - min_x + (int64_t) max_y - min_y;
+}
+
+// every tree spans its pins, its length is the sum of its edges, and it is
+// no longer than the minimum spanning tree; trees of up to three pins are
+// optimal, i.e., as long as the half perimeter of the pins
+static void CheckTrees(PhyDB &phy_db, SteinerTreeEngine &engine) {
+  Design &design = phy_db.design();
+  NetConnectivity const &csr = engine.GetConnectivity();
+  std::vector<Point2D<int>> pins;
+  for (int net_id = 0; net_id < csr.GetNumNets(); ++net_id) {
+    pins.clear();
+    int end = csr.GetNetPinEnd(net_id);
+    for (int pin = csr.GetNetPinBegin(net_id); pin < end; ++pin) {
+      if (csr.IsIoPin(pin)) {
+        pins.push_back(design.GetIoPinLocation(csr.GetPinId(pin)));
+      } else {
+        pins.push_back(design.GetComponentPinLocation(
+            csr.GetPinComponentId(pin),
+            csr.GetPinId(pin)
+        ));
+      }
+    }
+    int num_pins = (int) pins.size();
+    if (num_pins < 2) continue;
+    int num_nodes = engine.GetNumNodes(net_id);
+    assert(num_nodes >= num_pins && num_nodes <= 2 * num_pins);
+    for (int i = 0; i < num_pins; ++i) {
+      assert(engine.GetNodeLocation(net_id, i).x == pins[i].x);
+      assert(engine.GetNodeLocation(net_id, i).y == pins[i].y);
+    }
+
+    // union-find over the nodes, the edges must connect all of them
+    std::vector<int> root(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) root[i] = i;
+    auto find = [&](int a) {
+      while (root[a] != a) a = root[a] = root[root[a]];
+      return a;
+    };
+    int64_t length = 0;
+    assert(engine.GetNumEdges(net_id) == num_nodes - 1);
+    for (int i = 0; i < engine.GetNumEdges(net_id); ++i) {
+      SteinerEdge const &edge = engine.GetEdge(net_id, i);
+      length += ManhattanDistance(
+          engine.GetNodeLocation(net_id, edge.u),
+          engine.GetNodeLocation(net_id, edge.v)
+      );
+      int ru = find(edge.u);
+      int rv = find(edge.v);
+      assert(ru != rv);
+      root[ru] = rv;
+    }
+    assert(engine.GetNetWirelength(net_id) == length);
+    assert(length <= MinimumSpanningTreeLength(pins));
+    if (num_pins <= 3) {
+      assert(length == HalfPerimeter(pins));
+    }
+  }
+}
+
+/****
+ * Steiner trees of random nets must be valid trees no longer than the
+ * minimum spanning tree, optimal on nets of up to three pins, and the same
+ * after incremental updates as after a full build.
+ */
+int main() {
+  // mostly two- and three-pin nets
+  PhyDB small_nets;
+  BuildSyntheticDesign(small_nets, 3000, 2500, 2, 19);
+  SteinerTreeEngine small_engine(&small_nets);
+  small_engine.SetNumThreads(4);
+  small_engine.Build();
+  CheckTrees(small_nets, small_engine);
+
+  // nets of up to 64 pins
+  PhyDB large_nets;
+  BuildSyntheticDesign(large_nets, 3000, 200, 63, 23);
+  SteinerTreeEngine large_engine(&large_nets);
+  large_engine.Build();
+  CheckTrees(large_nets, large_engine);
+
+  std::mt19937 rng(29);
+  std::uniform_int_distribution<int> coordinate(0, 198000);
+  std::uniform_int_distribution<int> comp_id(0, 2999);
+  auto &components = large_nets.design().GetComponentsRef();
+  for (int i = 0; i < 300; ++i) {
+    components[comp_id(rng)].SetLocation(coordinate(rng), coordinate(rng));
+  }
+  large_engine.Update();
+  CheckTrees(large_nets, large_engine);
+  SteinerTreeEngine rebuilt_engine(&large_nets);
+  rebuilt_engine.Build();
+  assert(large_engine.GetTotalWirelength()
+             == rebuilt_engine.GetTotalWirelength());
+
+  std::cout << "Steiner tree test passes!" << std::endl;
+  return 0;
+}